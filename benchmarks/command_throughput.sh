@@ -0,0 +1,64 @@
+#!/bin/sh
+# Measures cmgui command throughput. Runs cmgui on two comfiles: one with only
+# "quit" to time start up and shut down, and one with NUMBER_OF_COMMANDS
+# gfx modify and gfx set commands before "quit". The difference gives the time
+# spent parsing and executing the commands, best of REPEATS runs.
+#
+# Usage: command_throughput.sh [CMGUI_EXECUTABLE [NUMBER_OF_COMMANDS [REPEATS]]]
+#
+# Run with builds from before and after a change to compare commands/second.
+
+CMGUI=${1:-cmgui}
+NUMBER_OF_COMMANDS=${2:-20000}
+REPEATS=${3:-3}
+WORK_DIRECTORY=$(mktemp -d "${TMPDIR:-/tmp}/cmgui_command_throughput.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+seconds_now()
+{
+	date +%s.%N
+}
+
+# run_cmgui COMFILE: runs the commands in COMFILE, printing elapsed seconds
+run_cmgui()
+{
+	START=$(seconds_now)
+	(cd "$WORK_DIRECTORY" && "$CMGUI" -no_display "$1" > "$1.log" 2>&1)
+	STATUS=$?
+	END=$(seconds_now)
+	awk -v start="$START" -v end="$END" 'BEGIN { print end - start }'
+	return $STATUS
+}
+
+# best_of COMFILE: prints the least elapsed seconds of REPEATS runs
+best_of()
+{
+	BEST=""
+	RUN=0
+	while [ $RUN -lt "$REPEATS" ]; do
+		SECONDS_TAKEN=$(run_cmgui "$1")
+		BEST=$(awk -v best="$BEST" -v taken="$SECONDS_TAKEN" \
+			'BEGIN { print ((best == "") || (taken < best)) ? taken : best }')
+		RUN=$((RUN + 1))
+	done
+	echo "$BEST"
+}
+
+echo "quit" > "$WORK_DIRECTORY/startup.com"
+STARTUP_SECONDS=$(best_of startup.com)
+
+awk -v n="$NUMBER_OF_COMMANDS" 'BEGIN {
+	for (i = 0; i < n; i += 2) {
+		printf "gfx modify material default diffuse %g 0.5 0.5\n", (i % 100)/100.0;
+		print "gfx set point_size 1";
+	}
+	print "quit";
+}' > "$WORK_DIRECTORY/commands.com"
+TOTAL_SECONDS=$(best_of commands.com)
+
+awk -v n="$NUMBER_OF_COMMANDS" -v total="$TOTAL_SECONDS" -v startup="$STARTUP_SECONDS" 'BEGIN {
+	print "start up and shut down: " startup " seconds";
+	print n " commands: " total - startup " seconds";
+	if (total - startup > 0)
+		print "commands per second: " n/(total - startup);
+}'
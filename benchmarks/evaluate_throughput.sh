@@ -0,0 +1,56 @@
+#!/bin/sh
+# Measures gfx evaluate throughput over a nodeset. Writes NUMBER_OF_POINTS
+# data points with coordinates and a scalar result field, then runs cmgui
+# with the commands in evaluate_throughput.com evaluating the result from a
+# computed field of the coordinates REPEATS times. A run reading the data and
+# defining the fields without evaluating gives the start up time to subtract.
+#
+# Usage: evaluate_throughput.sh [CMGUI_EXECUTABLE [NUMBER_OF_POINTS [REPEATS]]]
+#
+# Run with builds from before and after a change to compare points/second.
+
+CMGUI=${1:-cmgui}
+NUMBER_OF_POINTS=${2:-1000000}
+REPEATS=${3:-5}
+BENCHMARK_DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+WORK_DIRECTORY=$(mktemp -d "${TMPDIR:-/tmp}/cmgui_evaluate_throughput.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+seconds_now()
+{
+	date +%s.%N
+}
+
+run_cmgui()
+{
+	START=$(seconds_now)
+	(cd "$WORK_DIRECTORY" && "$CMGUI" -no_display "$1" > /dev/null 2>&1)
+	END=$(seconds_now)
+	awk -v start="$START" -v end="$END" 'BEGIN { print end - start }'
+}
+
+awk -v n="$NUMBER_OF_POINTS" 'BEGIN {
+	print " Group name: benchmark";
+	print " #Fields=2";
+	print " 1) coordinates, coordinate, rectangular cartesian, #Components=3";
+	print "   x.  Value index= 1, #Derivatives= 0";
+	print "   y.  Value index= 2, #Derivatives= 0";
+	print "   z.  Value index= 3, #Derivatives= 0";
+	print " 2) result, field, rectangular cartesian, #Components=1";
+	print "   1.  Value index= 4, #Derivatives= 0";
+	for (i = 1; i <= n; i++) {
+		printf " Node: %d\n %g %g %g 0\n", i, (i % 1000)*0.001, (int(i/1000) % 1000)*0.001, int(i/1000000)*0.001;
+	}
+}' > "$WORK_DIRECTORY/points.exdata"
+
+grep -v "^gfx evaluate" "$BENCHMARK_DIRECTORY/evaluate_throughput.com" > "$WORK_DIRECTORY/read.com"
+READ_SECONDS=$(run_cmgui "$WORK_DIRECTORY/read.com")
+echo "start up and read $NUMBER_OF_POINTS points: $READ_SECONDS seconds"
+
+awk -v repeats="$REPEATS" '/^gfx evaluate/ { for (r = 1; r < repeats; r++) print } { print }' \
+	"$BENCHMARK_DIRECTORY/evaluate_throughput.com" > "$WORK_DIRECTORY/repeat.com"
+TOTAL_SECONDS=$(run_cmgui "$WORK_DIRECTORY/repeat.com")
+awk -v total="$TOTAL_SECONDS" -v read="$READ_SECONDS" -v repeats="$REPEATS" -v n="$NUMBER_OF_POINTS" \
+	'BEGIN { seconds = (total - read)/repeats;
+		print seconds " seconds per gfx evaluate";
+		if (seconds > 0) print n/seconds " points per second" }'
@@ -0,0 +1,154 @@
+/***************************************************************************//**
+ * event_dispatch.cpp
+ *
+ * Micro-benchmark for the generic event dispatcher. Registers many idle file
+ * descriptors and far future timeouts, then times Event_dispatcher_do_one_event
+ * dispatching a single ready descriptor and a single due timeout. Built and run
+ * by event_dispatch.sh against the event_dispatcher.cpp of a cmgui source tree.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+#include "user_interface/event_dispatcher.h"
+
+namespace {
+
+int descriptor_events = 0;
+int timeout_events = 0;
+int idle_events = 0;
+
+double seconds_now()
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + 1.0e-9*now.tv_nsec;
+}
+
+int read_byte(Fdio_id, void *descriptor_void)
+{
+	char byte;
+	if (1 == read(*static_cast<int *>(descriptor_void), &byte, 1))
+		++descriptor_events;
+	return 1;
+}
+
+int count_timeout(void *)
+{
+	++timeout_events;
+	return 1;
+}
+
+int idle_read(Fdio_id, void *)
+{
+	++idle_events;
+	return 1;
+}
+
+int idle_timeout(void *)
+{
+	++idle_events;
+	return 1;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+	const int number_of_descriptors = (1 < argc) ? atoi(argv[1]) : 200;
+	const int number_of_timeouts = (2 < argc) ? atoi(argv[2]) : 200;
+	const int iterations = (3 < argc) ? atoi(argv[3]) : 20000;
+	if ((number_of_descriptors < 0) || (number_of_timeouts < 0) || (iterations < 1))
+	{
+		fprintf(stderr, "Usage: event_dispatch [NUMBER_OF_DESCRIPTORS [NUMBER_OF_TIMEOUTS [ITERATIONS]]]\n");
+		return 1;
+	}
+	struct Event_dispatcher *event_dispatcher = CREATE(Event_dispatcher)();
+	if (!event_dispatcher)
+	{
+		fprintf(stderr, "event_dispatch: could not create event dispatcher\n");
+		return 1;
+	}
+	/* the active pipe is created first so it has a low descriptor number */
+	int active_pipe[2];
+	if (0 != pipe(active_pipe))
+	{
+		fprintf(stderr, "event_dispatch: could not create pipe\n");
+		return 1;
+	}
+	Fdio_id active_fdio = Event_dispatcher_create_Fdio(event_dispatcher, active_pipe[0]);
+	Fdio_set_read_callback(active_fdio, read_byte, &active_pipe[0]);
+
+	std::vector<int> idle_pipes;
+	std::vector<Fdio_id> idle_fdios;
+	for (int i = 0; i < number_of_descriptors; ++i)
+	{
+		int idle_pipe[2];
+		if (0 != pipe(idle_pipe))
+		{
+			fprintf(stderr, "event_dispatch: could only create %d idle descriptors\n", i);
+			break;
+		}
+		idle_pipes.push_back(idle_pipe[0]);
+		idle_pipes.push_back(idle_pipe[1]);
+		Fdio_id idle_fdio = Event_dispatcher_create_Fdio(event_dispatcher, idle_pipe[0]);
+		Fdio_set_read_callback(idle_fdio, idle_read, NULL);
+		idle_fdios.push_back(idle_fdio);
+	}
+	std::vector<struct Event_dispatcher_timeout_callback *> idle_timeouts;
+	for (int i = 0; i < number_of_timeouts; ++i)
+	{
+		idle_timeouts.push_back(Event_dispatcher_add_timeout_callback(event_dispatcher,
+			/*timeout_s*/3600 + i, /*timeout_ns*/0, idle_timeout, NULL));
+	}
+
+	const char byte = 0;
+	double start = seconds_now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		if (1 != write(active_pipe[1], &byte, 1))
+			break;
+		Event_dispatcher_do_one_event(event_dispatcher);
+	}
+	const double descriptor_seconds = seconds_now() - start;
+
+	start = seconds_now();
+	for (int i = 0; i < iterations; ++i)
+	{
+		Event_dispatcher_add_timeout_callback(event_dispatcher,
+			/*timeout_s*/0, /*timeout_ns*/0, count_timeout, NULL);
+		Event_dispatcher_do_one_event(event_dispatcher);
+	}
+	const double timeout_seconds = seconds_now() - start;
+
+	printf("descriptors: %d idle + 1 active, timeouts: %d pending\n",
+		static_cast<int>(idle_fdios.size()), static_cast<int>(idle_timeouts.size()));
+	printf("descriptor dispatch: %d of %d events, %.3f microseconds per event\n",
+		descriptor_events, iterations, 1.0e6*descriptor_seconds/iterations);
+	printf("timeout dispatch: %d of %d events, %.3f microseconds per event\n",
+		timeout_events, iterations, 1.0e6*timeout_seconds/iterations);
+
+	for (size_t i = 0; i < idle_timeouts.size(); ++i)
+		Event_dispatcher_remove_timeout_callback(event_dispatcher, idle_timeouts[i]);
+	for (size_t i = 0; i < idle_fdios.size(); ++i)
+		DESTROY(Fdio)(&idle_fdios[i]);
+	DESTROY(Fdio)(&active_fdio);
+	DESTROY(Event_dispatcher)(&event_dispatcher);
+	for (size_t i = 0; i < idle_pipes.size(); ++i)
+		close(idle_pipes[i]);
+	close(active_pipe[0]);
+	close(active_pipe[1]);
+	const int failures = ((descriptor_events != iterations) ? 1 : 0) +
+		((timeout_events != iterations) ? 1 : 0) + ((0 != idle_events) ? 1 : 0);
+	if (failures)
+		printf("FAIL: %d idle callbacks called, %d descriptor and %d timeout events missed\n",
+			idle_events, iterations - descriptor_events, iterations - timeout_events);
+	return failures;
+}
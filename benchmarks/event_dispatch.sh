@@ -0,0 +1,39 @@
+#!/bin/sh
+# Times event dispatch with many idle descriptors and pending timeouts. Builds
+# event_dispatch.cpp against source/user_interface/event_dispatcher.cpp of the
+# cmgui source tree given, using the generic (console) event dispatcher, then
+# registers NUMBER_OF_DESCRIPTORS idle pipes and NUMBER_OF_TIMEOUTS far future
+# timeouts and reports the time per Event_dispatcher_do_one_event to dispatch
+# one ready descriptor and one due timeout, averaged over ITERATIONS events.
+# Run it once per source tree to compare dispatchers. Keep descriptors under
+# FD_SETSIZE/2 for trees whose dispatcher uses select.
+# Exits with non-zero status if the build fails or any event is missed.
+#
+# The Zinc headers and library the tree builds against are taken from the
+# environment: ZINC_CFLAGS (e.g. -I<zinc source>/src -I<zinc build>/src) and
+# ZINC_LIBS (e.g. -L<zinc build>/lib -lzinc); CXX defaults to c++.
+#
+# Usage: event_dispatch.sh [CMGUI_SOURCE_DIRECTORY [NUMBER_OF_DESCRIPTORS [NUMBER_OF_TIMEOUTS [ITERATIONS]]]]
+
+BENCHMARK_DIRECTORY=$(cd "$(dirname "$0")" && pwd)
+SOURCE_DIRECTORY=${1:-$BENCHMARK_DIRECTORY/..}
+NUMBER_OF_DESCRIPTORS=${2:-200}
+NUMBER_OF_TIMEOUTS=${3:-200}
+ITERATIONS=${4:-20000}
+WORK_DIRECTORY=$(mktemp -d "${TMPDIR:-/tmp}/cmgui_event_dispatch.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+
+# console build: no user interface defines, so the generic dispatcher is used
+mkdir "$WORK_DIRECTORY/configure"
+cat > "$WORK_DIRECTORY/configure/cmgui_configure.h" <<HEADER
+#ifndef CMGUI_CONFIGURE_H
+#define CMGUI_CONFIGURE_H
+#define CONSOLE_USER_INTERFACE
+#endif
+HEADER
+
+${CXX:-c++} -O2 -I"$WORK_DIRECTORY" -I"$SOURCE_DIRECTORY/source" $ZINC_CFLAGS \
+	-o "$WORK_DIRECTORY/event_dispatch" "$BENCHMARK_DIRECTORY/event_dispatch.cpp" \
+	"$SOURCE_DIRECTORY/source/user_interface/event_dispatcher.cpp" $ZINC_LIBS || exit 1
+
+"$WORK_DIRECTORY/event_dispatch" "$NUMBER_OF_DESCRIPTORS" "$NUMBER_OF_TIMEOUTS" "$ITERATIONS"
@@ -0,0 +1,146 @@
+#!/bin/sh
+# Compares reading large EX files through a memory mapping against reading
+# them as a stream. Writes an EX region file of NUMBER_OF_REGIONS child
+# regions, each with NODES_PER_REGION nodes with coordinates and first
+# derivatives, and an EX node file of all of them in one region, then with the
+# cmgui given:
+# - reads each file with mmap and with no_mmap and writes its nodes as EX,
+#   checking the results match;
+# - times each read, best of REPEATS runs, less the time to start up and shut
+#   down with no commands.
+# The defaults give files of about 100 MB, above the size at which cmgui
+# memory maps a file when neither mmap nor no_mmap is given.
+# Exits with non-zero status if any check fails.
+#
+# Usage: mapped_read.sh [CMGUI_EXECUTABLE [NUMBER_OF_REGIONS [NODES_PER_REGION [REPEATS]]]]
+
+CMGUI=${1:-cmgui}
+NUMBER_OF_REGIONS=${2:-20}
+NODES_PER_REGION=${3:-125000}
+REPEATS=${4:-3}
+WORK_DIRECTORY=$(mktemp -d "${TMPDIR:-/tmp}/cmgui_mapped_read.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+FAILURES=0
+
+seconds_now()
+{
+	date +%s.%N
+}
+
+# run_cmgui COMFILE: runs the commands in COMFILE, printing elapsed seconds
+run_cmgui()
+{
+	START=$(seconds_now)
+	(cd "$WORK_DIRECTORY" && "$CMGUI" -no_display "$1" > "$1.log" 2>&1)
+	STATUS=$?
+	END=$(seconds_now)
+	awk -v start="$START" -v end="$END" 'BEGIN { print end - start }'
+	return $STATUS
+}
+
+# best_of COMFILE: prints the least elapsed seconds of REPEATS runs
+best_of()
+{
+	BEST=""
+	RUN=0
+	while [ $RUN -lt "$REPEATS" ]; do
+		SECONDS_TAKEN=$(run_cmgui "$1")
+		BEST=$(awk -v best="$BEST" -v taken="$SECONDS_TAKEN" \
+			'BEGIN { print ((best == "") || (taken < best)) ? taken : best }')
+		RUN=$((RUN + 1))
+	done
+	echo "$BEST"
+}
+
+check()
+{
+	if [ "$2" -eq 0 ]; then
+		echo "PASS: $1"
+	else
+		echo "FAIL: $1"
+		FAILURES=$((FAILURES + 1))
+	fi
+}
+
+# write_nodes REGION_HEADERS: writes the nodes of every region, each under its
+# own region header if REGION_HEADERS is 1, otherwise numbered on in one region
+write_nodes()
+{
+	awk -v regions="$NUMBER_OF_REGIONS" -v n="$NODES_PER_REGION" -v header="$1" 'BEGIN {
+		for (r = 1; r <= regions; r++) {
+			if (header)
+				printf " Region: /r%d\n", r;
+			if (header || (r == 1)) {
+				print " #Fields=1";
+				print " 1) coordinates, coordinate, rectangular cartesian, #Components=3";
+				print "   x.  Value index= 1, #Derivatives= 1 (d/ds1)";
+				print "   y.  Value index= 3, #Derivatives= 1 (d/ds1)";
+				print "   z.  Value index= 5, #Derivatives= 1 (d/ds1)";
+			}
+			for (i = 1; i <= n; i++) {
+				printf " Node: %d\n %.15g 1\n %.15g 0.5\n %.15g 0.25\n",
+					header ? i : (r - 1)*n + i,
+					(i % 100)*0.01, (int(i/100) % 100)*0.01, r*0.01;
+			}
+		}
+	}'
+}
+
+write_nodes 1 > "$WORK_DIRECTORY/model.exregion"
+write_nodes 0 > "$WORK_DIRECTORY/model.exnode"
+ls -l "$WORK_DIRECTORY/model.exregion" "$WORK_DIRECTORY/model.exnode" |
+	awk '{ print $NF ": " $5/1048576 " MB" }' | sed "s|$WORK_DIRECTORY/||"
+
+echo "quit" > "$WORK_DIRECTORY/startup.com"
+STARTUP_SECONDS=$(best_of startup.com)
+echo "start up and shut down: $STARTUP_SECONDS seconds"
+
+for MODE in mmap no_mmap; do
+	{
+		echo "gfx read region model.exregion $MODE"
+		R=1
+		while [ $R -le "$NUMBER_OF_REGIONS" ]; do
+			echo "gfx write nodes region_${MODE}_$R.exnode group r$R"
+			R=$((R + 1))
+		done
+		echo "quit"
+	} > "$WORK_DIRECTORY/check_region_$MODE.com"
+	run_cmgui "check_region_$MODE.com" > /dev/null
+	check "read region file with $MODE" $?
+	cat > "$WORK_DIRECTORY/check_nodes_$MODE.com" <<COMMANDS
+gfx read nodes model.exnode $MODE
+gfx write nodes nodes_$MODE.exnode
+quit
+COMMANDS
+	run_cmgui "check_nodes_$MODE.com" > /dev/null
+	check "read node file with $MODE" $?
+done
+R=1
+while [ $R -le "$NUMBER_OF_REGIONS" ]; do
+	cmp -s "$WORK_DIRECTORY/region_mmap_$R.exnode" "$WORK_DIRECTORY/region_no_mmap_$R.exnode" ||
+		break
+	R=$((R + 1))
+done
+test $R -gt "$NUMBER_OF_REGIONS" && test -s "$WORK_DIRECTORY/region_mmap_1.exnode"
+check "region file read the same with mmap and no_mmap" $?
+test -s "$WORK_DIRECTORY/nodes_mmap.exnode" &&
+	cmp -s "$WORK_DIRECTORY/nodes_mmap.exnode" "$WORK_DIRECTORY/nodes_no_mmap.exnode"
+check "node file read the same with mmap and no_mmap" $?
+
+for MODE in mmap no_mmap; do
+	printf 'gfx read region model.exregion %s\nquit\n' "$MODE" > "$WORK_DIRECTORY/time_region_$MODE.com"
+	printf 'gfx read nodes model.exnode %s\nquit\n' "$MODE" > "$WORK_DIRECTORY/time_nodes_$MODE.com"
+done
+for FILE in region nodes; do
+	MMAP_SECONDS=$(best_of "time_${FILE}_mmap.com")
+	STREAM_SECONDS=$(best_of "time_${FILE}_no_mmap.com")
+	awk -v file="$FILE" -v mapped="$MMAP_SECONDS" -v stream="$STREAM_SECONDS" \
+		-v startup="$STARTUP_SECONDS" 'BEGIN {
+		print "read " file " with mmap: " mapped - startup " seconds";
+		print "read " file " with no_mmap: " stream - startup " seconds";
+		if (mapped - startup > 0)
+			print "speed up: " (stream - startup)/(mapped - startup);
+	}'
+done
+
+exit $FAILURES
@@ -0,0 +1,112 @@
+#!/bin/sh
+# Tests and times the binary region format. Writes NUMBER_OF_NODES nodes with
+# coordinates and first derivatives in a group, then with the cmgui given:
+# - reads the EX file and writes it back as EX, as a binary region file and as
+#   a compressed binary region file;
+# - reads each binary file into a fresh session and writes it as EX, checking
+#   the result matches the EX written from the original;
+# - reads a truncated binary file and one whose block header claims more data
+#   than the file holds, checking cmgui reports an error and exits cleanly;
+# - reports the time to read each format, less start up time.
+# Exits with non-zero status if any check fails.
+#
+# Usage: region_binary.sh [CMGUI_EXECUTABLE [NUMBER_OF_NODES]]
+
+CMGUI=${1:-cmgui}
+NUMBER_OF_NODES=${2:-200000}
+WORK_DIRECTORY=$(mktemp -d "${TMPDIR:-/tmp}/cmgui_region_binary.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+FAILURES=0
+
+seconds_now()
+{
+	date +%s.%N
+}
+
+# run_cmgui COMFILE: runs the commands in COMFILE, printing elapsed seconds
+run_cmgui()
+{
+	START=$(seconds_now)
+	(cd "$WORK_DIRECTORY" && "$CMGUI" -no_display "$1" > "$1.log" 2>&1)
+	STATUS=$?
+	END=$(seconds_now)
+	awk -v start="$START" -v end="$END" 'BEGIN { print end - start }'
+	return $STATUS
+}
+
+check()
+{
+	if [ "$2" -eq 0 ]; then
+		echo "PASS: $1"
+	else
+		echo "FAIL: $1"
+		FAILURES=$((FAILURES + 1))
+	fi
+}
+
+awk -v n="$NUMBER_OF_NODES" 'BEGIN {
+	print " Group name: benchmark";
+	print " #Fields=1";
+	print " 1) coordinates, coordinate, rectangular cartesian, #Components=3";
+	print "   x.  Value index= 1, #Derivatives= 1 (d/ds1)";
+	print "   y.  Value index= 3, #Derivatives= 1 (d/ds1)";
+	print "   z.  Value index= 5, #Derivatives= 1 (d/ds1)";
+	for (i = 1; i <= n; i++) {
+		printf " Node: %d\n %.15g 1\n %.15g 0.5\n %.15g 0.25\n", i,
+			(i % 100)*0.01, (int(i/100) % 100)*0.01, int(i/10000)*0.01;
+	}
+}' > "$WORK_DIRECTORY/model.exnode"
+
+echo "quit" > "$WORK_DIRECTORY/startup.com"
+STARTUP_SECONDS=$(run_cmgui startup.com)
+echo "start up and shut down: $STARTUP_SECONDS seconds"
+
+cat > "$WORK_DIRECTORY/write.com" <<COMMANDS
+gfx read nodes model.exnode
+gfx write nodes original.exnode
+gfx write region model.cmregion format binary
+gfx write region compressed.cmregion format binary compress
+quit
+COMMANDS
+run_cmgui write.com > /dev/null
+check "write binary region files" $?
+
+for NAME in model compressed; do
+	cat > "$WORK_DIRECTORY/read_$NAME.com" <<COMMANDS
+gfx read region $NAME.cmregion
+gfx write nodes $NAME.exnode
+quit
+COMMANDS
+	run_cmgui "read_$NAME.com" > /dev/null
+	cmp -s "$WORK_DIRECTORY/original.exnode" "$WORK_DIRECTORY/$NAME.exnode"
+	check "round trip through $NAME.cmregion" $?
+done
+
+# truncated file and a block header claiming 2^60 bytes of data
+SIZE=$(wc -c < "$WORK_DIRECTORY/model.cmregion")
+head -c $((SIZE / 2)) "$WORK_DIRECTORY/model.cmregion" > "$WORK_DIRECTORY/truncated.cmregion"
+head -c 20 "$WORK_DIRECTORY/model.cmregion" > "$WORK_DIRECTORY/oversized.cmregion"
+printf '\001\000\000\000\000\000\000\000\000\000\000\000\000\000\000\020\000\000\000\000\000\000\000\020' \
+	>> "$WORK_DIRECTORY/oversized.cmregion"
+for NAME in truncated oversized; do
+	cat > "$WORK_DIRECTORY/read_$NAME.com" <<COMMANDS
+gfx read region $NAME.cmregion
+quit
+COMMANDS
+	run_cmgui "read_$NAME.com" > /dev/null
+	STATUS=$?
+	grep -q "Binary region file" "$WORK_DIRECTORY/read_$NAME.com.log"
+	check "$NAME file rejected with an error" $((STATUS + $?))
+done
+
+echo "gfx read nodes model.exnode" > "$WORK_DIRECTORY/time_ex.com"
+echo "gfx read region model.cmregion" > "$WORK_DIRECTORY/time_model.com"
+echo "gfx read region compressed.cmregion" > "$WORK_DIRECTORY/time_compressed.com"
+for NAME in ex model compressed; do
+	echo "quit" >> "$WORK_DIRECTORY/time_$NAME.com"
+	TOTAL_SECONDS=$(run_cmgui "time_$NAME.com")
+	awk -v name="$NAME" -v total="$TOTAL_SECONDS" -v startup="$STARTUP_SECONDS" \
+		'BEGIN { print "read " name ": " total - startup " seconds" }'
+done
+
+exit $FAILURES
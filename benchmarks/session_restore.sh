@@ -0,0 +1,142 @@
+#!/bin/sh
+# Compares session start up time restoring from a comfile against restoring
+# from a snapshot. Builds a session of NUMBER_OF_REGIONS child regions, each
+# with NODES_PER_REGION nodes, materials and a points graphic, plus a region
+# with time varying nodal parameters, then with the cmgui given:
+# - writes the session as a snapshot and its nodes as EX;
+# - restores the snapshot into a fresh session and writes its nodes as EX,
+#   checking they match, including the time varying region at time 1;
+# - times start up with the comfile and with the snapshot, best of REPEATS
+#   runs, less the time to start up and shut down with no commands.
+# Exits with non-zero status if any check fails.
+#
+# Usage: session_restore.sh [CMGUI_EXECUTABLE [NUMBER_OF_REGIONS [NODES_PER_REGION [REPEATS]]]]
+
+CMGUI=${1:-cmgui}
+NUMBER_OF_REGIONS=${2:-50}
+NODES_PER_REGION=${3:-2000}
+REPEATS=${4:-3}
+WORK_DIRECTORY=$(mktemp -d "${TMPDIR:-/tmp}/cmgui_session_restore.XXXXXX") || exit 1
+trap 'rm -rf "$WORK_DIRECTORY"' EXIT
+FAILURES=0
+
+seconds_now()
+{
+	date +%s.%N
+}
+
+# run_cmgui COMFILE: runs the commands in COMFILE, printing elapsed seconds
+run_cmgui()
+{
+	START=$(seconds_now)
+	(cd "$WORK_DIRECTORY" && "$CMGUI" -no_display "$1" > "$1.log" 2>&1)
+	STATUS=$?
+	END=$(seconds_now)
+	awk -v start="$START" -v end="$END" 'BEGIN { print end - start }'
+	return $STATUS
+}
+
+# best_of COMFILE: prints the least elapsed seconds of REPEATS runs
+best_of()
+{
+	BEST=""
+	RUN=0
+	while [ $RUN -lt "$REPEATS" ]; do
+		SECONDS_TAKEN=$(run_cmgui "$1")
+		BEST=$(awk -v best="$BEST" -v taken="$SECONDS_TAKEN" \
+			'BEGIN { print ((best == "") || (taken < best)) ? taken : best }')
+		RUN=$((RUN + 1))
+	done
+	echo "$BEST"
+}
+
+check()
+{
+	if [ "$2" -eq 0 ]; then
+		echo "PASS: $1"
+	else
+		echo "FAIL: $1"
+		FAILURES=$((FAILURES + 1))
+	fi
+}
+
+awk -v regions="$NUMBER_OF_REGIONS" -v n="$NODES_PER_REGION" 'BEGIN {
+	for (r = 1; r <= regions; r++) {
+		printf " Region: /r%d\n", r;
+		print " #Fields=1";
+		print " 1) coordinates, coordinate, rectangular cartesian, #Components=3";
+		print "   x.  Value index= 1, #Derivatives= 0";
+		print "   y.  Value index= 2, #Derivatives= 0";
+		print "   z.  Value index= 3, #Derivatives= 0";
+		for (i = 1; i <= n; i++) {
+			printf " Node: %d\n %.15g %.15g %.15g\n", i,
+				(i % 100)*0.01, (int(i/100) % 100)*0.01, r*0.01;
+		}
+	}
+}' > "$WORK_DIRECTORY/model.exregion"
+
+for TIME in 0 1; do
+	awk -v t="$TIME" 'BEGIN {
+		print " #Fields=1";
+		print " 1) coordinates, coordinate, rectangular cartesian, #Components=3";
+		print "   x.  Value index= 1, #Derivatives= 0";
+		print "   y.  Value index= 2, #Derivatives= 0";
+		print "   z.  Value index= 3, #Derivatives= 0";
+		for (i = 1; i <= 100; i++)
+			printf " Node: %d\n %.15g %.15g %.15g\n", i, i*0.01, t, t*i*0.01;
+	}' > "$WORK_DIRECTORY/timed_$TIME.exnode"
+done
+
+{
+	echo "gfx read region model.exregion"
+	echo "gfx read nodes timed_0.exnode region timed time 0"
+	echo "gfx read nodes timed_1.exnode region timed time 1"
+	echo "gfx create spectrum heights"
+	R=1
+	while [ $R -le "$NUMBER_OF_REGIONS" ]; do
+		echo "gfx create material material_$R diffuse 0.$((R % 10)) 0.5 0.5"
+		echo "gfx modify g_element /r$R points domain_nodes coordinate coordinates glyph sphere size \"0.005*0.005*0.005\" material material_$R"
+		R=$((R + 1))
+	done
+} > "$WORK_DIRECTORY/session.com"
+
+echo "quit" > "$WORK_DIRECTORY/startup.com"
+STARTUP_SECONDS=$(best_of startup.com)
+echo "start up and shut down: $STARTUP_SECONDS seconds"
+
+{
+	cat "$WORK_DIRECTORY/session.com"
+	echo "gfx write snapshot session.cmsnapshot"
+	echo "gfx write nodes original.exnode"
+	echo "gfx write nodes timed_original.exnode group timed time 1"
+	echo "quit"
+} > "$WORK_DIRECTORY/write.com"
+run_cmgui write.com > /dev/null
+check "write snapshot" $?
+test -s "$WORK_DIRECTORY/session.cmsnapshot"
+check "snapshot file written" $?
+
+cat > "$WORK_DIRECTORY/restore.com" <<COMMANDS
+gfx read snapshot session.cmsnapshot
+gfx write nodes restored.exnode
+gfx write nodes timed_restored.exnode group timed time 1
+quit
+COMMANDS
+run_cmgui restore.com > /dev/null
+cmp -s "$WORK_DIRECTORY/original.exnode" "$WORK_DIRECTORY/restored.exnode"
+check "nodes restored from snapshot" $?
+cmp -s "$WORK_DIRECTORY/timed_original.exnode" "$WORK_DIRECTORY/timed_restored.exnode"
+check "time varying nodes restored from snapshot" $?
+
+echo "quit" >> "$WORK_DIRECTORY/session.com"
+printf 'gfx read snapshot session.cmsnapshot\nquit\n' > "$WORK_DIRECTORY/snapshot.com"
+COMFILE_SECONDS=$(best_of session.com)
+SNAPSHOT_SECONDS=$(best_of snapshot.com)
+awk -v comfile="$COMFILE_SECONDS" -v snapshot="$SNAPSHOT_SECONDS" -v startup="$STARTUP_SECONDS" 'BEGIN {
+	print "restore from comfile: " comfile - startup " seconds";
+	print "restore from snapshot: " snapshot - startup " seconds";
+	if (snapshot - startup > 0)
+		print "speed up: " (comfile - startup)/(snapshot - startup);
+}'
+
+exit $FAILURES
@@ -60,6 +60,7 @@ SET(APP_HDRS
     source/graphics/element_point_ranges_app.h
     source/graphics/environment_map_app.h
     source/finite_element/finite_element_region_app.h
+    source/finite_element/finite_element_ranges_app.hpp
     source/graphics/font_app.h
     source/graphics/scene_viewer_app.h
     source/graphics/glyph_app.h
@@ -72,6 +73,7 @@ SET(APP_HDRS
     source/graphics/auxiliary_graphics_types_app.h
     source/finite_element/finite_element_conversion_app.h
     source/graphics/texture_app.h
+    source/graphics/texture_image_series_app.hpp
     source/graphics/colour_app.h
     source/graphics/scene_app.h
     source/graphics/scenefilter_app.hpp
@@ -79,6 +81,14 @@ SET(APP_HDRS
     source/graphics/light_app.h
     source/computed_field/computed_field_set_app.h
     source/general/multi_range_app.h
+    source/general/elapsed_time_app.h
+    source/general/comfile_capture_app.hpp
+    source/general/mapped_file_app.hpp
+    source/general/movie_writer_app.hpp
+    source/general/thread_pool_app.hpp
+    source/general/zip_writer_app.hpp
+    source/general/tiled_image_writer_app.hpp
+    source/general/text_ring_buffer_app.hpp
     source/choose/choose_class.hpp
     source/choose/choose_enumerator_class.hpp
     source/choose/choose_listbox_class.hpp
@@ -92,6 +102,7 @@ SET(APP_HDRS
     source/comfile/comfile.h
     source/command/cmiss.h
     source/command/command.h
+    source/command/command_server_app.h
     source/command/console.h
     source/command/example_path.h
     source/command/parser.h
@@ -115,6 +126,9 @@ SET(APP_HDRS
     source/interaction/interactive_tool_private.h
     source/io_devices/matrix.h
     source/region/cmiss_region_app.h
+    source/node/node_time_series_app.hpp
+    source/region/region_binary_app.h
+    source/region/region_snapshot_app.h
     source/node/node_tool.h
     source/three_d_drawing/window_system_extensions.h
     source/colour/colour_editor_wx.hpp
@@ -60,11 +60,20 @@ SET(APP_SRCS
     source/graphics/tessellation_app.cpp
     source/curve/curve_app.cpp
     source/graphics/texture_app.cpp
+    source/graphics/texture_image_series_app.cpp
     source/three_d_drawing/graphics_buffer_app.cpp
+    source/general/comfile_capture_app.cpp
+    source/general/elapsed_time_app.cpp
     source/general/geometry_app.cpp
+    source/general/mapped_file_app.cpp
+    source/general/movie_writer_app.cpp
     source/computed_field/computed_field_app.cpp
     source/computed_field/computed_field_set_app.cpp
     source/general/multi_range_app.cpp
+    source/general/thread_pool_app.cpp
+    source/general/zip_writer_app.cpp
+    source/general/tiled_image_writer_app.cpp
+    source/general/text_ring_buffer_app.cpp
     source/graphics/auxiliary_graphics_types_app.cpp
     source/graphics/light_app.cpp
     source/graphics/scene_app.cpp
@@ -74,11 +83,15 @@ SET(APP_SRCS
     source/graphics/colour_app.cpp
     source/graphics/material_app.cpp
     source/region/cmiss_region_app.cpp
+    source/node/node_time_series_app.cpp
+    source/region/region_binary_app.cpp
+    source/region/region_snapshot_app.cpp
     source/graphics/scene_viewer_app.cpp
     source/cmgui.cpp
     source/comfile/comfile.cpp
     source/command/cmiss.cpp
     source/command/command.cpp
+    source/command/command_server_app.cpp
     source/command/console.cpp
     source/command/example_path.cpp
     source/command/parser.cpp
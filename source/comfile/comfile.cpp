@@ -79,6 +79,9 @@ specified on the command line, a file selection box is presented to the user.
 				filename = (char *)NULL;
 			}
 			option_table = CREATE(Option_table)();
+			/* batch */
+			Option_table_add_entry(option_table, "batch",
+				&(open_comfile_data->batch_flag), NULL, set_char_flag);
 			/* example */
 			Option_table_add_entry(option_table, open_comfile_data->example_symbol,
 				&(open_comfile_data->example_flag), NULL, set_char_flag);
@@ -267,9 +270,17 @@ specified on the command line, a file selection box is presented to the user.
 					{
 						for (i=open_comfile_data->execute_count;i>0;i--)
 						{
-							 execute_comfile(filename, open_comfile_data->io_stream_package,
-								open_comfile_data->execute_command);
-
+							if (open_comfile_data->batch_flag)
+							{
+								execute_comfile_batch(filename,
+									open_comfile_data->io_stream_package,
+									open_comfile_data->execute_command);
+							}
+							else
+							{
+								execute_comfile(filename, open_comfile_data->io_stream_package,
+									open_comfile_data->execute_command);
+							}
 						}
 #if defined (WX_USER_INTERFACE)
 						/* Change back to original dir */
@@ -37,7 +37,9 @@ LAST MODIFIED : 18 April 2002
 DESCRIPTION :
 ==============================================================================*/
 {
-	char example_flag,*examples_directory;
+	/* if batch_flag is set, commands are executed as a single batch with
+		change messages cached until the end of the file */
+	char batch_flag,example_flag,*examples_directory;
 	const char *example_symbol,*file_extension,*file_name;
 	int execute_count;
 	struct Execute_command *execute_command,*set_command;
@@ -13,10 +13,12 @@
 #include "configure/cmgui_configure.h"
 #endif /* defined (BUILD_WITH_CMAKE) */
 
+#include <limits.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string>
+#include <vector>
 #if defined (WIN32_SYSTEM)
 #  include <direct.h>
 #else /* !defined (WIN32_SYSTEM) */
@@ -42,6 +44,7 @@
 #if defined (WX_USER_INTERFACE)
 #include "comfile/comfile_window_wx.h"
 #endif /* defined (WX_USER_INTERFACE) */
+#include "command/command_server_app.h"
 #include "command/console.h"
 #include "command/command_window.h"
 #include "command/example_path.h"
@@ -99,13 +102,19 @@
 #include "finite_element/finite_element_to_streamlines.h"
 #include "finite_element/import_finite_element.h"
 #include "finite_element/snake.h"
+#include "general/comfile_capture_app.hpp"
 #include "general/debug.h"
+#include "general/elapsed_time_app.h"
 #include "general/error_handler.h"
 #include "general/image_utilities.h"
 #include "general/io_stream.h"
+#include "general/mapped_file_app.hpp"
 #include "general/matrix_vector.h"
+#include "general/movie_writer_app.hpp"
 #include "general/multi_range.h"
 #include "general/mystring.h"
+#include "general/thread_pool_app.hpp"
+#include "general/zip_writer_app.hpp"
 #include "graphics/environment_map.h"
 #include "graphics/graphics_object.h"
 #include "graphics/graphics_window.h"
@@ -169,12 +178,15 @@
 #endif /* defined (SWITCH_USER_INTERFACE) */
 #include "minimise/minimise.h"
 #include "node/node_operations.h"
+#include "node/node_time_series_app.hpp"
 #include "node/node_tool.h"
 #if defined (WX_USER_INTERFACE)
 #include "node/node_viewer_wx.h"
 #endif /* defined (WX_USER_INTERFACE) */
 #include "region/cmiss_region.h"
 #include "region/cmiss_region_app.h"
+#include "region/region_binary_app.h"
+#include "region/region_snapshot_app.h"
 #include "three_d_drawing/graphics_buffer.h"
 #include "graphics/font.h"
 #include "time/time_keeper_app.hpp"
@@ -250,6 +262,7 @@
 #include "finite_element/export_finite_element_app.h"
 #include "graphics/element_point_ranges_app.h"
 #include "graphics/environment_map_app.h"
+#include "finite_element/finite_element_ranges_app.hpp"
 #include "finite_element/finite_element_region_app.h"
 #include "graphics/scene_viewer_app.h"
 #include "graphics/font_app.h"
@@ -264,6 +277,7 @@
 #include "graphics/auxiliary_graphics_types_app.h"
 #include "finite_element/finite_element_conversion_app.h"
 #include "graphics/texture_app.h"
+#include "graphics/texture_image_series_app.hpp"
 #include "graphics/colour_app.h"
 #include "graphics/scene_app.h"
 #include "graphics/spectrum_component_app.h"
@@ -296,6 +310,7 @@ DESCRIPTION :
 		*example_requirements,*help_directory,*help_url;
 	bool start_event_dispatcher;
 	struct Console *command_console;
+	struct Command_server *command_server;
 #if defined (USE_CMGUI_COMMAND_WINDOW)
 	struct Command_window *command_window;
 #endif /* USE_CMGUI_COMMAND_WINDOW */
@@ -363,6 +378,21 @@ DESCRIPTION :
 	struct cmzn_graphics_module *graphics_module;
 	cmzn_logger_id logger;
 	cmzn_loggernotifier_id loggerNotifier;
+	/* fixed command tree option tables, built and compiled on first use and
+		reused for every command. User data they refer to must live as long */
+	struct Option_table *command_option_table, *gfx_option_table,
+		*gfx_modify_option_table;
+	struct Modify_environment_map_data modify_environment_map_data;
+#if defined (USE_CMGUI_GRAPHICS_WINDOW)
+	struct Modify_graphics_window_data modify_graphics_window_data;
+#endif /* defined (USE_CMGUI_GRAPHICS_WINDOW) */
+	struct Material_module_app modify_materialmodule;
+	Define_scene_data define_scene_data;
+	/* nesting level of batched command execution; while positive, change
+		messages from regions and graphics modules are cached */
+	int batch_level;
+	/* node and data series read with gfx read nodes/data lazy */
+	Node_time_series_set *node_time_series_set;
 }; /* struct cmzn_command_data */
 
 typedef struct
@@ -453,6 +483,129 @@ void CMZN_set_directory_and_filename_WIN32(char **filename_address,
 
 #endif /*(WX_USER_INTERFACE)*/
 
+/***************************************************************************//**
+ * Starts caching change messages for the whole region tree and the graphics
+ * modules whose objects are commonly modified by commands.
+ */
+static void cmzn_command_data_begin_change_cache(
+	struct cmzn_command_data *command_data)
+{
+	if (command_data->root_region)
+	{
+		cmzn_region_begin_hierarchical_change(command_data->root_region);
+	}
+	if (command_data->spectrum_manager)
+	{
+		MANAGER_BEGIN_CACHE(cmzn_spectrum)(command_data->spectrum_manager);
+	}
+	if (command_data->materialmodule)
+	{
+		cmzn_materialmodule_begin_change(command_data->materialmodule);
+	}
+	if (command_data->tessellationmodule)
+	{
+		cmzn_tessellationmodule_begin_change(command_data->tessellationmodule);
+	}
+	if (command_data->glyphmodule)
+	{
+		cmzn_glyphmodule_begin_change(command_data->glyphmodule);
+	}
+	if (command_data->filter_module)
+	{
+		cmzn_scenefiltermodule_begin_change(command_data->filter_module);
+	}
+}
+
+/***************************************************************************//**
+ * Ends caching change messages started by cmzn_command_data_begin_change_cache,
+ * sending all cached changes.
+ */
+static void cmzn_command_data_end_change_cache(
+	struct cmzn_command_data *command_data)
+{
+	if (command_data->filter_module)
+	{
+		cmzn_scenefiltermodule_end_change(command_data->filter_module);
+	}
+	if (command_data->glyphmodule)
+	{
+		cmzn_glyphmodule_end_change(command_data->glyphmodule);
+	}
+	if (command_data->tessellationmodule)
+	{
+		cmzn_tessellationmodule_end_change(command_data->tessellationmodule);
+	}
+	if (command_data->materialmodule)
+	{
+		cmzn_materialmodule_end_change(command_data->materialmodule);
+	}
+	if (command_data->spectrum_manager)
+	{
+		MANAGER_END_CACHE(cmzn_spectrum)(command_data->spectrum_manager);
+	}
+	if (command_data->root_region)
+	{
+		cmzn_region_end_hierarchical_change(command_data->root_region);
+	}
+}
+
+/***************************************************************************//**
+ * Execute_command_batch_function starting a batch of commands. Change messages
+ * are cached from the start of the outermost batch.
+ */
+static int cmzn_command_data_begin_batch(void *command_data_void)
+{
+	struct cmzn_command_data *command_data =
+		static_cast<struct cmzn_command_data *>(command_data_void);
+	if (command_data)
+	{
+		command_data->batch_level++;
+		if (1 == command_data->batch_level)
+		{
+			cmzn_command_data_begin_change_cache(command_data);
+		}
+		return 1;
+	}
+	return 0;
+}
+
+/***************************************************************************//**
+ * Execute_command_batch_function ending a batch of commands. Cached changes are
+ * sent at the end of the outermost batch.
+ */
+static int cmzn_command_data_end_batch(void *command_data_void)
+{
+	struct cmzn_command_data *command_data =
+		static_cast<struct cmzn_command_data *>(command_data_void);
+	if (command_data && (0 < command_data->batch_level))
+	{
+		command_data->batch_level--;
+		if (0 == command_data->batch_level)
+		{
+			cmzn_command_data_end_change_cache(command_data);
+		}
+		return 1;
+	}
+	display_message(ERROR_MESSAGE,
+		"cmzn_command_data_end_batch.  Invalid argument or not in batch");
+	return 0;
+}
+
+/***************************************************************************//**
+ * Called by commands which need an up-to-date model and graphics, e.g. gfx
+ * update and gfx print. If commands are being executed in a batch, sends all
+ * changes cached so far and resumes caching.
+ */
+static void cmzn_command_data_flush_batch_changes(
+	struct cmzn_command_data *command_data)
+{
+	if (0 < command_data->batch_level)
+	{
+		cmzn_command_data_end_change_cache(command_data);
+		cmzn_command_data_begin_change_cache(command_data);
+	}
+}
+
 static int set_command_prompt(const char *prompt, struct cmzn_command_data *command_data)
 /*******************************************************************************
 LAST MODIFIED : 26 June 2002
@@ -997,12 +1150,10 @@ static int process_modify_element_group(cmzn_field_group_id group,
 			{
 				iteration_mesh = from_mesh;
 			}
-			cmzn_elementiterator_id iter = cmzn_mesh_create_elementiterator(iteration_mesh);
+			Mesh_ranges_iterator iter(iteration_mesh, element_ranges);
 			cmzn_element_id element = 0;
-			while (NULL != (element = cmzn_elementiterator_next_non_access(iter)))
+			while (NULL != (element = iter.nextNonAccess()))
 			{
-				if (element_ranges && !Multi_range_is_value_in_range(element_ranges, cmzn_element_get_identifier(element)))
-					continue;
 				if (selection_mesh && (selection_mesh != iteration_mesh) && !cmzn_mesh_contains_element(selection_mesh, element))
 					continue;
 				if (from_mesh && (from_mesh != iteration_mesh) && !cmzn_mesh_contains_element(from_mesh, element))
@@ -1034,7 +1185,6 @@ static int process_modify_element_group(cmzn_field_group_id group,
 					}
 				}
 			}
-			cmzn_elementiterator_destroy(&iter);
 			cmzn_fieldcache_destroy(&cache);
 			cmzn_field_group_set_subelement_handling_mode(group, oldSubelementHandlingMode);
 			cmzn_mesh_group_destroy(&modify_mesh_group);
@@ -1132,20 +1282,16 @@ static int gfx_create_group(struct Parse_state *state,
 									(object_type == 1) ? CMZN_FIELD_DOMAIN_TYPE_NODES : CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS);
 								cmzn_field_node_group_id node_group = cmzn_field_group_create_field_node_group(group, master_nodeset);
 								cmzn_nodeset_group_id modify_nodeset_group = cmzn_field_node_group_get_nodeset_group(node_group);
-								cmzn_nodeiterator_id iter = cmzn_nodeset_create_nodeiterator(master_nodeset);
+								Nodeset_ranges_iterator iter(master_nodeset, add_ranges);
 								cmzn_node_id node = 0;
-								while (NULL != (node = cmzn_nodeiterator_next_non_access(iter)))
+								while (NULL != (node = iter.nextNonAccess()))
 								{
-									if (Multi_range_is_value_in_range(add_ranges, cmzn_node_get_identifier(node)))
+									if (!cmzn_nodeset_group_add_node(modify_nodeset_group, node))
 									{
-										if (!cmzn_nodeset_group_add_node(modify_nodeset_group, node))
-										{
-											return_code = 0;
-											break;
-										}
+										return_code = 0;
+										break;
 									}
 								}
-								cmzn_nodeiterator_destroy(&iter);
 								cmzn_nodeset_group_destroy(&modify_nodeset_group);
 								cmzn_field_node_group_destroy(&node_group);
 								cmzn_nodeset_destroy(&master_nodeset);
@@ -3019,8 +3165,8 @@ Modifies the properties of a texture.
 	double alpha, distortion_centre_x, distortion_centre_y,
 		distortion_factor_k1, mipmap_level_of_detail_bias;
 	float mipmap_level_of_detail_bias_flt;
-	int file_number, i, number_of_file_names, number_of_valid_strings, process,
-		return_code, specify_depth, specify_height,
+	int downsample, file_number, i, number_of_file_names,
+		number_of_valid_strings, process, return_code, specify_depth, specify_height,
 		specify_number_of_bytes_per_component, specify_width, texture_is_managed = 0;
 	struct Cmgui_image *cmgui_image;
 	struct Cmgui_image_information *cmgui_image_information;
@@ -3209,6 +3355,7 @@ Modifies the properties of a texture.
 					file_number_series_data.start = 0;
 					file_number_series_data.stop = 0;
 					file_number_series_data.increment = 0;
+					downsample = 1;
 
 					option_table = CREATE(Option_table)();
 					/* alpha */
@@ -3249,6 +3396,9 @@ Modifies the properties of a texture.
 					DEALLOCATE(valid_strings);
 					/* depth */
 					Option_table_add_non_negative_double_entry(option_table, "depth", &depth);
+					/* downsample */
+					Option_table_add_entry(option_table, "downsample", &downsample,
+						NULL, set_int_positive);
 					/* distortion */
 					Option_table_add_entry(option_table, "distortion",
 						&texture_distortion,
@@ -3499,34 +3649,38 @@ Modifies the properties of a texture.
 							}
 							if (return_code)
 							{
-								Image_file_format image_file_format = UNKNOWN_IMAGE_FILE_FORMAT;
-								Image_file_format_from_file_name(image_data.image_file_name, &image_file_format);
-								cmgui_image = 0;
-								if (image_file_format == ANALYZE_FILE_FORMAT)
-								{
-									cmgui_image = Cmgui_image_read_analyze(cmgui_image_information,
-										CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_DEFAULT);
-								}
-								else if (image_file_format == ANALYZE_OBJECT_MAP_FORMAT)
-								{
-									cmgui_image = Cmgui_image_read_analyze_object_map(cmgui_image_information,
-										CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_DEFAULT);
-								}
-								else
-								{
-									cmgui_image = Cmgui_image_read(cmgui_image_information);
-								}
+								/* every file of a series is read the same way as the first */
+								cmgui_image = Texture_series_read_image(cmgui_image_information,
+									image_data.image_file_name);
+								const bool read_series_downsampled = (0 != file_number_series_data.increment) &&
+									(1 < downsample);
 								if (cmgui_image != 0)
 								{
 									char *property, *value;
 
-									return_code = Texture_set_image(texture, cmgui_image,
-										image_data.image_file_name, file_number_pattern,
-										file_number_series_data.start,
-										file_number_series_data.stop,
-										file_number_series_data.increment,
-										image_data.crop_left_margin, image_data.crop_bottom_margin,
-										image_data.crop_width, image_data.crop_height);
+									if (read_series_downsampled)
+									{
+										/* remaining files are averaged into the reduced texture image */
+										return_code = Texture_set_image_file_number_series_downsampled(texture,
+											cmgui_image_information, cmgui_image,
+											image_data.image_file_name, file_number_pattern,
+											file_number_series_data.start,
+											file_number_series_data.stop,
+											file_number_series_data.increment,
+											image_data.crop_left_margin, image_data.crop_bottom_margin,
+											image_data.crop_width, image_data.crop_height,
+											downsample);
+									}
+									else
+									{
+										return_code = Texture_set_image(texture, cmgui_image,
+											image_data.image_file_name, file_number_pattern,
+											file_number_series_data.start,
+											file_number_series_data.stop,
+											file_number_series_data.increment,
+											image_data.crop_left_margin, image_data.crop_bottom_margin,
+											image_data.crop_width, image_data.crop_height);
+									}
 									/* Delete any existing properties as we are modifying */
 									Texture_clear_all_properties(texture);
 									/* Calling get_proprety with wildcard ensures they
@@ -3551,7 +3705,8 @@ Modifies the properties of a texture.
 										"gfx modify texture:  Could not read image file");
 									return_code = 0;
 								}
-								if (return_code && (0 != file_number_series_data.increment))
+								if (return_code && (0 != file_number_series_data.increment) &&
+									(!read_series_downsampled))
 								{
 									number_of_file_names = 1 + (file_number_series_data.stop -
 										file_number_series_data.start) /
@@ -3565,7 +3720,8 @@ Modifies the properties of a texture.
 											/*file_name_template*/image_data.image_file_name,
 											file_number_pattern, /*start*/file_number,
 											/*end*/file_number, /*increment*/1);
-										if (NULL != (cmgui_image = Cmgui_image_read(cmgui_image_information)))
+										if (NULL != (cmgui_image = Texture_series_read_image(
+											cmgui_image_information, image_data.image_file_name)))
 										{
 											return_code = Texture_add_image(texture, cmgui_image,
 												image_data.crop_left_margin, image_data.crop_bottom_margin,
@@ -5214,21 +5370,24 @@ static int gfx_destroy_group(struct Parse_state *state,
 }
 
 static int gfx_destroy_region(struct Parse_state *state,
-	void *dummy_to_be_modified, void *root_region_void)
+	void *dummy_to_be_modified, void *command_data_void)
 /*******************************************************************************
-LAST MODIFIED : 27 March 2003
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
 Executes a GFX DESTROY REGION command.
+Lazy node time series for the region and its subregions are also destroyed.
 ==============================================================================*/
 {
 	const char *current_token;
 	int return_code = 1;
+	struct cmzn_command_data *command_data;
 	struct cmzn_region *root_region;
 
 	ENTER(gfx_destroy_region);
 	USE_PARAMETER(dummy_to_be_modified);
-	if (state && (root_region = (struct cmzn_region *)root_region_void))
+	if (state && (command_data = (struct cmzn_command_data *)command_data_void) &&
+		(root_region = command_data->root_region))
 	{
 		if (NULL != (current_token = state->current_token))
 		{
@@ -5242,6 +5401,8 @@ Executes a GFX DESTROY REGION command.
 					struct cmzn_region *parent_region = cmzn_region_get_parent(region);
 					if (parent_region)
 					{
+						if (command_data->node_time_series_set)
+							command_data->node_time_series_set->removeRegion(region);
 						cmzn_region_remove_child(parent_region, region);
 						cmzn_region_destroy(&parent_region);
 					}
@@ -5966,7 +6127,7 @@ Executes a GFX DESTROY command.
 					command_data_void, gfx_destroy_nodes);
 				/* region */
 				Option_table_add_entry(option_table, "region", NULL,
-					command_data->root_region, gfx_destroy_region);
+					command_data_void, gfx_destroy_region);
 				/* scene */
 				Option_table_add_entry(option_table, "scene", NULL,
 					command_data->scene_manager, gfx_destroy_Scene);
@@ -7663,6 +7824,228 @@ static int execute_command_gfx_import(struct Parse_state *state,
 
 #endif /* USE_OPENCASCADE */
 
+#if defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (WX_USER_INTERFACE)
+/***************************************************************************//**
+ * Executes a GFX EXPORT MOVIE command. Steps the default time keeper through
+ * a time range, rendering each frame offscreen from a graphics window. For a
+ * Y4M movie, earlier frames are encoded by worker threads while the next frame
+ * renders and is read back; image sequence frames are written as rendered.
+ */
+static int gfx_export_movie(struct Parse_state *state,
+	void *dummy_to_be_modified, void *command_data_void)
+{
+	char alpha_flag, end_time_flag, *file_name, frames_flag, start_time_flag;
+	double end_time, frames_per_second, start_time;
+	int antialias, height, number_of_frames, number_of_threads, return_code,
+		transparency_layers, width;
+	struct cmzn_command_data *command_data;
+	struct Graphics_window *window;
+	struct Option_table *option_table;
+
+	USE_PARAMETER(dummy_to_be_modified);
+	if (!(state && (command_data = (struct cmzn_command_data *)command_data_void)))
+	{
+		display_message(ERROR_MESSAGE, "gfx_export_movie.  Invalid argument(s)");
+		return 0;
+	}
+	Time_keeper_app *time_keeper_app = command_data->default_time_keeper_app;
+	alpha_flag = 0;
+	antialias = -1;
+	end_time = time_keeper_app->getTimeKeeper()->getMaximum();
+	end_time_flag = 0;
+	file_name = (char *)NULL;
+	frames_per_second = 25.0;
+	frames_flag = 0;
+	height = 0;
+	number_of_frames = 0;
+	number_of_threads = Thread_pool::getNumberOfProcessors();
+	start_time = time_keeper_app->getTimeKeeper()->getMinimum();
+	start_time_flag = 0;
+	transparency_layers = 0;
+	width = 0;
+	if (NULL != (window = FIRST_OBJECT_IN_MANAGER_THAT(
+		Graphics_window)((MANAGER_CONDITIONAL_FUNCTION(Graphics_window) *)NULL,
+			(void *)NULL, command_data->graphics_window_manager)))
+	{
+		ACCESS(Graphics_window)(window);
+	}
+	option_table = CREATE(Option_table)();
+	Option_table_add_help(option_table,
+		"Renders frames from a graphics window while stepping the time keeper "
+		"from start to end time, and writes them as a raw YUV4MPEG2 movie for FILE "
+		"ending in .y4m, encoded by worker threads while the next frame renders. "
+		"For any other FILE extension writes an image sequence in that format, as "
+		"gfx print does; FILE must contain one frame number conversion e.g. "
+		"frame%04d.png. "
+		"Defaults to the time keeper range with one frame per 1/fps time units.");
+	/* alpha */
+	Option_table_add_char_flag_entry(option_table, "alpha", &alpha_flag);
+	/* antialias */
+	Option_table_add_entry(option_table, "antialias",
+		&antialias, NULL, set_int_positive);
+	/* end_time */
+	Option_table_add_entry(option_table, "end_time",
+		&end_time, &end_time_flag, set_double_and_char_flag);
+	/* file */
+	Option_table_add_entry(option_table, "file", &file_name,
+		(void *)1, set_name);
+	/* fps */
+	Option_table_add_entry(option_table, "fps",
+		&frames_per_second, NULL, set_double);
+	/* frames */
+	Option_table_add_entry(option_table, "frames",
+		&number_of_frames, &frames_flag, set_int_and_char_flag);
+	/* height */
+	Option_table_add_entry(option_table, "height",
+		&height, NULL, set_int_non_negative);
+	/* start_time */
+	Option_table_add_entry(option_table, "start_time",
+		&start_time, &start_time_flag, set_double_and_char_flag);
+	/* threads */
+	Option_table_add_entry(option_table, "threads",
+		&number_of_threads, NULL, set_int_non_negative);
+	/* transparency_layers */
+	Option_table_add_entry(option_table, "transparency_layers",
+		&transparency_layers, NULL, set_int_positive);
+	/* width */
+	Option_table_add_entry(option_table, "width",
+		&width, NULL, set_int_non_negative);
+	/* window */
+	Option_table_add_entry(option_table, "window",
+		&window, command_data->graphics_window_manager, set_Graphics_window);
+	return_code = Option_table_multi_parse(option_table, state);
+	DESTROY(Option_table)(&option_table);
+	enum Movie_writer_format format = MOVIE_WRITER_FORMAT_INVALID;
+	if (return_code)
+	{
+		if (!file_name)
+		{
+			display_message(ERROR_MESSAGE, "gfx export movie.  Must specify file name");
+			return_code = 0;
+		}
+		else if (MOVIE_WRITER_FORMAT_INVALID ==
+			(format = Movie_writer::getFormatFromFileName(file_name)))
+		{
+			display_message(ERROR_MESSAGE, "gfx export movie.  "
+				"File name must end in .y4m or an image file extension");
+			return_code = 0;
+		}
+		if (!window)
+		{
+			display_message(ERROR_MESSAGE,
+				"gfx export movie.  No graphics windows to render");
+			return_code = 0;
+		}
+		if (alpha_flag && (format == MOVIE_WRITER_FORMAT_Y4M))
+		{
+			display_message(WARNING_MESSAGE,
+				"gfx export movie.  alpha is ignored for Y4M output");
+			alpha_flag = 0;
+		}
+		if (frames_flag && (number_of_frames < 1))
+		{
+			display_message(ERROR_MESSAGE,
+				"gfx export movie.  Number of frames must be positive");
+			return_code = 0;
+		}
+		if (frames_per_second <= 0.0)
+		{
+			display_message(ERROR_MESSAGE,
+				"gfx export movie.  fps must be positive");
+			return_code = 0;
+		}
+	}
+	if (return_code)
+	{
+		cmzn_command_data_flush_batch_changes(command_data);
+		if (!frames_flag)
+		{
+			number_of_frames = 1 + (int)floor((end_time - start_time)*frames_per_second + 0.5);
+			if (number_of_frames < 1)
+			{
+				number_of_frames = 1;
+			}
+		}
+		const enum Texture_storage_type storage = (alpha_flag) ? TEXTURE_RGBA : TEXTURE_RGB;
+		const int number_of_components = (alpha_flag) ? 4 : 3;
+		const double original_time = time_keeper_app->getTimeKeeper()->getTime();
+		double render_seconds = 0.0;
+		const double export_start_time = get_elapsed_time_seconds();
+		Movie_writer *movie_writer = 0;
+		std::vector<unsigned char> pixels;
+		for (int frame = 0; return_code && (frame < number_of_frames); ++frame)
+		{
+			const double time = (number_of_frames > 1) ?
+				start_time + (end_time - start_time)*frame/(number_of_frames - 1) : start_time;
+			time_keeper_app->requestNewTime(time);
+			unsigned char *frame_data = (unsigned char *)NULL;
+			int frame_width = width;
+			int frame_height = height;
+			double render_start_time = get_elapsed_time_seconds();
+			if (Graphics_window_get_frame_pixels(window, storage, &frame_width, &frame_height,
+				antialias, transparency_layers, &frame_data, /*force_onscreen*/0))
+			{
+				pixels.assign(frame_data,
+					frame_data + frame_width*frame_height*number_of_components);
+				DEALLOCATE(frame_data);
+				render_seconds += get_elapsed_time_seconds() - render_start_time;
+				if (!movie_writer)
+				{
+					/* first frame fixes the size of all frames */
+					width = frame_width;
+					height = frame_height;
+					movie_writer = new Movie_writer(format, file_name, width, height,
+						number_of_components, frames_per_second, number_of_threads);
+					if (!movie_writer->open())
+					{
+						return_code = 0;
+					}
+				}
+				if (return_code && !movie_writer->addFrame(pixels))
+				{
+					return_code = 0;
+				}
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE,
+					"gfx export movie.  Could not render frame %d at time %g", frame, time);
+				return_code = 0;
+			}
+		}
+		if (movie_writer)
+		{
+			if (!movie_writer->finish())
+			{
+				return_code = 0;
+			}
+			if (return_code)
+			{
+				display_message(INFORMATION_MESSAGE,
+					"gfx export movie.  Wrote %d frames to %s in %.3f seconds\n"
+					"  render and read back %.3f, encode %.3f (over %d threads), write %.3f, "
+					"waiting for encoding %.3f\n",
+					movie_writer->getNumberOfFrames(), file_name,
+					get_elapsed_time_seconds() - export_start_time, render_seconds,
+					movie_writer->getEncodeSeconds(), number_of_threads,
+					movie_writer->getWriteSeconds(), movie_writer->getWaitSeconds());
+			}
+			delete movie_writer;
+		}
+		time_keeper_app->requestNewTime(original_time);
+	}
+	if (window)
+	{
+		DEACCESS(Graphics_window)(&window);
+	}
+	if (file_name)
+	{
+		DEALLOCATE(file_name);
+	}
+	return (return_code);
+}
+#endif /* defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (WX_USER_INTERFACE) */
+
 static int execute_command_gfx_export(struct Parse_state *state,
 	void *dummy_to_be_modified,void *command_data_void)
 /*******************************************************************************
@@ -7686,6 +8069,10 @@ Executes a GFX EXPORT command.
 			command_data_void, gfx_export_cm);
 		Option_table_add_entry(option_table,"iges",NULL,
 			command_data_void, gfx_export_iges);
+#if defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (WX_USER_INTERFACE)
+		Option_table_add_entry(option_table,"movie",NULL,
+			command_data_void, gfx_export_movie);
+#endif /* defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (WX_USER_INTERFACE) */
 		Option_table_add_entry(option_table,"stl",NULL,
 			command_data_void, gfx_export_stl);
 		Option_table_add_entry(option_table,"threejs",NULL,
@@ -8688,16 +9075,13 @@ Executes a GFX LIST ELEMENT.
 				{
 					iteration_mesh = cmzn_mesh_group_base_cast(selection_mesh_group);
 				}
-				const bool use_element_ranges = Multi_range_get_number_of_ranges(element_ranges) > 0;
 				if (Multi_range_get_total_number_in_ranges(element_ranges) == 1)
 					verbose_flag = 1;
 				Multi_range *output_element_ranges = CREATE(Multi_range)();
-				cmzn_elementiterator_id iter = cmzn_mesh_create_elementiterator(iteration_mesh);
+				Mesh_ranges_iterator iter(iteration_mesh, element_ranges);
 				cmzn_element_id element = 0;
-				while (NULL != (element = cmzn_elementiterator_next_non_access(iter)))
+				while (NULL != (element = iter.nextNonAccess()))
 				{
-					if (use_element_ranges && !Multi_range_is_value_in_range(element_ranges, cmzn_element_get_identifier(element)))
-						continue;
 					if (conditional_field)
 					{
 						cmzn_fieldcache_set_element(cache, element);
@@ -8715,7 +9099,6 @@ Executes a GFX LIST ELEMENT.
 					}
 					++number_of_elements_listed;
 				}
-				cmzn_elementiterator_destroy(&iter);
 				if ((!verbose_flag) && number_of_elements_listed)
 				{
 					if (dimension == 1)
@@ -8860,16 +9243,13 @@ use node_manager and node_selection.
 				{
 					iteration_nodeset = cmzn_nodeset_group_base_cast(selection_nodeset_group);
 				}
-				const bool use_node_ranges = Multi_range_get_number_of_ranges(node_ranges) > 0;
 				if (Multi_range_get_total_number_in_ranges(node_ranges) == 1)
 					verbose_flag = 1;
 				Multi_range *output_node_ranges = CREATE(Multi_range)();
-				cmzn_nodeiterator_id iter = cmzn_nodeset_create_nodeiterator(iteration_nodeset);
+				Nodeset_ranges_iterator iter(iteration_nodeset, node_ranges);
 				cmzn_node_id node = 0;
-				while (NULL != (node = cmzn_nodeiterator_next_non_access(iter)))
+				while (NULL != (node = iter.nextNonAccess()))
 				{
-					if (use_node_ranges && !Multi_range_is_value_in_range(node_ranges, cmzn_node_get_identifier(node)))
-						continue;
 					if (conditional_field)
 					{
 						cmzn_fieldcache_set_node(cache, node);
@@ -8887,7 +9267,6 @@ use node_manager and node_selection.
 					}
 					++number_of_nodes_listed;
 				}
-				cmzn_nodeiterator_destroy(&iter);
 				if ((!verbose_flag) && number_of_nodes_listed)
 				{
 					display_message(INFORMATION_MESSAGE, use_data ? "Data:\n" : "Nodes:\n");
@@ -10006,6 +10385,53 @@ Executes a GFX LIST WINDOW.
 } /* gfx_list_graphics_window */
 #endif /* defined (USE_CMGUI_GRAPHICS_WINDOW) */
 
+static int gfx_list_server(struct Parse_state *state,
+	void *dummy_to_be_modified, void *command_data_void)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Executes a GFX LIST SERVER command, listing the clients, queue depth and command
+latency of the command server started with -server_socket.
+==============================================================================*/
+{
+	int return_code;
+	struct cmzn_command_data *command_data;
+	struct Option_table *option_table;
+
+	ENTER(gfx_list_server);
+	USE_PARAMETER(dummy_to_be_modified);
+	if (state && (command_data = (struct cmzn_command_data *)command_data_void))
+	{
+		option_table = CREATE(Option_table)();
+		Option_table_add_help(option_table,
+			"List the clients, queue depth, number of commands and their latency "
+			"for the command server started with the -server_socket option.");
+		if (0 != (return_code = Option_table_multi_parse(option_table, state)))
+		{
+			if (command_data->command_server)
+			{
+				return_code = Command_server_list_statistics(command_data->command_server);
+			}
+			else
+			{
+				display_message(INFORMATION_MESSAGE,
+					"No command server. Start cmgui with -server_socket SOCKET_FILE_NAME\n");
+			}
+		}
+		DESTROY(Option_table)(&option_table);
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"gfx_list_server.  Invalid argument(s)");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* gfx_list_server */
+
 static int execute_command_gfx_list(struct Parse_state *state,
 	void *dummy_to_be_modified,void *command_data_void)
 /*******************************************************************************
@@ -10055,6 +10481,9 @@ Executes a GFX LIST command.
 			/* field */
 			Option_table_add_entry(option_table, "field", NULL,
 				(void *)command_data->root_region, gfx_list_Computed_field);
+			/* field_types */
+			Option_table_add_entry(option_table, "field_types", NULL,
+				(void *)command_data->computed_field_package, gfx_list_field_types);
 			/* g_element */
 			Option_table_add_entry(option_table, "g_element", NULL,
 				command_data_void, gfx_list_g_element);
@@ -10096,6 +10525,9 @@ Executes a GFX LIST command.
 			/* scene */
 			Option_table_add_entry(option_table, "scene", NULL,
 				command_data->root_region, gfx_list_scene);
+			/* server */
+			Option_table_add_entry(option_table, "server", NULL,
+				command_data_void, gfx_list_server);
 			/* spectrum */
 			Option_table_add_entry(option_table, "spectrum", NULL,
 				command_data->spectrum_manager, gfx_list_spectrum);
@@ -10783,13 +11215,10 @@ static int gfx_modify_node_group(struct Parse_state *state,
 						iteration_nodeset = from_nodeset;
 					}
 
-					cmzn_nodeiterator_id iter = cmzn_nodeset_create_nodeiterator(iteration_nodeset);
-					const bool use_node_ranges = Multi_range_get_number_of_ranges(node_ranges) > 0;
+					Nodeset_ranges_iterator iter(iteration_nodeset, node_ranges);
 					cmzn_node_id node = 0;
-					while (NULL != (node = cmzn_nodeiterator_next_non_access(iter)))
+					while (NULL != (node = iter.nextNonAccess()))
 					{
-						if (use_node_ranges && !Multi_range_is_value_in_range(node_ranges, cmzn_node_get_identifier(node)))
-							continue;
 						if (selection_nodeset && (selection_nodeset != iteration_nodeset) && !cmzn_nodeset_contains_node(selection_nodeset, node))
 							continue;
 						if (from_nodeset && (from_nodeset != iteration_nodeset) && !cmzn_nodeset_contains_node(from_nodeset, node))
@@ -10822,7 +11251,6 @@ static int gfx_modify_node_group(struct Parse_state *state,
 							}
 						}
 					}
-					cmzn_nodeiterator_destroy(&iter);
 					cmzn_fieldcache_destroy(&cache);
 					cmzn_nodeset_group_destroy(&modify_nodeset_group);
 					cmzn_field_node_group_destroy(&modify_node_group);
@@ -11097,13 +11525,10 @@ static int gfx_modify_nodes(struct Parse_state *state,
 				cmzn_fieldmodule_begin_change(field_module);
 				cmzn_fieldcache_id cache = cmzn_fieldmodule_create_fieldcache(field_module);
 				cmzn_fieldcache_set_time(cache, time);
-				cmzn_nodeiterator_id iter = cmzn_nodeset_create_nodeiterator(nodeset);
-				const bool use_node_ranges = Multi_range_get_number_of_ranges(node_ranges) > 0;
+				Nodeset_ranges_iterator iter(nodeset, node_ranges);
 				cmzn_node_id node = 0;
-				while (NULL != (node = cmzn_nodeiterator_next_non_access(iter)))
+				while (NULL != (node = iter.nextNonAccess()))
 				{
-					if (use_node_ranges && !Multi_range_is_value_in_range(node_ranges, cmzn_node_get_identifier(node)))
-						continue;
 					if (conditional_field || selection_field)
 					{
 						cmzn_fieldcache_set_node(cache, node);
@@ -11120,7 +11545,6 @@ static int gfx_modify_nodes(struct Parse_state *state,
 					}
 					++nodes_processed;
 				}
-				cmzn_nodeiterator_destroy(&iter);
 				cmzn_fieldcache_destroy(&cache);
 				cmzn_fieldmodule_end_change(field_module);
 			}
@@ -11174,6 +11598,134 @@ static int gfx_modify_nodes(struct Parse_state *state,
 	return (return_code);
 }
 
+#if defined (EMOTER_ENABLE)
+/***************************************************************************//**
+ * Executes a GFX MODIFY EMOTER command with the emoter dialog current at the
+ * time of the command, since the persistent gfx modify option table is built
+ * before the dialog is created.
+ */
+static int gfx_modify_emoter_current(struct Parse_state *state,
+	void *dummy_to_be_modified, void *command_data_void)
+{
+	struct cmzn_command_data *command_data =
+		static_cast<struct cmzn_command_data *>(command_data_void);
+	return gfx_modify_emoter(state, dummy_to_be_modified,
+		(void *)command_data->emoter_slider_dialog);
+}
+#endif /* defined (EMOTER_ENABLE) */
+
+/***************************************************************************//**
+ * Executes a GFX MODIFY LIGHT command with the default light current at the
+ * time of the command rather than when the persistent gfx modify option table
+ * was built.
+ */
+static int gfx_modify_light_current(struct Parse_state *state,
+	void *dummy_to_be_modified, void *command_data_void)
+{
+	struct cmzn_command_data *command_data =
+		static_cast<struct cmzn_command_data *>(command_data_void);
+	struct Modify_light_data modify_light_data;
+	modify_light_data.default_light = command_data->default_light;
+	modify_light_data.lightmodule = command_data->lightmodule;
+	return modify_cmzn_light(state, dummy_to_be_modified,
+		(void *)(&modify_light_data));
+}
+
+/***************************************************************************//**
+ * Returns the option table for GFX MODIFY commands, building and compiling it
+ * on first call. Owned by <command_data>; do not destroy.
+ */
+static struct Option_table *cmzn_command_data_get_gfx_modify_option_table(
+	struct cmzn_command_data *command_data)
+{
+	if (!command_data->gfx_modify_option_table)
+	{
+		struct Option_table *option_table = CREATE(Option_table)();
+		/* data */
+		Option_table_add_entry(option_table, "data", /*use_data*/(void *)1,
+			(void *)command_data, gfx_modify_nodes);
+		/* dgroup */
+		Option_table_add_entry(option_table,"dgroup",(void *)1/*data*/,
+			(void *)command_data, gfx_modify_node_group);
+		/* egroup */
+		Option_table_add_entry(option_table,"egroup",NULL,
+			(void *)command_data, gfx_modify_element_group);
+#if defined (EMOTER_ENABLE)
+		/* emoter */
+		Option_table_add_entry(option_table,"emoter",NULL,
+			(void *)command_data, gfx_modify_emoter_current);
+#endif
+		/* environment_map */
+		command_data->modify_environment_map_data.graphical_material_manager=
+			cmzn_materialmodule_get_manager(command_data->materialmodule);
+		command_data->modify_environment_map_data.environment_map_manager=
+			command_data->environment_map_manager;
+		Option_table_add_entry(option_table,"environment_map",NULL,
+			(&command_data->modify_environment_map_data),modify_Environment_map);
+		/* field */
+		Option_table_add_entry(option_table,"field",NULL,
+			(void *)command_data, gfx_modify_field);
+		/* flow_particles */
+		Option_table_add_entry(option_table,"flow_particles",NULL,
+			(void *)command_data, gfx_modify_flow_particles);
+		/* g_element */
+		Option_table_add_entry(option_table,"g_element",NULL,
+			(void *)command_data, gfx_modify_g_element);
+		/* glyph */
+		Option_table_add_entry(option_table,"glyph",NULL,
+			(void *)command_data, gfx_modify_glyph);
+		/* graphics_object */
+		Option_table_add_entry(option_table,"graphics_object",NULL,
+			(void *)command_data, gfx_modify_graphics_object);
+		/* light */
+		Option_table_add_entry(option_table,"light",NULL,
+			(void *)command_data, gfx_modify_light_current);
+		/* lmodel */
+		Option_table_add_entry(option_table,"lmodel",NULL,
+			NULL, gfx_create_modify_light_model);
+		/* material */
+		command_data->modify_materialmodule.module = (void *)command_data->materialmodule;
+		command_data->modify_materialmodule.region = (void *)command_data->root_region;
+		Option_table_add_entry(option_table,"material",NULL,
+			(void *)(&command_data->modify_materialmodule), modify_Graphical_material);
+		/* ngroup */
+		Option_table_add_entry(option_table,"ngroup",NULL,
+			(void *)command_data, gfx_modify_node_group);
+		/* nodes */
+		Option_table_add_entry(option_table, "nodes", /*use_data*/(void *)0,
+			(void *)command_data, gfx_modify_nodes);
+		/* scene */
+		command_data->define_scene_data.root_region = command_data->root_region;
+		command_data->define_scene_data.graphics_module = command_data->graphics_module;
+		Option_table_add_entry(option_table, "scene", NULL,
+			(void *)(&command_data->define_scene_data), define_Scene);
+		/* spectrum */
+		Option_table_add_entry(option_table,"spectrum",NULL,
+			(void *)command_data, gfx_modify_Spectrum);
+		/* texture */
+		Option_table_add_entry(option_table,"texture",NULL,
+			(void *)command_data, gfx_modify_Texture);
+#if defined (USE_CMGUI_GRAPHICS_WINDOW)
+		/* window */
+		command_data->modify_graphics_window_data.computed_field_package=
+			command_data->computed_field_package;
+		command_data->modify_graphics_window_data.graphics_window_manager=
+			command_data->graphics_window_manager;
+		command_data->modify_graphics_window_data.interactive_tool_manager=
+			command_data->interactive_tool_manager;
+		command_data->modify_graphics_window_data.light_manager=
+			cmzn_lightmodule_get_manager(command_data->lightmodule);
+		command_data->modify_graphics_window_data.root_region=command_data->root_region;
+		command_data->modify_graphics_window_data.filter_module = command_data->filter_module;
+		Option_table_add_entry(option_table,"window",NULL,
+			(void *)(&command_data->modify_graphics_window_data), modify_Graphics_window);
+#endif /* defined (USE_CMGUI_GRAPHICS_WINDOW) */
+		Option_table_compile(option_table);
+		command_data->gfx_modify_option_table = option_table;
+	}
+	return command_data->gfx_modify_option_table;
+}
+
 static int execute_command_gfx_modify(struct Parse_state *state,
 	void *dummy_to_be_modified,void *command_data_void)
 /*******************************************************************************
@@ -11186,12 +11738,6 @@ Executes a GFX MODIFY command.
 {
 	int return_code;
 	struct cmzn_command_data *command_data;
-	struct Modify_environment_map_data modify_environment_map_data;
-#if defined (USE_CMGUI_GRAPHICS_WINDOW)
-	struct Modify_graphics_window_data modify_graphics_window_data;
-#endif /* defined (USE_CMGUI_GRAPHICS_WINDOW) */
-	struct Option_table *option_table;
-	struct Modify_light_data modify_light_data;
 
 	ENTER(execute_command_gfx_modify);
 	USE_PARAMETER(dummy_to_be_modified);
@@ -11202,94 +11748,8 @@ Executes a GFX MODIFY command.
 		{
 			if (state->current_token)
 			{
-				option_table=CREATE(Option_table)();
-				/* data */
-				Option_table_add_entry(option_table, "data", /*use_data*/(void *)1,
-					(void *)command_data, gfx_modify_nodes);
-				/* dgroup */
-				Option_table_add_entry(option_table,"dgroup",(void *)1/*data*/,
-					(void *)command_data, gfx_modify_node_group);
-				/* egroup */
-				Option_table_add_entry(option_table,"egroup",NULL,
-					(void *)command_data, gfx_modify_element_group);
-#if defined (EMOTER_ENABLE)
-				/* emoter */
-				Option_table_add_entry(option_table,"emoter",NULL,
-					(void *)command_data->emoter_slider_dialog,
-					gfx_modify_emoter);
-#endif
-				/* environment_map */
-				modify_environment_map_data.graphical_material_manager=
-					cmzn_materialmodule_get_manager(command_data->materialmodule);
-				modify_environment_map_data.environment_map_manager=
-					command_data->environment_map_manager;
-				Option_table_add_entry(option_table,"environment_map",NULL,
-					(&modify_environment_map_data),modify_Environment_map);
-				/* field */
-				Option_table_add_entry(option_table,"field",NULL,
-					(void *)command_data, gfx_modify_field);
-				/* flow_particles */
-				Option_table_add_entry(option_table,"flow_particles",NULL,
-					(void *)command_data, gfx_modify_flow_particles);
-				/* g_element */
-				Option_table_add_entry(option_table,"g_element",NULL,
-					(void *)command_data, gfx_modify_g_element);
-				/* glyph */
-				Option_table_add_entry(option_table,"glyph",NULL,
-					(void *)command_data, gfx_modify_glyph);
-				/* graphics_object */
-				Option_table_add_entry(option_table,"graphics_object",NULL,
-					(void *)command_data, gfx_modify_graphics_object);
-				/* light */
-				modify_light_data.default_light=command_data->default_light;
-				modify_light_data.lightmodule=command_data->lightmodule;
-				Option_table_add_entry(option_table,"light",NULL,
-					(void *)(&modify_light_data), modify_cmzn_light);
-				/* lmodel */
-				Option_table_add_entry(option_table,"lmodel",NULL,
-					NULL, gfx_create_modify_light_model);
-				/* material */
-				struct Material_module_app materialmodule;
-				materialmodule.module = (void *)command_data->materialmodule;
-				materialmodule.region = (void *)command_data->root_region;
-				Option_table_add_entry(option_table,"material",NULL,
-					(void *)(&materialmodule), modify_Graphical_material);
-				/* ngroup */
-				Option_table_add_entry(option_table,"ngroup",NULL,
-					(void *)command_data, gfx_modify_node_group);
-				/* nodes */
-				Option_table_add_entry(option_table, "nodes", /*use_data*/(void *)0,
-					(void *)command_data, gfx_modify_nodes);
-				/* scene */
-				Define_scene_data define_scene_data;
-				define_scene_data.root_region = command_data->root_region;
-				define_scene_data.graphics_module = command_data->graphics_module;
-				Option_table_add_entry(option_table, "scene", NULL,
-					(void *)(&define_scene_data), define_Scene);
-				/* spectrum */
-				Option_table_add_entry(option_table,"spectrum",NULL,
-					(void *)command_data, gfx_modify_Spectrum);
-				/* texture */
-				Option_table_add_entry(option_table,"texture",NULL,
-					(void *)command_data, gfx_modify_Texture);
-#if defined (USE_CMGUI_GRAPHICS_WINDOW)
-				/* window */
-				modify_graphics_window_data.computed_field_package=
-					command_data->computed_field_package;
-				modify_graphics_window_data.graphics_window_manager=
-					command_data->graphics_window_manager;
-				modify_graphics_window_data.interactive_tool_manager=
-					command_data->interactive_tool_manager;
-				modify_graphics_window_data.light_manager=
-					cmzn_lightmodule_get_manager(command_data->lightmodule);
-				modify_graphics_window_data.root_region=command_data->root_region;
-				modify_graphics_window_data.filter_module = command_data->filter_module;
-				Option_table_add_entry(option_table,"window",NULL,
-					(void *)(&modify_graphics_window_data), modify_Graphics_window);
-#endif /* defined (USE_CMGUI_GRAPHICS_WINDOW) */
-
-				return_code=Option_table_parse(option_table,state);
-				DESTROY(Option_table)(&option_table);
+				return_code=Option_table_parse(
+					cmzn_command_data_get_gfx_modify_option_table(command_data), state);
 			}
 			else
 			{
@@ -11379,12 +11839,12 @@ DESCRIPTION :
 Executes a GFX PRINT command.
 ==============================================================================*/
 {
-	char *file_name, force_onscreen_flag;
-	const char*image_file_format_string, **valid_strings;
+	char *file_name, force_onscreen_flag, tiled_flag;
+	const char *file_extension, *image_file_format_string, **valid_strings;
 	enum Image_file_format image_file_format;
 	enum Texture_storage_type storage;
-	int antialias, height, number_of_valid_strings, return_code,
-		transparency_layers, width;
+	int antialias, height, number_of_threads, number_of_valid_strings, return_code,
+		tile_size, transparency_layers, width;
 	struct Cmgui_image *cmgui_image;
 	struct Cmgui_image_information *cmgui_image_information;
 	struct cmzn_command_data *command_data;
@@ -11400,7 +11860,10 @@ Executes a GFX PRINT command.
 		file_name = (char *)NULL;
 		height = 0;
 		force_onscreen_flag = 0;
+		number_of_threads = Thread_pool::getNumberOfProcessors();
 		storage = TEXTURE_RGBA;
+		tiled_flag = 0;
+		tile_size = GRAPHICS_WINDOW_DEFAULT_TILE_SIZE;
 		transparency_layers = 0;
 		width = 0;
 		/* default file format is to obtain it from the filename extension */
@@ -11439,6 +11902,14 @@ Executes a GFX PRINT command.
 		/* height */
 		Option_table_add_entry(option_table, "height",
 			&height, NULL, set_int_non_negative);
+		/* threads */
+		Option_table_add_entry(option_table, "threads",
+			&number_of_threads, NULL, set_int_non_negative);
+		/* tile_size */
+		Option_table_add_entry(option_table, "tile_size",
+			&tile_size, NULL, set_int_positive);
+		/* tiled */
+		Option_table_add_char_flag_entry(option_table, "tiled", &tiled_flag);
 		/* transparency_layers */
 		Option_table_add_entry(option_table, "transparency_layers",
 			&transparency_layers, NULL, set_int_positive);
@@ -11454,6 +11925,7 @@ Executes a GFX PRINT command.
 		/* no errors, not asking for help */
 		if (return_code)
 		{
+			cmzn_command_data_flush_batch_changes(command_data);
 			if (!file_name)
 			{
 				if (!(file_name = confirmation_get_write_filename(NULL,
@@ -11474,18 +11946,52 @@ Executes a GFX PRINT command.
 				return_code = 0;
 			}
 		}
-		if (return_code)
+		/* an explicit format overrides the file name extension */
+		const bool image_file_format_specified = (0 != image_file_format_string) &&
+			STRING_TO_ENUMERATOR(Image_file_format)(image_file_format_string, &image_file_format) &&
+			(UNKNOWN_IMAGE_FILE_FORMAT != image_file_format);
+		if (!image_file_format_specified)
 		{
-			cmgui_image_information = CREATE(Cmgui_image_information)();
-			if (image_file_format_string)
+			image_file_format = UNKNOWN_IMAGE_FILE_FORMAT;
+		}
+		if (return_code && tiled_flag)
+		{
+			/* stream tiles straight to a PNM/PAM file without assembling the frame */
+			if (image_file_format_specified)
 			{
-				STRING_TO_ENUMERATOR(Image_file_format)(
-					image_file_format_string, &image_file_format);
+				display_message(ERROR_MESSAGE, "gfx print:  "
+					"Image file format %s cannot be written tiled, only PNM/PAM",
+					image_file_format_string);
+				return_code = 0;
 			}
-			else
+			file_extension = strrchr(file_name, '.');
+			if (!(file_extension &&
+				(fuzzy_string_compare_same_length(file_extension, ".pnm") ||
+				fuzzy_string_compare_same_length(file_extension, ".ppm") ||
+				fuzzy_string_compare_same_length(file_extension, ".pgm") ||
+				fuzzy_string_compare_same_length(file_extension, ".pam"))))
+			{
+				display_message(ERROR_MESSAGE, "gfx print:  Tiled images are written as "
+					"PNM/PAM so file name must end in .pnm, .ppm, .pgm or .pam: %s", file_name);
+				return_code = 0;
+			}
+			if (return_code && force_onscreen_flag)
 			{
-				image_file_format = UNKNOWN_IMAGE_FILE_FORMAT;
+				display_message(WARNING_MESSAGE,
+					"gfx print:  force_onscreen is ignored when writing tiled");
 			}
+			if (return_code && !Graphics_window_write_tiled_image(window, file_name, storage,
+				width, height, antialias, transparency_layers, tile_size,
+				number_of_threads))
+			{
+				display_message(ERROR_MESSAGE,
+					"gfx print:  Error writing tiled image %s", file_name);
+				return_code = 0;
+			}
+		}
+		else if (return_code)
+		{
+			cmgui_image_information = CREATE(Cmgui_image_information)();
 			Cmgui_image_information_set_image_file_format(
 				cmgui_image_information, image_file_format);
 			Cmgui_image_information_add_file_name(cmgui_image_information,
@@ -11684,6 +12190,97 @@ int offset_region_identifier(cmzn_region_id region, char element_flag, int eleme
 	return return_code;
 }
 
+/** EX files at least this size are read through a memory mapping by default */
+#define CMGUI_READ_MMAP_THRESHOLD_BYTES (64*1024*1024)
+
+/**
+ * Decides whether to read a file through a memory mapping.
+ * @param mmap_mode  1 if mmap was requested, 0 if no_mmap was requested, -1 to
+ * choose automatically from the file size.
+ * @return  true if the file should be memory mapped.
+ */
+static bool read_file_use_mmap(const char *file_name, int mmap_mode)
+{
+	long long file_size = Mapped_file::getFileSize(file_name);
+	/* zinc memory stream resources are limited to unsigned int length */
+	if ((file_size <= 0) || (file_size > static_cast<long long>(UINT_MAX)))
+	{
+		if ((1 == mmap_mode) && (0 < file_size))
+		{
+			display_message(WARNING_MESSAGE,
+				"File %s is too large to memory map. Reading as stream", file_name);
+		}
+		return false;
+	}
+	if (-1 == mmap_mode)
+		return (file_size >= CMGUI_READ_MMAP_THRESHOLD_BYTES);
+	return (0 != mmap_mode);
+}
+
+/**
+ * Reads an EX node, data or element file into region. Memory mapped files are
+ * parsed in place from a zinc memory stream resource.
+ * @param use_data  If non-zero, read nodes into the data point domain.
+ * @param time_index  Optional time to read node field values at.
+ * @param mmap_mode  1 to read through a memory mapping, 0 to read through an
+ * IO_stream, -1 to choose from the file size.
+ * @return  1 on success, 0 if the file contents could not be read, -1 if the
+ * file could not be opened.
+ */
+static int read_EX_file_into_region(struct cmzn_command_data *command_data,
+	cmzn_region_id region, const char *file_name, int use_data,
+	struct FE_import_time_index *time_index, int mmap_mode)
+{
+	int return_code = -1;
+	if (read_file_use_mmap(file_name, mmap_mode))
+	{
+		Mapped_file mapped_file;
+		if (mapped_file.open(file_name))
+		{
+			cmzn_streaminformation_id streaminformation = cmzn_region_create_streaminformation_region(region);
+			cmzn_streamresource_id resource = cmzn_streaminformation_create_streamresource_memory_buffer(
+				streaminformation, mapped_file.getData(), static_cast<unsigned int>(mapped_file.getSize()));
+			cmzn_streaminformation_region_id streaminformation_region =
+				cmzn_streaminformation_cast_region(streaminformation);
+			if (use_data)
+			{
+				cmzn_streaminformation_region_set_resource_domain_types(streaminformation_region,
+					resource, CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS);
+			}
+			if (time_index)
+			{
+				cmzn_streaminformation_region_set_resource_attribute_real(streaminformation_region,
+					resource, CMZN_STREAMINFORMATION_REGION_ATTRIBUTE_TIME, time_index->time);
+			}
+			return_code = (CMZN_OK == cmzn_region_read(region, streaminformation_region)) ? 1 : 0;
+			cmzn_streamresource_destroy(&resource);
+			cmzn_streaminformation_region_destroy(&streaminformation_region);
+			cmzn_streaminformation_destroy(&streaminformation);
+		}
+	}
+	else
+	{
+		struct IO_stream *input_file = CREATE(IO_stream)(command_data->io_stream_package);
+		if (input_file)
+		{
+			if (IO_stream_open_for_read(input_file, file_name))
+			{
+				if (use_data)
+				{
+					return_code = read_exdata_file(region, input_file, time_index) ? 1 : 0;
+				}
+				else
+				{
+					return_code = read_exregion_file(region, input_file, time_index) ? 1 : 0;
+				}
+				IO_stream_close(input_file);
+			}
+			DESTROY(IO_stream)(&input_file);
+		}
+	}
+	return return_code;
+}
+
 static int gfx_read_elements(struct Parse_state *state,
 	void *dummy_to_be_modified,void *command_data_void)
 /*******************************************************************************
@@ -11696,18 +12293,17 @@ user, otherwise the elements file is read.
 {
 	char *file_name, *region_path,
 		element_flag, face_flag, line_flag, node_flag;
-	int element_offset, face_offset, line_offset, node_offset,
-		return_code;
+	int element_offset, face_offset, line_offset, mmap_mode, node_offset,
+		read_result, return_code;
 	struct cmzn_command_data *command_data;
 	struct cmzn_region *region, *top_region;
-	struct IO_stream *input_file;
 	struct Option_table *option_table;
 
 	ENTER(gfx_read_elements);
 	USE_PARAMETER(dummy_to_be_modified);
-	input_file = NULL;
 	if (state && (command_data = (struct cmzn_command_data *)command_data_void))
 	{
+		mmap_mode = -1;
 		element_flag = 0;
 		element_offset = 0;
 		face_flag = 0;
@@ -11731,6 +12327,8 @@ user, otherwise the elements file is read.
 		/* line_offset */
 		Option_table_add_entry(option_table, "line_offset", &line_offset,
 			&line_flag, set_int_and_char_flag);
+		/* mmap|no_mmap */
+		Option_table_add_switch(option_table, "mmap", "no_mmap", &mmap_mode);
 		/* node_offset */
 		Option_table_add_entry(option_table, "node_offset", &node_offset,
 			&node_flag, set_int_and_char_flag);
@@ -11792,13 +12390,12 @@ user, otherwise the elements file is read.
 			}
 			if (return_code)
 			{
-				/* open the file */
-				if ((input_file = CREATE(IO_stream)(command_data->io_stream_package))
-					&& (IO_stream_open_for_read(input_file, file_name)))
+				region = cmzn_region_create_region(top_region);
+				read_result = read_EX_file_into_region(command_data, region, file_name,
+					/*use_data*/0, (struct FE_import_time_index *)NULL, mmap_mode);
+				if (0 <= read_result)
 				{
-					region = cmzn_region_create_region(top_region);
-					if (read_exregion_file(region, input_file,
-						(struct FE_import_time_index *)NULL))
+					if (read_result)
 					{
 						if (element_flag || face_flag || line_flag || node_flag)
 						{
@@ -11831,9 +12428,6 @@ user, otherwise the elements file is read.
 							"Error reading element file: %s", file_name);
 						return_code = 0;
 					}
-					DEACCESS(cmzn_region)(&region);
-					IO_stream_close(input_file);
-					DESTROY(IO_stream)(&input_file);
 				}
 				else
 				{
@@ -11841,14 +12435,11 @@ user, otherwise the elements file is read.
 						"Could not open element file: %s", file_name);
 					return_code = 0;
 				}
+				DEACCESS(cmzn_region)(&region);
 			}
 			DEACCESS(cmzn_region)(&top_region);
 		}
 		DESTROY(Option_table)(&option_table);
-#if defined (WX_USER_INTERFACE)
-		if (input_file)
-			 DESTROY(IO_stream)(&input_file);
-#endif /*defined (WX_USER_INTERFACE)*/
 		if (file_name)
 		{
 			DEALLOCATE(file_name);
@@ -11879,18 +12470,16 @@ otherwise the nodes file is read.
 If the <use_data> flag is set, then read data, otherwise nodes.
 ==============================================================================*/
 {
-	char *file_name, node_offset_flag, *region_path, time_set_flag;
-	double maximum, minimum;
+	char *file_name, lazy_flag, node_offset_flag, *region_path, time_set_flag;
+	double cache_memory, maximum, minimum;
 	float time;
-	int node_offset, return_code;
+	int mmap_mode, node_offset, read_result, return_code;
 	struct cmzn_command_data *command_data;
 	struct cmzn_region *region, *top_region;
 	struct FE_import_time_index *node_time_index, node_time_index_data;
-	struct IO_stream *input_file;
 	struct Option_table *option_table;
 
 	ENTER(gfx_read_nodes);
-	input_file=NULL;
 	if (state)
 	{
 		if (NULL != (command_data = (struct cmzn_command_data *)command_data_void))
@@ -11902,10 +12491,20 @@ If the <use_data> flag is set, then read data, otherwise nodes.
 			time = 0;
 			time_set_flag = 0;
 			node_time_index = (struct FE_import_time_index *)NULL;
+			mmap_mode = -1;
+			lazy_flag = 0;
+			cache_memory = NODE_TIME_SERIES_DEFAULT_CACHE_MEGABYTES;
 			option_table=CREATE(Option_table)();
+			/* cache_memory */
+			Option_table_add_entry(option_table, "cache_memory", &cache_memory,
+				NULL, set_double_non_negative);
 			/* example */
 			Option_table_add_entry(option_table,CMGUI_EXAMPLE_DIRECTORY_SYMBOL,
 				&file_name, &(command_data->example_directory), set_file_name);
+			/* lazy */
+			Option_table_add_char_flag_entry(option_table, "lazy", &lazy_flag);
+			/* mmap|no_mmap */
+			Option_table_add_switch(option_table, "mmap", "no_mmap", &mmap_mode);
 			if (!use_data)
 			{
 				/* node_offset */
@@ -11956,6 +12555,13 @@ If the <use_data> flag is set, then read data, otherwise nodes.
 						}
 					}
 				}
+				if (lazy_flag && ((!time_set_flag) || node_offset_flag))
+				{
+					display_message(ERROR_MESSAGE, "gfx read %s.  "
+						"lazy requires a time and does not support %s",
+						use_data ? "data" : "nodes", use_data ? "data_offset" : "node_offset");
+					return_code = 0;
+				}
 				if (time_set_flag)
 				{
 					node_time_index_data.time = time;
@@ -11999,21 +12605,38 @@ If the <use_data> flag is set, then read data, otherwise nodes.
 					{
 						top_region = ACCESS(cmzn_region)(command_data->root_region);
 					}
-					if (return_code)
+					if (return_code && lazy_flag)
 					{
-						if ((input_file = CREATE(IO_stream)(command_data->io_stream_package))
-							&& (IO_stream_open_for_read(input_file, file_name)))
+						/* record the step; it is only read when the time keeper reaches it */
+						if (0 <= Mapped_file::getFileSize(file_name))
 						{
-							region = cmzn_region_create_region(top_region);
-							if (use_data)
-							{
-								return_code = read_exdata_file(region, input_file, node_time_index);
-							}
-							else
-							{
-								return_code = read_exregion_file(region, input_file, node_time_index);
-							}
-							if (return_code)
+							if (!command_data->node_time_series_set)
+								command_data->node_time_series_set =
+									new Node_time_series_set(command_data->root_region);
+							Node_time_series *node_time_series =
+								command_data->node_time_series_set->findOrCreate(top_region,
+									(use_data != 0), command_data->default_time_keeper_app,
+									command_data->io_stream_package);
+							node_time_series->setCacheMemoryLimit(
+								static_cast<size_t>(cache_memory*1024.0*1024.0));
+							node_time_series->addStep(time, file_name);
+							return_code = node_time_series->update();
+						}
+						else
+						{
+							display_message(ERROR_MESSAGE,
+								"Could not open node file: %s", file_name);
+							return_code = 0;
+						}
+					}
+					else if (return_code)
+					{
+						region = cmzn_region_create_region(top_region);
+						read_result = read_EX_file_into_region(command_data, region, file_name,
+							(use_data != 0), node_time_index, mmap_mode);
+						if (0 <= read_result)
+						{
+							if (read_result)
 							{
 								if (node_offset_flag)
 								{
@@ -12060,10 +12683,6 @@ If the <use_data> flag is set, then read data, otherwise nodes.
 									"Error reading node file: %s", file_name);
 								return_code = 0;
 							}
-							DEACCESS(cmzn_region)(&region);
-							IO_stream_close(input_file);
-							DESTROY(IO_stream)(&input_file);
-							input_file =NULL;
 						}
 						else
 						{
@@ -12071,6 +12690,7 @@ If the <use_data> flag is set, then read data, otherwise nodes.
 								"Could not open node file: %s", file_name);
 							return_code = 0;
 						}
+						DEACCESS(cmzn_region)(&region);
 					}
 					DEACCESS(cmzn_region)(&top_region);
 					if (return_code && time_set_flag)
@@ -12093,11 +12713,6 @@ If the <use_data> flag is set, then read data, otherwise nodes.
 				}
 			}
 			DESTROY(Option_table)(&option_table);
-#if defined (WX_USER_INTERFACE)
-			if (input_file)
-				 DESTROY(IO_stream)(&input_file);
-			input_file =NULL;
-#endif /*defined (WX_USER_INTERFACE)*/
 			if (file_name)
 			{
 				DEALLOCATE(file_name);
@@ -12213,12 +12828,19 @@ static int gfx_read_region(struct Parse_state *state,
 		struct FE_field_order_info *field_order_info = (struct FE_field_order_info *)NULL;
 		cmzn_region_id region = cmzn_region_access(command_data->root_region);
 		char *file_name = (char *)NULL;
+		char *format_name = (char *)NULL;
+		int mmap_mode = -1;
 
 		struct Option_table *option_table = CREATE(Option_table)();
 		/* fields */
 		Option_table_add_entry(option_table, "fields", &field_order_info,
 			cmzn_region_get_FE_region(command_data->root_region),
 			set_FE_fields_FE_region);
+		/* format */
+		Option_table_add_string_entry(option_table, "format", &format_name,
+			" binary|ex|fieldml");
+		/* mmap|no_mmap */
+		Option_table_add_switch(option_table, "mmap", "no_mmap", &mmap_mode);
 		/* region */
 		Option_table_add_set_cmzn_region(option_table, "region",
 			command_data->root_region, &region);
@@ -12240,11 +12862,47 @@ static int gfx_read_region(struct Parse_state *state,
 					return_code = 0;
 				}
 			}
+			/* binary region files are recognised by signature if format not given */
+			bool binary_format = false;
 			if (return_code)
 			{
+				if (format_name)
+				{
+					if (fuzzy_string_compare(format_name, "binary"))
+					{
+						binary_format = true;
+					}
+					else if (!(fuzzy_string_compare(format_name, "ex") ||
+						fuzzy_string_compare(format_name, "fieldml")))
+					{
+						display_message(ERROR_MESSAGE,
+							"gfx read region:  Unknown format '%s'", format_name);
+						return_code = 0;
+					}
+				}
+				else
+				{
+					binary_format = (0 != is_region_binary_file(file_name));
+				}
+			}
+			if (return_code && binary_format)
+			{
+				return_code = read_region_binary_file(region, file_name);
+			}
+			else if (return_code)
+			{
+				/* FieldML is read from file by name; only EX formats are memory mapped */
+				const size_t file_name_length = strlen(file_name);
+				const bool fieldml_file = (file_name_length >= strlen(file_ext)) &&
+					(0 == strcmp(file_name + file_name_length - strlen(file_ext), file_ext));
+				Mapped_file mapped_file;
+				const bool use_mmap = (!fieldml_file) && read_file_use_mmap(file_name, mmap_mode) &&
+					mapped_file.open(file_name);
 				cmzn_streaminformation_id streaminformation = cmzn_region_create_streaminformation_region(region);
-				cmzn_streamresource_id resource = cmzn_streaminformation_create_streamresource_file(
-					streaminformation, file_name);
+				cmzn_streamresource_id resource = (use_mmap) ?
+					cmzn_streaminformation_create_streamresource_memory_buffer(streaminformation,
+						mapped_file.getData(), static_cast<unsigned int>(mapped_file.getSize())) :
+					cmzn_streaminformation_create_streamresource_file(streaminformation, file_name);
 				cmzn_streaminformation_region_id streaminformation_region =
 					cmzn_streaminformation_cast_region(streaminformation);
 				return_code = cmzn_region_read(region, streaminformation_region);
@@ -12267,7 +12925,418 @@ static int gfx_read_region(struct Parse_state *state,
 		{
 			DEALLOCATE(file_name);
 		}
+		if (format_name)
+		{
+			DEALLOCATE(format_name);
+		}
+		cmzn_region_destroy(&region);
+	}
+	return return_code;
+}
+
+/***************************************************************************//**
+ * Executes a GFX READ SNAPSHOT command. Reads all regions from a snapshot file
+ * written by gfx write snapshot, then executes its commands recreating fields,
+ * materials, spectra, graphics and windows.
+ */
+static int gfx_read_snapshot(struct Parse_state *state,
+	void *dummy, void *command_data_void)
+{
+	int return_code = 0;
+	USE_PARAMETER(dummy);
+	cmzn_command_data *command_data = reinterpret_cast<cmzn_command_data*>(command_data_void);
+	if (state && command_data)
+	{
+		char *file_name = 0;
+		struct Option_table *option_table = CREATE(Option_table)();
+		Option_table_add_help(option_table,
+			"Restore a session saved with 'gfx write snapshot' into the root region.");
+		/* default option: file name */
+		Option_table_add_default_string_entry(option_table, &file_name, "FILE_NAME");
+		return_code = Option_table_multi_parse(option_table, state);
+		DESTROY(Option_table)(&option_table);
+		if (return_code && (!file_name))
+		{
+			if (!(file_name = confirmation_get_read_filename(REGION_SNAPSHOT_FILE_EXTENSION,
+				command_data->user_interface
+#if defined(WX_USER_INTERFACE)
+				, command_data->execute_command
+#endif /*defined (WX_USER_INTERFACE) */
+				)))
+			{
+				return_code = 0;
+			}
+		}
+		if (return_code)
+		{
+			const double start_time = get_elapsed_time_seconds();
+			std::string commands;
+			double region_seconds = 0.0;
+			return_code = read_region_snapshot_file(command_data->root_region, file_name,
+				commands, &region_seconds);
+			const double commands_start_time = get_elapsed_time_seconds();
+			if (return_code)
+			{
+				Execute_command_begin_batch(command_data->execute_command);
+				size_t line_start = 0;
+				while (line_start < commands.size())
+				{
+					size_t line_end = commands.find('\n', line_start);
+					if (std::string::npos == line_end)
+						line_end = commands.size();
+					std::string line(commands, line_start, line_end - line_start);
+					line_start = line_end + 1;
+					if (line.empty() || ('#' == line[0]))
+						continue;
+					if (!Execute_command_execute_string(command_data->execute_command, line.c_str()))
+						return_code = 0;
+				}
+				Execute_command_end_batch(command_data->execute_command);
+			}
+			const double end_time = get_elapsed_time_seconds();
+			if (return_code)
+			{
+				display_message(INFORMATION_MESSAGE,
+					"Read snapshot in %g seconds (regions %g, commands %g)\n",
+					end_time - start_time, region_seconds, end_time - commands_start_time);
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE, "Error reading snapshot file: %s", file_name);
+			}
+		}
+		if (file_name)
+			DEALLOCATE(file_name);
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "gfx_read_snapshot.  Invalid argument(s)");
+	}
+	return return_code;
+}
+
+/**
+ * One file in a gfx read series. The file contents are loaded into buffer by a
+ * worker thread; parsing and merging are done on the main thread.
+ */
+struct Read_series_file
+{
+	char *file_name;
+	double time;
+	char *buffer;
+	size_t buffer_length;
+	int task_identifier;
+	/* set by worker: 1 if loaded, 0 if file could not be opened or read, -1 if
+	   too large to read from a memory buffer */
+	int load_status;
+};
+
+/**
+ * Thread pool task loading the whole of a series file into memory. Must not
+ * call Zinc or display_message as it runs on a worker thread.
+ */
+static void Read_series_file_load(void *series_file_void)
+{
+	Read_series_file *series_file = static_cast<Read_series_file *>(series_file_void);
+	series_file->load_status = 0;
+	FILE *file = fopen(series_file->file_name, "rb");
+	if (file)
+	{
+		if ((0 == fseek(file, 0, SEEK_END)))
+		{
+			long length = ftell(file);
+			/* Zinc memory stream resources have an unsigned int length */
+			if ((0 <= length) && (static_cast<unsigned long>(length) > UINT_MAX))
+			{
+				series_file->load_status = -1;
+			}
+			else if ((0 <= length) && (0 == fseek(file, 0, SEEK_SET)))
+			{
+				/* malloc as cmgui memory tracking is not thread safe */
+				series_file->buffer = static_cast<char *>(malloc(static_cast<size_t>(length) + 1));
+				if (series_file->buffer)
+				{
+					series_file->buffer_length = fread(series_file->buffer, 1,
+						static_cast<size_t>(length), file);
+					series_file->buffer[series_file->buffer_length] = '\0';
+					if (series_file->buffer_length == static_cast<size_t>(length))
+						series_file->load_status = 1;
+				}
+			}
+		}
+		fclose(file);
+	}
+}
+
+/**
+ * Parses a loaded series file into a temporary child of top_region at its time,
+ * and merges it into top_region. Frees the file buffer.
+ */
+static int Read_series_file_parse_and_merge(Read_series_file *series_file,
+	cmzn_region_id top_region, double *parse_seconds, double *merge_seconds)
+{
+	int return_code = 1;
+	if (series_file->load_status < 0)
+	{
+		display_message(ERROR_MESSAGE,
+			"gfx read series.  File is larger than %u bytes: %s", UINT_MAX,
+			series_file->file_name);
+		return_code = 0;
+	}
+	else if (!series_file->load_status)
+	{
+		display_message(ERROR_MESSAGE,
+			"gfx read series.  Could not read file: %s", series_file->file_name);
+		return_code = 0;
+	}
+	else
+	{
+		double start_time = get_elapsed_time_seconds();
+		cmzn_region_id region = cmzn_region_create_region(top_region);
+		cmzn_streaminformation_id streaminformation = cmzn_region_create_streaminformation_region(region);
+		cmzn_streamresource_id resource = cmzn_streaminformation_create_streamresource_memory_buffer(
+			streaminformation, series_file->buffer, static_cast<unsigned int>(series_file->buffer_length));
+		cmzn_streaminformation_region_id streaminformation_region =
+			cmzn_streaminformation_cast_region(streaminformation);
+		cmzn_streaminformation_region_set_resource_attribute_real(streaminformation_region, resource,
+			CMZN_STREAMINFORMATION_REGION_ATTRIBUTE_TIME, series_file->time);
+		if (CMZN_OK != cmzn_region_read(region, streaminformation_region))
+		{
+			display_message(ERROR_MESSAGE,
+				"gfx read series.  Error reading file: %s", series_file->file_name);
+			return_code = 0;
+		}
+		cmzn_streamresource_destroy(&resource);
+		cmzn_streaminformation_region_destroy(&streaminformation_region);
+		cmzn_streaminformation_destroy(&streaminformation);
+		double parsed_time = get_elapsed_time_seconds();
+		*parse_seconds += parsed_time - start_time;
+		if (return_code)
+		{
+			if (cmzn_region_can_merge(top_region, region))
+			{
+				if (!cmzn_region_merge(top_region, region))
+				{
+					display_message(ERROR_MESSAGE,
+						"gfx read series.  Error merging file: %s", series_file->file_name);
+					return_code = 0;
+				}
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE,
+					"gfx read series.  Contents of file %s not compatible with global objects",
+					series_file->file_name);
+				return_code = 0;
+			}
+		}
 		cmzn_region_destroy(&region);
+		*merge_seconds += get_elapsed_time_seconds() - parsed_time;
+	}
+	if (series_file->buffer)
+	{
+		free(series_file->buffer);
+		series_file->buffer = 0;
+	}
+	return return_code;
+}
+
+/**
+ * Reads a time series of EX node/element/region files named from a template in
+ * which number_pattern is replaced by each number in the number_series, padded
+ * with leading zeros to the length of the pattern. Each file is read at time
+ * time_offset + number*time_scale. Files are loaded into memory ahead of use by
+ * a pool of worker threads while the main thread parses and merges them into
+ * the region in series order. Zinc is not thread safe so parsing and merging
+ * are not concurrent. Reports load, parse and merge timings and throughput.
+ */
+static int gfx_read_series(struct Parse_state *state,
+	void *dummy, void *command_data_void)
+{
+	int return_code = 0;
+	USE_PARAMETER(dummy);
+	cmzn_command_data *command_data = reinterpret_cast<cmzn_command_data*>(command_data_void);
+	if (state && command_data)
+	{
+		cmzn_region_id top_region = cmzn_region_access(command_data->root_region);
+		char *file_name_template = (char *)NULL;
+		char *file_number_pattern = (char *)NULL;
+		struct Texture_file_number_series_data file_number_series_data;
+		file_number_series_data.start = 0;
+		file_number_series_data.stop = 0;
+		file_number_series_data.increment = 0;
+		double time_offset = 0.0;
+		double time_scale = 1.0;
+		int number_of_threads = Thread_pool::getNumberOfProcessors();
+
+		struct Option_table *option_table = CREATE(Option_table)();
+		Option_table_add_help(option_table,
+			"Read a time series of EX files named from FILE_NAME by replacing the "
+			"number_pattern with each number in the number_series, zero padded to the "
+			"pattern length. Each file is read at time = time_offset + number*time_scale. "
+			"Files are loaded into memory by <threads> worker threads ahead of being "
+			"parsed and merged in order.");
+		/* example */
+		Option_table_add_entry(option_table, CMGUI_EXAMPLE_DIRECTORY_SYMBOL,
+			&file_name_template, &(command_data->example_directory), set_file_name);
+		/* number_pattern */
+		Option_table_add_entry(option_table, "number_pattern",
+			&file_number_pattern, (void *)1, set_name);
+		/* number_series */
+		Option_table_add_entry(option_table, "number_series",
+			&file_number_series_data, (void *)NULL,
+			gfx_modify_Texture_file_number_series);
+		/* region */
+		Option_table_add_set_cmzn_region(option_table, "region",
+			command_data->root_region, &top_region);
+		/* threads */
+		Option_table_add_entry(option_table, "threads",
+			&number_of_threads, NULL, set_int_non_negative);
+		/* time_offset */
+		Option_table_add_entry(option_table, "time_offset",
+			&time_offset, NULL, set_double);
+		/* time_scale */
+		Option_table_add_entry(option_table, "time_scale",
+			&time_scale, NULL, set_double);
+		/* default option: file name */
+		Option_table_add_default_string_entry(option_table, &file_name_template, "FILE_NAME");
+		return_code = Option_table_multi_parse(option_table, state);
+		DESTROY(Option_table)(&option_table);
+		if (return_code)
+		{
+			const char *pattern_location = 0;
+			if (!(file_name_template && file_number_pattern &&
+				(0 != file_number_series_data.increment)))
+			{
+				display_message(ERROR_MESSAGE, "gfx read series.  "
+					"Must specify FILE_NAME, number_pattern and number_series");
+				return_code = 0;
+			}
+			else if (!(pattern_location = strstr(file_name_template, file_number_pattern)))
+			{
+				display_message(ERROR_MESSAGE, "gfx read series.  "
+					"File number pattern \"%s\" not found in file name \"%s\"",
+					file_number_pattern, file_name_template);
+				return_code = 0;
+			}
+			if (return_code)
+			{
+				const int number_of_files = 1 +
+					(file_number_series_data.stop - file_number_series_data.start)/
+					file_number_series_data.increment;
+				if (number_of_threads > number_of_files)
+					number_of_threads = number_of_files;
+				const int prefix_length = static_cast<int>(pattern_location - file_name_template);
+				const int pattern_length = static_cast<int>(strlen(file_number_pattern));
+				const char *suffix = pattern_location + pattern_length;
+				const size_t file_name_length = strlen(file_name_template) + 32;
+				std::vector<Read_series_file> series_files(number_of_files);
+				for (int i = 0; i < number_of_files; ++i)
+				{
+					Read_series_file& series_file = series_files[i];
+					const int number = file_number_series_data.start + i*file_number_series_data.increment;
+					series_file.time = time_offset + static_cast<double>(number)*time_scale;
+					series_file.buffer = 0;
+					series_file.buffer_length = 0;
+					series_file.task_identifier = -1;
+					series_file.load_status = 0;
+					ALLOCATE(series_file.file_name, char, file_name_length);
+					if (series_file.file_name)
+					{
+						sprintf(series_file.file_name, "%.*s%0*d%s", prefix_length,
+							file_name_template, pattern_length, number, suffix);
+					}
+					else
+					{
+						return_code = 0;
+					}
+				}
+				if (return_code)
+				{
+					double load_wait_seconds = 0.0, parse_seconds = 0.0, merge_seconds = 0.0;
+					double total_bytes = 0.0;
+					const double start_time = get_elapsed_time_seconds();
+					/* limit files held in memory to those being loaded or waiting to be parsed */
+					const int prefetch_count = 2*((0 < number_of_threads) ? number_of_threads : 1);
+					int files_merged = 0;
+					Thread_pool thread_pool(number_of_threads);
+					int next_load = 0;
+					cmzn_region_begin_hierarchical_change(top_region);
+					for (int i = 0; i < number_of_files; ++i)
+					{
+						while ((next_load < number_of_files) && (next_load < i + prefetch_count))
+						{
+							series_files[next_load].task_identifier =
+								thread_pool.addTask(Read_series_file_load, &(series_files[next_load]));
+							++next_load;
+						}
+						double wait_start_time = get_elapsed_time_seconds();
+						thread_pool.waitForTask(series_files[i].task_identifier);
+						load_wait_seconds += get_elapsed_time_seconds() - wait_start_time;
+						total_bytes += static_cast<double>(series_files[i].buffer_length);
+						if (return_code)
+						{
+							if (Read_series_file_parse_and_merge(&(series_files[i]), top_region,
+								&parse_seconds, &merge_seconds))
+							{
+								++files_merged;
+							}
+							else
+							{
+								return_code = 0;
+							}
+						}
+					}
+					thread_pool.waitForAll();
+					cmzn_region_end_hierarchical_change(top_region);
+					const double total_seconds = get_elapsed_time_seconds() - start_time;
+					if (0 < files_merged)
+					{
+						/* Increase the range of the default time keeper to cover the series */
+						double first_time = series_files[0].time;
+						double last_time = series_files[files_merged - 1].time;
+						if (first_time > last_time)
+						{
+							double swap = first_time;
+							first_time = last_time;
+							last_time = swap;
+						}
+						double maximum = command_data->default_time_keeper_app->getTimeKeeper()->getMaximum();
+						double minimum = command_data->default_time_keeper_app->getTimeKeeper()->getMinimum();
+						if (first_time < minimum)
+							minimum = first_time;
+						if (last_time > maximum)
+							maximum = last_time;
+						command_data->default_time_keeper_app->setMinimum(minimum);
+						command_data->default_time_keeper_app->setMaximum(maximum);
+					}
+					const double megabytes = total_bytes/(1024.0*1024.0);
+					display_message(INFORMATION_MESSAGE,
+						"gfx read series:  %d of %d files, %.2f MB in %.3f s using %d threads\n"
+						"  load wait %.3f s, parse %.3f s (%.2f MB/s), merge %.3f s (%.2f files/s)\n",
+						files_merged, number_of_files, megabytes, total_seconds, thread_pool.getNumberOfThreads(),
+						load_wait_seconds, parse_seconds,
+						(0.0 < parse_seconds) ? megabytes/parse_seconds : 0.0,
+						merge_seconds, (0.0 < merge_seconds) ? files_merged/merge_seconds : 0.0);
+				}
+				for (int i = 0; i < number_of_files; ++i)
+				{
+					if (series_files[i].buffer)
+						free(series_files[i].buffer);
+					if (series_files[i].file_name)
+						DEALLOCATE(series_files[i].file_name);
+				}
+			}
+		}
+		if (file_number_pattern)
+		{
+			DEALLOCATE(file_number_pattern);
+		}
+		if (file_name_template)
+		{
+			DEALLOCATE(file_name_template);
+		}
+		cmzn_region_destroy(&top_region);
 	}
 	return return_code;
 }
@@ -12423,6 +13492,12 @@ Executes a GFX READ command.
 			/* region */
 			Option_table_add_entry(option_table, "region",
 				NULL, command_data_void, gfx_read_region);
+			/* series */
+			Option_table_add_entry(option_table, "series",
+				NULL, command_data_void, gfx_read_series);
+			/* snapshot */
+			Option_table_add_entry(option_table, "snapshot",
+				NULL, command_data_void, gfx_read_snapshot);
 			/* wavefront_obj */
 			Option_table_add_entry(option_table, "wavefront_obj",
 				NULL, command_data_void, gfx_read_wavefront_obj);
@@ -12446,6 +13521,55 @@ Executes a GFX READ command.
 	return (return_code);
 } /* execute_command_gfx_read */
 
+/**
+ * Creates a temporary group containing the elements of mesh with identifiers
+ * in element_ranges for which conditional_field, if any, is true at time, by
+ * looking up each identifier in the ranges. For use as the conditional field
+ * for changing the element selection.
+ * @return  Group field, or NULL if the ranges are empty or not fewer than the
+ * number of elements in mesh, so looking up identifiers is not worthwhile.
+ */
+static cmzn_field_id cmzn_mesh_create_group_field_ranges_conditional_indexed(
+	cmzn_mesh_id mesh, Multi_range *element_ranges, cmzn_field_id conditional_field,
+	FE_value time)
+{
+	Mesh_ranges_iterator iter(mesh, element_ranges);
+	if ((!Multi_range_get_number_of_ranges(element_ranges)) || (!iter.isLookup()))
+		return 0;
+	cmzn_fieldmodule_id fieldmodule = cmzn_mesh_get_fieldmodule(mesh);
+	cmzn_field_id group_field = cmzn_fieldmodule_create_field_group(fieldmodule);
+	cmzn_field_group_id group = cmzn_field_cast_group(group_field);
+	cmzn_field_element_group_id element_group = cmzn_field_group_create_field_element_group(group, mesh);
+	cmzn_mesh_group_id mesh_group = cmzn_field_element_group_get_mesh_group(element_group);
+	cmzn_fieldcache_id cache = 0;
+	if (conditional_field)
+	{
+		cache = cmzn_fieldmodule_create_fieldcache(fieldmodule);
+		cmzn_fieldcache_set_time(cache, time);
+	}
+	cmzn_element_id element = 0;
+	while (0 != (element = iter.nextNonAccess()))
+	{
+		if (conditional_field)
+		{
+			cmzn_fieldcache_set_element(cache, element);
+			if (!cmzn_field_evaluate_boolean(conditional_field, cache))
+				continue;
+		}
+		if (CMZN_OK != cmzn_mesh_group_add_element(mesh_group, element))
+		{
+			cmzn_field_destroy(&group_field);
+			break;
+		}
+	}
+	cmzn_fieldcache_destroy(&cache);
+	cmzn_mesh_group_destroy(&mesh_group);
+	cmzn_field_element_group_destroy(&element_group);
+	cmzn_field_group_destroy(&group);
+	cmzn_fieldmodule_destroy(&fieldmodule);
+	return group_field;
+}
+
 /**
  * Executes a GFX SELECT|UNSELECT command.
  * @param unselect_flag_void  0 to select, non-zero to unselect.
@@ -12464,7 +13588,6 @@ static int execute_command_gfx_select(struct Parse_state *state,
 	struct FE_element_grid_to_Element_point_ranges_list_data grid_to_list_data;
 	struct FE_field *grid_field;
 	struct FE_region *fe_region;
-	struct LIST(FE_node) *node_list;
 	struct Multi_range *multi_range;
 	struct Option_table *option_table;
 	struct Set_FE_field_conditional_FE_region_data set_grid_field_data;
@@ -12595,27 +13718,20 @@ static int execute_command_gfx_select(struct Parse_state *state,
 				/* data */
 				if (data_flag)
 				{
-					cmzn_nodeset *nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(fieldmodule,
-						CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS);
-					node_list = cmzn_nodeset_create_node_list_ranges_conditional(
-						nodeset, Multi_range_get_total_number_in_ranges(multi_range) ?
-							multi_range : static_cast<Multi_range *>(0), conditional_field, time);
-					cmzn_nodeset_destroy(&nodeset);
-					if (node_list)
+					const double start_seconds = get_elapsed_time_seconds();
+					int number_changed = 0;
+					cmzn_scene *local_scene = cmzn_region_get_scene(region);
+					if (!cmzn_scene_change_node_selection_ranges_conditional(local_scene, /*use_data*/1,
+						multi_range, conditional_field, time, /*add_flag*/!unselect, &number_changed))
 					{
-						cmzn_scene *local_scene = cmzn_region_get_scene(region);
-						if (unselect)
-							cmzn_scene_remove_selection_from_node_list(local_scene, node_list, /* use_data */1);
-						else
-							cmzn_scene_add_selection_from_node_list(local_scene, node_list, /* use_data */1);
-						cmzn_scene_destroy(&local_scene);
-						if (verbose_flag)
-						{
-							display_message(INFORMATION_MESSAGE,
-								unselect ? "Unselected %d data points.\n" : "Selected %d data points.\n",
-								NUMBER_IN_LIST(FE_node)(node_list));
-						}
-						DESTROY(LIST(FE_node))(&node_list);
+						return_code = 0;
+					}
+					cmzn_scene_destroy(&local_scene);
+					if (verbose_flag)
+					{
+						display_message(INFORMATION_MESSAGE,
+							unselect ? "Unselected %d data points in %g seconds.\n" : "Selected %d data points in %g seconds.\n",
+							number_changed, get_elapsed_time_seconds() - start_seconds);
 					}
 				}
 				/* element_points */
@@ -12636,9 +13752,16 @@ static int execute_command_gfx_select(struct Parse_state *state,
 					{
 						cmzn_region_begin_change(region);
 						FE_region *fe_region = cmzn_region_get_FE_region(region);
-						FE_mesh *fe_mesh = FE_region_find_FE_mesh_by_dimension(fe_region, element_dimension);
-						cmzn_field_id use_conditional_field = FE_mesh_create_conditional_field_from_ranges_and_selection(
-							fe_mesh, multi_range, /*selection_field*/0, /*groupField*/0, conditional_field, time);
+						cmzn_mesh_id mesh = cmzn_fieldmodule_find_mesh_by_dimension(fieldmodule, element_dimension);
+						cmzn_field_id use_conditional_field = cmzn_mesh_create_group_field_ranges_conditional_indexed(
+							mesh, multi_range, conditional_field, time);
+						cmzn_mesh_destroy(&mesh);
+						if (!use_conditional_field)
+						{
+							FE_mesh *fe_mesh = FE_region_find_FE_mesh_by_dimension(fe_region, element_dimension);
+							use_conditional_field = FE_mesh_create_conditional_field_from_ranges_and_selection(
+								fe_mesh, multi_range, /*selection_field*/0, /*groupField*/0, conditional_field, time);
+						}
 						if (use_conditional_field)
 						{
 							cmzn_scene *local_scene = cmzn_region_get_scene(region);
@@ -12704,27 +13827,20 @@ static int execute_command_gfx_select(struct Parse_state *state,
 				/* nodes */
 				if (nodes_flag)
 				{
-					cmzn_nodeset *nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(fieldmodule,
-						CMZN_FIELD_DOMAIN_TYPE_NODES);
-					node_list = cmzn_nodeset_create_node_list_ranges_conditional(
-						nodeset, Multi_range_get_total_number_in_ranges(multi_range) ?
-							multi_range : static_cast<Multi_range *>(0), conditional_field, time);
-					cmzn_nodeset_destroy(&nodeset);
-					if (node_list)
+					const double start_seconds = get_elapsed_time_seconds();
+					int number_changed = 0;
+					cmzn_scene *local_scene = cmzn_region_get_scene(region);
+					if (!cmzn_scene_change_node_selection_ranges_conditional(local_scene, /*use_data*/0,
+						multi_range, conditional_field, time, /*add_flag*/!unselect, &number_changed))
 					{
-						cmzn_scene *local_scene = cmzn_region_get_scene(region);
-						if (unselect)
-							cmzn_scene_remove_selection_from_node_list(local_scene, node_list, /* use_data */0);
-						else
-							cmzn_scene_add_selection_from_node_list(local_scene, node_list, /* use_data */0);
-						cmzn_scene_destroy(&local_scene);
-						if (verbose_flag)
-						{
-							display_message(INFORMATION_MESSAGE,
-								unselect ? "Unselected %d data points.\n" : "Selected %d data points.\n",
-								NUMBER_IN_LIST(FE_node)(node_list));
-						}
-						DESTROY(LIST(FE_node))(&node_list);
+						return_code = 0;
+					}
+					cmzn_scene_destroy(&local_scene);
+					if (verbose_flag)
+					{
+						display_message(INFORMATION_MESSAGE,
+							unselect ? "Unselected %d nodes in %g seconds.\n" : "Selected %d nodes in %g seconds.\n",
+							number_changed, get_elapsed_time_seconds() - start_seconds);
 					}
 
 				}
@@ -13366,6 +14482,7 @@ Executes a GFX SET command.
 		if (state->current_token)
 		{
 			double point_size = 0.0;
+			double redraw_rate = Scene_viewer_app_get_redraw_frame_rate();
 			option_table=CREATE(Option_table)();
 			Option_table_add_entry(option_table, "node_value", NULL,
 				command_data_void, gfx_set_FE_nodal_value);
@@ -13373,6 +14490,8 @@ Executes a GFX SET command.
 				(void *)command_data->root_region, gfx_set_region_order);
 			Option_table_add_positive_double_entry(option_table, "point_size",
 				&point_size);
+			Option_table_add_non_negative_double_entry(option_table, "redraw_rate",
+				&redraw_rate);
 			Option_table_add_entry(option_table, "transformation", NULL,
 				command_data_void, gfx_set_transformation);
 #if defined (WX_USER_INTERFACE)
@@ -13382,6 +14501,10 @@ Executes a GFX SET command.
 			Option_table_add_entry(option_table, "visibility", NULL,
 				command_data_void, gfx_set_visibility);
 			return_code = Option_table_parse(option_table, state);
+			if (return_code)
+			{
+				return_code = Scene_viewer_app_set_redraw_frame_rate(redraw_rate);
+			}
 			if (point_size != 0.0)
 			{
 				display_message(WARNING_MESSAGE, "Set option 'point_size' has been removed; set point_size on individual graphics using gfx modify g_element commands instead");
@@ -13493,7 +14616,7 @@ DESCRIPTION :
 ==============================================================================*/
 {
 	char every, loop, maximum_flag, minimum_flag, once, play, set_time_flag,
-		skip, speed_flag, stop, swing;
+		skip, speed_flag, statistics, stop, swing;
 	double maximum, minimum, set_time, speed;
 	int return_code;
 	static struct Modifier_entry option_table[]=
@@ -13507,6 +14630,7 @@ DESCRIPTION :
 		{"set_time",NULL,NULL,set_double_and_char_flag},
 		{"skip_frames",NULL,NULL,set_char_flag},
 		{"speed",NULL,NULL,set_double_and_char_flag},
+		{"statistics",NULL,NULL,set_char_flag},
 		{"stop",NULL,NULL,set_char_flag},
 		{"swing",NULL,NULL,set_char_flag},
 		{NULL,NULL,NULL,NULL}
@@ -13577,6 +14701,7 @@ DESCRIPTION :
 				set_time_flag = 0;
 				skip = 0;
 				speed_flag = 0;
+				statistics = 0;
 				stop = 0;
 				swing = 0;
 
@@ -13593,8 +14718,9 @@ DESCRIPTION :
 				(option_table[7]).to_be_modified = &skip;
 				(option_table[8]).to_be_modified = &speed;
 				(option_table[8]).user_data = &speed_flag;
-				(option_table[9]).to_be_modified = &stop;
-				(option_table[10]).to_be_modified = &swing;
+				(option_table[9]).to_be_modified = &statistics;
+				(option_table[10]).to_be_modified = &stop;
+				(option_table[11]).to_be_modified = &swing;
 				return_code=process_multiple_options(state,option_table);
 
 				if(return_code)
@@ -13666,6 +14792,10 @@ DESCRIPTION :
 						{
 							time_keeper_app->stop();
 						}
+						if ( statistics )
+						{
+							time_keeper_app->listStatistics();
+						}
 #if defined (WX_USER_INTERFACE)
 						if (command_data->graphics_window_manager)
 						{
@@ -13770,6 +14900,7 @@ Executes a GFX UPDATE command.
 			/* no errors, not asking for help */
 			if (return_code)
 			{
+				cmzn_command_data_flush_batch_changes(command_data);
 				if (window)
 				{
 					return_code=Graphics_window_update_now(window);
@@ -13804,45 +14935,147 @@ Executes a GFX UPDATE command.
 } /* execute_command_gfx_update */
 #endif /* defined (WX_USER_INTERFACE) */
 
+/**
+ * @return  Pointer to the name of file_name following any directory path, for
+ * naming entries in zip files.
+ */
+static const char *gfx_write_all_get_entry_name(const char *file_name)
+{
+	const char *entry_name = file_name;
+	for (const char *c = file_name; *c; ++c)
+	{
+		if ((*c == '/') || (*c == '\\'))
+			entry_name = c + 1;
+	}
+	return entry_name;
+}
+
+/**
+ * Appends commands defining the fields, spectra, materials and tessellations,
+ * then with scene_region the graphics of its scene and those of all
+ * descendants, then the graphics windows to the temp_file_com.com command file.
+ * Call within a Comfile_capture to get the commands without writing the file
+ * to the current directory.
+ * @return  1 on success, 0 if any commands could not be written.
+ */
+static int gfx_write_definition_commands_to_comfile(
+	struct cmzn_command_data *command_data, cmzn_region_id scene_region)
+{
+	int return_code = 1;
+	struct MANAGER(Computed_field) *computed_field_manager;
+	if (command_data->computed_field_package && (computed_field_manager=
+		Computed_field_package_get_computed_field_manager(
+			command_data->computed_field_package)))
+	{
+		struct LIST(Computed_field) *list_of_fields = CREATE(LIST(Computed_field))();
+		if (list_of_fields)
+		{
+			struct List_Computed_field_commands_data list_commands_data;
+			list_commands_data.command_prefix = "gfx define field ";
+			list_commands_data.listed_fields = 0;
+			list_commands_data.computed_field_list = list_of_fields;
+			list_commands_data.computed_field_manager = computed_field_manager;
+			while (FOR_EACH_OBJECT_IN_MANAGER(Computed_field)(
+				write_Computed_field_commands_if_managed_source_fields_in_list_to_comfile,
+				(void *)&list_commands_data, computed_field_manager) &&
+				(0 != list_commands_data.listed_fields))
+			{
+				list_commands_data.listed_fields = 0;
+			}
+			DESTROY(LIST(Computed_field))(&list_of_fields);
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE,
+				"gfx_write_definition_commands_to_comfile.  Could not list field commands");
+			return_code = 0;
+		}
+	}
+	if (command_data->spectrum_manager)
+	{
+		FOR_EACH_OBJECT_IN_MANAGER(cmzn_spectrum)(
+			for_each_spectrum_list_or_write_commands, (void *)"true", command_data->spectrum_manager);
+	}
+	struct MANAGER(cmzn_material) *graphical_material_manager =
+		cmzn_materialmodule_get_manager(command_data->materialmodule);
+	if (graphical_material_manager)
+	{
+		FOR_EACH_OBJECT_IN_MANAGER(cmzn_material)(
+			write_Graphical_material_commands_to_comfile, (void *)"gfx create material ",
+			graphical_material_manager);
+	}
+	/* graphics refer to tessellations by name */
+	if (command_data->tessellationmodule &&
+		(!cmzn_tessellationmodule_write_commands_to_comfile(command_data->tessellationmodule)))
+	{
+		return_code = 0;
+	}
+	if (scene_region)
+	{
+		/* parents first so child scenes can refer to them */
+		std::vector<cmzn_region_id> regions(1, cmzn_region_access(scene_region));
+		for (size_t r = 0; r < regions.size(); ++r)
+		{
+			cmzn_region_id child = cmzn_region_get_first_child(regions[r]);
+			while (child)
+			{
+				regions.push_back(cmzn_region_access(child));
+				cmzn_region_reaccess_next_sibling(&child);
+			}
+			int error = 0;
+			char *region_path = cmzn_region_get_path(regions[r]);
+			make_valid_token(&region_path);
+			char *command_prefix = duplicate_string("gfx modify g_element ");
+			append_string(&command_prefix, region_path, &error);
+			append_string(&command_prefix, " ", &error);
+			cmzn_scene_id scene = cmzn_region_get_scene(regions[r]);
+			if (!cmzn_scene_write_commands_to_comfile(scene, command_prefix, /*command_suffix*/";"))
+				return_code = 0;
+			cmzn_scene_destroy(&scene);
+			DEALLOCATE(command_prefix);
+			DEALLOCATE(region_path);
+		}
+		for (size_t r = 0; r < regions.size(); ++r)
+			cmzn_region_destroy(&(regions[r]));
+	}
+#if defined (USE_CMGUI_GRAPHICS_WINDOW)
+	if (!FOR_EACH_OBJECT_IN_MANAGER(Graphics_window)(
+		write_Graphics_window_commands_to_comfile,(void *)NULL,
+		command_data->graphics_window_manager))
+	{
+		return_code = 0;
+	}
+#endif /*defined (USE_CMGUI_GRAPHICS_WINDOW)*/
+	return (return_code);
+}
+
 static int gfx_write_all(struct Parse_state *state,
 	 void *dummy_to_be_modified,void *command_data_void)
 /*******************************************************************************
-LAST MODIFIED : 3 August 2007
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
 If an zip file is not specified a file selection box is presented to the
 user, otherwise files are written.
 Can also write individual groups with the <group> option.
+Each region is exported to memory and compressed into the zip file on a worker
+thread while the next region is exported. Commands are captured in memory so
+no temporary files are written.
 ==============================================================================*/
 {
 	 FILE *com_file;
 	 char *com_file_name, *exfile_name, *file_name;
 	 enum FE_write_criterion write_criterion;
 	 enum FE_write_recursion write_recursion;
-	 int exfile_return_code, return_code, exfile_fd, com_return_code;
+	 int exfile_return_code, return_code, com_return_code;
 	 struct cmzn_command_data *command_data;
 	 struct Option_table *option_table;
-	 struct MANAGER(cmzn_material) *graphical_material_manager;
-	 struct MANAGER(Computed_field) *computed_field_manager;
-	 struct LIST(Computed_field) *list_of_fields;
-	 struct List_Computed_field_commands_data list_commands_data;
-	 static const char	*command_prefix;
 	 FE_value time;
-#if defined (WX_USER_INTERFACE)
-#if defined (WIN32_SYSTEM)
-	 char temp_exfile[L_tmpnam];
-#else /* (WIN32_SYSTEM) */
-	 char temp_exfile[] = "regionXXXXXX";
-#endif /* (WIN32_SYSTEM) */
-#else /* (WX_USER_INTERFACE) */
-	 char *temp_exfile = NULL;
-#endif /* (WX_USER_INTERFACE) */
 
 	 ENTER(gfx_write_all);
 	 USE_PARAMETER(dummy_to_be_modified);
 	 if (state && (command_data=(struct cmzn_command_data *)command_data_void))
 	 {
-			exfile_fd = 1;
 			exfile_return_code = 1;
 			com_return_code = 1;
 			return_code = 1;
@@ -13989,137 +15222,150 @@ Can also write individual groups with the <group> option.
 				{
 					exfile_return_code = check_suffix(&exfile_name,".exregion");
 				}
+				/* zip file is named from file_name or "temp" with the wx user interface */
 #if defined (WX_USER_INTERFACE)
-#if defined (WIN32_SYSTEM)
-				 /* 	Non MS-windows platform does not have mkstemp implemented,
-						therefore tmpnam is used.*/
-				 if (exfile_return_code)
-				 {
-						tmpnam(temp_exfile);
-						if (temp_exfile == NULL)
+				const bool write_zip = (0 != exfile_name);
+#else /* defined (WX_USER_INTERFACE) */
+				const bool write_zip = (0 != file_name);
+#endif /* defined (WX_USER_INTERFACE) */
+				Zip_writer *zip_writer = 0;
+				if (write_zip && (exfile_return_code || com_return_code))
+				{
+					std::string zip_file_name(file_name ? file_name : "temp");
+					zip_file_name += ".zip";
+					zip_writer = new Zip_writer(zip_file_name.c_str());
+					if (!zip_writer->open())
+					{
+						exfile_return_code = 0;
+						com_return_code = 0;
+						return_code = 0;
+					}
+				}
+				if (exfile_return_code)
+				{
+					cmzn_streaminformation_region_recursion_mode recursion_mode = CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_ON;
+					if (write_recursion == FE_WRITE_NON_RECURSIVE)
+						recursion_mode = CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_OFF;
+					const int write_elements = CMZN_FIELD_DOMAIN_TYPE_MESH1D|CMZN_FIELD_DOMAIN_TYPE_MESH2D|
+						CMZN_FIELD_DOMAIN_TYPE_MESH3D|CMZN_FIELD_DOMAIN_TYPE_MESH_HIGHEST_DIMENSION;
+					if (zip_writer)
+					{
+						/* Each region is exported on its own, parents before children as in
+						 * a recursive write, and compressed on the zip writer's thread while
+						 * the next region is exported, so at most two regions' EX text is
+						 * held in memory. A group is exported as a single chunk. */
+						const bool chunk_regions = (0 == group_name) &&
+							(CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_ON == recursion_mode);
+						std::vector<cmzn_region_id> regions_to_write(1, cmzn_region_access(region));
+						cmzn_streamresource_memory_id previous_memory = 0;
+						exfile_return_code = zip_writer->beginEntry(gfx_write_all_get_entry_name(exfile_name));
+						while (exfile_return_code && (!regions_to_write.empty()))
 						{
-							 exfile_fd = -1;
+							cmzn_region_id write_region = regions_to_write.back();
+							regions_to_write.pop_back();
+							if (chunk_regions)
+							{
+								std::vector<cmzn_region_id> children;
+								cmzn_region_id child = cmzn_region_get_first_child(write_region);
+								while (child)
+								{
+									children.push_back(cmzn_region_access(child));
+									cmzn_region_reaccess_next_sibling(&child);
+								}
+								regions_to_write.insert(regions_to_write.end(), children.rbegin(), children.rend());
+							}
+							cmzn_streamresource_memory_id memory = export_region_to_memory(write_region,
+								group_name, root_region, write_elements, /*write_nodes*/1, /*write_data*/1,
+								field_names.number_of_strings, field_names.strings, time,
+								chunk_regions ? CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_OFF : recursion_mode,
+								/*isFieldML*/0);
+							cmzn_region_destroy(&write_region);
+							const void *buffer = 0;
+							unsigned int buffer_length = 0;
+							exfile_return_code = memory &&
+								(CMZN_OK == cmzn_streamresource_memory_get_buffer(memory, &buffer, &buffer_length)) &&
+								zip_writer->writeEntryData(buffer, buffer_length);
+							/* writeEntryData has finished with the previous chunk */
+							if (previous_memory)
+								cmzn_streamresource_memory_destroy(&previous_memory);
+							previous_memory = memory;
 						}
-				 }
-#else
-				 /* Non MS-windows platform has mkstemp implemented into it*/
-				 if (exfile_return_code)
-				 {
-					 exfile_fd = mkstemp((char *)temp_exfile);
-				 }
-#endif /* (WIN32_SYSTEM) */
-#else /* (WX_USER_INTERFACE) */
-				 /* Non wx_user_interface won't be able to stored the file in
-						a zip file at the moment */
-				 if (exfile_return_code)
-				 {
-					 temp_exfile = exfile_name;
-				 }
-#endif /* (WX_USER_INTERFACE) */
-				 if (exfile_fd == -1)
-				 {
+						if (!zip_writer->endEntry())
+							exfile_return_code = 0;
+						if (previous_memory)
+							cmzn_streamresource_memory_destroy(&previous_memory);
+						for (size_t r = 0; r < regions_to_write.size(); ++r)
+							cmzn_region_destroy(&(regions_to_write[r]));
+					}
+					else
+					{
+						exfile_return_code = export_region_file_of_name(exfile_name,
+							region, group_name, root_region, write_elements,
+							/*write_nodes*/1, /*write_data*/1,
+							field_names.number_of_strings, field_names.strings,
+							time, recursion_mode, /*isFieldML*/0);
+					}
+					if (!exfile_return_code)
+					{
 						display_message(ERROR_MESSAGE,
-							 "gfx_write_all.  Could not open temporary exregion file");
-				 }
-				 else
-				 {
-					 cmzn_streaminformation_region_recursion_mode recursion_mode = CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_ON;
-					 if (write_recursion == FE_WRITE_NON_RECURSIVE)
-						 recursion_mode = CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_OFF;
-					 if (!(exfile_return_code = export_region_file_of_name(temp_exfile,
-						 region, group_name, root_region,
-						 /*write_elements*/CMZN_FIELD_DOMAIN_TYPE_MESH1D|CMZN_FIELD_DOMAIN_TYPE_MESH2D|
-						 CMZN_FIELD_DOMAIN_TYPE_MESH3D|CMZN_FIELD_DOMAIN_TYPE_MESH_HIGHEST_DIMENSION,
-						 /*write_nodes*/1, /*write_data*/1,
-						 field_names.number_of_strings, field_names.strings,
-						 time, recursion_mode,/*isFieldML*/0)))
-					 {
-						 display_message(ERROR_MESSAGE,
-							 "gfx_write_all.  Could not create temporary data file");
-					 }
-				 }
-				 if (com_return_code)
-				 {
-						if (NULL != (com_file = fopen("temp_file_com.com", "w")))
+							"gfx_write_all.  Could not write region data");
+					}
+				}
+				if (com_return_code)
+				{
+					/* commands are captured in memory, not in the current directory */
+					std::string commands;
+					if (exfile_name)
+					{
+						commands = "gfx read nodes ";
+						commands += exfile_name;
+						commands += "\n";
+					}
+					Comfile_capture comfile_capture;
+					std::string definition_commands;
+					com_return_code = comfile_capture.begin();
+					if (com_return_code)
+					{
+						return_code = gfx_write_definition_commands_to_comfile(command_data, /*scene_region*/0);
+						com_return_code = comfile_capture.end(definition_commands);
+					}
+					commands += definition_commands;
+					if (!com_return_code)
+					{
+						return_code = 0;
+					}
+					else if (zip_writer)
+					{
+						zip_writer->addEntry(gfx_write_all_get_entry_name(com_file_name),
+							commands.data(), commands.size());
+					}
+					else
+					{
+						bool com_file_written = false;
+						if (NULL != (com_file = fopen(com_file_name, "w")))
 						{
-							 if (exfile_name)
-							 {
-									fprintf(com_file, "gfx read nodes %s\n",exfile_name);
-							 }
-							 fclose(com_file);
-							 if (command_data->computed_field_package && (computed_field_manager=
-										 Computed_field_package_get_computed_field_manager(
-												command_data->computed_field_package)))
-							 {
-									if (NULL != (list_of_fields = CREATE(LIST(Computed_field))()))
-									{
-										 command_prefix="gfx define field ";
-										 list_commands_data.command_prefix = command_prefix;
-										 list_commands_data.listed_fields = 0;
-										 list_commands_data.computed_field_list = list_of_fields;
-										 list_commands_data.computed_field_manager =
-												computed_field_manager;
-										 while (FOR_EACH_OBJECT_IN_MANAGER(Computed_field)(
-															 write_Computed_field_commands_if_managed_source_fields_in_list_to_comfile,
-															 (void *)&list_commands_data, computed_field_manager) &&
-												(0 != list_commands_data.listed_fields))
-										 {
-												list_commands_data.listed_fields = 0;
-										 }
-										 DESTROY(LIST(Computed_field))(&list_of_fields);
-									}
-									else
-									{
-										 return_code=0;
-									}
-									if (!return_code)
-									{
-										 display_message(ERROR_MESSAGE,
-												"gfx_write_all.  Could not list field commands");
-									}
-							 }
-
-							 if (command_data->spectrum_manager)
-							 {
-									FOR_EACH_OBJECT_IN_MANAGER(cmzn_spectrum)(
-										 for_each_spectrum_list_or_write_commands, (void *)"true", command_data->spectrum_manager);
-							 }
-							 if (NULL != (graphical_material_manager =
-									cmzn_materialmodule_get_manager(command_data->materialmodule)))
-							 {
-									command_prefix="gfx create material ";
-									return_code=FOR_EACH_OBJECT_IN_MANAGER(cmzn_material)(
-										 write_Graphical_material_commands_to_comfile,(void *)command_prefix,
-										 graphical_material_manager);
-							 }
-							 return_code =1;
-#if defined (USE_CMGUI_GRAPHICS_WINDOW)
-							 return_code=FOR_EACH_OBJECT_IN_MANAGER(Graphics_window)(
-									write_Graphics_window_commands_to_comfile,(void *)NULL,
-									command_data->graphics_window_manager);
-#endif /*defined (USE_CMGUI_GRAPHICS_WINDOW)*/
-							 rename("temp_file_com.com", com_file_name);
+							com_file_written = (commands.size() ==
+								fwrite(commands.data(), 1, commands.size(), com_file));
+							if (0 != fclose(com_file))
+								com_file_written = false;
 						}
-				 }
-#if defined (WX_USER_INTERFACE)
-				 if (exfile_name)
-				 {
-						filedir_compressing_process_wx_compress(com_file_name, exfile_name,
-							 exfile_return_code, file_name, temp_exfile);
-				 }
-#if !defined (WIN32_SYSTEM)
-				 if (unlink(temp_exfile) == -1)
-				 {
-						display_message(ERROR_MESSAGE,
-							 "gfx_write_all.  Could not unlink temporary exregion file");
-				 }
-				 if (unlink(com_file_name) == -1)
-				 {
-						display_message(ERROR_MESSAGE,
-							 "compressing_process_wx_compress.  Could not unlink temporary com file");
-				 }
-#endif /*!definde (WIN32_SYSTEM)*/
-#endif /* defined (WX_USER_INTERFACE) */
+						if (!com_file_written)
+						{
+							display_message(ERROR_MESSAGE,
+								"gfx_write_all.  Could not write com file %s", com_file_name);
+							return_code = 0;
+						}
+					}
+				}
+				if (zip_writer)
+				{
+					if (!zip_writer->finish())
+					{
+						display_message(ERROR_MESSAGE, "gfx_write_all.  Could not write zip file");
+						return_code = 0;
+					}
+					delete zip_writer;
+				}
 				 if (com_file_name)
 				 {
 						DEALLOCATE(com_file_name);
@@ -14481,18 +15727,42 @@ static int gfx_write_region(struct Parse_state *state,
 		char *region_or_group_path = 0;
 		Multiple_strings field_names;
 		char *file_name = 0;
+		char *format_name = 0;
+		char compress_flag = 0;
 		cmzn_region_id region = cmzn_region_access(root_region);
 		option_table = CREATE(Option_table)();
 		Option_table_add_help(option_table,
-			"Export fields of the specified region into FieldML format. "
+			"Export fields of the specified region into FieldML format, or with "
+			"'format binary' into the cmgui binary region format, optionally with "
+			"compressed blocks. "
 			"Only the specified region will be exported, child regions will not.");
+		/* compress */
+		Option_table_add_char_flag_entry(option_table, "compress", &compress_flag);
+		/* format */
+		Option_table_add_string_entry(option_table, "format", &format_name,
+			" binary|fieldml");
 		Option_table_add_set_cmzn_region(option_table, "region", root_region, &region);
 		/* default option: file name */
 		Option_table_add_default_string_entry(option_table, &file_name, "FILE_NAME");
 
 		if (0 != (return_code = Option_table_multi_parse(option_table, state)))
 		{
-			if (!file_name)
+			bool binary_format = false;
+			if (format_name)
+			{
+				if (fuzzy_string_compare(format_name, "binary"))
+				{
+					binary_format = true;
+					file_ext = REGION_BINARY_FILE_EXTENSION;
+				}
+				else if (!fuzzy_string_compare(format_name, "fieldml"))
+				{
+					display_message(ERROR_MESSAGE,
+						"gfx write region:  Unknown format '%s'", format_name);
+					return_code = 0;
+				}
+			}
+			if (return_code && (!file_name))
 			{
 				if (!(file_name = confirmation_get_write_filename(file_ext,
 					command_data->user_interface
@@ -14510,7 +15780,11 @@ static int gfx_write_region(struct Parse_state *state,
 				CMZN_set_directory_and_filename_WIN32(&file_name, command_data);
 			}
 #endif /* defined (WX_USER_INTERFACE) && (WIN32_SYSTEM) */
-			if (return_code)
+			if (return_code && binary_format)
+			{
+				return_code = write_region_binary_file(region, file_name, compress_flag);
+			}
+			else if (return_code)
 			{
 				cmzn_streaminformation_id streaminformation = cmzn_region_create_streaminformation_region(region);
 				cmzn_streamresource_id resource =
@@ -14528,6 +15802,8 @@ static int gfx_write_region(struct Parse_state *state,
 		DESTROY(Option_table)(&option_table);
 		if (file_name)
 			DEALLOCATE(file_name);
+		if (format_name)
+			DEALLOCATE(format_name);
 		cmzn_region_destroy(&root_region);
 		cmzn_region_destroy(&region);
 	}
@@ -14540,6 +15816,96 @@ static int gfx_write_region(struct Parse_state *state,
 	return (return_code);
 } /* gfx_write_nodes */
 
+/***************************************************************************//**
+ * Executes a GFX WRITE SNAPSHOT command. Writes the root region and all its
+ * descendants in binary region format with the commands recreating fields,
+ * materials, spectra, graphics and windows to one file, for fast restore with
+ * gfx read snapshot.
+ */
+static int gfx_write_snapshot(struct Parse_state *state,
+	void *dummy, void *command_data_void)
+{
+	int return_code = 0;
+	USE_PARAMETER(dummy);
+	cmzn_command_data *command_data = reinterpret_cast<cmzn_command_data*>(command_data_void);
+	if (state && command_data)
+	{
+		char *file_name = 0;
+		char compress_flag = 0;
+		struct Option_table *option_table = CREATE(Option_table)();
+		Option_table_add_help(option_table,
+			"Save the whole session for fast restore with 'gfx read snapshot': all "
+			"regions in binary region format, optionally with compressed blocks, "
+			"and the commands recreating fields, materials, spectra, graphics and "
+			"windows. Regions with time varying nodal parameters are stored as EX "
+			"text instead. Files are only readable on machines with the same byte order.");
+		/* compress */
+		Option_table_add_char_flag_entry(option_table, "compress", &compress_flag);
+		/* default option: file name */
+		Option_table_add_default_string_entry(option_table, &file_name, "FILE_NAME");
+		return_code = Option_table_multi_parse(option_table, state);
+		DESTROY(Option_table)(&option_table);
+		if (return_code && (!file_name))
+		{
+			if (!(file_name = confirmation_get_write_filename(REGION_SNAPSHOT_FILE_EXTENSION,
+				command_data->user_interface
+#if defined(WX_USER_INTERFACE)
+				, command_data->execute_command
+#endif /*defined (WX_USER_INTERFACE) */
+				)))
+			{
+				return_code = 0;
+			}
+		}
+#if defined (WX_USER_INTERFACE) && defined (WIN32_SYSTEM)
+		if (file_name)
+		{
+			CMZN_set_directory_and_filename_WIN32(&file_name, command_data);
+		}
+#endif /* defined (WX_USER_INTERFACE) && (WIN32_SYSTEM) */
+		if (return_code)
+		{
+			const double start_time = get_elapsed_time_seconds();
+			/* commands are captured in memory with the same writers as gfx write all */
+			std::string commands;
+			Comfile_capture comfile_capture;
+			return_code = comfile_capture.begin();
+			if (return_code)
+			{
+				return_code = gfx_write_definition_commands_to_comfile(command_data,
+					command_data->root_region);
+				if (!comfile_capture.end(commands))
+					return_code = 0;
+			}
+			const double regions_start_time = get_elapsed_time_seconds();
+			if (return_code)
+			{
+				return_code = write_region_snapshot_file(command_data->root_region,
+					commands.c_str(), commands.size(), compress_flag, file_name);
+			}
+			const double end_time = get_elapsed_time_seconds();
+			if (return_code)
+			{
+				display_message(INFORMATION_MESSAGE,
+					"Wrote snapshot in %g seconds (commands %g, regions %g)\n",
+					end_time - start_time, regions_start_time - start_time,
+					end_time - regions_start_time);
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE, "gfx write snapshot:  Could not write %s", file_name);
+			}
+		}
+		if (file_name)
+			DEALLOCATE(file_name);
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "gfx_write_snapshot.  Invalid argument(s)");
+	}
+	return return_code;
+}
+
 static int gfx_write_nodes(struct Parse_state *state,
 	void *use_data, void *command_data_void)
 /*******************************************************************************
@@ -15008,6 +16374,8 @@ Executes a GFX WRITE command.
 				command_data_void, gfx_write_nodes);
 			Option_table_add_entry(option_table, "region", 0,
 				command_data_void, gfx_write_region);
+			Option_table_add_entry(option_table, "snapshot", 0,
+				command_data_void, gfx_write_snapshot);
 			Option_table_add_entry(option_table, "texture", NULL,
 				command_data_void, gfx_write_texture);
 			return_code = Option_table_parse(option_table, state);
@@ -15030,106 +16398,120 @@ Executes a GFX WRITE command.
 	return (return_code);
 } /* execute_command_gfx_write */
 
-static int execute_command_gfx(struct Parse_state *state,
-	void *dummy_to_be_modified,void *command_data_void)
-/*******************************************************************************
-LAST MODIFIED : 6 March 2003
-
-DESCRIPTION :
-Executes a GFX command.
-==============================================================================*/
+/***************************************************************************//**
+ * Returns the option table for GFX commands, building and compiling it on first
+ * call. Owned by <command_data>; do not destroy.
+ */
+static struct Option_table *cmzn_command_data_get_gfx_option_table(
+	struct cmzn_command_data *command_data)
 {
-	int return_code;
-	struct Option_table *option_table;
-	struct cmzn_command_data *command_data;
-
-	ENTER(execute_command_gfx);
-	USE_PARAMETER(dummy_to_be_modified);
-	if (state && (command_data = (struct cmzn_command_data *)command_data_void))
+	if (!command_data->gfx_option_table)
 	{
-		if (state->current_token)
-		{
-			option_table=CREATE(Option_table)();
-			Option_table_add_entry(option_table, "change_identifier", NULL,
-				command_data_void, gfx_change_identifier);
-			Option_table_add_entry(option_table, "convert", NULL,
-				command_data_void, gfx_convert);
-			Option_table_add_entry(option_table, "create", NULL,
-				command_data_void, execute_command_gfx_create);
+		struct Option_table *option_table = CREATE(Option_table)();
+		Option_table_add_entry(option_table, "change_identifier", NULL,
+			(void *)command_data, gfx_change_identifier);
+		Option_table_add_entry(option_table, "convert", NULL,
+			(void *)command_data, gfx_convert);
+		Option_table_add_entry(option_table, "create", NULL,
+			(void *)command_data, execute_command_gfx_create);
 #if defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (WX_USER_INTERFACE)
-			Option_table_add_entry(option_table, "data_tool", /*data_tool*/(void *)1,
-			   command_data_void, execute_command_gfx_node_tool);
+		Option_table_add_entry(option_table, "data_tool", /*data_tool*/(void *)1,
+		   (void *)command_data, execute_command_gfx_node_tool);
 #endif /* defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (WX_USER_INTERFACE)*/
-			Option_table_add_entry(option_table, "define", NULL,
-				command_data_void, execute_command_gfx_define);
-			Option_table_add_entry(option_table, "destroy", NULL,
-				command_data_void, execute_command_gfx_destroy);
-			Option_table_add_entry(option_table, "draw", NULL,
-				command_data_void, execute_command_gfx_draw);
-			Option_table_add_entry(option_table, "edit", NULL,
-				command_data_void, execute_command_gfx_edit);
+		Option_table_add_entry(option_table, "define", NULL,
+			(void *)command_data, execute_command_gfx_define);
+		Option_table_add_entry(option_table, "destroy", NULL,
+			(void *)command_data, execute_command_gfx_destroy);
+		Option_table_add_entry(option_table, "draw", NULL,
+			(void *)command_data, execute_command_gfx_draw);
+		Option_table_add_entry(option_table, "edit", NULL,
+			(void *)command_data, execute_command_gfx_edit);
 #if defined (WX_USER_INTERFACE)
-			Option_table_add_entry(option_table, "element_creator", NULL,
-				command_data_void, execute_command_gfx_element_creator);
+		Option_table_add_entry(option_table, "element_creator", NULL,
+			(void *)command_data, execute_command_gfx_element_creator);
 #endif /* defined (WX_USER_INTERFACE) */
 #if defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (CARBON_USER_INTERFACE) || defined (WX_USER_INTERFACE)
-			Option_table_add_entry(option_table, "element_point_tool", NULL,
-				command_data_void, execute_command_gfx_element_point_tool);
+		Option_table_add_entry(option_table, "element_point_tool", NULL,
+			(void *)command_data, execute_command_gfx_element_point_tool);
 #endif /* defined (GTK_USER_INTERFACE) || defined	(WIN32_USER_INTERFACE) || defined (CARBON_USER_INTERFACE)  || defined (WX_USER_INTERFACE)*/
 #if defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (CARBON_USER_INTERFACE) || defined (WX_USER_INTERFACE)
-			Option_table_add_entry(option_table, "element_tool", NULL,
-				command_data_void, execute_command_gfx_element_tool);
+		Option_table_add_entry(option_table, "element_tool", NULL,
+			(void *)command_data, execute_command_gfx_element_tool);
 #endif /* defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (CARBON_USER_INTERFACE) || defined (WX_USER_INTERFACE) */
-			Option_table_add_entry(option_table, "evaluate", NULL,
-				command_data_void, gfx_evaluate);
-			Option_table_add_entry(option_table, "export", NULL,
-				command_data_void, execute_command_gfx_export);
+		Option_table_add_entry(option_table, "evaluate", NULL,
+			(void *)command_data, gfx_evaluate);
+		Option_table_add_entry(option_table, "export", NULL,
+			(void *)command_data, execute_command_gfx_export);
 #if defined (USE_OPENCASCADE)
-			Option_table_add_entry(option_table, "import", NULL,
-				command_data_void, execute_command_gfx_import);
+		Option_table_add_entry(option_table, "import", NULL,
+			(void *)command_data, execute_command_gfx_import);
 #endif /* defined (USE_OPENCASCADE) */
-			Option_table_add_entry(option_table, "list", NULL,
-				command_data_void, execute_command_gfx_list);
-			Option_table_add_entry(option_table, "minimise",
-				NULL, (void *)command_data->root_region, gfx_minimise);
-			Option_table_add_entry(option_table, "modify", NULL,
-				command_data_void, execute_command_gfx_modify);
+		Option_table_add_entry(option_table, "list", NULL,
+			(void *)command_data, execute_command_gfx_list);
+		Option_table_add_entry(option_table, "minimise",
+			NULL, (void *)command_data->root_region, gfx_minimise);
+		Option_table_add_entry(option_table, "modify", NULL,
+			(void *)command_data, execute_command_gfx_modify);
 #if defined (SGI_MOVIE_FILE)
-			Option_table_add_entry(option_table, "movie", NULL,
-				command_data_void, gfx_movie);
+		Option_table_add_entry(option_table, "movie", NULL,
+			(void *)command_data, gfx_movie);
 #endif /* defined (SGI_MOVIE_FILE) */
 #if defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (CARBON_USER_INTERFACE) || defined (WX_USER_INTERFACE)
-			Option_table_add_entry(option_table, "node_tool", /*data_tool*/(void *)0,
-				command_data_void, execute_command_gfx_node_tool);
+		Option_table_add_entry(option_table, "node_tool", /*data_tool*/(void *)0,
+			(void *)command_data, execute_command_gfx_node_tool);
 #endif /* defined (GTK_USER_INTERFACE) || defined	(WIN32_USER_INTERFACE) || defined (CARBON_USER_INTERFACE) || defined (WX_USER_INTERFACE) */
 #if defined (GTK_USER_INTERFACE) || defined (WIN32_USER_INTERFACE) || defined (WX_USER_INTERFACE)
-			Option_table_add_entry(option_table, "print", NULL,
-				command_data_void, execute_command_gfx_print);
+		Option_table_add_entry(option_table, "print", NULL,
+			(void *)command_data, execute_command_gfx_print);
 #endif
-			Option_table_add_entry(option_table, "read", NULL,
-				command_data_void, execute_command_gfx_read);
-			Option_table_add_entry(option_table, "select", /*unselect*/0,
-				command_data_void, execute_command_gfx_select);
-			Option_table_add_entry(option_table, "set", NULL,
-				command_data_void, execute_command_gfx_set);
-			Option_table_add_entry(option_table, "mesh", NULL,
-				command_data_void, execute_command_gfx_mesh);
-			Option_table_add_entry(option_table, "smooth", NULL,
-				command_data_void, execute_command_gfx_smooth);
-			Option_table_add_entry(option_table, "timekeeper", NULL,
-				command_data_void, gfx_timekeeper);
-			Option_table_add_entry(option_table, "transform_tool", NULL,
-				command_data_void, gfx_transform_tool);
-			Option_table_add_entry(option_table, "unselect", /*unselect*/reinterpret_cast<void *>(1),
-				command_data_void, execute_command_gfx_select);
+		Option_table_add_entry(option_table, "read", NULL,
+			(void *)command_data, execute_command_gfx_read);
+		Option_table_add_entry(option_table, "select", /*unselect*/0,
+			(void *)command_data, execute_command_gfx_select);
+		Option_table_add_entry(option_table, "set", NULL,
+			(void *)command_data, execute_command_gfx_set);
+		Option_table_add_entry(option_table, "mesh", NULL,
+			(void *)command_data, execute_command_gfx_mesh);
+		Option_table_add_entry(option_table, "smooth", NULL,
+			(void *)command_data, execute_command_gfx_smooth);
+		Option_table_add_entry(option_table, "timekeeper", NULL,
+			(void *)command_data, gfx_timekeeper);
+		Option_table_add_entry(option_table, "transform_tool", NULL,
+			(void *)command_data, gfx_transform_tool);
+		Option_table_add_entry(option_table, "unselect", /*unselect*/reinterpret_cast<void *>(1),
+			(void *)command_data, execute_command_gfx_select);
 #if defined (WX_USER_INTERFACE)
-			Option_table_add_entry(option_table, "update", NULL,
-				command_data_void, execute_command_gfx_update);
+		Option_table_add_entry(option_table, "update", NULL,
+			(void *)command_data, execute_command_gfx_update);
 #endif /* defined (WX_USER_INTERFACE) */
-			Option_table_add_entry(option_table, "write", NULL,
-				command_data_void, execute_command_gfx_write);
-			return_code = Option_table_parse(option_table, state);
-			DESTROY(Option_table)(&option_table);
+		Option_table_add_entry(option_table, "write", NULL,
+			(void *)command_data, execute_command_gfx_write);
+		Option_table_compile(option_table);
+		command_data->gfx_option_table = option_table;
+	}
+	return command_data->gfx_option_table;
+}
+
+static int execute_command_gfx(struct Parse_state *state,
+	void *dummy_to_be_modified,void *command_data_void)
+/*******************************************************************************
+LAST MODIFIED : 6 March 2003
+
+DESCRIPTION :
+Executes a GFX command.
+==============================================================================*/
+{
+	int return_code;
+	struct cmzn_command_data *command_data;
+
+	ENTER(execute_command_gfx);
+	USE_PARAMETER(dummy_to_be_modified);
+	if (state && (command_data = (struct cmzn_command_data *)command_data_void))
+	{
+		if (state->current_token)
+		{
+			return_code = Option_table_parse(
+				cmzn_command_data_get_gfx_option_table(command_data), state);
 		}
 		else
 		{
@@ -15242,6 +16624,7 @@ Executes a READ command.
 				option_table = CREATE(Option_table)();
 				/* comfile */
 				open_comfile_data.file_name=(char *)NULL;
+				open_comfile_data.batch_flag=0;
 				open_comfile_data.example_flag=0;
 				open_comfile_data.execute_count=1;
 				open_comfile_data.examples_directory=command_data->example_directory;
@@ -15420,6 +16803,7 @@ Executes a OPEN command.
 				option_table = CREATE(Option_table)();
 				/* comfile */
 				open_comfile_data.file_name=(char *)NULL;
+				open_comfile_data.batch_flag=0;
 				open_comfile_data.example_flag=0;
 				open_comfile_data.execute_count=0;
 				open_comfile_data.examples_directory=command_data->example_directory;
@@ -15785,6 +17169,74 @@ Executes a SET DIR #CMGUI_EXAMPLE_DIRECTORY_SYMBOL command.
 	return (return_code);
 } /* execute_command_system */
 
+#if defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE) || defined (WX_USER_INTERFACE)
+/***************************************************************************//**
+ * Executes a COMMAND_WINDOW command with the command window current at the time
+ * of the command, since the persistent top level option table may be built
+ * before the command window is created.
+ */
+static int execute_command_command_window(struct Parse_state *state,
+	void *dummy_to_be_modified, void *command_data_void)
+{
+	struct cmzn_command_data *command_data =
+		static_cast<struct cmzn_command_data *>(command_data_void);
+	return modify_Command_window(state, dummy_to_be_modified,
+		(void *)command_data->command_window);
+}
+#endif /* defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE) || defined (WX_USER_INTERFACE) */
+
+/***************************************************************************//**
+ * Returns the option table for top level commands, building and compiling it on
+ * first call. Owned by <command_data>; do not destroy.
+ */
+static struct Option_table *cmzn_command_data_get_command_option_table(
+	struct cmzn_command_data *command_data)
+{
+	if (!command_data->command_option_table)
+	{
+		struct Option_table *option_table = CREATE(Option_table)();
+#if defined (SELECT_DESCRIPTORS)
+		/* attach */
+		Option_table_add_entry(option_table, "attach", NULL, (void *)command_data,
+			execute_command_attach);
+#endif /* !defined (SELECT_DESCRIPTORS) */
+#if defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE) || defined (WX_USER_INTERFACE)
+		/* command_window */
+		Option_table_add_entry(option_table, "command_window", NULL, (void *)command_data,
+			execute_command_command_window);
+#endif /* defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE) || defined (WX_USER_INTERFACE) */
+#if defined (SELECT_DESCRIPTORS)
+		/* detach */
+		Option_table_add_entry(option_table, "detach", NULL, (void *)command_data,
+			execute_command_detach);
+#endif /* !defined (SELECT_DESCRIPTORS) */
+		/* gfx */
+		Option_table_add_entry(option_table, "gfx", NULL, (void *)command_data,
+			execute_command_gfx);
+		/* open */
+		Option_table_add_entry(option_table, "open", NULL, (void *)command_data,
+			execute_command_open);
+		/* quit */
+		Option_table_add_entry(option_table, "quit", NULL, (void *)command_data,
+			execute_command_quit);
+		/* list_memory */
+		Option_table_add_entry(option_table, "list_memory", NULL, NULL,
+			execute_command_list_memory);
+		/* read */
+		Option_table_add_entry(option_table, "read", NULL, (void *)command_data,
+			execute_command_read);
+		/* set */
+		Option_table_add_entry(option_table, "set", NULL, (void *)command_data,
+			execute_command_set);
+		/* system */
+		Option_table_add_entry(option_table, "system", NULL, (void *)command_data,
+			execute_command_system);
+		Option_table_compile(option_table);
+		command_data->command_option_table = option_table;
+	}
+	return command_data->command_option_table;
+}
+
 /*
 Global functions
 ----------------
@@ -15801,7 +17253,6 @@ DESCRIPTION:
 	char **token;
 	int i,return_code = 1;
 	struct cmzn_command_data *command_data;
-	struct Option_table *option_table;
 	struct Parse_state *state;
 
 	ENTER(execute_command);
@@ -15830,45 +17281,8 @@ DESCRIPTION:
 				}
 				else
 				{
-					option_table = CREATE(Option_table)();
-#if defined (SELECT_DESCRIPTORS)
-					/* attach */
-					Option_table_add_entry(option_table, "attach", NULL, command_data_void,
-						execute_command_attach);
-#endif /* !defined (SELECT_DESCRIPTORS) */
-#if defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE)
-					/* command_window */
-					Option_table_add_entry(option_table, "command_window", NULL, command_data->command_window,
-						modify_Command_window);
-#endif /* defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE) */
-#if defined (SELECT_DESCRIPTORS)
-					/* detach */
-					Option_table_add_entry(option_table, "detach", NULL, command_data_void,
-						execute_command_detach);
-#endif /* !defined (SELECT_DESCRIPTORS) */
-					/* gfx */
-					Option_table_add_entry(option_table, "gfx", NULL, command_data_void,
-						execute_command_gfx);
-					/* open */
-					Option_table_add_entry(option_table, "open", NULL, command_data_void,
-						execute_command_open);
-					/* quit */
-					Option_table_add_entry(option_table, "quit", NULL, command_data_void,
-						execute_command_quit);
-					/* list_memory */
-					Option_table_add_entry(option_table, "list_memory", NULL, NULL,
-						execute_command_list_memory);
-					/* read */
-					Option_table_add_entry(option_table, "read", NULL, command_data_void,
-						execute_command_read);
-					/* set */
-					Option_table_add_entry(option_table, "set", NULL, command_data_void,
-						execute_command_set);
-					/* system */
-					Option_table_add_entry(option_table, "system", NULL, command_data_void,
-						execute_command_system);
-					return_code=Option_table_parse(option_table, state);
-					DESTROY(Option_table)(&option_table);
+					return_code=Option_table_parse(
+						cmzn_command_data_get_command_option_table(command_data), state);
 				}
 				// Catching case where a fail returned code is returned but we are
 				// asking for help, reseting the return code to pass if this is the case.
@@ -15962,7 +17376,6 @@ Execute a <command_string>. If there is a command
 	char **token;
 	int i,return_code = 0;
 	struct cmzn_command_data *command_data;
-	struct Option_table *option_table;
 	struct Parse_state *state;
 
 	ENTER(cmiss_execute_command);
@@ -15998,45 +17411,8 @@ Execute a <command_string>. If there is a command
 				}
 				else
 				{
-					option_table = CREATE(Option_table)();
-#if defined (SELECT_DESCRIPTORS)
-					/* attach */
-					Option_table_add_entry(option_table, "attach", NULL, command_data_void,
-						execute_command_attach);
-#endif /* !defined (SELECT_DESCRIPTORS) */
-#if defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE)
-					/* command_window */
-					Option_table_add_entry(option_table, "command_window", NULL, command_data->command_window,
-						modify_Command_window);
-#endif /* defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE) */
-#if defined (SELECT_DESCRIPTORS)
-					/* detach */
-					Option_table_add_entry(option_table, "detach", NULL, command_data_void,
-						execute_command_detach);
-#endif /* !defined (SELECT_DESCRIPTORS) */
-					/* gfx */
-					Option_table_add_entry(option_table, "gfx", NULL, command_data_void,
-						execute_command_gfx);
-					/* open */
-					Option_table_add_entry(option_table, "open", NULL, command_data_void,
-						execute_command_open);
-					/* quit */
-					Option_table_add_entry(option_table, "quit", NULL, command_data_void,
-						execute_command_quit);
-					/* list_memory */
-					Option_table_add_entry(option_table, "list_memory", NULL, NULL,
-						execute_command_list_memory);
-					/* read */
-					Option_table_add_entry(option_table, "read", NULL, command_data_void,
-						execute_command_read);
-					/* set */
-					Option_table_add_entry(option_table, "set", NULL, command_data_void,
-						execute_command_set);
-					/* system */
-					Option_table_add_entry(option_table, "system", NULL, command_data_void,
-						execute_command_system);
-					return_code=Option_table_parse(option_table, state);
-					DESTROY(Option_table)(&option_table);
+					return_code=Option_table_parse(
+						cmzn_command_data_get_command_option_table(command_data), state);
 				}
 			}
 #if defined (WIN32_USER_INTERFACE) || defined (GTK_USER_INTERFACE) || defined (WX_USER_INTERFACE)
@@ -16172,12 +17548,13 @@ static void display_command_window_message(cmzn_loggerevent_id event,
 
 static int cmgui_execute_comfile(const char *comfile_name,const char *example_id,
 	const char *examples_directory,const char *example_symbol,char **example_comfile_name,
-	struct Execute_command *execute_command)
+	struct Execute_command *execute_command, int batch_flag)
 /*******************************************************************************
 LAST MODIFIED : 16 October 1998
 
 DESCRIPTION :
-Executes the comfile specified on the command line.
+Executes the comfile specified on the command line. If <batch_flag> is set the
+comfile is executed as a single batch with change messages cached.
 ==============================================================================*/
 {
 	int return_code;
@@ -16217,6 +17594,10 @@ Executes the comfile specified on the command line.
 				strcat(global_temp_string,";");
 				strcat(global_temp_string,example_symbol);
 				strcat(global_temp_string," execute");
+				if (batch_flag)
+				{
+					strcat(global_temp_string," batch");
+				}
 				return_code=Execute_command_execute_string(execute_command,global_temp_string);
 			}
 			else
@@ -16231,6 +17612,10 @@ Executes the comfile specified on the command line.
 			sprintf(global_temp_string,"open comfile ");
 			strcat(global_temp_string,comfile_name);
 			strcat(global_temp_string," execute");
+			if (batch_flag)
+			{
+				strcat(global_temp_string," batch");
+			}
 			return_code=Execute_command_execute_string(execute_command, global_temp_string);
 		}
 	}
@@ -16364,6 +17749,9 @@ Parses command line options from <state>.
 		/* -batch */
 		Option_table_add_entry(option_table, "-batch",
 			&(command_line_options->batch_mode_flag), NULL, set_char_flag);
+		/* -batch_comfile */
+		Option_table_add_entry(option_table, "-batch_comfile",
+			&(command_line_options->batch_comfile_flag), NULL, set_char_flag);
 		/* -cm */
 		Option_table_add_entry(option_table, "-cm",
 			&(command_line_options->cm_start_flag), NULL, set_char_flag);
@@ -16417,6 +17805,10 @@ Parses command line options from <state>.
 		/* -server */
 		Option_table_add_entry(option_table, "-server",
 			&(command_line_options->server_mode_flag), NULL, set_char_flag);
+		/* -server_socket */
+		Option_table_add_entry(option_table, "-server_socket",
+			&(command_line_options->server_socket_name),
+			(void *)" SOCKET_FILE_NAME", set_string);
 #if defined (CARBON_USER_INTERFACE) || (defined (WX_USER_INTERFACE) && defined (DARWIN))
 		/* -psn */
 		Option_table_add_entry(option_table, "-psn", NULL, NULL, ignore_entry);
@@ -16452,6 +17844,7 @@ int cmzn_command_data_process_command_line(int argc, char *argv[],
 
 	/* put command line options into structure for parsing & extract below */
 	command_line_options->batch_mode_flag = (char)0;
+	command_line_options->batch_comfile_flag = (char)0;
 	command_line_options->cm_start_flag = (char)0;
 	command_line_options->cm_epath_directory_name = NULL;
 	command_line_options->cm_parameters_file_name = NULL;
@@ -16466,6 +17859,7 @@ int cmzn_command_data_process_command_line(int argc, char *argv[],
 	command_line_options->no_display_flag = (char)0;
 	command_line_options->random_number_seed = -1;
 	command_line_options->server_mode_flag = (char)0;
+	command_line_options->server_socket_name = NULL;
 	command_line_options->visual_id_number = 0;
 	command_line_options->command_file_name = NULL;
 
@@ -16504,10 +17898,10 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 {
 	char *cm_examples_directory,*cm_parameters_file_name,*comfile_name,
 		*example_id,*examples_directory,*examples_environment,*execute_string,
-		*version_command_id;
+		*server_socket_name,*version_command_id;
 	char global_temp_string[1000];
 	int return_code;
-	int batch_mode, console_mode, command_list, no_display, non_random,
+	int batch_comfile, batch_mode, console_mode, command_list, no_display, non_random,
 		server_mode, start_cm, start_mycm, visual_id, write_help;
 #if defined (F90_INTERPRETER) || defined (USE_PERL_INTERPRETER)
 	int status;
@@ -16537,6 +17931,11 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		command_data->emoter_slider_dialog=(struct Emoter_dialog *)NULL;
 		command_data->logger = 0;
 		command_data->loggerNotifier = 0;
+		command_data->command_option_table = (struct Option_table *)NULL;
+		command_data->gfx_option_table = (struct Option_table *)NULL;
+		command_data->gfx_modify_option_table = (struct Option_table *)NULL;
+		command_data->batch_level = 0;
+		command_data->node_time_series_set = (Node_time_series_set *)NULL;
 #if defined (WX_USER_INTERFACE)
 		command_data->data_viewer=(struct Node_viewer *)NULL;
 		command_data->node_viewer=(struct Node_viewer *)NULL;
@@ -16548,6 +17947,7 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		command_data->spectrum_editor_dialog = (struct Spectrum_editor_dialog *)NULL;
 #endif /*defined (WX_USER_INTERFACE) */
 		command_data->command_console = (struct Console *)NULL;
+		command_data->command_server = (struct Command_server *)NULL;
 		command_data->example_directory=(char *)NULL;
 
 #if defined (WX_USER_INTERFACE)
@@ -16605,6 +18005,7 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 
 		/* set default values for command-line modifiable options */
 		/* Note User_interface will not be created if command_list selected */
+		batch_comfile = 0;
 		batch_mode = 0;
 		command_list = 0;
 		console_mode = 0;
@@ -16632,6 +18033,8 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		version_command_id = (char *)NULL;
 		/* the name of the comfile to be run on startup */
 		comfile_name = (char *)NULL;
+		/* socket for receiving commands from other processes */
+		server_socket_name = (char *)NULL;
 
 		user_settings.examples_directory = (char *)NULL;
 		user_settings.help_directory = (char *)NULL;
@@ -16641,6 +18044,7 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		/* parse commmand line options */
 
 		/* put command line options into structure for parsing & extract below */
+		command_line_options.batch_comfile_flag = (char)batch_comfile;
 		command_line_options.batch_mode_flag = (char)batch_mode;
 		command_line_options.cm_start_flag = (char)start_cm;
 		command_line_options.cm_epath_directory_name = cm_examples_directory;
@@ -16656,6 +18060,7 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		command_line_options.no_display_flag = (char)no_display;
 		command_line_options.random_number_seed = non_random;
 		command_line_options.server_mode_flag = (char)server_mode;
+		command_line_options.server_socket_name = server_socket_name;
 		command_line_options.visual_id_number = visual_id;
 		command_line_options.command_file_name = comfile_name;
 
@@ -16680,6 +18085,7 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 			}
 		}
 		/* copy command line options to local vars for use and easy clean-up */
+		batch_comfile = (int)command_line_options.batch_comfile_flag;
 		batch_mode = (int)command_line_options.batch_mode_flag;
 		start_cm = command_line_options.cm_start_flag;
 		cm_examples_directory = command_line_options.cm_epath_directory_name;
@@ -16695,6 +18101,7 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		no_display = command_line_options.no_display_flag;
 		non_random = command_line_options.random_number_seed;
 		server_mode = (int)command_line_options.server_mode_flag;
+		server_socket_name = command_line_options.server_socket_name;
 		visual_id = command_line_options.visual_id_number;
 		comfile_name = command_line_options.command_file_name;
 		if (write_help)
@@ -17086,6 +18493,8 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		/* properly set up the Execute_command objects */
 		Execute_command_set_command_function(command_data->execute_command,
 			cmiss_execute_command, (void *)command_data);
+		Execute_command_set_batch_functions(command_data->execute_command,
+			cmzn_command_data_begin_batch, cmzn_command_data_end_batch);
 		Execute_command_set_command_function(command_data->set_command,
 			cmiss_set_command, (void *)command_data);
 		/* initialize random number generator */
@@ -17150,6 +18559,19 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 			}
 		}
 
+		if (return_code && (!command_list) && (!write_help) && (!batch_mode) &&
+			server_socket_name)
+		{
+			/* receive commands from other processes, also with -no_display */
+			if (!(command_data->command_server = CREATE(Command_server)(
+				command_data->execute_command, command_data->event_dispatcher,
+				command_data->logger, server_socket_name)))
+			{
+				display_message(ERROR_MESSAGE, "main.  "
+					"Unable to create command server on socket '%s'.", server_socket_name);
+			}
+		}
+
 		if (return_code && (!command_list) && (!write_help))
 		{
 			if (start_cm||start_mycm)
@@ -17177,7 +18599,8 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 			{
 				/* Can't get the startupComfile name without X at the moment */
 				cmgui_execute_comfile(user_settings.startup_comfile, NULL,
-					NULL, NULL, (char **)NULL, command_data->execute_command);
+					NULL, NULL, (char **)NULL, command_data->execute_command,
+					batch_comfile);
 			}
 			if (execute_string)
 			{
@@ -17189,7 +18612,7 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 				cmgui_execute_comfile(comfile_name,example_id,
 					command_data->examples_directory,
 					CMGUI_EXAMPLE_DIRECTORY_SYMBOL, &command_data->example_comfile,
-					command_data->execute_command);
+					command_data->execute_command, batch_comfile);
 			}
 		}
 
@@ -17238,6 +18661,10 @@ Initialise all the subcomponents of cmgui and create the cmzn_command_data
 		{
 			DEALLOCATE(comfile_name);
 		}
+		if (server_socket_name)
+		{
+			DEALLOCATE(server_socket_name);
+		}
 
 		if (command_list || write_help || batch_mode || !return_code)
 		{
@@ -17277,6 +18704,20 @@ NOTE: Do not call this directly: call cmzn_command_data_destroy() to deaccess.
 				"Call to DESTROY(cmzn_command_data) while still in use");
 			return 0;
 		}
+		if (command_data->command_option_table)
+		{
+			DESTROY(Option_table)(&command_data->command_option_table);
+		}
+		if (command_data->gfx_option_table)
+		{
+			DESTROY(Option_table)(&command_data->gfx_option_table);
+		}
+		if (command_data->gfx_modify_option_table)
+		{
+			DESTROY(Option_table)(&command_data->gfx_modify_option_table);
+		}
+		delete command_data->node_time_series_set;
+		command_data->node_time_series_set = (Node_time_series_set *)NULL;
 		if (command_data->emoter_slider_dialog)
 		{
 			DESTROY(Emoter_dialog)(&command_data->emoter_slider_dialog);
@@ -17310,6 +18751,11 @@ NOTE: Do not call this directly: call cmzn_command_data_destroy() to deaccess.
 			DESTROY(Spectrum_editor_dialog)(&(command_data->spectrum_editor_dialog));
 		}
 #endif /* defined (WX_USER_INTERFACE) */
+		/* stops capturing messages, so before the logger is released */
+		if (command_data->command_server)
+		{
+			DESTROY(Command_server)(&command_data->command_server);
+		}
 		cmzn_loggernotifier_clear_callback(command_data->loggerNotifier);
 		cmzn_loggernotifier_destroy(&command_data->loggerNotifier);
 		cmzn_logger_destroy(&command_data->logger);
@@ -54,6 +54,7 @@ DESCRIPTION :
 Command line options to be parsed by read_cmgui_command_line_options.
 ==============================================================================*/
 {
+	char batch_comfile_flag;
 	char batch_mode_flag;
 	char cm_start_flag;
 	char *cm_epath_directory_name;
@@ -68,6 +69,7 @@ Command line options to be parsed by read_cmgui_command_line_options.
 	char mycm_start_flag;
 	char no_display_flag;
 	char server_mode_flag;
+	char *server_socket_name;
 	int random_number_seed;
 	int visual_id_number;
 	/* default option; no token */
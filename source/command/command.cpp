@@ -34,6 +34,7 @@ DESCRIPTION :
 ==============================================================================*/
 {
 	Execute_command_function *function;
+	Execute_command_batch_function *begin_batch_function, *end_batch_function;
 	void *data;
 }; /* struct Execute_command */
 
@@ -110,6 +111,10 @@ to set the function it calls, and the user data to be passed with it.
 	if (ALLOCATE(execute_command,struct Execute_command, 1))
 	{
 		execute_command->function = (Execute_command_function *)NULL;
+		execute_command->begin_batch_function =
+			(Execute_command_batch_function *)NULL;
+		execute_command->end_batch_function =
+			(Execute_command_batch_function *)NULL;
 		execute_command->data = (void *)NULL;
 	}
 	else
@@ -182,6 +187,95 @@ with it.
 	return (return_code);
 } /* Execute_command_set_command_function */
 
+int Execute_command_set_batch_functions(
+	struct Execute_command *execute_command,
+	Execute_command_batch_function *begin_batch_function,
+	Execute_command_batch_function *end_batch_function)
+/*******************************************************************************
+DESCRIPTION :
+Sets the functions called by Execute_command_begin_batch and
+Execute_command_end_batch.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Execute_command_set_batch_functions);
+	if (execute_command && ((begin_batch_function && end_batch_function) ||
+		((!begin_batch_function) && (!end_batch_function))))
+	{
+		execute_command->begin_batch_function = begin_batch_function;
+		execute_command->end_batch_function = end_batch_function;
+		return_code = 1;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Execute_command_set_batch_functions.  Invalid argument(s)");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Execute_command_set_batch_functions */
+
+int Execute_command_begin_batch(struct Execute_command *execute_command)
+/*******************************************************************************
+DESCRIPTION :
+Starts a batch of commands executed with <execute_command>.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Execute_command_begin_batch);
+	if (execute_command)
+	{
+		return_code = 1;
+		if (execute_command->begin_batch_function)
+		{
+			return_code =
+				(*(execute_command->begin_batch_function))(execute_command->data);
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Execute_command_begin_batch.  Missing execute_command");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Execute_command_begin_batch */
+
+int Execute_command_end_batch(struct Execute_command *execute_command)
+/*******************************************************************************
+DESCRIPTION :
+Ends a batch of commands started with Execute_command_begin_batch.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Execute_command_end_batch);
+	if (execute_command)
+	{
+		return_code = 1;
+		if (execute_command->end_batch_function)
+		{
+			return_code =
+				(*(execute_command->end_batch_function))(execute_command->data);
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Execute_command_end_batch.  Missing execute_command");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Execute_command_end_batch */
+
 int Execute_command_execute_string(struct Execute_command *execute_command,
 	const char *command_string)
 /*******************************************************************************
@@ -289,3 +383,31 @@ Opens, executes and then closes a com file.  No window is created.
 	return (return_code);
 } /* execute_comfile */
 
+int execute_comfile_batch(char *file_name,
+	struct IO_stream_package *io_stream_package,
+	struct Execute_command *execute_command)
+/******************************************************************************
+DESCRIPTION :
+Same as execute_comfile but executes all commands in the com file as a single
+batch.
+=============================================================================*/
+{
+	int return_code;
+
+	ENTER(execute_comfile_batch);
+	if (execute_command)
+	{
+		Execute_command_begin_batch(execute_command);
+		return_code = execute_comfile(file_name, io_stream_package, execute_command);
+		Execute_command_end_batch(execute_command);
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,"execute_comfile_batch.  "
+			"Invalid execute command");
+		return_code=0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* execute_comfile_batch */
@@ -31,6 +31,8 @@ Global types
 */
 typedef int (Execute_command_function)(const char *command,void *user_data);
 
+typedef int (Execute_command_batch_function)(void *user_data);
+
 struct Execute_command;
 
 /*
@@ -81,6 +83,32 @@ DESCRIPTION :
 Executes the given string using the Execute_command stucture
 ==============================================================================*/
 
+int Execute_command_set_batch_functions(
+	struct Execute_command *execute_command,
+	Execute_command_batch_function *begin_batch_function,
+	Execute_command_batch_function *end_batch_function);
+/*******************************************************************************
+DESCRIPTION :
+Sets the functions called by Execute_command_begin_batch and
+Execute_command_end_batch, which are passed the same user data as the command
+function. Typically used to cache change messages while a run of commands is
+executed.
+==============================================================================*/
+
+int Execute_command_begin_batch(struct Execute_command *execute_command);
+/*******************************************************************************
+DESCRIPTION :
+Starts a batch of commands executed with <execute_command>. Calls to begin and
+end batch must be matched and may be nested. Does nothing if no batch functions
+are set.
+==============================================================================*/
+
+int Execute_command_end_batch(struct Execute_command *execute_command);
+/*******************************************************************************
+DESCRIPTION :
+Ends a batch of commands started with Execute_command_begin_batch.
+==============================================================================*/
+
 int execute_comfile(char *file_name,struct IO_stream_package *io_stream_package,
 	struct Execute_command *execute_command);
 /******************************************************************************
@@ -89,4 +117,14 @@ LAST MODIFIED : 3 September 2004
 DESCRIPTION :
 Opens, executes and then closes a com file.  No window is created.
 =============================================================================*/
+
+int execute_comfile_batch(char *file_name,
+	struct IO_stream_package *io_stream_package,
+	struct Execute_command *execute_command);
+/******************************************************************************
+DESCRIPTION :
+Same as execute_comfile but executes all commands in the com file as a single
+batch, so change messages are cached until the end of the file or until a
+command flushes them explicitly.
+=============================================================================*/
 #endif /* !defined (COMMAND_H) */
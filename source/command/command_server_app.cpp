@@ -0,0 +1,687 @@
+/*******************************************************************************
+FILE : command_server_app.cpp
+
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Server executing commands received from local clients over a Unix domain
+socket. Commands are queued and executed one at a time from an idle callback so
+they are serialised with all other work on the main loop.
+==============================================================================*/
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#include <stdio.h>
+#include <string.h>
+#include <deque>
+#include <map>
+#include <string>
+#if 1
+#include "zinc/zincconfigure.h"
+#endif /* defined (1) */
+#if defined (UNIX)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#endif /* defined (UNIX) */
+#include "zinc/logger.h"
+#include "api/cmiss_fdio.h"
+#include "general/debug.h"
+#include "general/elapsed_time_app.h"
+#include "general/object.h"
+#include "command/command.h"
+#include "command/command_server_app.h"
+#include "user_interface/fd_io.h"
+#include "user_interface/event_dispatcher.h"
+#include "general/message.h"
+#include "general/mystring.h"
+
+/*
+Module types
+------------
+*/
+
+/* bytes read from a client in one callback so other events are served */
+#define COMMAND_SERVER_READ_SIZE (65536)
+/* clients sending a longer line without a newline are disconnected */
+#define COMMAND_SERVER_MAXIMUM_LINE_LENGTH (1 << 20)
+
+struct Command_server_client
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Connection to one client. <input> holds an incomplete command line and
+<output> replies not yet accepted by the socket. Once <closed> the client is
+destroyed when its queued commands have run and output is written.
+==============================================================================*/
+{
+	int id;
+	int fd;
+	Fdio_id fdio;
+	struct Command_server *server;
+	std::string input, output;
+	int queued_commands;
+	int closed;
+};
+
+struct Command_server_command
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+A command waiting to be executed for client <client_id>, with the time it was
+received.
+==============================================================================*/
+{
+	int client_id;
+	std::string command;
+	double received_seconds;
+};
+
+struct Command_server
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Messages written to the logger while a command executes are appended to
+<captured_output>. Latencies are from receipt of a command to its reply being
+queued for writing, so include time waiting behind other commands.
+==============================================================================*/
+{
+	char *socket_name;
+	int listen_fd;
+	Fdio_id listen_fdio;
+	struct Execute_command *execute_command;
+	struct Event_dispatcher *event_dispatcher;
+	struct Event_dispatcher_idle_callback *idle_callback;
+	cmzn_loggernotifier_id logger_notifier;
+	std::map<int, Command_server_client *> clients;
+	std::deque<Command_server_command> queue;
+	int next_client_id;
+	int executing, capturing;
+	std::string captured_output;
+	/* statistics */
+	int number_of_clients_connected;
+	size_t maximum_queue_depth;
+	int number_of_commands, number_of_failed_commands;
+	double total_latency_seconds, maximum_latency_seconds;
+	double total_execution_seconds;
+};
+
+/*
+Module functions
+----------------
+*/
+
+#if defined (UNIX)
+
+static void Command_server_logger_callback(cmzn_loggerevent_id event,
+	void *command_server_void)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Appends messages written while a command is executing to the captured output,
+prefixing errors and warnings as in the command window.
+==============================================================================*/
+{
+	struct Command_server *server = (struct Command_server *)command_server_void;
+	if (event && server && server->capturing)
+	{
+		char *message = cmzn_loggerevent_get_message_text(event);
+		if (message)
+		{
+			switch (cmzn_loggerevent_get_message_type(event))
+			{
+				case CMZN_LOGGER_MESSAGE_TYPE_ERROR:
+				{
+					server->captured_output.append("ERROR: ");
+					server->captured_output.append(message);
+					server->captured_output.append("\n");
+				} break;
+				case CMZN_LOGGER_MESSAGE_TYPE_WARNING:
+				{
+					server->captured_output.append("WARNING: ");
+					server->captured_output.append(message);
+					server->captured_output.append("\n");
+				} break;
+				default:
+				{
+					server->captured_output.append(message);
+				} break;
+			}
+			DEALLOCATE(message);
+		}
+	}
+}
+
+static void Command_server_destroy_client(struct Command_server_client *client)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Removes <client> from its server, stops listening to it and closes it.
+==============================================================================*/
+{
+	client->server->clients.erase(client->id);
+	DESTROY(Fdio)(&client->fdio);
+	close(client->fd);
+	delete client;
+}
+
+static void Command_server_close_client(struct Command_server_client *client)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Stops reading from <client>, destroying it unless commands are still queued for
+it or replies remain to be written.
+==============================================================================*/
+{
+	client->closed = 1;
+	client->input.clear();
+	Fdio_set_read_callback(client->fdio, (Fdio_callback)NULL, (void *)NULL);
+	if ((0 == client->queued_commands) && client->output.empty())
+	{
+		Command_server_destroy_client(client);
+	}
+}
+
+static int Command_server_client_write_callback(Fdio_id fdio, void *client_void);
+
+static void Command_server_write_client(struct Command_server_client *client)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Writes as much pending output to <client> as the socket accepts without
+blocking, waiting for a write callback to send the rest. A client which has
+disconnected has its output discarded.
+==============================================================================*/
+{
+	int flags = 0;
+#if defined (MSG_NOSIGNAL)
+	/* a client disconnecting must not raise SIGPIPE */
+	flags = MSG_NOSIGNAL;
+#endif /* defined (MSG_NOSIGNAL) */
+	while (!client->output.empty())
+	{
+		ssize_t length = send(client->fd, client->output.data(), client->output.size(), flags);
+		if (0 < length)
+		{
+			client->output.erase(0, length);
+		}
+		else if ((length < 0) && (EINTR == errno))
+		{
+			continue;
+		}
+		else if ((length < 0) && ((EAGAIN == errno) || (EWOULDBLOCK == errno)))
+		{
+			Fdio_set_write_callback(client->fdio, Command_server_client_write_callback,
+				(void *)client);
+			return;
+		}
+		else
+		{
+			client->output.clear();
+			client->closed = 1;
+		}
+	}
+	Fdio_set_write_callback(client->fdio, (Fdio_callback)NULL, (void *)NULL);
+	if (client->closed)
+	{
+		Command_server_close_client(client);
+	}
+}
+
+static int Command_server_client_write_callback(Fdio_id fdio, void *client_void)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Called when a client socket can accept more output.
+==============================================================================*/
+{
+	USE_PARAMETER(fdio);
+	Command_server_write_client((struct Command_server_client *)client_void);
+	return (1);
+}
+
+static int Command_server_idle_callback(void *command_server_void);
+
+static void Command_server_schedule(struct Command_server *server)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Ensures the idle callback is registered while commands are queued. While a
+command executes it is not, as commands may run the event loop; it is
+registered again when the command finishes.
+==============================================================================*/
+{
+	if ((!server->queue.empty()) && (!server->idle_callback) && (!server->executing))
+	{
+		server->idle_callback = Event_dispatcher_add_idle_callback(
+			server->event_dispatcher, Command_server_idle_callback, (void *)server,
+			EVENT_DISPATCHER_X_PRIORITY);
+	}
+}
+
+static int Command_server_idle_callback(void *command_server_void)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Executes the oldest queued command, capturing its output, and queues the reply
+to its client. The callback is removed before the command executes, as commands
+may run the event loop and it must not be called again until the command
+finishes; it is added again afterwards if commands remain. Always returns 0.
+==============================================================================*/
+{
+	struct Command_server *server = (struct Command_server *)command_server_void;
+	if (!server)
+	{
+		return (0);
+	}
+	if (server->idle_callback)
+	{
+		Event_dispatcher_remove_idle_callback(server->event_dispatcher,
+			server->idle_callback);
+		server->idle_callback = (struct Event_dispatcher_idle_callback *)NULL;
+	}
+	if (server->queue.empty())
+	{
+		return (0);
+	}
+	Command_server_command command = server->queue.front();
+	server->queue.pop_front();
+	server->executing = 1;
+	server->capturing = 1;
+	server->captured_output.clear();
+	const double start_seconds = get_elapsed_time_seconds();
+	int return_code = Execute_command_execute_string(server->execute_command,
+		command.command.c_str());
+	const double end_seconds = get_elapsed_time_seconds();
+	server->capturing = 0;
+	server->executing = 0;
+	const double latency_seconds = end_seconds - command.received_seconds;
+	++(server->number_of_commands);
+	if (!return_code)
+	{
+		++(server->number_of_failed_commands);
+	}
+	server->total_latency_seconds += latency_seconds;
+	if (latency_seconds > server->maximum_latency_seconds)
+	{
+		server->maximum_latency_seconds = latency_seconds;
+	}
+	server->total_execution_seconds += end_seconds - start_seconds;
+	std::map<int, Command_server_client *>::iterator client_iter =
+		server->clients.find(command.client_id);
+	if (client_iter != server->clients.end())
+	{
+		struct Command_server_client *client = client_iter->second;
+		--(client->queued_commands);
+		char header[64];
+		sprintf(header, "%s %lu\n", return_code ? "OK" : "ERROR",
+			(unsigned long)server->captured_output.size());
+		client->output.append(header);
+		client->output.append(server->captured_output);
+		Command_server_write_client(client);
+	}
+	server->captured_output.clear();
+	Command_server_schedule(server);
+	return (0);
+}
+
+static void Command_server_queue_lines(struct Command_server_client *client)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Queues each complete, non-blank line of <client> input as a command, keeping
+any incomplete final line, and ensures the queue will be processed.
+==============================================================================*/
+{
+	struct Command_server *server = client->server;
+	size_t line_start = 0, line_end;
+	const double received_seconds = get_elapsed_time_seconds();
+	while (std::string::npos != (line_end = client->input.find('\n', line_start)))
+	{
+		size_t command_end = line_end;
+		while ((command_end > line_start) && ('\r' == client->input[command_end - 1]))
+		{
+			--command_end;
+		}
+		std::string line = client->input.substr(line_start, command_end - line_start);
+		line_start = line_end + 1;
+		if (std::string::npos != line.find_first_not_of(" \t"))
+		{
+			Command_server_command command;
+			command.client_id = client->id;
+			command.command = line;
+			command.received_seconds = received_seconds;
+			server->queue.push_back(command);
+			++(client->queued_commands);
+		}
+	}
+	client->input.erase(0, line_start);
+	if (server->queue.size() > server->maximum_queue_depth)
+	{
+		server->maximum_queue_depth = server->queue.size();
+	}
+	Command_server_schedule(server);
+}
+
+static int Command_server_client_read_callback(Fdio_id fdio, void *client_void)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Reads available input from a client and queues the complete command lines.
+At end of input any unterminated last line is queued too and the client is
+closed once replies are sent. Closes the client on error or if a line is too
+long.
+==============================================================================*/
+{
+	struct Command_server_client *client = (struct Command_server_client *)client_void;
+	char buffer[COMMAND_SERVER_READ_SIZE];
+	USE_PARAMETER(fdio);
+	ssize_t length = read(client->fd, buffer, sizeof(buffer));
+	if (0 < length)
+	{
+		client->input.append(buffer, length);
+		Command_server_queue_lines(client);
+		if (client->input.size() > COMMAND_SERVER_MAXIMUM_LINE_LENGTH)
+		{
+			client->output.append("ERROR 0\n");
+			client->closed = 1;
+			Command_server_write_client(client);
+		}
+	}
+	else if (0 == length)
+	{
+		/* replies are still sent if the client only shut down writing */
+		if (!client->input.empty())
+		{
+			client->input.append("\n");
+			Command_server_queue_lines(client);
+		}
+		Command_server_close_client(client);
+	}
+	else if ((EAGAIN != errno) && (EWOULDBLOCK != errno) && (EINTR != errno))
+	{
+		Command_server_close_client(client);
+	}
+	return (1);
+}
+
+static int Command_server_listen_callback(Fdio_id fdio, void *command_server_void)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Accepts waiting client connections.
+==============================================================================*/
+{
+	struct Command_server *server = (struct Command_server *)command_server_void;
+	int fd;
+	USE_PARAMETER(fdio);
+	while (0 <= (fd = accept(server->listen_fd, (struct sockaddr *)NULL, (socklen_t *)NULL)))
+	{
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+#if defined (SO_NOSIGPIPE)
+		int no_sigpipe = 1;
+		setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif /* defined (SO_NOSIGPIPE) */
+		struct Command_server_client *client = new Command_server_client();
+		client->id = server->next_client_id++;
+		client->fd = fd;
+		client->server = server;
+		client->queued_commands = 0;
+		client->closed = 0;
+		client->fdio = Event_dispatcher_create_Fdio(server->event_dispatcher, fd);
+		if (!client->fdio)
+		{
+			display_message(ERROR_MESSAGE,
+				"Command_server_listen_callback.  Unable to register client");
+			close(fd);
+			delete client;
+			continue;
+		}
+		server->clients[client->id] = client;
+		++(server->number_of_clients_connected);
+		Fdio_set_read_callback(client->fdio, Command_server_client_read_callback,
+			(void *)client);
+	}
+	return (1);
+}
+
+#endif /* defined (UNIX) */
+
+/*
+Global functions
+----------------
+*/
+
+struct Command_server *CREATE(Command_server)(
+	struct Execute_command *execute_command,
+	struct Event_dispatcher *event_dispatcher, cmzn_logger_id logger,
+	const char *socket_name)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Creates a server listening on a Unix domain socket at <socket_name>.
+==============================================================================*/
+{
+	struct Command_server *server = (struct Command_server *)NULL;
+
+	ENTER(CREATE(Command_server));
+	if (execute_command && event_dispatcher && logger && socket_name)
+	{
+#if defined (UNIX)
+		struct sockaddr_un address;
+		memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (strlen(socket_name) >= sizeof(address.sun_path))
+		{
+			display_message(ERROR_MESSAGE,
+				"CREATE(Command_server).  Socket name '%s' is too long", socket_name);
+			LEAVE;
+			return (server);
+		}
+		strcpy(address.sun_path, socket_name);
+		int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd < 0)
+		{
+			display_message(ERROR_MESSAGE,
+				"CREATE(Command_server).  Could not create socket: %s", strerror(errno));
+			LEAVE;
+			return (server);
+		}
+		fcntl(fd, F_SETFD, FD_CLOEXEC);
+		/* replace a socket left by a previous server, but not a live one */
+		struct stat socket_stat;
+		if ((0 == lstat(socket_name, &socket_stat)) && S_ISSOCK(socket_stat.st_mode))
+		{
+			int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+			const int connect_result = (0 <= probe_fd) ?
+				connect(probe_fd, (struct sockaddr *)&address, sizeof(address)) : -1;
+			const int connect_errno = errno;
+			if (0 <= probe_fd)
+			{
+				close(probe_fd);
+			}
+			if ((0 == connect_result) || (ECONNREFUSED != connect_errno))
+			{
+				display_message(ERROR_MESSAGE,
+					"CREATE(Command_server).  Socket '%s' is in use by another server",
+					socket_name);
+				close(fd);
+				LEAVE;
+				return (server);
+			}
+			unlink(socket_name);
+		}
+		/* only the user may connect */
+		const mode_t old_umask = umask(S_IRWXG | S_IRWXO);
+		const int bind_result = bind(fd, (struct sockaddr *)&address, sizeof(address));
+		umask(old_umask);
+		if ((0 != bind_result) || (0 != listen(fd, SOMAXCONN)))
+		{
+			display_message(ERROR_MESSAGE,
+				"CREATE(Command_server).  Could not listen on socket '%s': %s",
+				socket_name, strerror(errno));
+			close(fd);
+			LEAVE;
+			return (server);
+		}
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+		server = new Command_server();
+		server->socket_name = duplicate_string(socket_name);
+		server->listen_fd = fd;
+		server->execute_command = execute_command;
+		server->event_dispatcher = event_dispatcher;
+		server->idle_callback = (struct Event_dispatcher_idle_callback *)NULL;
+		server->next_client_id = 1;
+		server->executing = 0;
+		server->capturing = 0;
+		server->number_of_clients_connected = 0;
+		server->maximum_queue_depth = 0;
+		server->number_of_commands = 0;
+		server->number_of_failed_commands = 0;
+		server->total_latency_seconds = 0.0;
+		server->maximum_latency_seconds = 0.0;
+		server->total_execution_seconds = 0.0;
+		server->logger_notifier = cmzn_logger_create_loggernotifier(logger);
+		cmzn_loggernotifier_set_callback(server->logger_notifier,
+			Command_server_logger_callback, (void *)server);
+		server->listen_fdio = Event_dispatcher_create_Fdio(event_dispatcher, fd);
+		if (server->listen_fdio)
+		{
+			Fdio_set_read_callback(server->listen_fdio, Command_server_listen_callback,
+				(void *)server);
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE,
+				"CREATE(Command_server).  Unable to register callback for socket");
+			DESTROY(Command_server)(&server);
+		}
+#else /* defined (UNIX) */
+		display_message(ERROR_MESSAGE,
+			"CREATE(Command_server).  Command sockets are not supported on this platform");
+#endif /* defined (UNIX) */
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"CREATE(Command_server).  Invalid argument(s)");
+	}
+	LEAVE;
+
+	return (server);
+} /* CREATE(Command_server) */
+
+int DESTROY(Command_server)(struct Command_server **command_server_address)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Disconnects all clients, removes the socket file and destroys the server.
+==============================================================================*/
+{
+	int return_code;
+	struct Command_server *server;
+
+	ENTER(DESTROY(Command_server));
+	if (command_server_address && (server = *command_server_address))
+	{
+#if defined (UNIX)
+		while (!server->clients.empty())
+		{
+			Command_server_destroy_client(server->clients.begin()->second);
+		}
+		if (server->idle_callback)
+		{
+			Event_dispatcher_remove_idle_callback(server->event_dispatcher,
+				server->idle_callback);
+		}
+		if (server->listen_fdio)
+		{
+			DESTROY(Fdio)(&server->listen_fdio);
+		}
+		close(server->listen_fd);
+		unlink(server->socket_name);
+		cmzn_loggernotifier_clear_callback(server->logger_notifier);
+		cmzn_loggernotifier_destroy(&server->logger_notifier);
+#endif /* defined (UNIX) */
+		DEALLOCATE(server->socket_name);
+		delete server;
+		*command_server_address = (struct Command_server *)NULL;
+		return_code = 1;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"DESTROY(Command_server).  Invalid argument(s)");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* DESTROY(Command_server) */
+
+int Command_server_list_statistics(struct Command_server *command_server)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Writes the socket name, number of clients, queue depth, commands executed and
+their mean and maximum latency from receipt to reply.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Command_server_list_statistics);
+	if (command_server)
+	{
+		display_message(INFORMATION_MESSAGE,
+			"Command server on socket %s\n", command_server->socket_name);
+		display_message(INFORMATION_MESSAGE,
+			"  clients: %d connected, %d total\n",
+			(int)command_server->clients.size(), command_server->number_of_clients_connected);
+		display_message(INFORMATION_MESSAGE,
+			"  queue depth: %d current, %d maximum\n",
+			(int)command_server->queue.size(), (int)command_server->maximum_queue_depth);
+		display_message(INFORMATION_MESSAGE,
+			"  commands: %d executed, %d failed\n",
+			command_server->number_of_commands, command_server->number_of_failed_commands);
+		if (0 < command_server->number_of_commands)
+		{
+			display_message(INFORMATION_MESSAGE,
+				"  latency: %g seconds mean, %g seconds maximum, %g seconds mean execution\n",
+				command_server->total_latency_seconds/command_server->number_of_commands,
+				command_server->maximum_latency_seconds,
+				command_server->total_execution_seconds/command_server->number_of_commands);
+		}
+		return_code = 1;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Command_server_list_statistics.  Missing command server");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Command_server_list_statistics */
@@ -0,0 +1,69 @@
+/*******************************************************************************
+FILE : command_server_app.h
+
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Server executing commands received from local clients over a Unix domain
+socket, so one running cmgui can be sent work by other processes.
+==============================================================================*/
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+#if !defined (COMMAND_SERVER_APP_H)
+#define COMMAND_SERVER_APP_H
+
+#include "zinc/types/loggerid.h"
+#include "command/command.h"
+#include "general/object.h"
+#include "user_interface/event_dispatcher.h"
+
+/*
+Global types
+------------
+*/
+struct Command_server;
+
+/*
+Global functions
+----------------
+*/
+struct Command_server *CREATE(Command_server)(
+	struct Execute_command *execute_command,
+	struct Event_dispatcher *event_dispatcher, cmzn_logger_id logger,
+	const char *socket_name);
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Creates a server listening on a Unix domain socket at <socket_name>, replacing
+any existing socket file there. The socket is only accessible by the user.
+Clients send commands terminated by newlines. Commands from all clients are
+queued and executed in turn from the main loop with <execute_command>. After
+each command the client is sent a line "OK <length>" or "ERROR <length>"
+followed by <length> bytes of the messages written to <logger> while the
+command executed.
+Only supported on Unix platforms.
+==============================================================================*/
+
+int DESTROY(Command_server)(struct Command_server **command_server_address);
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Disconnects all clients, removes the socket file and destroys the server.
+Commands not yet executed are discarded.
+==============================================================================*/
+
+int Command_server_list_statistics(struct Command_server *command_server);
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Writes the socket name, number of clients, queue depth, commands executed and
+their mean and maximum latency from receipt to reply.
+==============================================================================*/
+
+#endif /* !defined (COMMAND_SERVER_APP_H) */
@@ -32,6 +32,10 @@ Management routines for the main command window.
 #include <wx/aboutdlg.h>
 #include <wx/fontdlg.h>
 #include <wx/splitter.h>
+#include <deque>
+#include <string>
+#include "general/elapsed_time_app.h"
+#include "general/text_ring_buffer_app.hpp"
 #endif /* defined (WX_USER_INTERFACE)*/
 #include "general/message.h"
 #include "user_interface/user_interface.h"
@@ -57,6 +61,16 @@ enum Command_window_outfile_mode
 	OUTFILE_INPUT = 2
 }; /* enum Command_window_outfile_mode */
 
+#if defined (WX_USER_INTERFACE)
+/* characters of output kept for the output pane; when exceeded the pane is
+	 reset to the most recent half. Use command_window out_file to log all output */
+#define COMMAND_WINDOW_OUTPUT_CAPACITY (1 << 20)
+/* commands kept in the history list */
+#define COMMAND_WINDOW_HISTORY_CAPACITY 1000
+/* minimum seconds between updates of the output pane and history list */
+#define COMMAND_WINDOW_FLUSH_INTERVAL (1.0/30.0)
+#endif /* defined (WX_USER_INTERFACE) */
+
 #if defined (WX_USER_INTERFACE)
 class wxCommandWindow;
 class wxCommandLineTextCtrl : public wxTextCtrl
@@ -678,32 +692,34 @@ DESCRIPTION :
 static int modify_Command_window_out_file(struct Parse_state *state,void *dummy,
 	void *command_window_void)
 /*******************************************************************************
-LAST MODIFIED : 11 November 1998
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
+Opens or closes the log file receiving all command window output and/or input.
 ==============================================================================*/
 {
-	int i,return_code;
-	static struct Modifier_entry option_table[]=
-	{
-		{"close",NULL,NULL,modify_Command_window_out_file_close},
-		{"open",NULL,NULL,modify_Command_window_out_file_open},
-		{NULL,NULL,NULL,NULL}
-	};
+	int return_code;
+	struct Option_table *option_table;
 
 	ENTER(modify_Command_window_out_file);
 	USE_PARAMETER(dummy);
 	return_code=0;
 	if (state)
 	{
-		i=0;
+		option_table=CREATE(Option_table)();
+		Option_table_add_help(option_table,
+			"Opens or closes the optional log file for the command window. Every "
+			"message written to the command window, and with 'input' every command "
+			"executed, is written to the log file, whereas the command window keeps "
+			"only the most recent output and commands.");
 		/* close */
-		option_table[i].user_data=command_window_void;
-		i++;
+		Option_table_add_entry(option_table,"close",NULL,command_window_void,
+			modify_Command_window_out_file_close);
 		/* open */
-		option_table[i].user_data=command_window_void;
-		i++;
-		return_code=process_option(state,option_table);
+		Option_table_add_entry(option_table,"open",NULL,command_window_void,
+			modify_Command_window_out_file_open);
+		return_code=Option_table_parse(option_table,state);
+		DESTROY(Option_table)(&option_table);
 	}
 	else
 	{
@@ -738,11 +754,20 @@ class wxCommandWindow : public wxFrame
 	struct TextCtrlMouseEventData mouse_event_data;
 	const char *name_string, *version_string, *date_string,
 	*copyright_string, *build_string, *revision_string;
+	/* output and commands not yet shown are held here until the next flush */
+	Text_ring_buffer output_buffer;
+	size_t output_list_length;
+	std::deque<std::string> pending_commands;
+	wxTimer flush_timer;
+	double last_flush_time;
 
 public:
 
 	wxCommandWindow(Command_window *command_window):
-		command_window(command_window)
+		command_window(command_window),
+		output_buffer(COMMAND_WINDOW_OUTPUT_CAPACITY),
+		output_list_length(0),
+		last_flush_time(0.0)
 	{
 		wxXmlInit_command_window();
 		command_window->wx_command_window = NULL;
@@ -764,15 +789,22 @@ public:
 			wxMouseEventHandler(wxCommandWindow::OnOutputLeftClick), NULL, this);
 		output_list->Connect(wxEVT_LEFT_DCLICK,
 			wxMouseEventHandler(wxCommandWindow::OnOutputDClick), NULL, this);
+		flush_timer.SetOwner(this);
+		this->Connect(flush_timer.GetId(), wxEVT_TIMER,
+			wxTimerEventHandler(wxCommandWindow::OnFlushTimer), NULL, this);
 	}
 
-	wxCommandWindow()
+	wxCommandWindow() :
+		output_buffer(COMMAND_WINDOW_OUTPUT_CAPACITY),
+		output_list_length(0),
+		last_flush_time(0.0)
 	{
 	}
 
 
 	~wxCommandWindow()
 	{
+		flush_timer.Stop();
 		if (name_string)
 		{
 			DEALLOCATE(name_string);
@@ -869,20 +901,99 @@ public:
 		event.Skip();
 	}
 
-	void wx_Add_to_command_list(wxString command)
+	void wx_Add_to_command_list(const char *command)
 	{
-		history_list = XRCCTRL(*this, "CommandHistory", wxListBox);
-		history_list->Freeze();
-		if(history_list->GetCount() == 0)
-			history_list->Append(command);
-		else
-			history_list->SetString(history_list->GetCount()-1, command);
-		history_list->Append(wxT(""));
-		// make item visible
-		history_list->SetSelection(history_list->GetCount()-1);
-		history_list->Thaw();
+		pending_commands.push_back(std::string(command));
+		if (pending_commands.size() > COMMAND_WINDOW_HISTORY_CAPACITY)
+			pending_commands.pop_front();
+		ScheduleFlush();
+	}
+
+	void wx_Write_output(const char *message)
+	{
+		output_buffer.append(message, strlen(message));
+		ScheduleFlush();
 	}
 
+	/**
+	 * Shows output and commands written since the last flush. The output pane
+	 * only grows by appending until it would exceed the buffer capacity, then is
+	 * replaced by the most recent half of the buffer.
+	 */
+	void FlushOutput()
+	{
+		flush_timer.Stop();
+		last_flush_time = get_elapsed_time_seconds();
+		if (0 < output_buffer.getPendingLength())
+		{
+			std::string text;
+			output_list->Freeze();
+			if (output_buffer.isPendingOverflowed() || (output_list_length +
+				output_buffer.getPendingLength() > output_buffer.getCapacity()))
+			{
+				output_buffer.takeTail(output_buffer.getCapacity()/2, text);
+				output_list->ChangeValue(wxString::FromAscii(text.c_str()));
+				output_list_length = text.size();
+			}
+			else
+			{
+				output_buffer.takePending(text);
+				output_list->AppendText(wxString::FromAscii(text.c_str()));
+				output_list_length += text.size();
+			}
+			output_list->ShowPosition(output_list->GetLastPosition());
+			output_list->Thaw();
+		}
+		if (!pending_commands.empty())
+		{
+			history_list = XRCCTRL(*this, "CommandHistory", wxListBox);
+			history_list->Freeze();
+			for (size_t i = 0; i < pending_commands.size(); ++i)
+			{
+				wxString command = wxString::FromAscii(pending_commands[i].c_str());
+				if (history_list->GetCount() == 0)
+					history_list->Append(command);
+				else
+					history_list->SetString(history_list->GetCount()-1, command);
+				history_list->Append(wxT(""));
+			}
+			pending_commands.clear();
+			while (history_list->GetCount() > COMMAND_WINDOW_HISTORY_CAPACITY + 1)
+				history_list->Delete(0);
+			// make item visible
+			history_list->SetSelection(history_list->GetCount()-1);
+			history_list->Thaw();
+		}
+	}
+
+private:
+
+	/**
+	 * Flushes now if a frame interval has passed since the last flush, otherwise
+	 * starts a timer to flush at the end of the interval.
+	 */
+	void ScheduleFlush()
+	{
+		const double elapsed = get_elapsed_time_seconds() - last_flush_time;
+		if (elapsed >= COMMAND_WINDOW_FLUSH_INTERVAL)
+		{
+			FlushOutput();
+		}
+		else if (!flush_timer.IsRunning())
+		{
+			flush_timer.Start(1 + static_cast<int>(1000.0*(COMMAND_WINDOW_FLUSH_INTERVAL - elapsed)),
+				wxTIMER_ONE_SHOT);
+		}
+	}
+
+	void OnFlushTimer(wxTimerEvent& event)
+	{
+		USE_PARAMETER(event);
+		FlushOutput();
+	}
+
+public:
+
 	void SetCmguiStrings(const char *name_string_in, const char *version_string_in,
 		const char *date_string_in, const char *copyright_string_in,
 		const char *build_string_in, const char *revision_string_in)
@@ -1660,7 +1771,13 @@ Adds the <command> to the bottom of the list for the <command_window>.
 		SendMessage(command_window->command_history, LB_ADDSTRING, 0,
 			(LPARAM)command);
 #elif defined (WX_USER_INTERFACE)
-		command_window->wx_command_window->wx_Add_to_command_list(wxString::FromAscii(command));
+		command_window->wx_command_window->wx_Add_to_command_list(command);
+		/* the history list keeps only recent commands; out_file logs them all */
+		if (command_window->out_file &&
+			(command_window->out_file_mode & OUTFILE_INPUT))
+		{
+			fprintf(command_window->out_file, "%s\n", command);
+		}
 		return_code = 1;
 #elif defined (GTK_USER_INTERFACE) /* switch (USER_INTERFACE) */
 #if GTK_MAJOR_VERSION >= 2
@@ -1835,6 +1952,8 @@ LAST MODIFIED : 9 November 1998
 
 DESCRIPTION :
 Writes the <message> to the <command_window>.
+With wxWidgets, messages are batched in a fixed size buffer and the output pane
+is updated at most once per frame, holding only the most recent output.
 ==============================================================================*/
 {
 	int return_code;
@@ -1896,8 +2015,8 @@ Writes the <message> to the <command_window>.
 #elif defined (WX_USER_INTERFACE)
 		if (command_window->output_window)
 		{
-			command_window->output_window->AppendText(wxString::FromAscii(message));
-			command_window->output_window->ScrollLines(- 1);
+			/* shown at most once per frame by the window */
+			command_window->wx_command_window->wx_Write_output(message);
 			return_code = 1;
 		}
 #endif /* switch (USER_INTERFACE) */
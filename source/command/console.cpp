@@ -13,6 +13,7 @@ Management routines for the main command window.
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #if 1
 #include "zinc/zincconfigure.h"
 #endif /* defined (1) */
@@ -26,10 +27,12 @@ Management routines for the main command window.
 #if defined (UNIX)
 #include <termios.h>
 #include <sgtty.h>
+#include <poll.h>
 #endif /* defined (UNIX) */
 
 #include "api/cmiss_fdio.h"
 #include "general/debug.h"
+#include "general/elapsed_time_app.h"
 #include "general/object.h"
 #include "command/console.h"
 #include "command/command.h"
@@ -42,11 +45,22 @@ Module types
 ------------
 */
 
+/* initial size of the input buffer, doubled whenever it fills */
+#define CONSOLE_INITIAL_BUFFER_SIZE (4096)
+/* minimum free space in the input buffer for each read */
+#define CONSOLE_MINIMUM_READ_SIZE (1024)
+/* limit on input read from a stream in one callback so other events are served */
+#define CONSOLE_MAXIMUM_STREAM_READ (1 << 20)
+
 struct Console
 /*******************************************************************************
-LAST MODIFIED : 27 June 2002
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
+<input_buffer> holds <input_length> characters read but not yet executed,
+normally the start of an incomplete command line. In <streaming> mode the
+prompt is not echoed and a summary of commands executed is reported at the end
+of input.
 ==============================================================================*/
 {
 	char *command_prompt;
@@ -54,6 +68,11 @@ DESCRIPTION :
 	cmzn_native_socket_t fd;
 	Fdio_id console_fdio;
 	struct Execute_command *execute_command;
+	char *input_buffer;
+	size_t input_buffer_size, input_length;
+	int streaming, processing, end_of_input;
+	int number_of_commands;
+	double start_seconds, end_seconds;
 }; /* struct Console */
 
 /*
@@ -61,50 +80,207 @@ Module functions
 ----------------
 */
 
+static int Console_read_input(struct Console *console)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Appends input available on the <console> file descriptor to its input buffer,
+growing the buffer as needed. In streaming mode reading continues while more
+input is immediately available, up to a limit per call. Sets end_of_input if
+the descriptor is at end of file.
+Returns the number of characters read, or -1 on error.
+==============================================================================*/
+{
+	char *new_buffer;
+	int length, total_length;
+	size_t new_size;
+
+	total_length = 0;
+	do
+	{
+		if (console->input_buffer_size - console->input_length <
+			CONSOLE_MINIMUM_READ_SIZE)
+		{
+			new_size = (console->input_buffer_size) ?
+				2*console->input_buffer_size : CONSOLE_INITIAL_BUFFER_SIZE;
+			if (REALLOCATE(new_buffer, console->input_buffer, char, new_size))
+			{
+				console->input_buffer = new_buffer;
+				console->input_buffer_size = new_size;
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE,
+					"Console_read_input.  Could not enlarge input buffer");
+				return (-1);
+			}
+		}
+		length = read(console->fd, console->input_buffer + console->input_length,
+			console->input_buffer_size - console->input_length);
+		if (length < 0)
+		{
+			return ((0 < total_length) ? total_length : -1);
+		}
+		if (0 == length)
+		{
+			console->end_of_input = 1;
+			break;
+		}
+		console->input_length += length;
+		total_length += length;
+		if (!console->streaming)
+		{
+			break;
+		}
+#if defined (UNIX)
+		struct pollfd poll_fd;
+		poll_fd.fd = console->fd;
+		poll_fd.events = POLLIN;
+		poll_fd.revents = 0;
+		if (poll(&poll_fd, 1, /*timeout*/0) <= 0)
+		{
+			break;
+		}
+#else /* defined (UNIX) */
+		break;
+#endif /* defined (UNIX) */
+	} while (total_length < CONSOLE_MAXIMUM_STREAM_READ);
+
+	return (total_length);
+} /* Console_read_input */
+
+static void Console_execute_line(struct Console *console, char *line)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Executes the null terminated command <line>, ignoring a trailing carriage
+return and blank lines.
+==============================================================================*/
+{
+	char *end;
+
+	end = line + strlen(line);
+	while ((end > line) && ('\r' == *(end - 1)))
+	{
+		--end;
+		*end = '\0';
+	}
+	if (line[strspn(line, " \t")])
+	{
+		Execute_command_execute_string(console->execute_command, line);
+		++(console->number_of_commands);
+	}
+} /* Console_execute_line */
+
+static int Console_execute_lines(struct Console *console)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Executes every complete line in the <console> input buffer within a single
+batch so change messages are sent once at the end, and keeps any incomplete
+final line for the next read. At end of input the incomplete line is executed
+too. Returns the number of lines executed.
+==============================================================================*/
+{
+	char *line, *line_end, *buffer_end;
+	int number_of_commands;
+
+	number_of_commands = console->number_of_commands;
+	line = console->input_buffer;
+	buffer_end = line + console->input_length;
+	line_end = line ? (char *)memchr(line, '\n', buffer_end - line) : (char *)NULL;
+	if (line_end || (console->end_of_input && (0 < console->input_length)))
+	{
+		if (0 == console->number_of_commands)
+		{
+			console->start_seconds = get_elapsed_time_seconds();
+		}
+		Execute_command_begin_batch(console->execute_command);
+		while (line_end)
+		{
+			*line_end = '\0';
+			Console_execute_line(console, line);
+			line = line_end + 1;
+			line_end = (char *)memchr(line, '\n', buffer_end - line);
+		}
+		console->input_length = buffer_end - line;
+		if (console->end_of_input && (0 < console->input_length))
+		{
+			/* last line without a newline; space is reserved after it */
+			line[console->input_length] = '\0';
+			Console_execute_line(console, line);
+			console->input_length = 0;
+		}
+		Execute_command_end_batch(console->execute_command);
+		console->end_seconds = get_elapsed_time_seconds();
+		if ((0 < console->input_length) && (line != console->input_buffer))
+		{
+			memmove(console->input_buffer, line, console->input_length);
+		}
+	}
+
+	return (console->number_of_commands - number_of_commands);
+} /* Console_execute_lines */
+
 static int Console_callback(Fdio_id fdio, void *console_void)
 /*******************************************************************************
-LAST MODIFIED : 27 June 2002
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
-This function is called to process stdin from a console.
+This function is called to process stdin from a console. All complete command
+lines read are executed; an incomplete final line is kept until the rest of it
+arrives. In streaming mode the callback is cancelled at end of input and the
+command rate is reported.
 ==============================================================================*/
 {
-#define ESC_KEYCODE '\033'
-#define KILL_KEYCODE '\025'
-#define MAX_CONSOLE_BUFFER (1000)
-	char buffer[MAX_CONSOLE_BUFFER];
-	int length, prompt_length, return_code;
+	int prompt_length, return_code;
 	struct Console *console;
 #if defined (UNIX)
 	int i;
 #endif /* defined (UNIX) */
 
 	ENTER(Console_callback);
-
-	USE_PARAMETER(fdio);
-
 	if (NULL != (console=(struct Console *)console_void))
 	{
-		length = read(console->fd, buffer, MAX_CONSOLE_BUFFER);
-		if (length)
+		/* commands may run the event loop; leave input until they finish */
+		if (!console->processing)
 		{
-			/* Look for control codes */
-			buffer[length - 1] = 0;
-			return_code=Execute_command_execute_string(console->execute_command,
-				buffer);
-			if (console->command_prompt)
+			console->processing = 1;
+			if ((0 < Console_read_input(console)) ||
+				(console->streaming && console->end_of_input))
 			{
-				prompt_length = strlen(console->command_prompt);
-#if defined (UNIX)
-				for (i = 0 ; i < prompt_length ; i++)
+				Console_execute_lines(console);
+				if (console->command_prompt && (!console->streaming))
 				{
-					/* Put the prompt out to the terminal as if it had been typed in */
-					ioctl(console->fd, TIOCSTI, console->command_prompt + i);
-				}
+					prompt_length = strlen(console->command_prompt);
+#if defined (UNIX)
+					for (i = 0 ; i < prompt_length ; i++)
+					{
+						/* Put the prompt out to the terminal as if it had been typed in */
+						ioctl(console->fd, TIOCSTI, console->command_prompt + i);
+					}
 #else
-				printf("%s", console->command_prompt);
+					printf("%s", console->command_prompt);
 #endif
+				}
 			}
+			if (console->end_of_input)
+			{
+				if (console->streaming)
+				{
+					Fdio_set_read_callback(fdio, (Fdio_callback)NULL, (void *)NULL);
+					Console_list_statistics(console);
+				}
+				else
+				{
+					/* a terminal may supply more input after end of file */
+					console->end_of_input = 0;
+				}
+			}
+			console->processing = 0;
 		}
 		return_code = 1;
 	}
@@ -144,6 +320,19 @@ Create the structures and retrieve the command window from the uil file.
 			console->execute_command=execute_command;
 			console->event_dispatcher = event_dispatcher;
 			console->fd = file_descriptor;
+			console->input_buffer = (char *)NULL;
+			console->input_buffer_size = 0;
+			console->input_length = 0;
+#if defined (WIN32_SYSTEM)
+			console->streaming = !_isatty(file_descriptor);
+#else /* defined (WIN32_SYSTEM) */
+			console->streaming = !isatty(file_descriptor);
+#endif /* defined (WIN32_SYSTEM) */
+			console->processing = 0;
+			console->end_of_input = 0;
+			console->number_of_commands = 0;
+			console->start_seconds = 0.0;
+			console->end_seconds = 0.0;
 			console->console_fdio =
 				Event_dispatcher_create_Fdio(event_dispatcher, file_descriptor);
 
@@ -154,9 +343,11 @@ Create the structures and retrieve the command window from the uil file.
 				DEALLOCATE(console);
 				console=(struct Console *)NULL;
 			}
-
-			Fdio_set_read_callback(console->console_fdio, Console_callback,
-				(void*)console);
+			else
+			{
+				Fdio_set_read_callback(console->console_fdio, Console_callback,
+					(void*)console);
+			}
 		}
 		else
 		{
@@ -189,6 +380,10 @@ DESCRIPTION:
 	if (console_pointer && (console = *console_pointer))
 	{
 		DESTROY(Fdio)(&console->console_fdio);
+		if (console->input_buffer)
+		{
+			DEALLOCATE(console->input_buffer);
+		}
 		DEALLOCATE(*console_pointer);
 		return_code = 1;
 	}
@@ -249,3 +444,98 @@ Sets the value of the <prompt> for the <console>.
 	return (return_code);
 } /* set_command_prompt */
 
+
+int Console_set_streaming(struct Console *console, int streaming)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Sets whether the <console> reads a stream of commands rather than interactive
+input. Overrides the mode chosen from the file descriptor on creation.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Console_set_streaming);
+	if (console)
+	{
+		console->streaming = (streaming != 0);
+		return_code = 1;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Console_set_streaming.  Missing console");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Console_set_streaming */
+
+int Console_get_statistics(struct Console *console, int *number_of_commands,
+	double *seconds)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Returns the <number_of_commands> executed by the <console> and the <seconds>
+from the start of the first batch of commands to the end of the last.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Console_get_statistics);
+	if (console && number_of_commands && seconds)
+	{
+		*number_of_commands = console->number_of_commands;
+		*seconds = console->end_seconds - console->start_seconds;
+		return_code = 1;
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Console_get_statistics.  Invalid argument(s)");
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Console_get_statistics */
+
+int Console_list_statistics(struct Console *console)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Writes the number of commands executed by the <console> and the rate they were
+processed at.
+==============================================================================*/
+{
+	double seconds;
+	int number_of_commands, return_code;
+
+	ENTER(Console_list_statistics);
+	if (Console_get_statistics(console, &number_of_commands, &seconds))
+	{
+		if (0.0 < seconds)
+		{
+			display_message(INFORMATION_MESSAGE,
+				"Console:  %d commands in %g seconds (%g commands per second)\n",
+				number_of_commands, seconds, (double)number_of_commands/seconds);
+		}
+		else
+		{
+			display_message(INFORMATION_MESSAGE,
+				"Console:  %d commands\n", number_of_commands);
+		}
+		return_code = 1;
+	}
+	else
+	{
+		return_code = 0;
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Console_list_statistics */
@@ -31,9 +31,12 @@ Global functions
 struct Console *CREATE(Console)(struct Execute_command *execute_command, 
 	struct Event_dispatcher *event_dispatcher, int file_descriptor);
 /*******************************************************************************
-LAST MODIFIED : 27 June 2002
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
+Creates a console executing command lines read from <file_descriptor>. If the
+descriptor is not a terminal, e.g. commands are piped in, the console starts in
+streaming mode.
 ==============================================================================*/
 
 int DESTROY(Console)(struct Console **console_pointer);
@@ -51,4 +54,34 @@ LAST MODIFIED : 27 June 2002
 DESCRIPTION :
 Sets the value of the <prompt> for the <console>.
 ==============================================================================*/
+
+int Console_set_streaming(struct Console *console, int streaming);
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Sets whether the <console> reads a stream of commands rather than interactive
+input. In streaming mode all available input is read on each wakeup, the prompt
+is not echoed, and at end of input any unterminated last line is executed and
+the command rate is reported.
+==============================================================================*/
+
+int Console_get_statistics(struct Console *console, int *number_of_commands,
+	double *seconds);
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Returns the <number_of_commands> executed by the <console> and the <seconds>
+from the start of the first batch of commands to the end of the last.
+==============================================================================*/
+
+int Console_list_statistics(struct Console *console);
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Writes the number of commands executed by the <console> and the rate they were
+processed at.
+==============================================================================*/
 #endif /* !defined (CONSOLE_H) */
@@ -55,8 +55,27 @@ DESCRIPTION :
 	/* store suboption_tables added to table for destroying with option_table */
 	int number_of_suboption_tables;
 	struct Option_table **suboption_tables;
+	/* set once the terminating blank entry has been added */
+	int terminated;
+	/* sorted index of reduced option tokens, built by Option_table_compile for
+	   tables which are parsed many times */
+	int number_of_lookup_keys;
+	struct Option_table_lookup_key *lookup_keys;
 }; /* struct Option_table */
 
+/***************************************************************************//**
+ * Entry in the sorted token index of a compiled Option_table. The key is the
+ * option token reduced to the form compared by fuzzy_string_compare, i.e.
+ * upper case with whitespace, dashes and underscores removed. Entry is NULL if
+ * more than one option reduces to the same key; these are left to
+ * process_option to report.
+ */
+struct Option_table_lookup_key
+{
+	char *key;
+	struct Modifier_entry *entry;
+};
+
 enum Variable_operation_type
 {
 	ADD_VARIABLE_OPERATION,
@@ -995,6 +1014,9 @@ Creates an Option_table for text parsing.
 		/* store suboption_tables added to table for destroying with option_table */
 		option_table->number_of_suboption_tables = 0;
 		option_table->suboption_tables = (struct Option_table **)NULL;
+		option_table->terminated = 0;
+		option_table->number_of_lookup_keys = 0;
+		option_table->lookup_keys = (struct Option_table_lookup_key *)NULL;
 	}
 	else
 	{
@@ -1039,6 +1061,14 @@ DESCRIPTION :
 			{
 				DEALLOCATE(option_table->help);
 			}
+			if (option_table->lookup_keys)
+			{
+				for (i=0;i<option_table->number_of_lookup_keys;i++)
+				{
+					DEALLOCATE(option_table->lookup_keys[i].key);
+				}
+				DEALLOCATE(option_table->lookup_keys);
+			}
 			if (option_table->entry)
 			{
 				DEALLOCATE(option_table->entry);
@@ -1073,6 +1103,14 @@ If fails, marks the option_table as invalid.
 	if (option_table)
 	{
 		return_code=1;
+		if (option_table->lookup_keys)
+		{
+			display_message(ERROR_MESSAGE,
+				"Option_table_add_entry_private.  Cannot add to compiled option table");
+			option_table->valid=0;
+			LEAVE;
+			return (0);
+		}
 		if (token)
 		{
 			i=0;
@@ -1126,6 +1164,106 @@ If fails, marks the option_table as invalid.
 	return (return_code);
 } /* Option_table_add_entry_private */
 
+/***************************************************************************//**
+ * Adds the blank entry needed for process_option to the end of the option
+ * table, if not already added. Allows the same table to be parsed repeatedly.
+ */
+static void Option_table_terminate(struct Option_table *option_table)
+{
+	if (!option_table->terminated)
+	{
+		Option_table_add_entry_private(option_table,(char *)NULL,(void *)NULL,
+			(void *)NULL,(modifier_function)NULL);
+		option_table->terminated = 1;
+	}
+}
+
+int fuzzy_string_reduce(const char *string, char *reduced_string)
+{
+	int length = 0;
+	for (const char *c = string; *c; c++)
+	{
+		if (!(isspace((unsigned char)*c) || ('-' == *c) || ('_' == *c)))
+		{
+			if (length >= FUZZY_STRING_MAXIMUM_REDUCED_LENGTH)
+			{
+				return 0;
+			}
+			reduced_string[length] = (char)toupper((unsigned char)*c);
+			length++;
+		}
+	}
+	reduced_string[length] = '\0';
+	return 1;
+}
+
+static int Option_table_lookup_key_compare(const void *first_void,
+	const void *second_void)
+{
+	return strcmp(
+		static_cast<const struct Option_table_lookup_key *>(first_void)->key,
+		static_cast<const struct Option_table_lookup_key *>(second_void)->key);
+}
+
+/***************************************************************************//**
+ * Sets <lookup_key> to the reduced token of <entry>.
+ * @return  1 on success, 0 if failed.
+ */
+static int Option_table_lookup_key_set(
+	struct Option_table_lookup_key *lookup_key, struct Modifier_entry *entry)
+{
+	char key[FUZZY_STRING_MAXIMUM_REDUCED_LENGTH + 1];
+	if (fuzzy_string_reduce(entry->option, key) &&
+		(0 != (lookup_key->key = duplicate_string(key))))
+	{
+		lookup_key->entry = entry;
+		return 1;
+	}
+	return 0;
+}
+
+/***************************************************************************//**
+ * Finds the single entry of a compiled <option_table> whose token exactly
+ * matches <token> under fuzzy comparison.
+ * @return  Matching entry, or NULL if no unique exact match, in which case the
+ * caller must defer to process_option for partial matching, default entries
+ * and error reporting.
+ */
+static struct Modifier_entry *Option_table_find_exact_entry(
+	struct Option_table *option_table, const char *token)
+{
+	char key[FUZZY_STRING_MAXIMUM_REDUCED_LENGTH + 1];
+	if (!fuzzy_string_reduce(token, key))
+	{
+		return 0;
+	}
+	int low = 0;
+	int high = option_table->number_of_lookup_keys - 1;
+	while (low <= high)
+	{
+		const int middle = (low + high)/2;
+		const int compare = strcmp(key, option_table->lookup_keys[middle].key);
+		if (compare < 0)
+		{
+			high = middle - 1;
+		}
+		else if (compare > 0)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			struct Modifier_entry *entry = option_table->lookup_keys[middle].entry;
+			if (entry && fuzzy_string_compare_same_length(token, entry->option))
+			{
+				return entry;
+			}
+			return 0;
+		}
+	}
+	return 0;
+}
+
 int Option_table_add_help(struct Option_table *option_table,
 	const char *help_string)
 /*******************************************************************************
@@ -1213,8 +1351,7 @@ of option_table!
 	if (option_table&&suboption_table)
 	{
 		/* add blank entry needed for process_option */
-		Option_table_add_entry_private(suboption_table,(char *)NULL,(void *)NULL,
-			(void *)NULL,(modifier_function)NULL);
+		Option_table_terminate(suboption_table);
 		if (suboption_table->valid)
 		{
 			if (REALLOCATE(temp_suboption_tables,option_table->suboption_tables,
@@ -1489,11 +1626,36 @@ entered.
 	if (option_table&&state)
 	{
 		/* add blank entry needed for process_option */
-		Option_table_add_entry_private(option_table,(char *)NULL,(void *)NULL,
-			(void *)NULL,(modifier_function)NULL);
+		Option_table_terminate(option_table);
 		if (option_table->valid)
 		{
-			return_code=process_option(state,option_table->entry);
+			struct Modifier_entry *entry = (struct Modifier_entry *)NULL;
+			if (option_table->lookup_keys && state->current_token)
+			{
+				entry = Option_table_find_exact_entry(option_table,
+					state->current_token);
+			}
+			if (entry)
+			{
+				/* fast path for compiled tables: equivalent to process_option with
+				   a single exact match */
+				exclusive_option++;
+				if (shift_Parse_state(state, 1))
+				{
+					return_code = (entry->modifier)(state, entry->to_be_modified,
+						entry->user_data);
+				}
+				else
+				{
+					display_message(ERROR_MESSAGE,"Option_table_parse.  Error parsing");
+					return_code = 0;
+				}
+				exclusive_option--;
+			}
+			else
+			{
+				return_code=process_option(state,option_table->entry);
+			}
 		}
 		else
 		{
@@ -1569,8 +1731,7 @@ entered.
 			}
 		}
 		/* add blank entry needed for process_option */
-		Option_table_add_entry_private(option_table,(char *)NULL,(void *)NULL,
-			(void *)NULL,(modifier_function)NULL);
+		Option_table_terminate(option_table);
 		if (option_table->valid)
 		{
 			return_code=process_multiple_options(state,option_table->entry);
@@ -1593,6 +1754,95 @@ entered.
 	return (return_code);
 } /* Option_table_multi_parse */
 
+int Option_table_compile(struct Option_table *option_table)
+{
+	int return_code = 0;
+	if (option_table && option_table->valid && !option_table->lookup_keys)
+	{
+		Option_table_terminate(option_table);
+		int number_of_keys = 0;
+		struct Modifier_entry *entry, *sub_entry;
+		for (entry = option_table->entry;
+			(entry->option) || ((entry->user_data) && !(entry->modifier)); entry++)
+		{
+			if (entry->option)
+			{
+				number_of_keys++;
+			}
+			else
+			{
+				for (sub_entry = (struct Modifier_entry *)(entry->user_data);
+					sub_entry->option; sub_entry++)
+				{
+					number_of_keys++;
+				}
+			}
+		}
+		struct Option_table_lookup_key *lookup_keys;
+		if ((0 < number_of_keys) &&
+			ALLOCATE(lookup_keys, struct Option_table_lookup_key, number_of_keys))
+		{
+			int number_of_lookup_keys = 0;
+			return_code = 1;
+			for (entry = option_table->entry; return_code &&
+				((entry->option) || ((entry->user_data) && !(entry->modifier))); entry++)
+			{
+				if (entry->option)
+				{
+					return_code = Option_table_lookup_key_set(
+						&lookup_keys[number_of_lookup_keys], entry);
+					number_of_lookup_keys += return_code;
+				}
+				else
+				{
+					for (sub_entry = (struct Modifier_entry *)(entry->user_data);
+						return_code && sub_entry->option; sub_entry++)
+					{
+						return_code = Option_table_lookup_key_set(
+							&lookup_keys[number_of_lookup_keys], sub_entry);
+						number_of_lookup_keys += return_code;
+					}
+				}
+			}
+			if (return_code)
+			{
+				qsort(lookup_keys, number_of_lookup_keys,
+					sizeof(struct Option_table_lookup_key), Option_table_lookup_key_compare);
+				/* repeated keys are not unique exact matches */
+				for (int i = 1; i < number_of_lookup_keys; i++)
+				{
+					if (0 == strcmp(lookup_keys[i - 1].key, lookup_keys[i].key))
+					{
+						lookup_keys[i - 1].entry = (struct Modifier_entry *)NULL;
+						lookup_keys[i].entry = (struct Modifier_entry *)NULL;
+					}
+				}
+				option_table->number_of_lookup_keys = number_of_lookup_keys;
+				option_table->lookup_keys = lookup_keys;
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE,
+					"Option_table_compile.  Could not build token index");
+				for (int i = 0; i < number_of_lookup_keys; i++)
+				{
+					DEALLOCATE(lookup_keys[i].key);
+				}
+				DEALLOCATE(lookup_keys);
+			}
+		}
+		else if (0 < number_of_keys)
+		{
+			display_message(ERROR_MESSAGE, "Option_table_compile.  Not enough memory");
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "Option_table_compile.  Invalid argument(s)");
+	}
+	return (return_code);
+}
+
 static int extract_token(char **source_address,char **token_address)
 /*******************************************************************************
 LAST MODIFIED : 11 September 2002
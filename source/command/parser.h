@@ -129,6 +129,18 @@ Same as fuzzy_string_compare except that the two reduced strings must be the
 same length.
 ==============================================================================*/
 
+/* longest reduced string fuzzy_string_reduce writes */
+#define FUZZY_STRING_MAXIMUM_REDUCED_LENGTH 256
+
+/***************************************************************************//**
+ * Writes <string> reduced to the form compared by fuzzy_string_compare, i.e.
+ * upper case with whitespace, dashes and underscores removed, into
+ * <reduced_string>, which must be FUZZY_STRING_MAXIMUM_REDUCED_LENGTH + 1 chars
+ * long. Lets callers index strings for exact fuzzy matching.
+ * @return  1 on success, 0 if string is too long to be reduced.
+ */
+int fuzzy_string_reduce(const char *string, char *reduced_string);
+
 int process_option(struct Parse_state *state,
 	struct Modifier_entry *modifier_table);
 /*******************************************************************************
@@ -271,6 +283,18 @@ Parses the options in the <option_table>, giving all options a chance to be
 entered.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Prepares a fully populated <option_table> for being parsed many times, as
+ * for the fixed command tree built once per command data. Builds a sorted index
+ * of the reduced option tokens so Option_table_parse resolves a unique exact
+ * token match by binary search instead of fuzzy comparison with every entry.
+ * Partial matches, ambiguities, help and default entries still go through
+ * process_option. No entries may be added after compiling.
+ * @return  1 on success, 0 on failure in which case the table is still usable
+ * but uncompiled.
+ */
+int Option_table_compile(struct Option_table *option_table);
+
 struct Parse_state *create_Parse_state(const char *command_string);
 /*******************************************************************************
 LAST MODIFIED : 12 June 1996
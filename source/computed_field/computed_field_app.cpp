@@ -5,6 +5,9 @@
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include <stdio.h>
+#include <algorithm>
+#include <string>
+#include <vector>
 
 #include "general/message.h"
 #include "general/mystring.h"
@@ -32,6 +35,8 @@ accessed by the rest of the program.
 	Define_Computed_field_type_function define_Computed_field_type_function;
 	Computed_field_type_package *define_type_user_data;
 	int access_count;
+	/* number of fields defined with this type */
+	int usage_count;
 };
 
 PROTOTYPE_OBJECT_FUNCTIONS(Computed_field_type_data);
@@ -39,6 +44,155 @@ PROTOTYPE_OBJECT_FUNCTIONS(Computed_field_type_data);
 DECLARE_LIST_TYPES(Computed_field_type_data);
 PROTOTYPE_LIST_FUNCTIONS(Computed_field_type_data);
 
+/***************************************************************************//**
+ * Persistent index of the computed field types registered with the package,
+ * resolving the type token of gfx define field without building an option
+ * table of all types per command. Keys are type names reduced as compared by
+ * fuzzy_string_compare: upper case without whitespace, dashes or underscores.
+ * Exact keys are found by hash; unique prefixes by binary search of the sorted
+ * keys. Tokens matching no type or several are left to the option table so
+ * help and error messages are unchanged.
+ */
+class Computed_field_type_registry
+{
+	struct Type_key
+	{
+		std::string key;
+		Computed_field_type_data *type;
+
+		bool operator<(const Type_key& other) const
+		{
+			return key < other.key;
+		}
+	};
+
+	/* sorted by key */
+	std::vector<Type_key> type_keys;
+	/* hash buckets of indexes into type_keys, rebuilt after types change */
+	std::vector< std::vector<int> > buckets;
+	bool buckets_valid;
+
+	static unsigned int hashKey(const std::string& key)
+	{
+		/* FNV-1a */
+		unsigned int hash = 2166136261u;
+		for (size_t i = 0; i < key.size(); ++i)
+		{
+			hash ^= static_cast<unsigned char>(key[i]);
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+
+	void buildBuckets()
+	{
+		size_t number_of_buckets = 16;
+		while (number_of_buckets < 2*type_keys.size())
+			number_of_buckets *= 2;
+		buckets.assign(number_of_buckets, std::vector<int>());
+		for (size_t i = 0; i < type_keys.size(); ++i)
+			buckets[hashKey(type_keys[i].key) & (number_of_buckets - 1)].push_back(static_cast<int>(i));
+		buckets_valid = true;
+	}
+
+public:
+	/* number of tokens resolved by exact key, by unique prefix, and left to the
+	 * option table */
+	int exact_lookups, prefix_lookups, option_table_lookups;
+
+	Computed_field_type_registry() :
+		buckets_valid(false),
+		exact_lookups(0),
+		prefix_lookups(0),
+		option_table_lookups(0)
+	{
+	}
+
+	/**
+	 * Reduces token to key form with fuzzy_string_reduce.
+	 * @return  false if token is too long or reduces to nothing.
+	 */
+	static bool reduceToken(const char *token, std::string& key)
+	{
+		char reduced_token[FUZZY_STRING_MAXIMUM_REDUCED_LENGTH + 1];
+		if (!fuzzy_string_reduce(token, reduced_token))
+		{
+			key.clear();
+			return false;
+		}
+		key = reduced_token;
+		return !key.empty();
+	}
+
+	bool addType(Computed_field_type_data *type)
+	{
+		Type_key type_key;
+		if (!reduceToken(type->name, type_key.key))
+			return false;
+		type_key.type = type;
+		type_keys.insert(std::upper_bound(type_keys.begin(), type_keys.end(), type_key), type_key);
+		buckets_valid = false;
+		return true;
+	}
+
+	void clear()
+	{
+		type_keys.clear();
+		buckets.clear();
+		buckets_valid = false;
+	}
+
+	/**
+	 * @return  The single type whose name matches token exactly, or failing
+	 * that the single type the token is a prefix of, otherwise NULL.
+	 */
+	Computed_field_type_data *findType(const char *token)
+	{
+		std::string key;
+		if (!reduceToken(token, key))
+			return 0;
+		if (!buckets_valid)
+			buildBuckets();
+		const std::vector<int>& bucket = buckets[hashKey(key) & (buckets.size() - 1)];
+		Computed_field_type_data *exact_type = 0;
+		int number_of_exact_matches = 0;
+		for (size_t i = 0; i < bucket.size(); ++i)
+		{
+			const Type_key& type_key = type_keys[bucket[i]];
+			if ((type_key.key == key) &&
+				fuzzy_string_compare_same_length(token, type_key.type->name))
+			{
+				exact_type = type_key.type;
+				++number_of_exact_matches;
+			}
+		}
+		if (1 == number_of_exact_matches)
+		{
+			++exact_lookups;
+			return exact_type;
+		}
+		if (0 == number_of_exact_matches)
+		{
+			Type_key search_key;
+			search_key.key = key;
+			std::vector<Type_key>::const_iterator iter =
+				std::lower_bound(type_keys.begin(), type_keys.end(), search_key);
+			if ((iter != type_keys.end()) && (0 == iter->key.compare(0, key.size(), key)))
+			{
+				std::vector<Type_key>::const_iterator next_iter = iter + 1;
+				if ((next_iter == type_keys.end()) ||
+					(0 != next_iter->key.compare(0, key.size(), key)))
+				{
+					++prefix_lookups;
+					return iter->type;
+				}
+			}
+		}
+		++option_table_lookups;
+		return 0;
+	}
+};
+
 struct Computed_field_package
 /*******************************************************************************
 LAST MODIFIED : 14 August 2006
@@ -52,6 +206,7 @@ from the appropriate cmzn_region.
 {
 	struct MANAGER(Computed_field) *computed_field_manager;
 	struct LIST(Computed_field_type_data) *computed_field_type_list;
+	Computed_field_type_registry *type_registry;
 	Computed_field_simple_package *simple_package;
 }; /* struct Computed_field_package */
 
@@ -78,6 +233,7 @@ manager from the respective cmzn_region.
 			computed_field_package->computed_field_manager=computed_field_manager;
 			computed_field_package->computed_field_type_list =
 				CREATE(LIST(Computed_field_type_data))();
+			computed_field_package->type_registry = new Computed_field_type_registry();
 			computed_field_package->simple_package =
 				new Computed_field_simple_package();
 			computed_field_package->simple_package->addref();
@@ -116,6 +272,7 @@ Cancels any further messages from managers.
 	{
 		/* not destroying field manager as not owned by package */
 		computed_field_package->simple_package->removeref();
+		delete computed_field_package->type_registry;
 		DESTROY(LIST(Computed_field_type_data))(&computed_field_package->computed_field_type_list);
 		DEALLOCATE(*package_address);
 		return_code = 1;
@@ -217,6 +374,7 @@ the define_computed_field option table when needed.
 				define_Computed_field_type_function;
 			type_data->define_type_user_data = define_type_user_data;
 			type_data->access_count = 0;
+			type_data->usage_count = 0;
 		}
 		else
 		{
@@ -287,6 +445,24 @@ struct Add_type_to_option_table_data
 	void *computed_field_package_void;
 };
 
+/**
+ * Modifier function defining a field with the type in <type_data_void>,
+ * counting its use unless only help was requested.
+ */
+static int Computed_field_type_data_define(struct Parse_state *state,
+	void *field_modify_void, void *type_data_void)
+{
+	Computed_field_type_data *type = static_cast<Computed_field_type_data *>(type_data_void);
+	const bool help = (0 != state->current_token) &&
+		((0 == strcmp(PARSER_HELP_STRING, state->current_token)) ||
+			(0 == strcmp(PARSER_RECURSIVE_HELP_STRING, state->current_token)));
+	int return_code = (type->define_Computed_field_type_function)(state,
+		field_modify_void, (void *)type->define_type_user_data);
+	if (return_code && !help)
+		++(type->usage_count);
+	return (return_code);
+}
+
 static int Computed_field_add_type_to_option_table(struct Computed_field_type_data *type,
 	void *add_type_to_option_table_data_void)
 /*******************************************************************************
@@ -304,9 +480,8 @@ Adds <type> to the <option_table> so it is available to the commands.
 		add_type_to_option_table_data_void))
 	{
 		Option_table_add_entry(data->option_table,type->name,
-			(void *)data->field_modify,
-			type->define_type_user_data,
-			type->define_Computed_field_type_function);
+			(void *)data->field_modify, (void *)type,
+			Computed_field_type_data_define);
 		return_code=1;
 	}
 	else
@@ -330,12 +505,15 @@ Part of the group of define_Computed_field functions. Here, we already have the
 <field> to be modified and have determined the number of components and
 coordinate system, and must now determine the type of computed field function
 and its parameter fields and values.
+The type is found in the package's type registry; an option table of all types
+is only built for help, or to report unknown or ambiguous types.
 ==============================================================================*/
 {
 	int return_code;
 	struct Add_type_to_option_table_data data;
 	Computed_field_modify_data *field_modify;
 	struct Computed_field_package *computed_field_package;
+	struct Computed_field_type_data *type;
 	struct Option_table *option_table;
 
 	ENTER(define_Computed_field_type);
@@ -343,7 +521,21 @@ and its parameter fields and values.
 		(computed_field_package=(struct Computed_field_package *)
 			computed_field_package_void))
 	{
-		if (state->current_token)
+		if (state->current_token && strcmp(PARSER_HELP_STRING, state->current_token) &&
+			strcmp(PARSER_RECURSIVE_HELP_STRING, state->current_token) &&
+			(0 != (type = computed_field_package->type_registry->findType(state->current_token))))
+		{
+			if (shift_Parse_state(state, 1))
+			{
+				return_code = Computed_field_type_data_define(state, field_modify_void, (void *)type);
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE, "define_Computed_field_type.  Error parsing");
+				return_code = 0;
+			}
+		}
+		else if (state->current_token)
 		{
 			option_table=CREATE(Option_table)();
 			/* new_types */
@@ -861,6 +1053,11 @@ define_Computed_field_type option table when parsing commands.
 			data->define_type_user_data->addref();
 			return_code = ADD_OBJECT_TO_LIST(Computed_field_type_data)(data,
 				computed_field_package->computed_field_type_list);
+			if (return_code && !computed_field_package->type_registry->addType(data))
+			{
+				display_message(ERROR_MESSAGE,
+					"Computed_field_package_add_type.  Could not index type %s", name);
+			}
 		}
 		else
 		{
@@ -902,6 +1099,7 @@ Unregisters each of the computed field types added.
 			REMOVE_OBJECT_FROM_LIST(Computed_field_type_data)(data,
 				computed_field_package->computed_field_type_list);
 		}
+		computed_field_package->type_registry->clear();
 		return_code = 1;
 	}
 	else
@@ -914,3 +1112,80 @@ Unregisters each of the computed field types added.
 	return (return_code);
 } /* Computed_field_package_add_type */
 
+namespace {
+
+struct Computed_field_type_usage
+{
+	const char *name;
+	int usage_count;
+
+	bool operator<(const Computed_field_type_usage& other) const
+	{
+		return (usage_count > other.usage_count) ||
+			((usage_count == other.usage_count) && (strcmp(name, other.name) < 0));
+	}
+};
+
+int Computed_field_type_data_get_usage(struct Computed_field_type_data *type,
+	void *usage_vector_void)
+{
+	Computed_field_type_usage usage;
+	usage.name = type->name;
+	usage.usage_count = type->usage_count;
+	static_cast<std::vector<Computed_field_type_usage> *>(usage_vector_void)->push_back(usage);
+	return 1;
+}
+
+}
+
+int gfx_list_field_types(struct Parse_state *state,
+	void *dummy_to_be_modified, void *computed_field_package_void)
+{
+	int return_code = 0;
+	USE_PARAMETER(dummy_to_be_modified);
+	struct Computed_field_package *computed_field_package =
+		static_cast<struct Computed_field_package *>(computed_field_package_void);
+	if (state && computed_field_package)
+	{
+		char statistics_flag = 0;
+		struct Option_table *option_table = CREATE(Option_table)();
+		Option_table_add_help(option_table,
+			"List the field types available to gfx define field. With 'statistics', "
+			"also list how many fields were defined with each type and how type "
+			"names were resolved.");
+		Option_table_add_char_flag_entry(option_table, "statistics", &statistics_flag);
+		return_code = Option_table_multi_parse(option_table, state);
+		DESTROY(Option_table)(&option_table);
+		if (return_code)
+		{
+			std::vector<Computed_field_type_usage> usages;
+			FOR_EACH_OBJECT_IN_LIST(Computed_field_type_data)(
+				Computed_field_type_data_get_usage, (void *)&usages,
+				computed_field_package->computed_field_type_list);
+			if (statistics_flag)
+			{
+				const Computed_field_type_registry *registry = computed_field_package->type_registry;
+				std::sort(usages.begin(), usages.end());
+				display_message(INFORMATION_MESSAGE,
+					"%d field types. Type lookups: %d exact, %d by prefix, %d by option table\n",
+					static_cast<int>(usages.size()), registry->exact_lookups,
+					registry->prefix_lookups, registry->option_table_lookups);
+				for (size_t i = 0; i < usages.size(); ++i)
+				{
+					display_message(INFORMATION_MESSAGE, "  %-32s %d\n",
+						usages[i].name, usages[i].usage_count);
+				}
+			}
+			else
+			{
+				for (size_t i = 0; i < usages.size(); ++i)
+					display_message(INFORMATION_MESSAGE, "  %s\n", usages[i].name);
+			}
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "gfx_list_field_types.  Invalid argument(s)");
+	}
+	return (return_code);
+}
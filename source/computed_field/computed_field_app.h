@@ -105,6 +105,14 @@ DESCRIPTION :
 Unregisters each of the computed field types added.
 ==============================================================================*/
 
+/**
+ * Executes a GFX LIST FIELD_TYPES command, listing the types of field which
+ * can be defined and optionally their usage statistics.
+ * @param computed_field_package_void  The Computed_field_package.
+ */
+int gfx_list_field_types(struct Parse_state *state,
+	void *dummy_to_be_modified, void *computed_field_package_void);
+
 struct MANAGER(Computed_field) * Computed_field_package_get_computed_field_manager(struct Computed_field_package *computed_field_package);
 /*******************************************************************************
 LAST MODIFIED : 3 February 1999
@@ -18,6 +18,8 @@
 
 #cmakedefine USE_PERL_INTERPRETER
 
+#cmakedefine USE_ZLIB
+
 #cmakedefine WIN32_SYSTEM
 
 #endif
@@ -22,6 +22,7 @@ group of nodes
 #include <time.h>
 #include "zinc/element.h"
 #include "zinc/fieldmodule.h"
+#include "zinc/node.h"
 #include "zinc/fieldsubobjectgroup.h"
 #include "zinc/region.h"
 #include "command/command.h"
@@ -52,6 +53,9 @@ Module constants
 */
 #define SLIDER_RESOLUTION (1000)
 #define SOLID_BODY_MODES (6)
+/* number of node coordinate values reconstructed together, sized so a block
+	of values stays in cache while all modes are accumulated into it */
+#define EMOTER_RECONSTRUCTION_BLOCK_SIZE (512)
 
 /*
 Module types
@@ -83,6 +87,12 @@ DESCRIPTION :
 #endif /* defined (USE_CMGUI_GRAPHICS_WINDOW) */
 	struct MANAGER(Curve) *curve_manager;
 	struct EM_Object *em_object;
+	/* nodes for em_object->index resolved on first update, and workspace for
+		their reconstructed coordinates */
+	cmzn_node_id *nodes;
+	double *node_values;
+	/* clears the cached nodes when nodes in region are removed or renumbered */
+	cmzn_fieldmodulenotifier_id fieldmodulenotifier;
 	int transform_graphics;
 	struct Scene *viewer_scene;
 	struct User_interface *user_interface;
@@ -171,6 +181,140 @@ Both or either of <sequence_filename> or <existing_mode_curve> can be NULL.
 Declared here because of circular recursive function calling.
 ==============================================================================*/
 
+/***************************************************************************//**
+ * Accumulates weighted mode shapes into values, blocked over values so each
+ * block stays in cache. Modes are stored mode by mode with stride mode_stride,
+ * so the inner loop is contiguous and vectorises without reordering the sum.
+ */
+static void emoter_reconstruct_values(int number_of_values, int mode_stride,
+	int number_of_modes, const double *modes, const double *weights,
+	double *values)
+{
+	for (int block_start = 0; block_start < number_of_values;
+		block_start += EMOTER_RECONSTRUCTION_BLOCK_SIZE)
+	{
+		int block_size = number_of_values - block_start;
+		if (block_size > EMOTER_RECONSTRUCTION_BLOCK_SIZE)
+		{
+			block_size = EMOTER_RECONSTRUCTION_BLOCK_SIZE;
+		}
+		double *block_values = values + block_start;
+		for (int i = 0; i < block_size; i++)
+		{
+			block_values[i] = 0.0;
+		}
+		const double *mode = modes + block_start;
+		for (int k = 0; k < number_of_modes; k++)
+		{
+			const double weight = weights[k];
+			for (int i = 0; i < block_size; i++)
+			{
+				block_values[i] += mode[i]*weight;
+			}
+			mode += mode_stride;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * Releases the cached nodes and coordinate workspace.
+ */
+static void emoter_clear_node_cache(struct Shared_emoter_slider_data *shared_data)
+{
+	if (shared_data->nodes)
+	{
+		for (int i = 0; i < shared_data->em_object->n_nodes; i++)
+		{
+			cmzn_node_destroy(&(shared_data->nodes[i]));
+		}
+		DEALLOCATE(shared_data->nodes);
+	}
+	if (shared_data->node_values)
+	{
+		DEALLOCATE(shared_data->node_values);
+	}
+}
+
+/***************************************************************************//**
+ * Field module callback for the emoter's region. Clears the cached nodes if
+ * any nodes are removed or change identifier, so they are found again by
+ * identifier on the next update. Changes to node field values, including
+ * those made by the emoter, keep the cache.
+ */
+static void emoter_fieldmoduleevent(cmzn_fieldmoduleevent_id event,
+	void *shared_data_void)
+{
+	struct Shared_emoter_slider_data *shared_data =
+		static_cast<struct Shared_emoter_slider_data *>(shared_data_void);
+	if (event && shared_data && shared_data->nodes)
+	{
+		cmzn_fieldmodule_id fieldmodule = cmzn_region_get_fieldmodule(shared_data->region);
+		cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(fieldmodule,
+			CMZN_FIELD_DOMAIN_TYPE_NODES);
+		cmzn_nodesetchanges_id nodesetchanges = cmzn_fieldmoduleevent_get_nodesetchanges(event, nodeset);
+		if (0 != (cmzn_nodesetchanges_get_summary_node_change_flags(nodesetchanges) &
+			(CMZN_NODE_CHANGE_FLAG_REMOVE | CMZN_NODE_CHANGE_FLAG_IDENTIFIER)))
+		{
+			emoter_clear_node_cache(shared_data);
+		}
+		cmzn_nodesetchanges_destroy(&nodesetchanges);
+		cmzn_nodeset_destroy(&nodeset);
+		cmzn_fieldmodule_destroy(&fieldmodule);
+	}
+}
+
+/***************************************************************************//**
+ * Resolves and caches the nodes for the emoter's node identifiers so they are
+ * not looked up on every update.
+ * @return  1 on success, 0 if any node is not found.
+ */
+static int emoter_cache_nodes(struct Shared_emoter_slider_data *shared_data,
+	cmzn_nodeset_id nodeset)
+{
+	int i, number_of_nodes, return_code;
+	struct EM_Object *em_object;
+
+	return_code = 1;
+	if (!shared_data->nodes)
+	{
+		em_object = shared_data->em_object;
+		number_of_nodes = em_object->n_nodes;
+		if (ALLOCATE(shared_data->nodes, cmzn_node_id, number_of_nodes))
+		{
+			for (i = 0; i < number_of_nodes; i++)
+			{
+				shared_data->nodes[i] = (cmzn_node_id)NULL;
+			}
+		}
+		if (shared_data->nodes &&
+			ALLOCATE(shared_data->node_values, double, 3*number_of_nodes))
+		{
+			for (i = 0; i < number_of_nodes; i++)
+			{
+				shared_data->nodes[i] = cmzn_nodeset_find_node_by_identifier(nodeset,
+					(em_object->index)[i]);
+				if (!shared_data->nodes[i])
+				{
+					display_message(ERROR_MESSAGE,
+						"emoter_cache_nodes.  Unknown node %d", (em_object->index)[i]);
+					return_code = 0;
+				}
+			}
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE,
+				"emoter_cache_nodes.  Unable to allocate node cache");
+			return_code = 0;
+		}
+		if (!return_code)
+		{
+			emoter_clear_node_cache(shared_data);
+		}
+	}
+	return (return_code);
+}
+
 static int emoter_update_nodes(struct Shared_emoter_slider_data *shared_data,
 	int solid_body_motion )
 /*******************************************************************************
@@ -181,10 +325,10 @@ Updates the node locations for the <emoter_slider>
 ==============================================================================*/
 {
 	char input_filename[200];
-	double position[3], temp_two, temp_cos, temp_sin, *u,*weights;
+	double *position, temp_two, temp_cos, temp_sin, *weights;
 	float euler_angles[3];
 	gtMatrix transformation; /* 4 x 4 */
-	int i,j,k,offset,return_code,versions;
+	int i,j,k,return_code,versions;
 	struct cmzn_region *input_sequence;
 	struct FE_field *field;
 	struct FE_node *node;
@@ -201,8 +345,8 @@ Updates the node locations for the <emoter_slider>
 			cmzn_fieldmodule_id fieldmodule = cmzn_region_get_fieldmodule(shared_data->region);
 			cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(fieldmodule,
 				CMZN_FIELD_DOMAIN_TYPE_NODES);
-			if ((node = cmzn_nodeset_find_node_by_identifier(nodeset, (em_object->index)[0])) &&
-				(field=get_FE_node_default_coordinate_field(node)))
+			if (emoter_cache_nodes(shared_data, nodeset) &&
+				(field=get_FE_node_default_coordinate_field(shared_data->nodes[0])))
 			{
 				/* Read from an input sequence which the emoter is overriding */
 				if (shared_data->input_sequence)
@@ -267,80 +411,61 @@ Updates the node locations for the <emoter_slider>
 					cmzn_scene_set_transformation(scene, &transformation);
 					cmzn_scene_destroy(&scene);
 				}
+				/* reconstruct all node coordinates at once, then transform and
+					store them node by node */
+				emoter_reconstruct_values(3*em_object->n_nodes, em_object->m,
+					shared_data->mode_limit, em_object->u,
+					shared_data->weights + SOLID_BODY_MODES, shared_data->node_values);
 				i=0;
-				offset=em_object->m;
 				while (return_code&&(i<em_object->n_nodes))
 				{
-					if ((node = cmzn_nodeset_find_node_by_identifier(nodeset, (em_object->index)[i])))
+					node = shared_data->nodes[i];
+					position = shared_data->node_values + 3*i;
+					if ( solid_body_motion )
 					{
-						position[0] = 0;
-						position[1] = 0;
-						position[2] = 0;
-						u=(em_object->u)+(3*i);
-						weights=shared_data->weights + SOLID_BODY_MODES;
-						for (k=shared_data->mode_limit;k>0;k--)
+						if (!shared_data->transform_graphics)
 						{
-							position[0] += u[0]*(*weights);
-							position[1] += u[1]*(*weights);
-							position[2] += u[2]*(*weights);
-							u += offset;
-							weights++;
-						}
-
-						if ( solid_body_motion )
-						{
-							if (!shared_data->transform_graphics)
-							{
-								/* Need to apply rotations in reverse order */
-								weights = shared_data->weights + 5;
-								temp_sin = sin( -*weights );
-								temp_cos = cos( -*weights );
-								temp_two = temp_cos * position[0] - temp_sin * position[1];
-								position[1] = temp_sin * position[0] + temp_cos * position[1];
-								position[0] = temp_two;
-								weights--;
-
-								temp_sin = sin( -*weights );
-								temp_cos = cos( -*weights );
-								temp_two = temp_cos * position[2] - temp_sin * position[0];
-								position[0] = temp_sin * position[2] + temp_cos * position[0];
-								position[2] = temp_two;
-								weights--;
-
-								temp_sin = sin( -*weights );
-								temp_cos = cos( -*weights );
-								temp_two = temp_cos * position[1] - temp_sin * position[2];
-								position[2] = temp_sin * position[1] + temp_cos * position[2];
-								position[1] = temp_two;
-								weights--;
-
-								position[2] -= *weights;
-								weights--;
-								position[1] -= *weights;
-								weights--;
-								position[0] -= *weights;
-							}
+							/* Need to apply rotations in reverse order */
+							weights = shared_data->weights + 5;
+							temp_sin = sin( -*weights );
+							temp_cos = cos( -*weights );
+							temp_two = temp_cos * position[0] - temp_sin * position[1];
+							position[1] = temp_sin * position[0] + temp_cos * position[1];
+							position[0] = temp_two;
+							weights--;
+
+							temp_sin = sin( -*weights );
+							temp_cos = cos( -*weights );
+							temp_two = temp_cos * position[2] - temp_sin * position[0];
+							position[0] = temp_sin * position[2] + temp_cos * position[0];
+							position[2] = temp_two;
+							weights--;
+
+							temp_sin = sin( -*weights );
+							temp_cos = cos( -*weights );
+							temp_two = temp_cos * position[1] - temp_sin * position[2];
+							position[2] = temp_sin * position[1] + temp_cos * position[2];
+							position[1] = temp_two;
+							weights--;
+
+							position[2] -= *weights;
+							weights--;
+							position[1] -= *weights;
+							weights--;
+							position[0] -= *weights;
 						}
+					}
 
-						for (k = 0 ; k < 3 ; k++)
+					for (k = 0 ; k < 3 ; k++)
+					{
+						versions = get_FE_node_field_component_number_of_versions(
+							node, field, k);
+						for (j = 0 ; j < versions ; j++)
 						{
-							versions = get_FE_node_field_component_number_of_versions(
-								node, field, k);
-							for (j = 0 ; j < versions ; j++)
-							{
-								return_code=set_FE_nodal_FE_value_value(node,
-									field, /*component_number*/k, j, FE_NODAL_VALUE,
-									/*time*/0, (FE_value)position[k]);
-							}
+							return_code=set_FE_nodal_FE_value_value(node,
+								field, /*component_number*/k, j, FE_NODAL_VALUE,
+								/*time*/0, (FE_value)position[k]);
 						}
-
-					}
-					else
-					{
-						display_message(ERROR_MESSAGE,
-							"emoter_update_nodes.  Unknown node %d",
-							(em_object->index)[i]);
-						return_code=0;
 					}
 					i++;
 				}
@@ -940,7 +1065,9 @@ Callback for the emoter dialog - tidies up all details - mem etc
 		/* Destroy shared slider data */
 		DEALLOCATE(emoter_dialog->shared->weights);
 		DEALLOCATE(emoter_dialog->shared->sliders);
+		cmzn_fieldmodulenotifier_destroy(&emoter_dialog->shared->fieldmodulenotifier);
 		DEACCESS(cmzn_region)(&emoter_dialog->shared->region);
+		emoter_clear_node_cache(emoter_dialog->shared);
 		destroy_EM_Object(&(emoter_dialog->shared->em_object));
 		cmzn_nodeset_group_destroy(&emoter_dialog->minimum_nodeset_group);
 		destroy_Shell_list_item(&(emoter_dialog->shell_list_item));
@@ -3336,6 +3463,13 @@ int gfx_create_emoter(struct Parse_state *state,void *dummy_to_be_modified,
 								shared_emoter_slider_data->execute_command =
 									create_emoter_slider_data->execute_command;
 								shared_emoter_slider_data->em_object = em_object;
+								shared_emoter_slider_data->nodes = (cmzn_node_id *)NULL;
+								shared_emoter_slider_data->node_values = (double *)NULL;
+								shared_emoter_slider_data->fieldmodulenotifier =
+									cmzn_fieldmodule_create_fieldmodulenotifier(fieldmodule);
+								cmzn_fieldmodulenotifier_set_callback(
+									shared_emoter_slider_data->fieldmodulenotifier, emoter_fieldmoduleevent,
+									static_cast<void *>(shared_emoter_slider_data));
 								shared_emoter_slider_data->active_slider =
 									(struct Emoter_slider *)NULL;
 								shared_emoter_slider_data->time = 1;
@@ -0,0 +1,240 @@
+/***************************************************************************//**
+ * finite_element_ranges_app.hpp
+ *
+ * Iterators over the nodes or elements of a domain with identifiers in a
+ * Multi_range. Small ranges are served by looking up each identifier in the
+ * domain's identifier index, so the cost scales with the size of the result
+ * rather than the size of the domain.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (FINITE_ELEMENT_RANGES_APP_HPP)
+#define FINITE_ELEMENT_RANGES_APP_HPP
+
+#include "zinc/element.h"
+#include "zinc/node.h"
+#include "zinc/nodeset.h"
+#include "general/multi_range.h"
+
+/***************************************************************************//**
+ * @return  Number of values in all ranges of multi_range, as a double so
+ * ranges spanning most of the integers cannot overflow.
+ */
+inline double Multi_range_get_number_in_ranges_double(struct Multi_range *multi_range)
+{
+	double number_in_ranges = 0.0;
+	const int number_of_ranges = multi_range ? Multi_range_get_number_of_ranges(multi_range) : 0;
+	int start, stop;
+	for (int i = 0; i < number_of_ranges; ++i)
+	{
+		if (Multi_range_get_range(multi_range, i, &start, &stop))
+			number_in_ranges += (double)stop - (double)start + 1.0;
+	}
+	return number_in_ranges;
+}
+
+/** Zinc handle functions used by Domain_ranges_iterator for nodes. */
+struct Nodeset_ranges_traits
+{
+	typedef cmzn_nodeset_id Domain;
+	typedef cmzn_node_id Object;
+	typedef cmzn_nodeiterator_id Iterator;
+
+	static int getSize(Domain domain)
+	{
+		return cmzn_nodeset_get_size(domain);
+	}
+
+	static Iterator createIterator(Domain domain)
+	{
+		return cmzn_nodeset_create_nodeiterator(domain);
+	}
+
+	static Object iteratorNextNonAccess(Iterator iterator)
+	{
+		return cmzn_nodeiterator_next_non_access(iterator);
+	}
+
+	static void destroyIterator(Iterator *iterator_address)
+	{
+		cmzn_nodeiterator_destroy(iterator_address);
+	}
+
+	static Object findByIdentifier(Domain domain, int identifier)
+	{
+		return cmzn_nodeset_find_node_by_identifier(domain, identifier);
+	}
+
+	static int getIdentifier(Object object)
+	{
+		return cmzn_node_get_identifier(object);
+	}
+
+	static void destroyObject(Object *object_address)
+	{
+		cmzn_node_destroy(object_address);
+	}
+};
+
+/** Zinc handle functions used by Domain_ranges_iterator for elements. */
+struct Mesh_ranges_traits
+{
+	typedef cmzn_mesh_id Domain;
+	typedef cmzn_element_id Object;
+	typedef cmzn_elementiterator_id Iterator;
+
+	static int getSize(Domain domain)
+	{
+		return cmzn_mesh_get_size(domain);
+	}
+
+	static Iterator createIterator(Domain domain)
+	{
+		return cmzn_mesh_create_elementiterator(domain);
+	}
+
+	static Object iteratorNextNonAccess(Iterator iterator)
+	{
+		return cmzn_elementiterator_next_non_access(iterator);
+	}
+
+	static void destroyIterator(Iterator *iterator_address)
+	{
+		cmzn_elementiterator_destroy(iterator_address);
+	}
+
+	static Object findByIdentifier(Domain domain, int identifier)
+	{
+		return cmzn_mesh_find_element_by_identifier(domain, identifier);
+	}
+
+	static int getIdentifier(Object object)
+	{
+		return cmzn_element_get_identifier(object);
+	}
+
+	static void destroyObject(Object *object_address)
+	{
+		cmzn_element_destroy(object_address);
+	}
+};
+
+/***************************************************************************//**
+ * Iterates over the objects in a nodeset or mesh with identifiers in a
+ * Multi_range, in increasing identifier order. If the ranges hold fewer
+ * identifiers than the domain holds objects, each identifier in the ranges is
+ * looked up, otherwise the domain is iterated over and identifiers outside the
+ * ranges are skipped. With no ranges all objects are returned.
+ * Neither the domain nor the ranges may be modified during iteration.
+ */
+template <class Traits> class Domain_ranges_iterator
+{
+	typename Traits::Domain domain;
+	struct Multi_range *ranges;
+	typename Traits::Iterator iterator;
+	/* last object found by lookup, accessed */
+	typename Traits::Object object;
+	int number_of_ranges, range_number, identifier, stop;
+	bool range_done;
+
+	Domain_ranges_iterator(const Domain_ranges_iterator&);
+	Domain_ranges_iterator& operator=(const Domain_ranges_iterator&);
+
+public:
+
+	/**
+	 * @param domain_in  The nodeset or mesh to iterate over. Not accessed so must
+	 * outlive the iterator.
+	 * @param ranges_in  Identifier ranges to restrict iteration to. NULL or
+	 * empty for all objects in domain.
+	 */
+	Domain_ranges_iterator(typename Traits::Domain domain_in, struct Multi_range *ranges_in) :
+		domain(domain_in),
+		ranges(0),
+		iterator(0),
+		object(0),
+		number_of_ranges(0),
+		range_number(-1),
+		identifier(0),
+		stop(0),
+		range_done(true)
+	{
+		if (ranges_in && (0 < Multi_range_get_number_of_ranges(ranges_in)))
+		{
+			ranges = ranges_in;
+			number_of_ranges = Multi_range_get_number_of_ranges(ranges);
+		}
+		if ((!ranges) || (static_cast<double>(Traits::getSize(domain)) <=
+			Multi_range_get_number_in_ranges_double(ranges)))
+		{
+			iterator = Traits::createIterator(domain);
+		}
+	}
+
+	~Domain_ranges_iterator()
+	{
+		if (iterator)
+			Traits::destroyIterator(&iterator);
+		if (object)
+			Traits::destroyObject(&object);
+	}
+
+	/** @return  True if identifiers in the ranges are looked up individually. */
+	bool isLookup() const
+	{
+		return (0 == iterator);
+	}
+
+	/**
+	 * @return  Non-accessed handle to the next object, valid until the next call
+	 * or the iterator is destroyed, or NULL if no more objects.
+	 */
+	typename Traits::Object nextNonAccess()
+	{
+		if (iterator)
+		{
+			typename Traits::Object next_object;
+			while (0 != (next_object = Traits::iteratorNextNonAccess(iterator)))
+			{
+				if ((!ranges) || Multi_range_is_value_in_range(ranges, Traits::getIdentifier(next_object)))
+					return next_object;
+			}
+			return 0;
+		}
+		if (object)
+			Traits::destroyObject(&object);
+		while (true)
+		{
+			if (range_done)
+			{
+				++range_number;
+				if ((range_number >= number_of_ranges) ||
+					(!Multi_range_get_range(ranges, range_number, &identifier, &stop)))
+				{
+					range_number = number_of_ranges;
+					return 0;
+				}
+				range_done = (identifier > stop);
+				continue;
+			}
+			const int current_identifier = identifier;
+			/* avoid incrementing past stop which may be the largest int */
+			if (current_identifier == stop)
+				range_done = true;
+			else
+				++identifier;
+			object = Traits::findByIdentifier(domain, current_identifier);
+			if (object)
+				return object;
+		}
+	}
+};
+
+typedef Domain_ranges_iterator<Nodeset_ranges_traits> Nodeset_ranges_iterator;
+typedef Domain_ranges_iterator<Mesh_ranges_traits> Mesh_ranges_iterator;
+
+#endif /* !defined (FINITE_ELEMENT_RANGES_APP_HPP) */
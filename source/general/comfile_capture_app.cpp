@@ -0,0 +1,160 @@
+/***************************************************************************//**
+ * comfile_capture_app.cpp
+ *
+ * Captures commands written by the *_to_comfile functions into memory.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#if defined (WIN32_SYSTEM)
+#	include <direct.h>
+#else /* defined (WIN32_SYSTEM) */
+#	include <unistd.h>
+#endif /* defined (WIN32_SYSTEM) */
+#include "general/message.h"
+#include "general/comfile_capture_app.hpp"
+
+namespace {
+
+/* file name the *_to_comfile functions append to */
+const char *Comfile_capture_file_name = "temp_file_com.com";
+
+bool Comfile_capture_get_current_directory(std::string& directory)
+{
+	std::vector<char> buffer(1024);
+	while (true)
+	{
+#if defined (WIN32_SYSTEM)
+		if (_getcwd(&(buffer[0]), static_cast<int>(buffer.size())))
+#else /* defined (WIN32_SYSTEM) */
+		if (getcwd(&(buffer[0]), buffer.size()))
+#endif /* defined (WIN32_SYSTEM) */
+		{
+			directory = &(buffer[0]);
+			return true;
+		}
+		if ((ERANGE != errno) || (buffer.size() >= 65536))
+			return false;
+		buffer.resize(buffer.size()*2);
+	}
+}
+
+int Comfile_capture_change_directory(const char *directory)
+{
+#if defined (WIN32_SYSTEM)
+	return _chdir(directory);
+#else /* defined (WIN32_SYSTEM) */
+	return chdir(directory);
+#endif /* defined (WIN32_SYSTEM) */
+}
+
+}
+
+Comfile_capture::~Comfile_capture()
+{
+	restore();
+}
+
+bool Comfile_capture::begin()
+{
+	if (!capture_directory.empty())
+	{
+		display_message(ERROR_MESSAGE, "Comfile_capture::begin.  Already begun");
+		return false;
+	}
+	if (!Comfile_capture_get_current_directory(previous_directory))
+	{
+		display_message(ERROR_MESSAGE, "Comfile_capture::begin.  Could not get current directory");
+		return false;
+	}
+#if defined (WIN32_SYSTEM)
+	char *directory_name = _tempnam(NULL, "cmgui");
+	if (directory_name && (0 == _mkdir(directory_name)))
+		capture_directory = directory_name;
+	free(directory_name);
+#else /* defined (WIN32_SYSTEM) */
+	const char *temporary_directory = getenv("TMPDIR");
+	std::string directory_template((temporary_directory && *temporary_directory) ?
+		temporary_directory : "/tmp");
+	directory_template += "/cmgui_commands_XXXXXX";
+	std::vector<char> directory_name(directory_template.begin(), directory_template.end());
+	directory_name.push_back('\0');
+	if (mkdtemp(&(directory_name[0])))
+		capture_directory = &(directory_name[0]);
+#endif /* defined (WIN32_SYSTEM) */
+	if (capture_directory.empty())
+	{
+		display_message(ERROR_MESSAGE, "Comfile_capture::begin.  Could not create temporary directory");
+		return false;
+	}
+	if (0 != Comfile_capture_change_directory(capture_directory.c_str()))
+	{
+		display_message(ERROR_MESSAGE, "Comfile_capture::begin.  Could not change to directory %s",
+			capture_directory.c_str());
+		restore();
+		return false;
+	}
+	return true;
+}
+
+bool Comfile_capture::restore()
+{
+	if (capture_directory.empty())
+		return false;
+	bool success = true;
+	if (0 != Comfile_capture_change_directory(previous_directory.c_str()))
+	{
+		display_message(ERROR_MESSAGE, "Comfile_capture.  Could not return to directory %s",
+			previous_directory.c_str());
+		success = false;
+	}
+	const std::string file_name = capture_directory + "/" + Comfile_capture_file_name;
+	remove(file_name.c_str());
+#if defined (WIN32_SYSTEM)
+	_rmdir(capture_directory.c_str());
+#else /* defined (WIN32_SYSTEM) */
+	rmdir(capture_directory.c_str());
+#endif /* defined (WIN32_SYSTEM) */
+	capture_directory.clear();
+	return success;
+}
+
+bool Comfile_capture::end(std::string& commands)
+{
+	if (capture_directory.empty())
+	{
+		display_message(ERROR_MESSAGE, "Comfile_capture::end.  Not begun");
+		return false;
+	}
+	bool success = true;
+	std::string captured;
+	const std::string file_name = capture_directory + "/" + Comfile_capture_file_name;
+	/* no file if nothing was written */
+	FILE *file = fopen(file_name.c_str(), "rb");
+	if (file)
+	{
+		char buffer[65536];
+		size_t length;
+		while (0 < (length = fread(buffer, 1, sizeof(buffer), file)))
+			captured.append(buffer, length);
+		if (ferror(file))
+		{
+			display_message(ERROR_MESSAGE, "Comfile_capture::end.  Could not read commands");
+			success = false;
+		}
+		fclose(file);
+	}
+	if (!restore())
+		success = false;
+	if (success)
+		commands.swap(captured);
+	return success;
+}
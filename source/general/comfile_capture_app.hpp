@@ -0,0 +1,56 @@
+/***************************************************************************//**
+ * comfile_capture_app.hpp
+ *
+ * Captures commands written by the *_to_comfile functions into memory.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (COMFILE_CAPTURE_APP_HPP)
+#define COMFILE_CAPTURE_APP_HPP
+
+#include <string>
+
+/***************************************************************************//**
+ * The *_to_comfile functions append to temp_file_com.com in the current
+ * directory. Between begin and end the current directory is a new private
+ * temporary directory so these writes cannot clobber or race with any user
+ * file, and end returns what was written. The previous directory is restored
+ * and the temporary directory removed on end or destruction.
+ */
+class Comfile_capture
+{
+	std::string previous_directory;
+	std::string capture_directory;
+
+	Comfile_capture(const Comfile_capture&);
+	Comfile_capture& operator=(const Comfile_capture&);
+
+	bool restore();
+
+public:
+
+	Comfile_capture()
+	{
+	}
+
+	~Comfile_capture();
+
+	/**
+	 * Creates the temporary directory and makes it current.
+	 * @return  true on success, false with error reported.
+	 */
+	bool begin();
+
+	/**
+	 * Restores the previous directory and removes the temporary directory.
+	 * @param commands  On success, set to the commands written since begin.
+	 * @return  true on success, false if not begun or with error reported.
+	 */
+	bool end(std::string& commands);
+};
+
+#endif /* !defined (COMFILE_CAPTURE_APP_HPP) */
@@ -0,0 +1,44 @@
+/***************************************************************************//**
+ * elapsed_time_app.cpp
+ *
+ * Monotonic wall clock for timing and pacing application operations.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+#if defined (WIN32_SYSTEM)
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#else /* defined (WIN32_SYSTEM) */
+#	include <time.h>
+#	include <sys/time.h>
+#endif /* defined (WIN32_SYSTEM) */
+#include "general/elapsed_time_app.h"
+
+double get_elapsed_time_seconds(void)
+{
+#if defined (WIN32_SYSTEM)
+	static double seconds_per_count = 0.0;
+	LARGE_INTEGER count;
+	if (0.0 == seconds_per_count)
+	{
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		seconds_per_count = 1.0/static_cast<double>(frequency.QuadPart);
+	}
+	QueryPerformanceCounter(&count);
+	return static_cast<double>(count.QuadPart)*seconds_per_count;
+#elif defined (CLOCK_MONOTONIC)
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return static_cast<double>(now.tv_sec) + 1.0E-9*static_cast<double>(now.tv_nsec);
+#else
+	struct timeval now;
+	gettimeofday(&now, 0);
+	return static_cast<double>(now.tv_sec) + 1.0E-6*static_cast<double>(now.tv_usec);
+#endif
+}
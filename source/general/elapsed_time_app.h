@@ -0,0 +1,22 @@
+/***************************************************************************//**
+ * elapsed_time_app.h
+ *
+ * Monotonic wall clock for timing and pacing application operations.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (ELAPSED_TIME_APP_H)
+#define ELAPSED_TIME_APP_H
+
+/***************************************************************************//**
+ * Returns seconds elapsed on a monotonic clock from an arbitrary fixed origin.
+ * Only differences between values are meaningful; unaffected by changes to
+ * the system date and time.
+ */
+double get_elapsed_time_seconds(void);
+
+#endif /* !defined (ELAPSED_TIME_APP_H) */
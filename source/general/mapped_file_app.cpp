@@ -0,0 +1,153 @@
+/***************************************************************************//**
+ * mapped_file_app.cpp
+ *
+ * Read-only memory mapping of a whole file.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+#if defined (WIN32_SYSTEM)
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#else /* defined (WIN32_SYSTEM) */
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif /* defined (WIN32_SYSTEM) */
+#include "general/mapped_file_app.hpp"
+
+struct Mapped_file_private
+{
+#if defined (WIN32_SYSTEM)
+	HANDLE file;
+	HANDLE mapping;
+#else /* defined (WIN32_SYSTEM) */
+	void *address;
+	size_t length;
+#endif /* defined (WIN32_SYSTEM) */
+};
+
+Mapped_file::Mapped_file() :
+	file_private(new Mapped_file_private()),
+	data(0),
+	size(0)
+{
+#if defined (WIN32_SYSTEM)
+	file_private->file = INVALID_HANDLE_VALUE;
+	file_private->mapping = 0;
+#else /* defined (WIN32_SYSTEM) */
+	file_private->address = 0;
+	file_private->length = 0;
+#endif /* defined (WIN32_SYSTEM) */
+}
+
+Mapped_file::~Mapped_file()
+{
+	close();
+	delete file_private;
+}
+
+bool Mapped_file::open(const char *file_name)
+{
+	close();
+	if (!file_name)
+		return false;
+#if defined (WIN32_SYSTEM)
+	file_private->file = CreateFileA(file_name, GENERIC_READ, FILE_SHARE_READ,
+		/*security*/0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, /*template*/0);
+	if (INVALID_HANDLE_VALUE == file_private->file)
+		return false;
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file_private->file, &file_size))
+	{
+		close();
+		return false;
+	}
+	size = static_cast<size_t>(file_size.QuadPart);
+	if (0 < size)
+	{
+		file_private->mapping = CreateFileMappingA(file_private->file, /*security*/0,
+			PAGE_READONLY, 0, 0, /*name*/0);
+		if (file_private->mapping)
+			data = static_cast<const char *>(MapViewOfFile(file_private->mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!data)
+		{
+			close();
+			return false;
+		}
+	}
+#else /* defined (WIN32_SYSTEM) */
+	int file_descriptor = ::open(file_name, O_RDONLY);
+	if (file_descriptor < 0)
+		return false;
+	struct stat file_status;
+	if (0 != fstat(file_descriptor, &file_status))
+	{
+		::close(file_descriptor);
+		return false;
+	}
+	size = static_cast<size_t>(file_status.st_size);
+	if (0 < size)
+	{
+		void *address = mmap(/*address*/0, size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
+		if (MAP_FAILED == address)
+		{
+			::close(file_descriptor);
+			size = 0;
+			return false;
+		}
+		/* file is parsed front to back once */
+		madvise(address, size, MADV_SEQUENTIAL);
+		file_private->address = address;
+		file_private->length = size;
+		data = static_cast<const char *>(address);
+	}
+	/* mapping remains valid after the descriptor is closed */
+	::close(file_descriptor);
+#endif /* defined (WIN32_SYSTEM) */
+	return true;
+}
+
+void Mapped_file::close()
+{
+#if defined (WIN32_SYSTEM)
+	if (data)
+		UnmapViewOfFile(data);
+	if (file_private->mapping)
+		CloseHandle(file_private->mapping);
+	if (INVALID_HANDLE_VALUE != file_private->file)
+		CloseHandle(file_private->file);
+	file_private->mapping = 0;
+	file_private->file = INVALID_HANDLE_VALUE;
+#else /* defined (WIN32_SYSTEM) */
+	if (file_private->address)
+		munmap(file_private->address, file_private->length);
+	file_private->address = 0;
+	file_private->length = 0;
+#endif /* defined (WIN32_SYSTEM) */
+	data = 0;
+	size = 0;
+}
+
+long long Mapped_file::getFileSize(const char *file_name)
+{
+	if (!file_name)
+		return -1;
+#if defined (WIN32_SYSTEM)
+	WIN32_FILE_ATTRIBUTE_DATA attributes;
+	if (!GetFileAttributesExA(file_name, GetFileExInfoStandard, &attributes))
+		return -1;
+	return (static_cast<long long>(attributes.nFileSizeHigh) << 32) |
+		static_cast<long long>(attributes.nFileSizeLow);
+#else /* defined (WIN32_SYSTEM) */
+	struct stat file_status;
+	if (0 != stat(file_name, &file_status))
+		return -1;
+	return static_cast<long long>(file_status.st_size);
+#endif /* defined (WIN32_SYSTEM) */
+}
@@ -0,0 +1,66 @@
+/***************************************************************************//**
+ * mapped_file_app.hpp
+ *
+ * Read-only memory mapping of a whole file, giving a contiguous view of its
+ * contents without copying through stdio buffers.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (MAPPED_FILE_APP_HPP)
+#define MAPPED_FILE_APP_HPP
+
+#include <stddef.h>
+
+struct Mapped_file_private;
+
+/***************************************************************************//**
+ * Read-only mapping of a file. The mapping is released on destruction.
+ */
+class Mapped_file
+{
+	Mapped_file_private *file_private;
+	const char *data;
+	size_t size;
+
+	Mapped_file(const Mapped_file&);
+	Mapped_file& operator=(const Mapped_file&);
+
+public:
+
+	Mapped_file();
+
+	~Mapped_file();
+
+	/**
+	 * Maps the whole of the named file, releasing any existing mapping.
+	 * @return  true on success, false if the file could not be opened or mapped.
+	 */
+	bool open(const char *file_name);
+
+	/** Releases the mapping, if any. */
+	void close();
+
+	/** @return  Pointer to the start of the mapped file, or 0 if not mapped or
+	 * the file is empty. */
+	const char *getData() const
+	{
+		return data;
+	}
+
+	/** @return  Size of the mapped file in bytes. */
+	size_t getSize() const
+	{
+		return size;
+	}
+
+	/**
+	 * @return  Size of the named file in bytes, or -1 if it could not be found.
+	 */
+	static long long getFileSize(const char *file_name);
+};
+
+#endif /* !defined (MAPPED_FILE_APP_HPP) */
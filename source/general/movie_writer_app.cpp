@@ -0,0 +1,321 @@
+/***************************************************************************//**
+ * movie_writer_app.cpp
+ *
+ * Encodes a stream of rendered frames to a Y4M movie or an image sequence.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+#include <ctype.h>
+#include <string.h>
+#include "general/debug.h"
+#include "general/elapsed_time_app.h"
+#include "general/image_utilities.h"
+#include "general/message.h"
+#include "general/movie_writer_app.hpp"
+#include "general/thread_pool_app.hpp"
+
+/** Y4M frame queued for encoding, owned by the writer. */
+struct Movie_writer_frame
+{
+	int width, height, number_of_components;
+	int index;
+	std::vector<unsigned char> pixels;
+	std::vector<unsigned char> output;
+	int task_identifier;
+	double encode_seconds;
+	bool success;
+};
+
+namespace {
+
+inline unsigned char Movie_writer_clamp_byte(double value)
+{
+	if (value <= 0.0)
+		return 0;
+	if (value >= 255.0)
+		return 255;
+	return static_cast<unsigned char>(value + 0.5);
+}
+
+/**
+ * Appends a Y4M frame: full range BT.601 luma plane then 2x2 averaged Cb and
+ * Cr planes, flipping rows from bottom-up to top-down order.
+ */
+void Movie_writer_encode_y4m(Movie_writer_frame *frame)
+{
+	const int width = frame->width;
+	const int height = frame->height;
+	const int nc = frame->number_of_components;
+	const int chroma_width = (width + 1)/2;
+	const int chroma_height = (height + 1)/2;
+	const char frame_header[] = "FRAME\n";
+	const size_t header_size = sizeof(frame_header) - 1;
+	std::vector<unsigned char>& output = frame->output;
+	output.resize(header_size + width*height + 2*chroma_width*chroma_height);
+	memcpy(&output[0], frame_header, header_size);
+	unsigned char *y_plane = &output[header_size];
+	unsigned char *cb_plane = y_plane + width*height;
+	unsigned char *cr_plane = cb_plane + chroma_width*chroma_height;
+	const unsigned char *pixels = &(frame->pixels[0]);
+	for (int row = 0; row < height; ++row)
+	{
+		const unsigned char *source = pixels + (height - 1 - row)*width*nc;
+		unsigned char *target = y_plane + row*width;
+		for (int column = 0; column < width; ++column, source += nc)
+			target[column] = Movie_writer_clamp_byte(
+				0.299*source[0] + 0.587*source[1] + 0.114*source[2]);
+	}
+	for (int chroma_row = 0; chroma_row < chroma_height; ++chroma_row)
+	{
+		for (int chroma_column = 0; chroma_column < chroma_width; ++chroma_column)
+		{
+			double r = 0.0, g = 0.0, b = 0.0;
+			int count = 0;
+			for (int row = 2*chroma_row; (row < 2*chroma_row + 2) && (row < height); ++row)
+			{
+				for (int column = 2*chroma_column; (column < 2*chroma_column + 2) && (column < width); ++column)
+				{
+					const unsigned char *source = pixels + ((height - 1 - row)*width + column)*nc;
+					r += source[0];
+					g += source[1];
+					b += source[2];
+					++count;
+				}
+			}
+			r /= count;
+			g /= count;
+			b /= count;
+			cb_plane[chroma_row*chroma_width + chroma_column] =
+				Movie_writer_clamp_byte(128.0 - 0.168736*r - 0.331264*g + 0.5*b);
+			cr_plane[chroma_row*chroma_width + chroma_column] =
+				Movie_writer_clamp_byte(128.0 + 0.5*r - 0.418688*g - 0.081312*b);
+		}
+	}
+}
+
+/**
+ * Thread_pool task encoding a Y4M frame, which the caller appends in order.
+ */
+void Movie_writer_encode_frame(void *frame_void)
+{
+	Movie_writer_frame *frame = static_cast<Movie_writer_frame *>(frame_void);
+	double start_time = get_elapsed_time_seconds();
+	Movie_writer_encode_y4m(frame);
+	std::vector<unsigned char>().swap(frame->pixels);
+	frame->encode_seconds = get_elapsed_time_seconds() - start_time;
+	frame->success = true;
+}
+
+/**
+ * @return  true if file_name contains exactly one integer conversion such as
+ * %d or %04d and no other conversions except %%.
+ */
+bool Movie_writer_is_valid_sequence_name(const char *file_name)
+{
+	int number_of_conversions = 0;
+	for (const char *c = file_name; *c; ++c)
+	{
+		if (*c == '%')
+		{
+			++c;
+			if (*c == '%')
+				continue;
+			while (isdigit(*c))
+				++c;
+			if (*c != 'd')
+				return false;
+			++number_of_conversions;
+		}
+	}
+	return (number_of_conversions == 1);
+}
+
+}
+
+Movie_writer::Movie_writer(enum Movie_writer_format format_in,
+	const char *file_name_in, int width_in, int height_in,
+	int number_of_components_in, double frames_per_second_in, int number_of_threads) :
+	format(format_in),
+	file_name(file_name_in ? file_name_in : ""),
+	width(width_in),
+	height(height_in),
+	number_of_components(number_of_components_in),
+	frames_per_second(frames_per_second_in),
+	file(0),
+	thread_pool(new Thread_pool(number_of_threads)),
+	maximum_pending_frames(number_of_threads + 1),
+	number_of_frames(0),
+	write_error(false),
+	encode_seconds(0.0),
+	write_seconds(0.0),
+	wait_seconds(0.0)
+{
+}
+
+Movie_writer::~Movie_writer()
+{
+	while (!pending_frames.empty())
+		completeOldestFrame();
+	delete thread_pool;
+	if (file)
+		fclose(file);
+}
+
+enum Movie_writer_format Movie_writer::getFormatFromFileName(const char *file_name)
+{
+	const char *extension = file_name ? strrchr(file_name, '.') : 0;
+	if (extension && extension[1] && (0 == strchr(extension, '/')))
+	{
+		if (0 == strcmp(extension, ".y4m"))
+			return MOVIE_WRITER_FORMAT_Y4M;
+		return MOVIE_WRITER_FORMAT_IMAGE_SEQUENCE;
+	}
+	return MOVIE_WRITER_FORMAT_INVALID;
+}
+
+bool Movie_writer::open()
+{
+	if ((format == MOVIE_WRITER_FORMAT_INVALID) || (width < 1) || (height < 1) ||
+		(number_of_components < 1) || (4 < number_of_components) ||
+		((format == MOVIE_WRITER_FORMAT_Y4M) && (number_of_components < 3)) ||
+		(frames_per_second <= 0.0))
+	{
+		display_message(ERROR_MESSAGE, "Movie_writer::open.  Invalid argument(s)");
+		return false;
+	}
+	if (format == MOVIE_WRITER_FORMAT_Y4M)
+	{
+		if (!(file = fopen(file_name.c_str(), "wb")))
+		{
+			display_message(ERROR_MESSAGE,
+				"Movie_writer::open.  Could not create file %s", file_name.c_str());
+			return false;
+		}
+		/* frame rate as a rational with millisecond precision */
+		if (0 > fprintf(file, "YUV4MPEG2 W%d H%d F%ld:1000 Ip A1:1 C420jpeg\n",
+			width, height, static_cast<long>(frames_per_second*1000.0 + 0.5)))
+		{
+			display_message(ERROR_MESSAGE,
+				"Movie_writer::open.  Could not write to file %s", file_name.c_str());
+			return false;
+		}
+	}
+	else if (!Movie_writer_is_valid_sequence_name(file_name.c_str()))
+	{
+		display_message(ERROR_MESSAGE, "Movie_writer::open.  Image sequence file name "
+			"must contain one frame number conversion e.g. frame%%04d.png");
+		return false;
+	}
+	return true;
+}
+
+/** Waits for the oldest frame, appends it to the Y4M file and frees it. */
+bool Movie_writer::completeOldestFrame()
+{
+	Movie_writer_frame *frame = pending_frames.front();
+	pending_frames.pop_front();
+	double start_time = get_elapsed_time_seconds();
+	thread_pool->waitForTask(frame->task_identifier);
+	double end_time = get_elapsed_time_seconds();
+	wait_seconds += end_time - start_time;
+	encode_seconds += frame->encode_seconds;
+	bool success = frame->success && (0 != file) && (frame->output.size() ==
+		fwrite(&(frame->output[0]), 1, frame->output.size(), file));
+	write_seconds += get_elapsed_time_seconds() - end_time;
+	if (!success)
+	{
+		display_message(ERROR_MESSAGE,
+			"Movie_writer.  Error encoding or writing frame %d", frame->index);
+		write_error = true;
+	}
+	delete frame;
+	return success;
+}
+
+/**
+ * Writes an image sequence frame with the Cmgui_image writers, which choose
+ * the image format from the file name extension.
+ */
+bool Movie_writer::writeImageFrame(std::vector<unsigned char>& pixels)
+{
+	double start_time = get_elapsed_time_seconds();
+	std::vector<char> name(file_name.size() + 32);
+	snprintf(&name[0], name.size(), file_name.c_str(), number_of_frames);
+	bool success = false;
+	struct Cmgui_image *cmgui_image = Cmgui_image_constitute(width, height,
+		number_of_components, /*number_of_bytes_per_component*/1,
+		width*number_of_components, &(pixels[0]));
+	if (cmgui_image)
+	{
+		struct Cmgui_image_information *cmgui_image_information =
+			CREATE(Cmgui_image_information)();
+		if (cmgui_image_information &&
+			Cmgui_image_information_add_file_name(cmgui_image_information, &name[0]) &&
+			Cmgui_image_write(cmgui_image, cmgui_image_information))
+		{
+			success = true;
+		}
+		if (cmgui_image_information)
+			DESTROY(Cmgui_image_information)(&cmgui_image_information);
+		DESTROY(Cmgui_image)(&cmgui_image);
+	}
+	write_seconds += get_elapsed_time_seconds() - start_time;
+	if (!success)
+	{
+		display_message(ERROR_MESSAGE,
+			"Movie_writer.  Error writing frame %d to %s", number_of_frames, &name[0]);
+		write_error = true;
+	}
+	return success;
+}
+
+bool Movie_writer::addFrame(std::vector<unsigned char>& pixels)
+{
+	if (pixels.size() < static_cast<size_t>(width)*height*number_of_components)
+	{
+		display_message(ERROR_MESSAGE, "Movie_writer::addFrame.  Invalid argument(s)");
+		return false;
+	}
+	if (format == MOVIE_WRITER_FORMAT_IMAGE_SEQUENCE)
+	{
+		if (write_error || !writeImageFrame(pixels))
+			return false;
+		++number_of_frames;
+		return true;
+	}
+	while (static_cast<int>(pending_frames.size()) >= maximum_pending_frames)
+		completeOldestFrame();
+	if (write_error)
+		return false;
+	Movie_writer_frame *frame = new Movie_writer_frame();
+	frame->width = width;
+	frame->height = height;
+	frame->number_of_components = number_of_components;
+	frame->index = number_of_frames;
+	frame->pixels.swap(pixels);
+	frame->encode_seconds = 0.0;
+	frame->success = false;
+	pending_frames.push_back(frame);
+	frame->task_identifier = thread_pool->addTask(Movie_writer_encode_frame, frame);
+	++number_of_frames;
+	return true;
+}
+
+bool Movie_writer::finish()
+{
+	while (!pending_frames.empty())
+		completeOldestFrame();
+	thread_pool->waitForAll();
+	if (file)
+	{
+		if (0 != fclose(file))
+			write_error = true;
+		file = 0;
+	}
+	return !write_error;
+}
@@ -0,0 +1,126 @@
+/***************************************************************************//**
+ * movie_writer_app.hpp
+ *
+ * Encodes a stream of rendered frames to a YUV4MPEG2 (Y4M) movie or to a
+ * numbered image sequence. Y4M frames are encoded by worker threads while the
+ * caller renders the next frame.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (MOVIE_WRITER_APP_HPP)
+#define MOVIE_WRITER_APP_HPP
+
+#include <stdio.h>
+#include <deque>
+#include <string>
+#include <vector>
+
+class Thread_pool;
+struct Movie_writer_frame;
+
+enum Movie_writer_format
+{
+	MOVIE_WRITER_FORMAT_INVALID,
+	MOVIE_WRITER_FORMAT_Y4M,
+	MOVIE_WRITER_FORMAT_IMAGE_SEQUENCE
+};
+
+/***************************************************************************//**
+ * Writes frames of 8-bit pixels supplied in OpenGL order, bottom row first.
+ * Y4M output is 4:2:0 full range and takes RGB or RGBA frames, ignoring alpha.
+ * Image sequences take 1 to 4 components and are written on the calling
+ * thread by the Cmgui_image writers in the format given by the file name
+ * extension, naming each file by substituting the frame number into a
+ * printf-style %d in the file name.
+ */
+class Movie_writer
+{
+	enum Movie_writer_format format;
+	std::string file_name;
+	int width, height, number_of_components;
+	double frames_per_second;
+	FILE *file;
+	Thread_pool *thread_pool;
+	/* frames being encoded, in order */
+	std::deque<Movie_writer_frame *> pending_frames;
+	int maximum_pending_frames;
+	int number_of_frames;
+	bool write_error;
+	double encode_seconds, write_seconds, wait_seconds;
+
+	Movie_writer(const Movie_writer&);
+	Movie_writer& operator=(const Movie_writer&);
+
+	bool completeOldestFrame();
+
+	bool writeImageFrame(std::vector<unsigned char>& pixels);
+
+public:
+
+	/**
+	 * @param number_of_threads  Number of Y4M encoding threads; 0 to encode
+	 * each frame before addFrame returns.
+	 */
+	Movie_writer(enum Movie_writer_format format_in, const char *file_name_in,
+		int width_in, int height_in, int number_of_components_in,
+		double frames_per_second_in, int number_of_threads);
+
+	/** Waits for frames being encoded; call finish to check for errors. */
+	~Movie_writer();
+
+	/**
+	 * @return  Y4M format for file name extension .y4m, an image sequence for
+	 * any other extension, or MOVIE_WRITER_FORMAT_INVALID if there is none.
+	 */
+	static enum Movie_writer_format getFormatFromFileName(const char *file_name);
+
+	/**
+	 * Checks arguments and opens the movie file or checks the sequence name.
+	 * @return  true on success, false on failure with error reported.
+	 */
+	bool open();
+
+	/**
+	 * Queues a Y4M frame for encoding, taking over the contents of pixels and
+	 * blocking while too many frames are being encoded, or writes an image
+	 * sequence frame.
+	 * @return  true if queued or written, false if this or an earlier frame
+	 * failed.
+	 */
+	bool addFrame(std::vector<unsigned char>& pixels);
+
+	/**
+	 * Waits for all frames to be encoded and written and closes the output.
+	 * @return  true if all frames were written successfully.
+	 */
+	bool finish();
+
+	int getNumberOfFrames() const
+	{
+		return number_of_frames;
+	}
+
+	/** @return  Total seconds spent encoding Y4M frames, summed over threads. */
+	double getEncodeSeconds() const
+	{
+		return encode_seconds;
+	}
+
+	/** @return  Seconds spent writing frames, including image encoding. */
+	double getWriteSeconds() const
+	{
+		return write_seconds;
+	}
+
+	/** @return  Seconds the caller was blocked waiting for encoding threads. */
+	double getWaitSeconds() const
+	{
+		return wait_seconds;
+	}
+};
+
+#endif /* !defined (MOVIE_WRITER_APP_HPP) */
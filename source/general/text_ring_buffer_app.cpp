@@ -0,0 +1,83 @@
+/***************************************************************************//**
+ * text_ring_buffer_app.cpp
+ *
+ * Fixed capacity store of the most recent text written to an output pane.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <string.h>
+#include "general/text_ring_buffer_app.hpp"
+
+Text_ring_buffer::Text_ring_buffer(size_t capacity) :
+	text((0 < capacity) ? capacity : 1),
+	start(0),
+	size(0),
+	pending_length(0),
+	discarded(false)
+{
+}
+
+void Text_ring_buffer::append(const char *new_text, size_t length)
+{
+	const size_t capacity = text.size();
+	pending_length += length;
+	if (length >= capacity)
+	{
+		/* only the end of new_text is kept */
+		memcpy(&(text[0]), new_text + length - capacity, capacity);
+		discarded = discarded || (0 < size) || (length > capacity);
+		start = 0;
+		size = capacity;
+		return;
+	}
+	size_t end = (start + size) % capacity;
+	const size_t first_length = (end + length <= capacity) ? length : (capacity - end);
+	memcpy(&(text[end]), new_text, first_length);
+	if (first_length < length)
+		memcpy(&(text[0]), new_text + first_length, length - first_length);
+	size += length;
+	if (size > capacity)
+	{
+		start = (start + size - capacity) % capacity;
+		size = capacity;
+		discarded = true;
+	}
+}
+
+void Text_ring_buffer::takePending(std::string& pending_text)
+{
+	const size_t length = (pending_length < size) ? pending_length : size;
+	const size_t capacity = text.size();
+	const size_t first = (start + size - length) % capacity;
+	const size_t first_length = (first + length <= capacity) ? length : (capacity - first);
+	pending_text.assign(&(text[first]), first_length);
+	if (first_length < length)
+		pending_text.append(&(text[0]), length - first_length);
+	pending_length = 0;
+}
+
+void Text_ring_buffer::takeTail(size_t length, std::string& tail_text)
+{
+	const bool partial = (length < size) || discarded;
+	pending_length = (length < size) ? length : size;
+	takePending(tail_text);
+	if (partial)
+	{
+		/* do not show a partial first line */
+		const size_t line_end = tail_text.find('\n');
+		if (std::string::npos != line_end)
+			tail_text.erase(0, line_end + 1);
+	}
+}
+
+void Text_ring_buffer::clear()
+{
+	start = 0;
+	size = 0;
+	pending_length = 0;
+	discarded = false;
+}
@@ -0,0 +1,77 @@
+/***************************************************************************//**
+ * text_ring_buffer_app.hpp
+ *
+ * Fixed capacity store of the most recent text written to an output pane,
+ * letting the pane be updated in batches and trimmed without holding the whole
+ * session output.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (TEXT_RING_BUFFER_APP_HPP)
+#define TEXT_RING_BUFFER_APP_HPP
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/***************************************************************************//**
+ * Keeps the last capacity characters appended, overwriting the oldest, and
+ * counts characters appended since pending text was last taken.
+ */
+class Text_ring_buffer
+{
+	std::vector<char> text;
+	/* index of oldest character and number of characters held */
+	size_t start, size;
+	size_t pending_length;
+	/* true if older text has been overwritten */
+	bool discarded;
+
+public:
+
+	explicit Text_ring_buffer(size_t capacity);
+
+	size_t getCapacity() const
+	{
+		return text.size();
+	}
+
+	size_t getSize() const
+	{
+		return size;
+	}
+
+	/** @return  Number of characters appended since pending text was taken. */
+	size_t getPendingLength() const
+	{
+		return pending_length;
+	}
+
+	/**
+	 * @return  true if more text was appended since pending text was taken than
+	 * is held, so the pending text is incomplete.
+	 */
+	bool isPendingOverflowed() const
+	{
+		return pending_length > size;
+	}
+
+	void append(const char *new_text, size_t length);
+
+	/** Copies text appended since the last call to pending_text. */
+	void takePending(std::string& pending_text);
+
+	/**
+	 * Copies up to the last length characters to tail_text, starting after a
+	 * line break if the oldest held text is omitted, and clears pending text.
+	 */
+	void takeTail(size_t length, std::string& tail_text);
+
+	void clear();
+};
+
+#endif /* !defined (TEXT_RING_BUFFER_APP_HPP) */
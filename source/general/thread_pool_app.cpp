@@ -0,0 +1,269 @@
+/***************************************************************************//**
+ * thread_pool_app.cpp
+ *
+ * Minimal pool of worker threads for running independent non-Zinc tasks.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+#if defined (WIN32_SYSTEM)
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#else /* defined (WIN32_SYSTEM) */
+#	include <pthread.h>
+#	include <unistd.h>
+#endif /* defined (WIN32_SYSTEM) */
+#include "general/debug.h"
+#include "general/message.h"
+#include "general/thread_pool_app.hpp"
+
+struct Thread_pool_private
+{
+#if defined (WIN32_SYSTEM)
+	CRITICAL_SECTION mutex;
+	CONDITION_VARIABLE task_added;
+	CONDITION_VARIABLE task_completed;
+	std::vector<HANDLE> threads;
+#else /* defined (WIN32_SYSTEM) */
+	pthread_mutex_t mutex;
+	pthread_cond_t task_added;
+	pthread_cond_t task_completed;
+	std::vector<pthread_t> threads;
+#endif /* defined (WIN32_SYSTEM) */
+
+	void lock()
+	{
+#if defined (WIN32_SYSTEM)
+		EnterCriticalSection(&mutex);
+#else
+		pthread_mutex_lock(&mutex);
+#endif
+	}
+
+	void unlock()
+	{
+#if defined (WIN32_SYSTEM)
+		LeaveCriticalSection(&mutex);
+#else
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+	void waitTaskAdded()
+	{
+#if defined (WIN32_SYSTEM)
+		SleepConditionVariableCS(&task_added, &mutex, INFINITE);
+#else
+		pthread_cond_wait(&task_added, &mutex);
+#endif
+	}
+
+	void waitTaskCompleted()
+	{
+#if defined (WIN32_SYSTEM)
+		SleepConditionVariableCS(&task_completed, &mutex, INFINITE);
+#else
+		pthread_cond_wait(&task_completed, &mutex);
+#endif
+	}
+
+	void signalTaskAdded(bool all)
+	{
+#if defined (WIN32_SYSTEM)
+		if (all)
+			WakeAllConditionVariable(&task_added);
+		else
+			WakeConditionVariable(&task_added);
+#else
+		if (all)
+			pthread_cond_broadcast(&task_added);
+		else
+			pthread_cond_signal(&task_added);
+#endif
+	}
+
+	void signalTaskCompleted()
+	{
+#if defined (WIN32_SYSTEM)
+		WakeAllConditionVariable(&task_completed);
+#else
+		pthread_cond_broadcast(&task_completed);
+#endif
+	}
+
+#if defined (WIN32_SYSTEM)
+	static DWORD WINAPI threadMain(LPVOID thread_pool_void)
+	{
+		static_cast<Thread_pool *>(thread_pool_void)->runTasks();
+		return 0;
+	}
+#else
+	static void *threadMain(void *thread_pool_void)
+	{
+		static_cast<Thread_pool *>(thread_pool_void)->runTasks();
+		return 0;
+	}
+#endif
+};
+
+/***************************************************************************//**
+ * Loop run by each worker thread: takes tasks from the front of the queue until
+ * the pool is stopping and the queue is empty.
+ */
+void Thread_pool::runTasks()
+{
+	pool_private->lock();
+	while (true)
+	{
+		while ((!stopping) && queue.empty())
+			pool_private->waitTaskAdded();
+		if (queue.empty())
+			break;
+		Task task = queue.front();
+		queue.pop_front();
+		pool_private->unlock();
+		(task.function)(task.task_data);
+		pool_private->lock();
+		task_complete[task.identifier] = true;
+		--number_of_incomplete_tasks;
+		pool_private->signalTaskCompleted();
+	}
+	pool_private->unlock();
+}
+
+Thread_pool::Thread_pool(int number_of_threads_in) :
+	pool_private(new Thread_pool_private()),
+	number_of_threads(0),
+	stopping(false),
+	number_of_incomplete_tasks(0)
+{
+#if defined (WIN32_SYSTEM)
+	InitializeCriticalSection(&pool_private->mutex);
+	InitializeConditionVariable(&pool_private->task_added);
+	InitializeConditionVariable(&pool_private->task_completed);
+#else /* defined (WIN32_SYSTEM) */
+	pthread_mutex_init(&pool_private->mutex, 0);
+	pthread_cond_init(&pool_private->task_added, 0);
+	pthread_cond_init(&pool_private->task_completed, 0);
+#endif /* defined (WIN32_SYSTEM) */
+	for (int i = 0; i < number_of_threads_in; ++i)
+	{
+#if defined (WIN32_SYSTEM)
+		HANDLE thread = CreateThread(/*security*/0, /*stack_size*/0,
+			Thread_pool_private::threadMain, static_cast<LPVOID>(this), 0, 0);
+		if (!thread)
+#else /* defined (WIN32_SYSTEM) */
+		pthread_t thread;
+		if (0 != pthread_create(&thread, 0, Thread_pool_private::threadMain, static_cast<void *>(this)))
+#endif /* defined (WIN32_SYSTEM) */
+		{
+			display_message(WARNING_MESSAGE,
+				"Thread_pool.  Could only create %d of %d worker threads",
+				number_of_threads, number_of_threads_in);
+			break;
+		}
+		pool_private->threads.push_back(thread);
+		++number_of_threads;
+	}
+}
+
+Thread_pool::~Thread_pool()
+{
+	waitForAll();
+	pool_private->lock();
+	stopping = true;
+	pool_private->signalTaskAdded(/*all*/true);
+	pool_private->unlock();
+	for (int i = 0; i < number_of_threads; ++i)
+	{
+#if defined (WIN32_SYSTEM)
+		WaitForSingleObject(pool_private->threads[i], INFINITE);
+		CloseHandle(pool_private->threads[i]);
+#else /* defined (WIN32_SYSTEM) */
+		pthread_join(pool_private->threads[i], 0);
+#endif /* defined (WIN32_SYSTEM) */
+	}
+#if defined (WIN32_SYSTEM)
+	DeleteCriticalSection(&pool_private->mutex);
+#else /* defined (WIN32_SYSTEM) */
+	pthread_cond_destroy(&pool_private->task_completed);
+	pthread_cond_destroy(&pool_private->task_added);
+	pthread_mutex_destroy(&pool_private->mutex);
+#endif /* defined (WIN32_SYSTEM) */
+	delete pool_private;
+}
+
+int Thread_pool::addTask(Thread_pool_task_function function, void *task_data)
+{
+	if (!function)
+	{
+		display_message(ERROR_MESSAGE, "Thread_pool::addTask.  Invalid argument(s)");
+		return -1;
+	}
+	pool_private->lock();
+	Task task;
+	task.function = function;
+	task.task_data = task_data;
+	task.identifier = static_cast<int>(task_complete.size());
+	task_complete.push_back(false);
+	++number_of_incomplete_tasks;
+	if (0 < number_of_threads)
+	{
+		queue.push_back(task);
+		pool_private->signalTaskAdded(/*all*/false);
+		pool_private->unlock();
+	}
+	else
+	{
+		pool_private->unlock();
+		(function)(task_data);
+		pool_private->lock();
+		task_complete[task.identifier] = true;
+		--number_of_incomplete_tasks;
+		pool_private->unlock();
+	}
+	return task.identifier;
+}
+
+void Thread_pool::waitForTask(int task_identifier)
+{
+	pool_private->lock();
+	if ((0 <= task_identifier) && (task_identifier < static_cast<int>(task_complete.size())))
+	{
+		while (!task_complete[task_identifier])
+			pool_private->waitTaskCompleted();
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "Thread_pool::waitForTask.  Invalid task identifier");
+	}
+	pool_private->unlock();
+}
+
+void Thread_pool::waitForAll()
+{
+	pool_private->lock();
+	while (0 < number_of_incomplete_tasks)
+		pool_private->waitTaskCompleted();
+	task_complete.clear();
+	pool_private->unlock();
+}
+
+int Thread_pool::getNumberOfProcessors()
+{
+	int number_of_processors = 1;
+#if defined (WIN32_SYSTEM)
+	SYSTEM_INFO system_info;
+	GetSystemInfo(&system_info);
+	number_of_processors = static_cast<int>(system_info.dwNumberOfProcessors);
+#elif defined (_SC_NPROCESSORS_ONLN)
+	number_of_processors = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+	if (number_of_processors < 1)
+		number_of_processors = 1;
+	return number_of_processors;
+}
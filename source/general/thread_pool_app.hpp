@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * thread_pool_app.hpp
+ *
+ * Minimal pool of worker threads for running independent tasks which do not
+ * call into Zinc, e.g. file input/output, compression and pixel format
+ * conversion. Zinc objects are not thread safe so must only be used from the
+ * main thread.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (THREAD_POOL_APP_HPP)
+#define THREAD_POOL_APP_HPP
+
+#include <deque>
+#include <vector>
+
+typedef void (*Thread_pool_task_function)(void *task_data);
+
+struct Thread_pool_private;
+
+/***************************************************************************//**
+ * Pool of worker threads executing tasks in the order they are added. A pool
+ * with no threads executes each task immediately in Thread_pool::addTask.
+ */
+class Thread_pool
+{
+	Thread_pool_private *pool_private;
+	int number_of_threads;
+	bool stopping;
+	/* tasks not yet started, and completion flags indexed by task identifier */
+	struct Task
+	{
+		Thread_pool_task_function function;
+		void *task_data;
+		int identifier;
+	};
+	std::deque<Task> queue;
+	std::vector<bool> task_complete;
+	int number_of_incomplete_tasks;
+
+	Thread_pool(const Thread_pool&);
+	Thread_pool& operator=(const Thread_pool&);
+
+	friend struct Thread_pool_private;
+
+	void runTasks();
+
+public:
+
+	/** @param number_of_threads_in  Number of worker threads; 0 for none. */
+	explicit Thread_pool(int number_of_threads_in);
+
+	/** Waits for all added tasks to complete before stopping threads. */
+	~Thread_pool();
+
+	int getNumberOfThreads() const
+	{
+		return number_of_threads;
+	}
+
+	/**
+	 * Adds a task to be executed by the next free worker thread.
+	 * @return  Identifier of task for passing to waitForTask, or -1 on error.
+	 */
+	int addTask(Thread_pool_task_function function, void *task_data);
+
+	/** Blocks until the task with the given identifier has completed. */
+	void waitForTask(int task_identifier);
+
+	/**
+	 * Blocks until all added tasks have completed. Task identifiers are reset so
+	 * any from before this call are invalid.
+	 */
+	void waitForAll();
+
+	/** @return  Number of processors available for worker threads, at least 1. */
+	static int getNumberOfProcessors();
+};
+
+#endif /* !defined (THREAD_POOL_APP_HPP) */
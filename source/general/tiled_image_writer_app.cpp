@@ -0,0 +1,246 @@
+/***************************************************************************//**
+ * tiled_image_writer_app.cpp
+ *
+ * Streams an image to a binary PNM/PAM file one tile at a time.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+#if defined (WIN32_SYSTEM)
+#	define WIN32_LEAN_AND_MEAN
+#	include <windows.h>
+#else /* defined (WIN32_SYSTEM) */
+#	include <pthread.h>
+#	include <sys/types.h>
+#	include <unistd.h>
+#endif /* defined (WIN32_SYSTEM) */
+#include "general/debug.h"
+#include "general/message.h"
+#include "general/thread_pool_app.hpp"
+#include "general/tiled_image_writer_app.hpp"
+
+namespace {
+
+/** Tile waiting to be written, deleted by the task writing it. */
+struct Tiled_image_writer_tile
+{
+	Tiled_image_writer *writer;
+	std::vector<unsigned char> pixels;
+	int left, bottom, tile_width, tile_height;
+};
+
+#if defined (WIN32_SYSTEM)
+/** Seeks with 64-bit offsets so images over 2GB can be written. */
+int Tiled_image_writer_seek(FILE *file, long long offset)
+{
+	return _fseeki64(file, offset, SEEK_SET);
+}
+#endif /* defined (WIN32_SYSTEM) */
+
+}
+
+/**
+ * Serialises access to the error flag from worker threads, and on Windows to
+ * the file position shared by all rows.
+ */
+struct Tiled_image_writer_private
+{
+#if defined (WIN32_SYSTEM)
+	CRITICAL_SECTION mutex;
+#else /* defined (WIN32_SYSTEM) */
+	pthread_mutex_t mutex;
+#endif /* defined (WIN32_SYSTEM) */
+
+	Tiled_image_writer_private()
+	{
+#if defined (WIN32_SYSTEM)
+		InitializeCriticalSection(&mutex);
+#else
+		pthread_mutex_init(&mutex, 0);
+#endif
+	}
+
+	~Tiled_image_writer_private()
+	{
+#if defined (WIN32_SYSTEM)
+		DeleteCriticalSection(&mutex);
+#else
+		pthread_mutex_destroy(&mutex);
+#endif
+	}
+
+	void lock()
+	{
+#if defined (WIN32_SYSTEM)
+		EnterCriticalSection(&mutex);
+#else
+		pthread_mutex_lock(&mutex);
+#endif
+	}
+
+	void unlock()
+	{
+#if defined (WIN32_SYSTEM)
+		LeaveCriticalSection(&mutex);
+#else
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+
+	/**
+	 * Thread_pool task writing one tile. Rows are flipped from OpenGL bottom-up
+	 * order to the top-down order of the file. Rows are written at their own
+	 * offsets with pwrite so tiles on different threads are written
+	 * concurrently; on Windows the seek and write of each tile is serialised.
+	 */
+	static void writeTile(void *tile_void)
+	{
+		Tiled_image_writer_tile *tile = static_cast<Tiled_image_writer_tile *>(tile_void);
+		Tiled_image_writer *writer = tile->writer;
+		const size_t row_size = static_cast<size_t>(tile->tile_width)*writer->number_of_components;
+		bool success = true;
+#if defined (WIN32_SYSTEM)
+		writer->writer_private->lock();
+#else /* defined (WIN32_SYSTEM) */
+		const int file_descriptor = fileno(writer->file);
+#endif /* defined (WIN32_SYSTEM) */
+		for (int row = 0; success && (row < tile->tile_height); ++row)
+		{
+			const long long file_row = writer->height - 1 - (tile->bottom + row);
+			const long long offset = writer->header_size +
+				(file_row*writer->width + tile->left)*writer->number_of_components;
+#if defined (WIN32_SYSTEM)
+			success = (0 == Tiled_image_writer_seek(writer->file, offset)) &&
+				(row_size == fwrite(&(tile->pixels[row*row_size]), 1, row_size, writer->file));
+#else /* defined (WIN32_SYSTEM) */
+			success = (static_cast<ssize_t>(row_size) == pwrite(file_descriptor,
+				&(tile->pixels[row*row_size]), row_size, static_cast<off_t>(offset)));
+#endif /* defined (WIN32_SYSTEM) */
+		}
+#if !defined (WIN32_SYSTEM)
+		writer->writer_private->lock();
+#endif /* !defined (WIN32_SYSTEM) */
+		if (!success)
+			writer->write_error = true;
+		writer->writer_private->unlock();
+		delete tile;
+	}
+};
+
+Tiled_image_writer::Tiled_image_writer(int width_in, int height_in,
+	int number_of_components_in, int number_of_threads) :
+	writer_private(new Tiled_image_writer_private()),
+	file(0),
+	width(width_in),
+	height(height_in),
+	number_of_components(number_of_components_in),
+	header_size(0),
+	thread_pool(new Thread_pool(number_of_threads)),
+	maximum_pending_tasks(2*number_of_threads + 1),
+	write_error(false)
+{
+}
+
+Tiled_image_writer::~Tiled_image_writer()
+{
+	delete thread_pool;
+	if (file)
+		fclose(file);
+	delete writer_private;
+}
+
+bool Tiled_image_writer::open(const char *file_name)
+{
+	if ((!file_name) || (width < 1) || (height < 1) ||
+		(number_of_components < 1) || (4 < number_of_components))
+	{
+		display_message(ERROR_MESSAGE, "Tiled_image_writer::open.  Invalid argument(s)");
+		return false;
+	}
+	if (!(file = fopen(file_name, "wb")))
+	{
+		display_message(ERROR_MESSAGE,
+			"Tiled_image_writer::open.  Could not create file %s", file_name);
+		return false;
+	}
+	int result;
+	if (number_of_components == 1)
+		result = fprintf(file, "P5\n%d %d\n255\n", width, height);
+	else if (number_of_components == 3)
+		result = fprintf(file, "P6\n%d %d\n255\n", width, height);
+	else
+	{
+		result = fprintf(file, "P7\nWIDTH %d\nHEIGHT %d\nDEPTH %d\nMAXVAL 255\nTUPLTYPE %s\nENDHDR\n",
+			width, height, number_of_components,
+			(number_of_components == 2) ? "GRAYSCALE_ALPHA" : "RGB_ALPHA");
+	}
+	/* rows are written to the file descriptor directly on POSIX systems */
+	if ((result < 0) || (0 != fflush(file)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Tiled_image_writer::open.  Could not write header to %s", file_name);
+		fclose(file);
+		file = 0;
+		return false;
+	}
+	header_size = result;
+	return true;
+}
+
+bool Tiled_image_writer::addTile(std::vector<unsigned char>& pixels, int left,
+	int bottom, int tile_width, int tile_height)
+{
+	if ((!file) || (left < 0) || (bottom < 0) || (tile_width < 1) || (tile_height < 1) ||
+		(width < left + tile_width) || (height < bottom + tile_height) ||
+		(pixels.size() < static_cast<size_t>(tile_width)*tile_height*number_of_components))
+	{
+		display_message(ERROR_MESSAGE, "Tiled_image_writer::addTile.  Invalid argument(s)");
+		return false;
+	}
+	while (static_cast<int>(pending_tasks.size()) >= maximum_pending_tasks)
+	{
+		thread_pool->waitForTask(pending_tasks.front());
+		pending_tasks.pop_front();
+	}
+	writer_private->lock();
+	const bool error = write_error;
+	writer_private->unlock();
+	if (error)
+		return false;
+	Tiled_image_writer_tile *tile = new Tiled_image_writer_tile();
+	tile->writer = this;
+	tile->pixels.swap(pixels);
+	tile->left = left;
+	tile->bottom = bottom;
+	tile->tile_width = tile_width;
+	tile->tile_height = tile_height;
+	const int task_identifier = thread_pool->addTask(Tiled_image_writer_private::writeTile, tile);
+	if (task_identifier < 0)
+	{
+		delete tile;
+		return false;
+	}
+	if (0 < thread_pool->getNumberOfThreads())
+		pending_tasks.push_back(task_identifier);
+	return true;
+}
+
+bool Tiled_image_writer::finish()
+{
+	thread_pool->waitForAll();
+	pending_tasks.clear();
+	bool success = (0 != file) && (!write_error);
+	if (file)
+	{
+		if (0 != fclose(file))
+			success = false;
+		file = 0;
+	}
+	if (!success)
+		display_message(ERROR_MESSAGE, "Tiled_image_writer::finish.  Error writing image");
+	return success;
+}
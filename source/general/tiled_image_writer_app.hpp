@@ -0,0 +1,84 @@
+/***************************************************************************//**
+ * tiled_image_writer_app.hpp
+ *
+ * Streams an image to a binary PNM/PAM file one tile at a time, so images far
+ * larger than available memory or graphics buffers can be assembled from
+ * separately rendered tiles. Tiles are flipped and written by worker
+ * threads while the caller produces the next tile.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (TILED_IMAGE_WRITER_APP_HPP)
+#define TILED_IMAGE_WRITER_APP_HPP
+
+#include <stdio.h>
+#include <deque>
+#include <vector>
+
+class Thread_pool;
+struct Tiled_image_writer_private;
+
+/***************************************************************************//**
+ * Writes 8-bit images of 1 to 4 components as P5 (grey), P6 (RGB) or P7 (PAM
+ * with alpha). Tiles are supplied in OpenGL order: rows from the bottom up,
+ * positioned by the pixel offset of their bottom left corner from the bottom
+ * left of the image.
+ */
+class Tiled_image_writer
+{
+	Tiled_image_writer_private *writer_private;
+	FILE *file;
+	int width, height, number_of_components;
+	long header_size;
+	Thread_pool *thread_pool;
+	/* identifiers of tasks not yet waited for, oldest first */
+	std::deque<int> pending_tasks;
+	int maximum_pending_tasks;
+	bool write_error;
+
+	Tiled_image_writer(const Tiled_image_writer&);
+	Tiled_image_writer& operator=(const Tiled_image_writer&);
+
+	friend struct Tiled_image_writer_private;
+
+public:
+
+	/**
+	 * @param number_of_threads  Number of worker threads writing tiles; 0 to
+	 * write each tile before addTile returns.
+	 */
+	Tiled_image_writer(int width_in, int height_in, int number_of_components_in,
+		int number_of_threads);
+
+	/** Closes the file without completing it if finish was not called. */
+	~Tiled_image_writer();
+
+	/**
+	 * Creates the file and writes its header.
+	 * @return  true on success, false on failure with error reported.
+	 */
+	bool open(const char *file_name);
+
+	/**
+	 * Queues a tile for writing, taking over the contents of pixels. Blocks if
+	 * too many tiles are waiting to be written.
+	 * @param pixels  Tightly packed tile_width*tile_height pixels, bottom row
+	 * first. Emptied on return.
+	 * @return  true if the tile was queued, false if it is outside the image or
+	 * an earlier write failed.
+	 */
+	bool addTile(std::vector<unsigned char>& pixels, int left, int bottom,
+		int tile_width, int tile_height);
+
+	/**
+	 * Waits for all tiles to be written and closes the file.
+	 * @return  true if the whole image was written successfully.
+	 */
+	bool finish();
+};
+
+#endif /* !defined (TILED_IMAGE_WRITER_APP_HPP) */
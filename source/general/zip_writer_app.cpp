@@ -0,0 +1,522 @@
+/***************************************************************************//**
+ * zip_writer_app.cpp
+ *
+ * Writes zip archives from entries supplied in chunks.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+#include <string.h>
+#include <time.h>
+#if defined (USE_ZLIB)
+#include <zlib.h>
+#endif /* defined (USE_ZLIB) */
+#include "general/debug.h"
+#include "general/elapsed_time_app.h"
+#include "general/message.h"
+#include "general/thread_pool_app.hpp"
+#include "general/zip_writer_app.hpp"
+
+/** Archive file and write position, only used by the worker thread until finish. */
+struct Zip_writer_archive
+{
+	FILE *file;
+	unsigned long long position;
+	double compress_seconds;
+};
+
+/** Entry being or already written, owned by the writer. */
+struct Zip_writer_entry
+{
+	std::string name;
+	unsigned short method, flags, dos_time, dos_date;
+	unsigned long crc;
+	unsigned long long length, compressed_size, offset;
+	bool success;
+#if defined (USE_ZLIB)
+	z_stream stream;
+	bool stream_initialised;
+#endif /* defined (USE_ZLIB) */
+};
+
+namespace {
+
+enum Zip_writer_task_type
+{
+	ZIP_WRITER_TASK_BEGIN_ENTRY,
+	ZIP_WRITER_TASK_ENTRY_DATA,
+	ZIP_WRITER_TASK_END_ENTRY
+};
+
+/** Step in writing an entry, deleted by the task executing it. */
+struct Zip_writer_task
+{
+	Zip_writer_archive *archive;
+	Zip_writer_entry *entry;
+	enum Zip_writer_task_type type;
+	const unsigned char *data;
+	size_t length;
+};
+
+/* sizes and offsets from this value are given in zip64 records */
+const unsigned long long ZIP_WRITER_ZIP64_LIMIT = 0xffffffffULL;
+const unsigned long ZIP_WRITER_VERSION_NEEDED_ZIP64 = 45;
+const size_t ZIP_WRITER_INPUT_CHUNK_SIZE = 1 << 20;
+
+void Zip_writer_append_uint16(std::vector<unsigned char>& output, unsigned long value)
+{
+	output.push_back(static_cast<unsigned char>(value & 0xff));
+	output.push_back(static_cast<unsigned char>((value >> 8) & 0xff));
+}
+
+void Zip_writer_append_uint32(std::vector<unsigned char>& output, unsigned long value)
+{
+	output.push_back(static_cast<unsigned char>(value & 0xff));
+	output.push_back(static_cast<unsigned char>((value >> 8) & 0xff));
+	output.push_back(static_cast<unsigned char>((value >> 16) & 0xff));
+	output.push_back(static_cast<unsigned char>((value >> 24) & 0xff));
+}
+
+void Zip_writer_append_uint64(std::vector<unsigned char>& output, unsigned long long value)
+{
+	Zip_writer_append_uint32(output, static_cast<unsigned long>(value & 0xffffffffULL));
+	Zip_writer_append_uint32(output, static_cast<unsigned long>(value >> 32));
+}
+
+/** @return  value, or the zip64 marker 0xffffffff if it does not fit 32 bits. */
+unsigned long Zip_writer_uint32_or_zip64(unsigned long long value)
+{
+	return (value < ZIP_WRITER_ZIP64_LIMIT) ? static_cast<unsigned long>(value) : 0xffffffffUL;
+}
+
+bool Zip_writer_archive_write(Zip_writer_archive *archive, const void *bytes, size_t size)
+{
+	if ((0 < size) && (size != fwrite(bytes, 1, size, archive->file)))
+		return false;
+	archive->position += size;
+	return true;
+}
+
+bool Zip_writer_archive_write(Zip_writer_archive *archive, const std::vector<unsigned char>& bytes)
+{
+	return bytes.empty() || Zip_writer_archive_write(archive, &(bytes[0]), bytes.size());
+}
+
+#if !defined (USE_ZLIB)
+unsigned long Zip_writer_crc32(unsigned long crc, const unsigned char *data, size_t length)
+{
+	static unsigned long table[256];
+	static bool table_built = false;
+	if (!table_built)
+	{
+		for (unsigned long n = 0; n < 256; ++n)
+		{
+			unsigned long c = n;
+			for (int k = 0; k < 8; ++k)
+				c = (c & 1) ? (0xedb88320UL ^ (c >> 1)) : (c >> 1);
+			table[n] = c;
+		}
+		table_built = true;
+	}
+	crc = crc ^ 0xffffffffUL;
+	for (size_t i = 0; i < length; ++i)
+		crc = table[(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffffUL;
+}
+#endif /* !defined (USE_ZLIB) */
+
+/**
+ * Writes the local header for an entry whose sizes and crc follow its data in
+ * a zip64 data descriptor, as they are not known until all chunks are written.
+ */
+bool Zip_writer_begin_entry(Zip_writer_archive *archive, Zip_writer_entry *entry)
+{
+	entry->offset = archive->position;
+	std::vector<unsigned char> header;
+	Zip_writer_append_uint32(header, 0x04034b50UL);
+	Zip_writer_append_uint16(header, ZIP_WRITER_VERSION_NEEDED_ZIP64);
+	Zip_writer_append_uint16(header, entry->flags);
+	Zip_writer_append_uint16(header, entry->method);
+	Zip_writer_append_uint16(header, entry->dos_time);
+	Zip_writer_append_uint16(header, entry->dos_date);
+	Zip_writer_append_uint32(header, /*crc*/0);
+	Zip_writer_append_uint32(header, /*compressed_size*/0xffffffffUL);
+	Zip_writer_append_uint32(header, /*uncompressed_size*/0xffffffffUL);
+	Zip_writer_append_uint16(header, static_cast<unsigned long>(entry->name.size()));
+	Zip_writer_append_uint16(header, /*extra_field_length*/20);
+	header.insert(header.end(), entry->name.begin(), entry->name.end());
+	/* zip64 extended information, sizes given in the data descriptor */
+	Zip_writer_append_uint16(header, 0x0001);
+	Zip_writer_append_uint16(header, 16);
+	Zip_writer_append_uint64(header, /*uncompressed_size*/0);
+	Zip_writer_append_uint64(header, /*compressed_size*/0);
+	if (!Zip_writer_archive_write(archive, header))
+		return false;
+#if defined (USE_ZLIB)
+	memset(&(entry->stream), 0, sizeof(entry->stream));
+	if (Z_OK != deflateInit2(&(entry->stream), Z_DEFAULT_COMPRESSION, Z_DEFLATED,
+		/*raw deflate*/-MAX_WBITS, /*memLevel*/8, Z_DEFAULT_STRATEGY))
+		return false;
+	entry->stream_initialised = true;
+	entry->crc = crc32(0L, Z_NULL, 0);
+#else /* defined (USE_ZLIB) */
+	entry->crc = 0;
+#endif /* defined (USE_ZLIB) */
+	return true;
+}
+
+#if defined (USE_ZLIB)
+/** Deflates data into the archive, or finishes the entry's stream if flush is Z_FINISH. */
+bool Zip_writer_deflate(Zip_writer_archive *archive, Zip_writer_entry *entry,
+	const unsigned char *data, size_t length, int flush)
+{
+	unsigned char output[65536];
+	z_stream& stream = entry->stream;
+	const unsigned char *next = data;
+	size_t remaining = length;
+	do
+	{
+		const size_t chunk = (remaining < ZIP_WRITER_INPUT_CHUNK_SIZE) ? remaining : ZIP_WRITER_INPUT_CHUNK_SIZE;
+		stream.next_in = const_cast<Bytef *>(next);
+		stream.avail_in = static_cast<uInt>(chunk);
+		next += chunk;
+		remaining -= chunk;
+		const int chunk_flush = (0 < remaining) ? Z_NO_FLUSH : flush;
+		do
+		{
+			stream.next_out = output;
+			stream.avail_out = static_cast<uInt>(sizeof(output));
+			if (Z_STREAM_ERROR == deflate(&stream, chunk_flush))
+				return false;
+			const size_t have = sizeof(output) - stream.avail_out;
+			if (!Zip_writer_archive_write(archive, output, have))
+				return false;
+			entry->compressed_size += have;
+		} while (0 == stream.avail_out);
+	} while (0 < remaining);
+	return true;
+}
+#endif /* defined (USE_ZLIB) */
+
+/** Compresses or stores a chunk of entry data into the archive. */
+bool Zip_writer_write_entry_data(Zip_writer_archive *archive, Zip_writer_entry *entry,
+	const unsigned char *data, size_t length)
+{
+	entry->length += length;
+#if defined (USE_ZLIB)
+	for (size_t offset = 0; offset < length; offset += ZIP_WRITER_INPUT_CHUNK_SIZE)
+	{
+		const size_t chunk = (length - offset < ZIP_WRITER_INPUT_CHUNK_SIZE) ?
+			(length - offset) : ZIP_WRITER_INPUT_CHUNK_SIZE;
+		entry->crc = crc32(entry->crc, data + offset, static_cast<uInt>(chunk));
+	}
+	return (0 == length) || Zip_writer_deflate(archive, entry, data, length, Z_NO_FLUSH);
+#else /* defined (USE_ZLIB) */
+	entry->crc = Zip_writer_crc32(entry->crc, data, length);
+	entry->compressed_size += length;
+	return Zip_writer_archive_write(archive, data, length);
+#endif /* defined (USE_ZLIB) */
+}
+
+/** Finishes the entry's data and writes its zip64 data descriptor. */
+bool Zip_writer_end_entry(Zip_writer_archive *archive, Zip_writer_entry *entry)
+{
+#if defined (USE_ZLIB)
+	if (!Zip_writer_deflate(archive, entry, /*data*/0, /*length*/0, Z_FINISH))
+		return false;
+#endif /* defined (USE_ZLIB) */
+	std::vector<unsigned char> descriptor;
+	Zip_writer_append_uint32(descriptor, 0x08074b50UL);
+	Zip_writer_append_uint32(descriptor, entry->crc);
+	Zip_writer_append_uint64(descriptor, entry->compressed_size);
+	Zip_writer_append_uint64(descriptor, entry->length);
+	return Zip_writer_archive_write(archive, descriptor);
+}
+
+/**
+ * Thread_pool task executing one step of writing an entry. Steps are run in
+ * the order added by the single worker thread, so each entry starts where the
+ * previous one ended. Steps after a failure in the entry are skipped.
+ */
+void Zip_writer_run_task(void *task_void)
+{
+	Zip_writer_task *task = static_cast<Zip_writer_task *>(task_void);
+	Zip_writer_entry *entry = task->entry;
+	const double start_time = get_elapsed_time_seconds();
+	switch (task->type)
+	{
+		case ZIP_WRITER_TASK_BEGIN_ENTRY:
+		{
+			entry->success = Zip_writer_begin_entry(task->archive, entry);
+		} break;
+		case ZIP_WRITER_TASK_ENTRY_DATA:
+		{
+			entry->success = entry->success &&
+				Zip_writer_write_entry_data(task->archive, entry, task->data, task->length);
+		} break;
+		case ZIP_WRITER_TASK_END_ENTRY:
+		{
+			entry->success = entry->success && Zip_writer_end_entry(task->archive, entry);
+#if defined (USE_ZLIB)
+			if (entry->stream_initialised)
+			{
+				deflateEnd(&(entry->stream));
+				entry->stream_initialised = false;
+			}
+#endif /* defined (USE_ZLIB) */
+		} break;
+	}
+	task->archive->compress_seconds += get_elapsed_time_seconds() - start_time;
+	delete task;
+}
+
+}
+
+Zip_writer::Zip_writer(const char *file_name_in) :
+	file_name(file_name_in ? file_name_in : ""),
+	archive(new Zip_writer_archive()),
+	thread_pool(new Thread_pool(1)),
+	current_entry(0),
+	chunk_task_identifier(-1)
+{
+	archive->file = 0;
+	archive->position = 0;
+	archive->compress_seconds = 0.0;
+}
+
+Zip_writer::~Zip_writer()
+{
+	delete thread_pool;
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+#if defined (USE_ZLIB)
+		if (entries[i]->stream_initialised)
+			deflateEnd(&(entries[i]->stream));
+#endif /* defined (USE_ZLIB) */
+		delete entries[i];
+	}
+	if (archive->file)
+		fclose(archive->file);
+	delete archive;
+}
+
+void Zip_writer::waitForChunk()
+{
+	if (0 <= chunk_task_identifier)
+	{
+		thread_pool->waitForTask(chunk_task_identifier);
+		chunk_task_identifier = -1;
+	}
+}
+
+bool Zip_writer::open()
+{
+	if (file_name.empty() || archive->file)
+	{
+		display_message(ERROR_MESSAGE, "Zip_writer::open.  Invalid file name or already open");
+		return false;
+	}
+	archive->file = fopen(file_name.c_str(), "wb");
+	if (!archive->file)
+	{
+		display_message(ERROR_MESSAGE, "Could not open zip file %s", file_name.c_str());
+		return false;
+	}
+	return true;
+}
+
+bool Zip_writer::beginEntry(const char *entry_name)
+{
+	if (!(archive->file && entry_name))
+	{
+		display_message(ERROR_MESSAGE, "Zip_writer::beginEntry.  Invalid argument(s)");
+		return false;
+	}
+	if (current_entry)
+		endEntry();
+	Zip_writer_entry *entry = new Zip_writer_entry();
+	entry->name = entry_name;
+#if defined (USE_ZLIB)
+	entry->method = 8;
+	entry->stream_initialised = false;
+#else /* defined (USE_ZLIB) */
+	entry->method = 0;
+#endif /* defined (USE_ZLIB) */
+	/* sizes and crc follow the data in a data descriptor */
+	entry->flags = 0x0008;
+	time_t now = time(0);
+	struct tm *local = localtime(&now);
+	if (local && (1980 <= local->tm_year + 1900))
+	{
+		entry->dos_time = static_cast<unsigned short>((local->tm_hour << 11) |
+			(local->tm_min << 5) | (local->tm_sec/2));
+		entry->dos_date = static_cast<unsigned short>(((local->tm_year - 80) << 9) |
+			((local->tm_mon + 1) << 5) | local->tm_mday);
+	}
+	else
+	{
+		entry->dos_time = 0;
+		entry->dos_date = (1 << 5) | 1;
+	}
+	entry->crc = 0;
+	entry->length = 0;
+	entry->compressed_size = 0;
+	entry->offset = 0;
+	entry->success = false;
+	entries.push_back(entry);
+	current_entry = entry;
+	Zip_writer_task *task = new Zip_writer_task();
+	task->archive = archive;
+	task->entry = entry;
+	task->type = ZIP_WRITER_TASK_BEGIN_ENTRY;
+	task->data = 0;
+	task->length = 0;
+	thread_pool->addTask(Zip_writer_run_task, task);
+	return true;
+}
+
+bool Zip_writer::writeEntryData(const void *data, size_t length)
+{
+	if (!(current_entry && (data || (0 == length))))
+	{
+		display_message(ERROR_MESSAGE, "Zip_writer::writeEntryData.  Invalid argument(s)");
+		return false;
+	}
+	Zip_writer_task *task = new Zip_writer_task();
+	task->archive = archive;
+	task->entry = current_entry;
+	task->type = ZIP_WRITER_TASK_ENTRY_DATA;
+	task->data = static_cast<const unsigned char *>(data);
+	task->length = length;
+	const int previous_chunk_task_identifier = chunk_task_identifier;
+	chunk_task_identifier = thread_pool->addTask(Zip_writer_run_task, task);
+	/* the previous chunk's data may be released by the caller after this */
+	if (0 <= previous_chunk_task_identifier)
+		thread_pool->waitForTask(previous_chunk_task_identifier);
+	return true;
+}
+
+bool Zip_writer::endEntry()
+{
+	if (!current_entry)
+	{
+		display_message(ERROR_MESSAGE, "Zip_writer::endEntry.  No current entry");
+		return false;
+	}
+	Zip_writer_task *task = new Zip_writer_task();
+	task->archive = archive;
+	task->entry = current_entry;
+	task->type = ZIP_WRITER_TASK_END_ENTRY;
+	task->data = 0;
+	task->length = 0;
+	chunk_task_identifier = thread_pool->addTask(Zip_writer_run_task, task);
+	waitForChunk();
+	current_entry = 0;
+	return true;
+}
+
+bool Zip_writer::finish()
+{
+	if (!archive->file)
+		return false;
+	if (current_entry)
+		endEntry();
+	thread_pool->waitForAll();
+	chunk_task_identifier = -1;
+	bool success = true;
+	std::vector<unsigned char> directory;
+	for (size_t i = 0; i < entries.size(); ++i)
+	{
+		const Zip_writer_entry *entry = entries[i];
+		if (!entry->success)
+		{
+			display_message(ERROR_MESSAGE, "Could not write entry %s to zip file %s",
+				entry->name.c_str(), file_name.c_str());
+			success = false;
+			continue;
+		}
+		/* zip64 extended information holds only the values too large for 32 bits */
+		std::vector<unsigned char> extra;
+		if (ZIP_WRITER_ZIP64_LIMIT <= entry->length)
+			Zip_writer_append_uint64(extra, entry->length);
+		if (ZIP_WRITER_ZIP64_LIMIT <= entry->compressed_size)
+			Zip_writer_append_uint64(extra, entry->compressed_size);
+		if (ZIP_WRITER_ZIP64_LIMIT <= entry->offset)
+			Zip_writer_append_uint64(extra, entry->offset);
+		Zip_writer_append_uint32(directory, 0x02014b50UL);
+		Zip_writer_append_uint16(directory, /*version_made_by*/ZIP_WRITER_VERSION_NEEDED_ZIP64);
+		Zip_writer_append_uint16(directory, ZIP_WRITER_VERSION_NEEDED_ZIP64);
+		Zip_writer_append_uint16(directory, entry->flags);
+		Zip_writer_append_uint16(directory, entry->method);
+		Zip_writer_append_uint16(directory, entry->dos_time);
+		Zip_writer_append_uint16(directory, entry->dos_date);
+		Zip_writer_append_uint32(directory, entry->crc);
+		Zip_writer_append_uint32(directory, Zip_writer_uint32_or_zip64(entry->compressed_size));
+		Zip_writer_append_uint32(directory, Zip_writer_uint32_or_zip64(entry->length));
+		Zip_writer_append_uint16(directory, static_cast<unsigned long>(entry->name.size()));
+		Zip_writer_append_uint16(directory, static_cast<unsigned long>(extra.empty() ? 0 : (4 + extra.size())));
+		Zip_writer_append_uint16(directory, /*comment_length*/0);
+		Zip_writer_append_uint16(directory, /*disk_number*/0);
+		Zip_writer_append_uint16(directory, /*internal_attributes*/0);
+		Zip_writer_append_uint32(directory, /*external_attributes*/0);
+		Zip_writer_append_uint32(directory, Zip_writer_uint32_or_zip64(entry->offset));
+		directory.insert(directory.end(), entry->name.begin(), entry->name.end());
+		if (!extra.empty())
+		{
+			Zip_writer_append_uint16(directory, 0x0001);
+			Zip_writer_append_uint16(directory, static_cast<unsigned long>(extra.size()));
+			directory.insert(directory.end(), extra.begin(), extra.end());
+		}
+	}
+	if (success)
+	{
+		const unsigned long long directory_offset = archive->position;
+		const unsigned long long directory_size = directory.size();
+		const unsigned long long number_of_entries = entries.size();
+		if ((0xffff <= number_of_entries) || (ZIP_WRITER_ZIP64_LIMIT <= directory_offset) ||
+			(ZIP_WRITER_ZIP64_LIMIT <= directory_size))
+		{
+			const unsigned long long zip64_end_offset = directory_offset + directory_size;
+			Zip_writer_append_uint32(directory, 0x06064b50UL);
+			Zip_writer_append_uint64(directory, /*size_of_remaining_record*/44);
+			Zip_writer_append_uint16(directory, /*version_made_by*/ZIP_WRITER_VERSION_NEEDED_ZIP64);
+			Zip_writer_append_uint16(directory, ZIP_WRITER_VERSION_NEEDED_ZIP64);
+			Zip_writer_append_uint32(directory, /*disk_number*/0);
+			Zip_writer_append_uint32(directory, /*directory_disk_number*/0);
+			Zip_writer_append_uint64(directory, number_of_entries);
+			Zip_writer_append_uint64(directory, number_of_entries);
+			Zip_writer_append_uint64(directory, directory_size);
+			Zip_writer_append_uint64(directory, directory_offset);
+			Zip_writer_append_uint32(directory, 0x07064b50UL);
+			Zip_writer_append_uint32(directory, /*zip64_end_disk_number*/0);
+			Zip_writer_append_uint64(directory, zip64_end_offset);
+			Zip_writer_append_uint32(directory, /*number_of_disks*/1);
+		}
+		const unsigned long entries_field = (number_of_entries < 0xffff) ?
+			static_cast<unsigned long>(number_of_entries) : 0xffffUL;
+		Zip_writer_append_uint32(directory, 0x06054b50UL);
+		Zip_writer_append_uint16(directory, /*disk_number*/0);
+		Zip_writer_append_uint16(directory, /*directory_disk_number*/0);
+		Zip_writer_append_uint16(directory, entries_field);
+		Zip_writer_append_uint16(directory, entries_field);
+		Zip_writer_append_uint32(directory, Zip_writer_uint32_or_zip64(directory_size));
+		Zip_writer_append_uint32(directory, Zip_writer_uint32_or_zip64(directory_offset));
+		Zip_writer_append_uint16(directory, /*comment_length*/0);
+		success = Zip_writer_archive_write(archive, directory);
+		if (!success)
+			display_message(ERROR_MESSAGE, "Could not write directory of zip file %s", file_name.c_str());
+	}
+	if (0 != fclose(archive->file))
+		success = false;
+	archive->file = 0;
+	return success;
+}
+
+double Zip_writer::getCompressSeconds() const
+{
+	return archive->compress_seconds;
+}
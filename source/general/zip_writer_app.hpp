@@ -0,0 +1,97 @@
+/***************************************************************************//**
+ * zip_writer_app.hpp
+ *
+ * Writes zip archives from entries supplied in chunks, compressing each chunk
+ * straight into the archive on a worker thread while the caller prepares the
+ * next chunk.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (ZIP_WRITER_APP_HPP)
+#define ZIP_WRITER_APP_HPP
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+
+class Thread_pool;
+struct Zip_writer_archive;
+struct Zip_writer_entry;
+
+/***************************************************************************//**
+ * Writes a zip archive entry by entry, with each entry's data supplied in one
+ * or more chunks. Entries are deflated when built with zlib, otherwise stored
+ * uncompressed. Zip64 records are written so entries and archives may exceed
+ * 4 GiB.
+ */
+class Zip_writer
+{
+	std::string file_name;
+	Zip_writer_archive *archive;
+	/* single worker thread writing chunks in the order they are added */
+	Thread_pool *thread_pool;
+	/* all entries in order added, written in the same order */
+	std::vector<Zip_writer_entry *> entries;
+	/* entry receiving data between beginEntry and endEntry, or NULL */
+	Zip_writer_entry *current_entry;
+	/* task writing the last chunk added, or -1 if none pending */
+	int chunk_task_identifier;
+
+	Zip_writer(const Zip_writer&);
+	Zip_writer& operator=(const Zip_writer&);
+
+	void waitForChunk();
+
+public:
+
+	explicit Zip_writer(const char *file_name_in);
+
+	/** Waits for entries being written; call finish to check for errors. */
+	~Zip_writer();
+
+	/** @return  true if the archive file was opened, false with error reported. */
+	bool open();
+
+	/**
+	 * Starts a new entry named entry_name, ending any current entry.
+	 * @return  true on success, false if the writer is not open.
+	 */
+	bool beginEntry(const char *entry_name);
+
+	/**
+	 * Queues a chunk of data for the current entry to be compressed on the
+	 * worker thread, then waits for the previous chunk to be written. The data
+	 * is not copied so must remain valid until the next call to
+	 * writeEntryData, endEntry or finish returns.
+	 * @return  true if queued, false if there is no current entry.
+	 */
+	bool writeEntryData(const void *data, size_t length);
+
+	/**
+	 * Ends the current entry, waiting for its data to be written.
+	 * @return  true on success, false if there is no current entry.
+	 */
+	bool endEntry();
+
+	/** Adds an entry with all its data in one chunk, waiting for it to be written. */
+	bool addEntry(const char *entry_name, const void *data, size_t length)
+	{
+		return beginEntry(entry_name) && writeEntryData(data, length) && endEntry();
+	}
+
+	/**
+	 * Ends any current entry, waits for all entries to be written, then writes
+	 * the central directory and closes the archive.
+	 * @return  true if all entries and the directory were written successfully.
+	 */
+	bool finish();
+
+	/** @return  Seconds spent compressing and writing entries. */
+	double getCompressSeconds() const;
+};
+
+#endif /* !defined (ZIP_WRITER_APP_HPP) */
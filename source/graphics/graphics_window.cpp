@@ -17,6 +17,7 @@ interest and set scene_viewer values directly.
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include <string>
+#include <vector>
 #if 1
 #include "configure/cmgui_configure.h"
 #endif /* defined (1) */
@@ -37,6 +38,7 @@ interest and set scene_viewer values directly.
 #include "general/mystring.h"
 #include "general/object.h"
 #include "general/photogrammetry.h"
+#include "general/tiled_image_writer_app.hpp"
 #include "graphics/colour.h"
 #include "graphics/graphics.h"
 #include "graphics/graphics_window.h"
@@ -5874,6 +5876,188 @@ Currently limited to 1 byte per component -- may want to improve for HPC.
 	return (cmgui_image);
 } /* Graphics_window_get_image */
 
+int Graphics_window_write_tiled_image(struct Graphics_window *window,
+	const char *file_name, enum Texture_storage_type storage, int width, int height,
+	int preferred_antialias, int preferred_transparency_layers, int tile_size,
+	int number_of_threads)
+{
+	int antialias, bottom_tile, framebuffer_flag, frame_height, frame_width, i, j, left_tile,
+		number_of_components, panel_height, panel_width, patch_height, patch_width,
+		return_code, tile_height, tile_width, tiles_across, tiles_down;
+	double bottom, fraction_across, fraction_down, left, NDC_height, NDC_width,
+		original_NDC_left, original_NDC_top, original_NDC_width, original_NDC_height,
+		original_left, original_right, original_bottom, original_top,
+		original_near_plane, original_far_plane,
+		original_viewport_left, original_viewport_top,
+		original_viewport_pixels_per_x, original_viewport_pixels_per_y,
+		real_left, real_right, real_bottom, real_top, right,
+		scaled_NDC_width, scaled_NDC_height, top;
+	struct Graphics_buffer_app *offscreen_buffer;
+	struct Scene_viewer_app *scene_viewer;
+
+	if (!(window && file_name && (0 <= width) && (0 <= height) && (0 < tile_size)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Graphics_window_write_tiled_image.  Invalid argument(s)");
+		return 0;
+	}
+	if ((window->layout_mode != GRAPHICS_WINDOW_LAYOUT_SIMPLE) &&
+		(window->layout_mode != GRAPHICS_WINDOW_LAYOUT_2D))
+	{
+		display_message(ERROR_MESSAGE, "Graphics_window_write_tiled_image.  "
+			"Only single pane layouts can be written in tiles");
+		return 0;
+	}
+	switch (storage)
+	{
+		case TEXTURE_LUMINANCE:
+		case TEXTURE_LUMINANCE_ALPHA:
+		case TEXTURE_RGB:
+		case TEXTURE_RGBA:
+		{
+			number_of_components = Texture_storage_type_get_number_of_components(storage);
+		} break;
+		default:
+		{
+			display_message(ERROR_MESSAGE, "Graphics_window_write_tiled_image.  "
+				"Format must be luminance, luminance_alpha, rgb or rgba");
+			return 0;
+		} break;
+	}
+	Graphics_window_get_viewing_area_size(window, &panel_width, &panel_height);
+	frame_width = (width) ? width : panel_width;
+	frame_height = (height) ? height : panel_height;
+	antialias = preferred_antialias;
+	if (antialias == -1)
+	{
+		antialias = window->antialias_mode;
+	}
+	if (tile_size > GRAPHICS_WINDOW_DEFAULT_TILE_SIZE)
+	{
+		tile_size = GRAPHICS_WINDOW_DEFAULT_TILE_SIZE;
+	}
+	tile_width = (frame_width < tile_size) ? frame_width : tile_size;
+	tile_height = (frame_height < tile_size) ? frame_height : tile_size;
+	fraction_across = (double)frame_width / (double)tile_width;
+	fraction_down = (double)frame_height / (double)tile_height;
+	tiles_across = (int)ceil(fraction_across);
+	tiles_down = (int)ceil(fraction_down);
+	scene_viewer = Graphics_window_get_Scene_viewer(window, /*pane_no*/0);
+	offscreen_buffer = create_Graphics_buffer_offscreen_from_buffer(
+		tile_width, tile_height, Scene_viewer_app_get_graphics_buffer(scene_viewer));
+	if (!offscreen_buffer)
+	{
+		display_message(ERROR_MESSAGE, "Graphics_window_write_tiled_image.  "
+			"Unable to create offscreen buffer");
+		return 0;
+	}
+	Tiled_image_writer writer(frame_width, frame_height, number_of_components,
+		number_of_threads);
+	return_code = writer.open(file_name) ? 1 : 0;
+	if (return_code)
+	{
+		framebuffer_flag = (GRAPHICS_BUFFER_GL_EXT_FRAMEBUFFER_TYPE ==
+			Graphics_buffer_get_type(Graphics_buffer_app_get_core_buffer(offscreen_buffer)));
+		if (framebuffer_flag)
+		{
+			Scene_viewer_app_redraw_now(scene_viewer);
+		}
+		Graphics_buffer_app_make_current(offscreen_buffer);
+#if defined (OPENGL_API) && defined (USE_MSAA) && defined (WX_USER_INTERFACE)
+		int multisample_framebuffer_flag = 0;
+		if (framebuffer_flag && (antialias > 1))
+		{
+			multisample_framebuffer_flag = Graphics_buffer_set_multisample_framebuffer(
+				Graphics_buffer_app_get_core_buffer(offscreen_buffer), antialias);
+		}
+#endif
+#if !defined (USE_MSAA)
+		if (framebuffer_flag)
+		{
+			/* as for Graphics_window_get_frame_pixels */
+			antialias = 0;
+		}
+#endif /* !defined (USE_MSAA) */
+		Scene_viewer_get_viewing_volume(scene_viewer->core_scene_viewer,
+			&original_left, &original_right, &original_bottom, &original_top,
+			&original_near_plane, &original_far_plane);
+		Scene_viewer_get_NDC_info(scene_viewer->core_scene_viewer,
+			&original_NDC_left, &original_NDC_top, &original_NDC_width, &original_NDC_height);
+		Scene_viewer_get_viewport_info(scene_viewer->core_scene_viewer,
+			&original_viewport_left, &original_viewport_top,
+			&original_viewport_pixels_per_x, &original_viewport_pixels_per_y);
+		Scene_viewer_get_viewing_volume_and_NDC_info_for_specified_size(
+			scene_viewer->core_scene_viewer, frame_width, frame_height,
+			panel_width, panel_height, &real_left, &real_right, &real_bottom, &real_top,
+			&scaled_NDC_width, &scaled_NDC_height);
+		NDC_width = scaled_NDC_width / fraction_across;
+		NDC_height = scaled_NDC_height / fraction_down;
+		std::vector<unsigned char> tile_pixels;
+		for (j = 0; return_code && (j < tiles_down); j++)
+		{
+			bottom = real_bottom + (double)j * (real_top - real_bottom) / fraction_down;
+			top = real_bottom + (double)(j + 1) * (real_top - real_bottom) / fraction_down;
+			bottom_tile = j * tile_height;
+			patch_height = (j < tiles_down - 1) ? tile_height : (frame_height - bottom_tile);
+			for (i = 0; return_code && (i < tiles_across); i++)
+			{
+				left = real_left + (double)i * (real_right - real_left) / fraction_across;
+				right = real_left + (double)(i + 1) * (real_right - real_left) / fraction_across;
+				left_tile = i * tile_width;
+				patch_width = (i < tiles_across - 1) ? tile_width : (frame_width - left_tile);
+				Scene_viewer_set_viewing_volume(scene_viewer->core_scene_viewer,
+					left, right, bottom, top, original_near_plane, original_far_plane);
+				Scene_viewer_set_NDC_info(scene_viewer->core_scene_viewer,
+					original_NDC_left + (double)i * original_NDC_width / fraction_across,
+					original_NDC_top + (double)j * original_NDC_height / fraction_down,
+					NDC_width, NDC_height);
+				Scene_viewer_set_viewport_info(scene_viewer->core_scene_viewer,
+					left_tile / original_viewport_pixels_per_x,
+					((j + 1) * tile_height - frame_height) / original_viewport_pixels_per_y,
+					original_viewport_pixels_per_x, original_viewport_pixels_per_y);
+				Scene_viewer_render_scene_in_viewport_with_overrides(scene_viewer->core_scene_viewer,
+					/*left*/0, /*bottom*/0, /*right*/tile_width, /*top*/tile_height,
+					antialias, preferred_transparency_layers, /*drawing_offscreen*/1);
+#if defined (OPENGL_API) && defined (USE_MSAA) && defined (WX_USER_INTERFACE)
+				if (multisample_framebuffer_flag)
+				{
+					Graphics_buffer_blit_framebuffer(Graphics_buffer_app_get_core_buffer(offscreen_buffer));
+				}
+#endif
+				/* read back into a fresh buffer handed over to the writer threads */
+				tile_pixels.resize(patch_width * patch_height * number_of_components);
+				return_code = Graphics_library_read_pixels(&(tile_pixels[0]),
+					patch_width, patch_height, storage, /*front_buffer*/0);
+				if (return_code)
+				{
+					return_code = writer.addTile(tile_pixels, left_tile, bottom_tile,
+						patch_width, patch_height) ? 1 : 0;
+				}
+#if defined (OPENGL_API) && defined (USE_MSAA) && defined (WX_USER_INTERFACE)
+				if (multisample_framebuffer_flag)
+				{
+					Graphics_buffer_reset_multisample_framebuffer(Graphics_buffer_app_get_core_buffer(offscreen_buffer));
+				}
+#endif
+			}
+		}
+		Scene_viewer_set_viewing_volume(scene_viewer->core_scene_viewer,
+			original_left, original_right, original_bottom, original_top,
+			original_near_plane, original_far_plane);
+		Scene_viewer_set_NDC_info(scene_viewer->core_scene_viewer,
+			original_NDC_left, original_NDC_top, original_NDC_width, original_NDC_height);
+		Scene_viewer_set_viewport_info(scene_viewer->core_scene_viewer,
+			original_viewport_left, original_viewport_top,
+			original_viewport_pixels_per_x, original_viewport_pixels_per_y);
+		if (!writer.finish())
+		{
+			return_code = 0;
+		}
+	}
+	DESTROY(Graphics_buffer_app)(&offscreen_buffer);
+	return (return_code);
+}
+
 int Graphics_window_view_all(struct Graphics_window *window)
 /*******************************************************************************
 LAST MODIFIED : 16 October 2001
@@ -6431,6 +6615,16 @@ Writes the properties of the <window> to the command window.
 		{
 			cmzn_sceneviewer *pane_sceneviewer = window->scene_viewer_array[pane_no]->core_scene_viewer;
 			display_message(INFORMATION_MESSAGE,"  pane: %d\n",pane_no+1);
+			/* render timing */
+			int number_of_renders;
+			double last_render_seconds, mean_render_seconds;
+			if (Scene_viewer_app_get_render_statistics(window->scene_viewer_array[pane_no],
+				&number_of_renders, &last_render_seconds, &mean_render_seconds))
+			{
+				display_message(INFORMATION_MESSAGE,
+					"    renders: %d (last %g ms, mean %g ms)\n", number_of_renders,
+					last_render_seconds*1000.0, mean_render_seconds*1000.0);
+			}
 			/* background */
 			Scene_viewer_get_background_colour(pane_sceneviewer,&colour);
 			display_message(INFORMATION_MESSAGE,
@@ -455,6 +455,24 @@ display and the <preferred_width> and <preferred_height> are ignored.
 Currently limited to 1 byte per component -- may want to improve for HPC.
 ==============================================================================*/
 
+/** Default and maximum tile size for Graphics_window_write_tiled_image. */
+#define GRAPHICS_WINDOW_DEFAULT_TILE_SIZE (2048)
+
+/***************************************************************************//**
+ * Renders the first pane of <window> offscreen at <width> x <height> in tiles
+ * of at most <tile_size> pixels square, streaming each tile to a binary
+ * PNM/PAM file as soon as it is read back so the whole frame is never held in
+ * memory. Rows are reordered and written by <number_of_threads> worker threads
+ * while the next tile renders. Only single pane layouts are supported.
+ * @param storage  Pixel format: luminance, luminance_alpha, rgb or rgba.
+ * @param width, height  Image size; zero to use the window size.
+ * @return  1 on success, 0 on failure.
+ */
+int Graphics_window_write_tiled_image(struct Graphics_window *window,
+	const char *file_name, enum Texture_storage_type storage, int width, int height,
+	int preferred_antialias, int preferred_transparency_layers, int tile_size,
+	int number_of_threads);
+
 int Graphics_window_view_all(struct Graphics_window *window);
 /*******************************************************************************
 LAST MODIFIED : 6 October 1998
@@ -4,6 +4,8 @@
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <vector>
+
 #include "zinc/glyph.h"
 #include "zinc/material.h"
 #include "zinc/status.h"
@@ -24,6 +26,7 @@
 #include "graphics/tessellation.hpp"
 #include "graphics/tessellation_app.hpp"
 #include "user_interface/process_list_or_write_command.hpp"
+#include "finite_element/finite_element_ranges_app.hpp"
 #include "finite_element/finite_element_region_app.h"
 #include "graphics/font.h"
 // insert app headers here
@@ -302,6 +305,21 @@ int cmzn_scene_list_commands(struct cmzn_scene *scene,
 	 return (return_code);
 }
 
+int cmzn_scene_write_commands_to_comfile(struct cmzn_scene *scene,
+	const char *command_prefix, const char *command_suffix)
+{
+	int return_code = 0;
+	Process_write_command_class *write_message =
+		new Process_write_command_class();
+	if (write_message)
+	{
+		return_code = cmzn_scene_process_list_or_write_window_commands(
+			scene, command_prefix, command_suffix, write_message);
+		delete write_message;
+	}
+	return (return_code);
+}
+
 int cmzn_scene_list_contents(struct cmzn_scene *scene)
 {
 	char *name = 0;
@@ -817,6 +835,181 @@ int cmzn_scene_change_selection_from_node_list(cmzn_scene_id scene,
 	return (return_code);
 }
 
+/** Number of nodes gathered before the conditional is evaluated on them. */
+const int CMZN_SCENE_NODE_SELECTION_CHUNK_SIZE = 4096;
+
+/**
+ * Releases the node handles in nodes and clears it.
+ */
+static void cmzn_scene_release_nodes(std::vector<cmzn_node_id>& nodes)
+{
+	const size_t number_of_nodes = nodes.size();
+	for (size_t i = 0; i < number_of_nodes; ++i)
+		cmzn_node_destroy(&(nodes[i]));
+	nodes.clear();
+}
+
+/**
+ * Moves the nodes in chunk for which conditional_field is true, or all of
+ * them if there is no conditional_field, onto the end of changes, releasing
+ * the others. Clears chunk.
+ * @param cache  Field cache with time set. Unused if no conditional_field.
+ */
+static void cmzn_scene_filter_node_selection_chunk(cmzn_field_id conditional_field,
+	cmzn_fieldcache_id cache, std::vector<cmzn_node_id>& chunk,
+	std::vector<cmzn_node_id>& changes)
+{
+	const size_t number_in_chunk = chunk.size();
+	for (size_t i = 0; i < number_in_chunk; ++i)
+	{
+		if (conditional_field)
+		{
+			cmzn_fieldcache_set_node(cache, chunk[i]);
+			if (!cmzn_field_evaluate_boolean(conditional_field, cache))
+			{
+				cmzn_node_destroy(&(chunk[i]));
+				continue;
+			}
+		}
+		changes.push_back(chunk[i]);
+	}
+	chunk.clear();
+}
+
+/**
+ * Adds or removes each node in changes to/from nodeset_group, then releases
+ * the node handles and clears changes.
+ */
+static void cmzn_scene_change_node_selection_batch(cmzn_nodeset_group_id nodeset_group,
+	std::vector<cmzn_node_id>& changes, bool add_flag)
+{
+	const size_t number_of_changes = changes.size();
+	for (size_t i = 0; i < number_of_changes; ++i)
+	{
+		if (add_flag)
+			cmzn_nodeset_group_add_node(nodeset_group, changes[i]);
+		else
+			cmzn_nodeset_group_remove_node(nodeset_group, changes[i]);
+		cmzn_node_destroy(&(changes[i]));
+	}
+	changes.clear();
+}
+
+int cmzn_scene_change_node_selection_ranges_conditional(cmzn_scene_id scene,
+	int use_data, struct Multi_range *node_ranges, cmzn_field_id conditional_field,
+	double time, bool add_flag, int *number_changed_address)
+{
+	if (number_changed_address)
+		*number_changed_address = 0;
+	if (!scene)
+	{
+		display_message(ERROR_MESSAGE,
+			"cmzn_scene_change_node_selection_ranges_conditional.  Invalid argument(s)");
+		return 0;
+	}
+	int return_code = 1;
+	cmzn_fieldmodule_id field_module = cmzn_region_get_fieldmodule(scene->region);
+	cmzn_fieldmodule_begin_change(field_module);
+	cmzn_nodeset_id master_nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(
+		field_module, use_data ? CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS : CMZN_FIELD_DOMAIN_TYPE_NODES);
+	/* for unselect, only get an existing selection; for select, the selection
+	 * group is created when the first matching node is found */
+	cmzn_nodeset_group_id nodeset_group = 0;
+	cmzn_field_group_id selection_group = cmzn_scene_get_selection_group(scene);
+	if (selection_group)
+	{
+		cmzn_field_node_group_id node_group = cmzn_field_group_get_field_node_group(selection_group, master_nodeset);
+		nodeset_group = cmzn_field_node_group_get_nodeset_group(node_group);
+		cmzn_field_node_group_destroy(&node_group);
+		cmzn_field_group_destroy(&selection_group);
+	}
+	int number_changed = 0;
+	const bool use_ranges = node_ranges && (0 < Multi_range_get_number_of_ranges(node_ranges));
+	if ((!add_flag) && (!nodeset_group))
+	{
+		/* nothing selected */
+	}
+	else if ((!add_flag) && (!use_ranges) && (!conditional_field))
+	{
+		number_changed = cmzn_nodeset_get_size(cmzn_nodeset_group_base_cast(nodeset_group));
+		cmzn_nodeset_group_remove_all_nodes(nodeset_group);
+	}
+	else
+	{
+		/* Nodes are gathered in chunks and the conditional evaluated on each
+		 * chunk. Select iterates over the master nodeset and adds each chunk as
+		 * it is evaluated. Unselect iterates over the selection only, which cannot
+		 * be modified until iteration ends, so nodes to remove are kept until
+		 * then. */
+		cmzn_nodeset_id iteration_nodeset = add_flag ? master_nodeset :
+			cmzn_nodeset_group_base_cast(nodeset_group);
+		cmzn_fieldcache_id cache = 0;
+		if (conditional_field)
+		{
+			cache = cmzn_fieldmodule_create_fieldcache(field_module);
+			cmzn_fieldcache_set_time(cache, time);
+		}
+		std::vector<cmzn_node_id> chunk, changes;
+		chunk.reserve(CMZN_SCENE_NODE_SELECTION_CHUNK_SIZE);
+		{
+			Nodeset_ranges_iterator iter(iteration_nodeset, node_ranges);
+			bool more = true;
+			while (more)
+			{
+				cmzn_node_id node = iter.nextNonAccess();
+				if (node)
+					chunk.push_back(cmzn_node_access(node));
+				else
+					more = false;
+				if (chunk.empty() ||
+					(more && (static_cast<int>(chunk.size()) < CMZN_SCENE_NODE_SELECTION_CHUNK_SIZE)))
+				{
+					continue;
+				}
+				cmzn_scene_filter_node_selection_chunk(conditional_field, cache, chunk, changes);
+				if ((!add_flag) || changes.empty())
+					continue;
+				if (!nodeset_group)
+				{
+					selection_group = cmzn_scene_get_or_create_selection_group(scene);
+					cmzn_field_node_group_id node_group = cmzn_field_group_get_field_node_group(selection_group, master_nodeset);
+					if (!node_group)
+						node_group = cmzn_field_group_create_field_node_group(selection_group, master_nodeset);
+					nodeset_group = cmzn_field_node_group_get_nodeset_group(node_group);
+					cmzn_field_node_group_destroy(&node_group);
+					cmzn_field_group_destroy(&selection_group);
+					if (!nodeset_group)
+					{
+						display_message(ERROR_MESSAGE,
+							"cmzn_scene_change_node_selection_ranges_conditional.  Could not create selection group");
+						return_code = 0;
+						break;
+					}
+				}
+				number_changed += static_cast<int>(changes.size());
+				cmzn_scene_change_node_selection_batch(nodeset_group, changes, add_flag);
+			}
+		}
+		cmzn_fieldcache_destroy(&cache);
+		cmzn_scene_release_nodes(chunk);
+		if (return_code && (!add_flag))
+		{
+			number_changed = static_cast<int>(changes.size());
+			cmzn_scene_change_node_selection_batch(nodeset_group, changes, add_flag);
+		}
+		cmzn_scene_release_nodes(changes);
+	}
+	cmzn_nodeset_group_destroy(&nodeset_group);
+	cmzn_nodeset_destroy(&master_nodeset);
+	cmzn_fieldmodule_end_change(field_module);
+	cmzn_fieldmodule_destroy(&field_module);
+	if ((!add_flag) && (0 < number_changed))
+		cmzn_scene_flush_tree_selections(scene);
+	if (number_changed_address)
+		*number_changed_address = number_changed;
+	return return_code;
+}
+
 int cmzn_scene_add_selection_from_node_list(cmzn_scene_id scene,
 	struct LIST(FE_node) *node_list, int use_data)
 /*******************************************************************************
@@ -37,6 +37,13 @@ struct Scene_command_data
 int gfx_modify_scene_general(struct Parse_state *state,
 	void *cmiss_region_void, void *dummy_void);
 
+/**
+ * Writes the commands recreating the graphics of <scene> to the command file
+ * currently being written, each line wrapped in prefix and suffix.
+ */
+int cmzn_scene_write_commands_to_comfile(struct cmzn_scene *scene,
+	const char *command_prefix, const char *command_suffix);
+
 /**
  * Lists the general graphics defined for <scene>.
  */
@@ -125,6 +132,25 @@ int cmzn_scene_add_selection_from_node_list(cmzn_scene_id scene,
 int cmzn_scene_remove_selection_from_node_list(cmzn_scene_id scene,
 	struct LIST(FE_node) *node_list, int use_data);
 
+/**
+ * Adds or removes nodes or datapoints to/from the scene's selection without
+ * building an intermediate node list. Nodes are visited in identifier order,
+ * with small ranges found by identifier lookup, and the conditional is
+ * evaluated on bounded chunks of them within a single change cache. Unselect
+ * only visits nodes in the selection. The selection group is only created
+ * when a node is to be selected.
+ * @param use_data  Non-zero to change datapoint selection, 0 for nodes.
+ * @param node_ranges  Optional identifier ranges; NULL or empty for all.
+ * @param conditional_field  Optional field which must be true at time.
+ * @param add_flag  True to select, false to unselect.
+ * @param number_changed_address  Optional: on return, the number of nodes
+ * matching ranges and conditional; for unselect, only those in the selection.
+ * @return  1 on success, 0 on failure.
+ */
+int cmzn_scene_change_node_selection_ranges_conditional(cmzn_scene_id scene,
+	int use_data, struct Multi_range *node_ranges, cmzn_field_id conditional_field,
+	double time, bool add_flag, int *number_changed_address);
+
 PROTOTYPE_OPTION_TABLE_ADD_ENUMERATOR_FUNCTION( cmzn_streaminformation_scene_io_data_type );
 
 /**
@@ -4,7 +4,10 @@
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <algorithm>
+#include <vector>
 #include "general/debug.h"
+#include "general/elapsed_time_app.h"
 #include "general/message.h"
 #include "graphics/graphics_module.h"
 #include "graphics/scene_viewer.h"
@@ -63,6 +66,202 @@ DEFINE_CMZN_CALLBACK_FUNCTIONS(Scene_viewer_app_callback, \
 DEFINE_CMZN_CALLBACK_FUNCTIONS(Scene_viewer_app_input_callback,
 	struct Scene_viewer_app *,struct Graphics_buffer_input *);
 
+/** Default maximum rate for redrawing scene viewers in idle time */
+#define SCENE_VIEWER_APP_DEFAULT_REDRAW_FRAME_RATE (60.0)
+
+/***************************************************************************//**
+ * Coalesces idle time redraw requests from all scene viewers so that each
+ * frame interval the viewers needing a redraw are drawn together, at most
+ * once each. A frame is posted as an idle callback, preceded by a timeout if
+ * the previous frame was drawn less than a frame interval ago, so pending
+ * input events are always handled first.
+ */
+struct Scene_viewer_app_redraw_scheduler
+{
+	struct Event_dispatcher *event_dispatcher;
+	struct Event_dispatcher_idle_callback *idle_callback_id;
+	struct Event_dispatcher_timeout_callback *timeout_callback_id;
+	std::vector<struct Scene_viewer_app *> pending_scene_viewers;
+	/* viewers in the frame being drawn; cleared as drawn or cancelled */
+	std::vector<struct Scene_viewer_app *> frame_scene_viewers;
+	/* 0 to draw as soon as idle */
+	double frame_interval;
+	double last_frame_seconds;
+
+	Scene_viewer_app_redraw_scheduler() :
+		event_dispatcher(0),
+		idle_callback_id(0),
+		timeout_callback_id(0),
+		frame_interval(1.0/SCENE_VIEWER_APP_DEFAULT_REDRAW_FRAME_RATE),
+		last_frame_seconds(0.0)
+	{
+	}
+};
+
+static Scene_viewer_app_redraw_scheduler scene_viewer_app_redraw_scheduler;
+
+static int Scene_viewer_app_redraw_scheduler_frame_callback(void *dummy_void)
+/*******************************************************************************
+Draws all scene viewers pending at the start of the frame. Viewers requesting
+a redraw after they are drawn, e.g. tumbling viewers, wait for the next frame.
+==============================================================================*/
+{
+	Scene_viewer_app_redraw_scheduler &scheduler = scene_viewer_app_redraw_scheduler;
+
+	USE_PARAMETER(dummy_void);
+	scheduler.idle_callback_id = (struct Event_dispatcher_idle_callback *)NULL;
+	scheduler.last_frame_seconds = get_elapsed_time_seconds();
+	scheduler.frame_scene_viewers.swap(scheduler.pending_scene_viewers);
+	for (size_t i = 0; i < scheduler.frame_scene_viewers.size(); ++i)
+	{
+		/* viewers redrawn immediately or destroyed meanwhile have been cleared */
+		struct Scene_viewer_app *scene_viewer = scheduler.frame_scene_viewers[i];
+		if (scene_viewer)
+		{
+			scheduler.frame_scene_viewers[i] = 0;
+			scene_viewer->redraw_pending = 0;
+			Scene_viewer_app_idle_update_callback(scene_viewer);
+		}
+	}
+	scheduler.frame_scene_viewers.clear();
+	/* We don't want the idle callback to repeat so we return 0 */
+	return 0;
+}
+
+static int Scene_viewer_app_redraw_scheduler_timeout_callback(void *dummy_void)
+/*******************************************************************************
+Frame interval has elapsed: draw the frame when next idle.
+==============================================================================*/
+{
+	Scene_viewer_app_redraw_scheduler &scheduler = scene_viewer_app_redraw_scheduler;
+
+	USE_PARAMETER(dummy_void);
+	scheduler.timeout_callback_id = (struct Event_dispatcher_timeout_callback *)NULL;
+	if (!scheduler.pending_scene_viewers.empty())
+	{
+		scheduler.idle_callback_id = Event_dispatcher_add_idle_callback(
+			scheduler.event_dispatcher, Scene_viewer_app_redraw_scheduler_frame_callback,
+			(void *)NULL, EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
+	}
+	return 1;
+}
+
+static void Scene_viewer_app_schedule_redraw(struct Scene_viewer_app *scene_viewer)
+/*******************************************************************************
+Queues <scene_viewer> for the next frame, posting the frame if not already.
+==============================================================================*/
+{
+	Scene_viewer_app_redraw_scheduler &scheduler = scene_viewer_app_redraw_scheduler;
+
+	if (!scene_viewer->redraw_pending)
+	{
+		scene_viewer->redraw_pending = 1;
+		scheduler.pending_scene_viewers.push_back(scene_viewer);
+	}
+	if ((!scheduler.pending_scene_viewers.empty()) &&
+		(!scheduler.idle_callback_id) && (!scheduler.timeout_callback_id))
+	{
+		scheduler.event_dispatcher =
+			User_interface_get_event_dispatcher(scene_viewer->user_interface);
+		const double wait_seconds = scheduler.last_frame_seconds +
+			scheduler.frame_interval - get_elapsed_time_seconds();
+		if (0.0 < wait_seconds)
+		{
+			const unsigned long wait_ns = (unsigned long)(wait_seconds*1.0e9);
+			scheduler.timeout_callback_id = Event_dispatcher_add_timeout_callback(
+				scheduler.event_dispatcher, wait_ns/1000000000, wait_ns%1000000000,
+				Scene_viewer_app_redraw_scheduler_timeout_callback, (void *)NULL);
+		}
+		else
+		{
+			scheduler.idle_callback_id = Event_dispatcher_add_idle_callback(
+				scheduler.event_dispatcher, Scene_viewer_app_redraw_scheduler_frame_callback,
+				(void *)NULL, EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
+		}
+	}
+}
+
+static void Scene_viewer_app_cancel_redraw(struct Scene_viewer_app *scene_viewer)
+/*******************************************************************************
+Removes <scene_viewer> from the next frame or the frame being drawn, removing
+the next frame if no other viewers are pending.
+==============================================================================*/
+{
+	Scene_viewer_app_redraw_scheduler &scheduler = scene_viewer_app_redraw_scheduler;
+
+	if (scene_viewer->redraw_pending)
+	{
+		scene_viewer->redraw_pending = 0;
+		std::replace(scheduler.frame_scene_viewers.begin(),
+			scheduler.frame_scene_viewers.end(), scene_viewer,
+			static_cast<struct Scene_viewer_app *>(0));
+		scheduler.pending_scene_viewers.erase(std::remove(
+			scheduler.pending_scene_viewers.begin(),
+			scheduler.pending_scene_viewers.end(), scene_viewer),
+			scheduler.pending_scene_viewers.end());
+		if (scheduler.pending_scene_viewers.empty())
+		{
+			if (scheduler.idle_callback_id)
+			{
+				Event_dispatcher_remove_idle_callback(scheduler.event_dispatcher,
+					scheduler.idle_callback_id);
+				scheduler.idle_callback_id = (struct Event_dispatcher_idle_callback *)NULL;
+			}
+			if (scheduler.timeout_callback_id)
+			{
+				Event_dispatcher_remove_timeout_callback(scheduler.event_dispatcher,
+					scheduler.timeout_callback_id);
+				scheduler.timeout_callback_id = (struct Event_dispatcher_timeout_callback *)NULL;
+			}
+		}
+	}
+}
+
+static void Scene_viewer_app_add_render_time(struct Scene_viewer_app *scene_viewer,
+	double render_seconds)
+{
+	++(scene_viewer->number_of_renders);
+	scene_viewer->last_render_seconds = render_seconds;
+	scene_viewer->total_render_seconds += render_seconds;
+}
+
+int Scene_viewer_app_set_redraw_frame_rate(double frames_per_second)
+{
+	if (0.0 <= frames_per_second)
+	{
+		scene_viewer_app_redraw_scheduler.frame_interval =
+			(0.0 < frames_per_second) ? 1.0/frames_per_second : 0.0;
+		return 1;
+	}
+	display_message(ERROR_MESSAGE,
+		"Scene_viewer_app_set_redraw_frame_rate.  Invalid argument(s)");
+	return 0;
+}
+
+double Scene_viewer_app_get_redraw_frame_rate(void)
+{
+	const double frame_interval = scene_viewer_app_redraw_scheduler.frame_interval;
+	return (0.0 < frame_interval) ? 1.0/frame_interval : 0.0;
+}
+
+int Scene_viewer_app_get_render_statistics(struct Scene_viewer_app *scene_viewer,
+	int *number_of_renders_address, double *last_render_seconds_address,
+	double *mean_render_seconds_address)
+{
+	if (scene_viewer && number_of_renders_address && last_render_seconds_address &&
+		mean_render_seconds_address)
+	{
+		*number_of_renders_address = scene_viewer->number_of_renders;
+		*last_render_seconds_address = scene_viewer->last_render_seconds;
+		*mean_render_seconds_address = (0 < scene_viewer->number_of_renders) ?
+			scene_viewer->total_render_seconds/scene_viewer->number_of_renders : 0.0;
+		return 1;
+	}
+	display_message(ERROR_MESSAGE,
+		"Scene_viewer_app_get_render_statistics.  Invalid argument(s)");
+	return 0;
+}
+
 struct cmzn_sceneviewermodule_app *CREATE(cmzn_sceneviewermodule_app)(
 	struct Graphics_buffer_app_package *graphics_buffer_package,
 	cmzn_scene_id scene,
@@ -162,7 +361,10 @@ struct Scene_viewer_app *CREATE(Scene_viewer_app)(struct Graphics_buffer_app *gr
 			cmzn_sceneviewer_set_scene(scene_viewer->core_scene_viewer, scene);
 			cmzn_sceneviewer_set_scenefilter(scene_viewer->core_scene_viewer, filter);
 			scene_viewer->user_interface = user_interface;
-			scene_viewer->idle_update_callback_id = (struct Event_dispatcher_idle_callback *)NULL;
+			scene_viewer->redraw_pending = 0;
+			scene_viewer->number_of_renders = 0;
+			scene_viewer->last_render_seconds = 0.0;
+			scene_viewer->total_render_seconds = 0.0;
 			/* no current interactive_tool */
 			scene_viewer->interactive_tool=(struct Interactive_tool *)NULL;
 			/* Currently only set when created from a cmzn_sceneviewermodule
@@ -216,7 +418,10 @@ struct Scene_viewer_app *Scene_viewer_app_for_spectrum_create(struct Graphics_bu
 				filter);
 			cmzn_sceneviewer_set_scene(scene_viewer->core_scene_viewer, scene);
 			scene_viewer->user_interface = user_interface;
-			scene_viewer->idle_update_callback_id = (struct Event_dispatcher_idle_callback *)NULL;
+			scene_viewer->redraw_pending = 0;
+			scene_viewer->number_of_renders = 0;
+			scene_viewer->last_render_seconds = 0.0;
+			scene_viewer->total_render_seconds = 0.0;
 			/* no current interactive_tool */
 			scene_viewer->interactive_tool=(struct Interactive_tool *)NULL;
 			/* Currently only set when created from a cmzn_sceneviewermodule
@@ -251,12 +456,7 @@ int DESTROY(Scene_viewer_app)(struct Scene_viewer_app **scene_viewer_app_address
 	if (scene_viewer_app_address && (scene_viewer = *scene_viewer_app_address))
 	{
 		return_code = 1;
-		if (scene_viewer->idle_update_callback_id)
-		{
-			Event_dispatcher_remove_idle_callback(
-				User_interface_get_event_dispatcher(scene_viewer->user_interface),
-				scene_viewer->idle_update_callback_id);
-		}
+		Scene_viewer_app_cancel_redraw(scene_viewer);
 		if (scene_viewer->notifier)
 		{
 			cmzn_sceneviewernotifier_destroy(&scene_viewer->notifier);
@@ -353,14 +553,8 @@ about which the scene is turning relative to its lookat point and the
 		scene_viewer->core_scene_viewer->tumble_axis[1] = tumble_axis[1];
 		scene_viewer->core_scene_viewer->tumble_axis[2] = tumble_axis[2];
 		scene_viewer->core_scene_viewer->tumble_angle = tumble_angle;
-		/* Repost the idle callback */
-		if(!scene_viewer->idle_update_callback_id)
-		{
-			scene_viewer->idle_update_callback_id = Event_dispatcher_add_idle_callback(
-				User_interface_get_event_dispatcher(scene_viewer->user_interface),
-				Scene_viewer_app_idle_update_callback, (void *)scene_viewer,
-				EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
-		}
+		/* Spin in the next frame */
+		Scene_viewer_app_schedule_redraw(scene_viewer);
 		return_code=1;
 	}
 	else
@@ -379,13 +573,7 @@ int Scene_viewer_app_sleep(struct Scene_viewer_app *scene_viewer)
 	int return_code = 1;
 	if (scene_viewer)
 	{
-		if (scene_viewer->idle_update_callback_id)
-		{
-			Event_dispatcher_remove_idle_callback(
-				User_interface_get_event_dispatcher(scene_viewer->user_interface),
-				scene_viewer->idle_update_callback_id);
-			scene_viewer->idle_update_callback_id=(struct Event_dispatcher_idle_callback *)NULL;
-		}
+		Scene_viewer_app_cancel_redraw(scene_viewer);
 		return_code = Scene_viewer_sleep(scene_viewer->core_scene_viewer);
 	}
 
@@ -677,13 +865,7 @@ int Scene_viewer_app_input_transform(struct Scene_viewer_app *scene_viewer_app,
 					scene_viewer_app->core_scene_viewer->tumble_angle)
 				{
 					scene_viewer_app->core_scene_viewer->tumble_active = 1;
-					if (!scene_viewer_app->idle_update_callback_id)
-					 {
-						scene_viewer_app->idle_update_callback_id = Event_dispatcher_add_idle_callback(
-								User_interface_get_event_dispatcher(scene_viewer_app->user_interface),
-								Scene_viewer_app_idle_update_callback, (void *)scene_viewer_app,
-								EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
-					 }
+					Scene_viewer_app_schedule_redraw(scene_viewer_app);
 				}
 			} break;
 			default:
@@ -856,36 +1038,26 @@ Requests a full redraw immediately.
 ==============================================================================*/
 {
 	int return_code = 0;
-	struct Event_dispatcher *event_dispatcher = 0;
 
 	ENTER(Scene_viewer_redraw_now);
 	if (scene_viewer)
 	{
-		/* remove idle update workproc if pending */
-		event_dispatcher = User_interface_get_event_dispatcher(
-			scene_viewer->user_interface);
-		if (scene_viewer->idle_update_callback_id)
-		{
-			Event_dispatcher_remove_idle_callback(
-				event_dispatcher, scene_viewer->idle_update_callback_id);
-			scene_viewer->idle_update_callback_id = (struct Event_dispatcher_idle_callback *)NULL;
-		}
+		/* this redraw takes the place of any pending in idle time */
+		Scene_viewer_app_cancel_redraw(scene_viewer);
 		if (scene_viewer->core_scene_viewer->tumble_active)
 		{
 			Scene_viewer_automatic_tumble(scene_viewer);
-			if(!scene_viewer->idle_update_callback_id)
-			{
-				scene_viewer->idle_update_callback_id =  Event_dispatcher_add_idle_callback(
-					event_dispatcher, Scene_viewer_app_idle_update_callback, scene_viewer,
-					EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
-			}
+			Scene_viewer_app_schedule_redraw(scene_viewer);
 		}
+		const double render_start_seconds = get_elapsed_time_seconds();
 		Graphics_buffer_app_make_current(scene_viewer->graphics_buffer);
 		return_code = cmzn_sceneviewer_render_scene(scene_viewer->core_scene_viewer);
 		if (scene_viewer->core_scene_viewer->swap_buffers)
 		{
 			Graphics_buffer_app_swap_buffers(scene_viewer->graphics_buffer);
 		}
+		Scene_viewer_app_add_render_time(scene_viewer,
+			get_elapsed_time_seconds() - render_start_seconds);
 	}
 	else
 	{
@@ -908,30 +1080,18 @@ and <transparency_layers> are used for just this render.
 ==============================================================================*/
 {
 	int return_code = 0;
-	struct Event_dispatcher *event_dispatcher = 0;
 
 	ENTER(Scene_viewer_redraw_now);
 	if (scene_viewer)
 	{
-		/* remove idle update workproc if pending */
-		event_dispatcher = User_interface_get_event_dispatcher(
-			scene_viewer->user_interface);
-		if (scene_viewer->idle_update_callback_id)
-		{
-			Event_dispatcher_remove_idle_callback(
-				event_dispatcher, scene_viewer->idle_update_callback_id);
-			scene_viewer->idle_update_callback_id = (struct Event_dispatcher_idle_callback *)NULL;
-		}
+		/* this redraw takes the place of any pending in idle time */
+		Scene_viewer_app_cancel_redraw(scene_viewer);
 		if (scene_viewer->core_scene_viewer->tumble_active)
 		{
 			Scene_viewer_automatic_tumble(scene_viewer);
-			if(!scene_viewer->idle_update_callback_id)
-			{
-				scene_viewer->idle_update_callback_id = Event_dispatcher_add_idle_callback(
-					event_dispatcher, Scene_viewer_app_idle_update_callback, (void *)scene_viewer,
-					EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
-			}
+			Scene_viewer_app_schedule_redraw(scene_viewer);
 		}
+		const double render_start_seconds = get_elapsed_time_seconds();
 		Graphics_buffer_app_make_current(scene_viewer->graphics_buffer);
 		return_code = Scene_viewer_render_scene_in_viewport_with_overrides(
 			scene_viewer->core_scene_viewer, /*left*/0, /*bottom*/0, /*right*/0, /*top*/0,
@@ -940,6 +1100,8 @@ and <transparency_layers> are used for just this render.
 		{
 			Graphics_buffer_app_swap_buffers(scene_viewer->graphics_buffer);
 		}
+		Scene_viewer_app_add_render_time(scene_viewer,
+			get_elapsed_time_seconds() - render_start_seconds);
 	}
 	else
 	{
@@ -986,7 +1148,8 @@ int Scene_viewer_app_idle_update_callback(void *scene_viewer_void)
 LAST MODIFIED : 14 July 2000
 
 DESCRIPTION :
-Updates the scene_viewer.
+Updates the scene_viewer. Called for each viewer in a frame of the redraw
+scheduler.
 ==============================================================================*/
 {
 	int repeat_idle;
@@ -995,32 +1158,27 @@ Updates the scene_viewer.
 	ENTER(Scene_viewer_app_idle_update_callback);
 	if (scene_viewer != 0)
 	{
-		/* set workproc no longer pending */
-		scene_viewer->idle_update_callback_id = (struct Event_dispatcher_idle_callback *)NULL;
 		if (scene_viewer->core_scene_viewer->tumble_active &&
 				(!Interactive_tool_is_Transform_tool(scene_viewer->interactive_tool) ||
 				Interactive_tool_transform_get_free_spin(scene_viewer->interactive_tool)))
 		{
 			Scene_viewer_automatic_tumble(scene_viewer);
-			/* Repost the idle callback */
-			if(!scene_viewer->idle_update_callback_id)
-			{
-				scene_viewer->idle_update_callback_id = Event_dispatcher_add_idle_callback(
-					User_interface_get_event_dispatcher(scene_viewer->user_interface),
-					Scene_viewer_app_idle_update_callback, (void *)scene_viewer,
-					EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
-			}
+			/* Keep tumbling in the next frame */
+			Scene_viewer_app_schedule_redraw(scene_viewer);
 		}
 		else
 		{
 			scene_viewer->core_scene_viewer->tumble_angle = 0.0;
 		}
+		const double render_start_seconds = get_elapsed_time_seconds();
 		Graphics_buffer_app_make_current(scene_viewer->graphics_buffer);
 		cmzn_sceneviewer_render_scene(scene_viewer->core_scene_viewer);
 		if (scene_viewer->core_scene_viewer->swap_buffers)
 		{
 			Graphics_buffer_app_swap_buffers(scene_viewer->graphics_buffer);
 		}
+		Scene_viewer_app_add_render_time(scene_viewer,
+			get_elapsed_time_seconds() - render_start_seconds);
 		/* We don't want the idle callback to repeat so we return 0 */
 		repeat_idle = 0;
 	}
@@ -1041,11 +1199,11 @@ int Scene_viewer_app_redraw_in_idle_time(struct Scene_viewer_app *scene_viewer)
 LAST MODIFIED : 14 July 2000
 
 DESCRIPTION :
-Sets up a callback to Scene_viewer_idle_update for an update in idle time.
-Does this by putting a WorkProc on the queue - if not already done for this
-Scene_viewer - which will force a redraw at the next idle moment. If the
-scene_viewer is changed again before it is updated, a new WorkProc will not be
-put in the queue, but the old one will update the window to the new state.
+Queues the <scene_viewer> to be redrawn in the next frame of the redraw
+scheduler, which is drawn in idle time no sooner than one frame interval after
+the previous frame. If the scene_viewer is changed again before it is updated,
+it is not queued again, but is drawn once in the new state. Redraws of other
+scene viewers requested meanwhile are drawn in the same frame.
 ==============================================================================*/
 {
 	int return_code;
@@ -1053,13 +1211,7 @@ put in the queue, but the old one will update the window to the new state.
 	ENTER(Scene_viewer_redraw_in_idle_time);
 	if (scene_viewer)
 	{
-		if (!scene_viewer->idle_update_callback_id)
-		{
-			scene_viewer->idle_update_callback_id = Event_dispatcher_add_idle_callback(
-				User_interface_get_event_dispatcher(scene_viewer->user_interface),
-				Scene_viewer_app_idle_update_callback, (void *)scene_viewer,
-				EVENT_DISPATCHER_IDLE_UPDATE_SCENE_VIEWER_PRIORITY);
-		}
+		Scene_viewer_app_schedule_redraw(scene_viewer);
 		return_code=1;
 	}
 	else
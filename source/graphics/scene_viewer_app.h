@@ -50,8 +50,11 @@ struct Scene_viewer_app
 	struct Graphics_buffer_app *graphics_buffer;
 	struct Scene_viewer *core_scene_viewer;
 	struct User_interface *user_interface;
-	/* interaction */
-	struct Event_dispatcher_idle_callback *idle_update_callback_id;
+	/* set while queued for the next frame of the redraw scheduler */
+	int redraw_pending;
+	/* render timing for both scheduled and immediate redraws */
+	int number_of_renders;
+	double last_render_seconds, total_render_seconds;
 	/* Note: interactive_tool is NOT accessed by Scene_viewer; up to dialog
 		 owning it to clear it if it is destroyed. This is usually ensured by having
 		 a tool chooser in the parent dialog */
@@ -134,6 +137,32 @@ int Scene_viewer_app_redraw_now_with_overrides(struct Scene_viewer_app *scene_vi
 int Scene_viewer_app_redraw_now_without_swapbuffers(
 	struct Scene_viewer_app *scene_viewer);
 
+/***************************************************************************//**
+ * Sets the maximum rate at which scene viewers are redrawn in idle time. All
+ * scene viewers needing a redraw are coalesced and drawn together once per
+ * frame interval. Immediate redraws, e.g. from interactive transformations,
+ * are not limited and take the place of any pending redraw of that viewer.
+ * @param frames_per_second  Maximum redraw rate, or 0 to redraw as soon as
+ * the application is idle.
+ * @return  1 on success, 0 if frames_per_second is negative.
+ */
+int Scene_viewer_app_set_redraw_frame_rate(double frames_per_second);
+
+/** @return  Maximum redraw rate in frames per second, or 0 if unlimited. */
+double Scene_viewer_app_get_redraw_frame_rate(void);
+
+/***************************************************************************//**
+ * Gets render timing for the scene viewer.
+ * @param number_of_renders_address  On return, number of renders.
+ * @param last_render_seconds_address  On return, duration of the last render
+ * including buffer swap, or 0 if none.
+ * @param mean_render_seconds_address  On return, mean duration of all renders,
+ * or 0 if none.
+ */
+int Scene_viewer_app_get_render_statistics(struct Scene_viewer_app *scene_viewer,
+	int *number_of_renders_address, double *last_render_seconds_address,
+	double *mean_render_seconds_address);
+
 struct cmzn_sceneviewermodule_app *CREATE(cmzn_sceneviewermodule_app)(
 	struct Graphics_buffer_app_package *graphics_buffer_package,
 	cmzn_scene_id scene,
@@ -4,8 +4,12 @@
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <stdio.h>
+#include <string>
+#include <vector>
 #include "zinc/core.h"
 #include "general/debug.h"
+#include "general/mystring.h"
 #include "general/message.h"
 #include "command/parser.h"
 #include "graphics/auxiliary_graphics_types_app.h"
@@ -408,3 +412,60 @@ int gfx_list_tessellation(struct Parse_state *state,
 	return (return_code);
 }
 
+namespace {
+
+/** Appends divisions separated by * to command. */
+void cmzn_tessellation_append_divisions(std::string& command, const char *token,
+	int (*get_divisions)(cmzn_tessellation_id, int, int *), cmzn_tessellation_id tessellation)
+{
+	const int size = (get_divisions)(tessellation, 0, 0);
+	if (size < 1)
+		return;
+	std::vector<int> divisions(size);
+	(get_divisions)(tessellation, size, &(divisions[0]));
+	command += " ";
+	command += token;
+	command += " \"";
+	char value_string[32];
+	for (int i = 0; i < size; ++i)
+	{
+		sprintf(value_string, (0 == i) ? "%d" : "*%d", divisions[i]);
+		command += value_string;
+	}
+	command += "\"";
+}
+
+}
+
+int cmzn_tessellationmodule_write_commands_to_comfile(
+	cmzn_tessellationmodule_id tessellationmodule)
+{
+	if (!tessellationmodule)
+	{
+		display_message(ERROR_MESSAGE,
+			"cmzn_tessellationmodule_write_commands_to_comfile.  Invalid argument(s)");
+		return 0;
+	}
+	cmzn_tessellationiterator_id iter = cmzn_tessellationmodule_create_tessellationiterator(tessellationmodule);
+	cmzn_tessellation_id tessellation;
+	while (0 != (tessellation = cmzn_tessellationiterator_next(iter)))
+	{
+		char *name = cmzn_tessellation_get_name(tessellation);
+		make_valid_token(&name);
+		std::string command("gfx define tessellation ");
+		command += name;
+		DEALLOCATE(name);
+		cmzn_tessellation_append_divisions(command, "minimum_divisions",
+			cmzn_tessellation_get_minimum_divisions, tessellation);
+		cmzn_tessellation_append_divisions(command, "refinement_factors",
+			cmzn_tessellation_get_refinement_factors, tessellation);
+		char value_string[32];
+		sprintf(value_string, " circle_divisions %d;\n",
+			cmzn_tessellation_get_circle_divisions(tessellation));
+		command += value_string;
+		write_message_to_file(INFORMATION_MESSAGE, command.c_str());
+		cmzn_tessellation_destroy(&tessellation);
+	}
+	cmzn_tessellationiterator_destroy(&iter);
+	return 1;
+}
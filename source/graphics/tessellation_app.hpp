@@ -57,3 +57,11 @@ int gfx_destroy_tessellation(struct Parse_state *state, void *dummy_to_be_modifi
 int gfx_list_tessellation(struct Parse_state *state, void *dummy_to_be_modified,
 	void *tessellationmodule_void);
 
+/***************************************************************************//**
+ * Writes gfx define tessellation commands reproducing every tessellation in
+ * the module to the command file, so graphics using them can be restored.
+ * @return  1 on success, 0 on failure.
+ */
+int cmzn_tessellationmodule_write_commands_to_comfile(
+	struct cmzn_tessellationmodule *tessellationmodule);
+
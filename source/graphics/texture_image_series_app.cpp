@@ -0,0 +1,260 @@
+/***************************************************************************//**
+ * texture_image_series_app.cpp
+ *
+ * Reading of 3-D texture images from a file number series.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <algorithm>
+#include <vector>
+#include "general/debug.h"
+#include "general/message.h"
+#include "graphics/texture_image_series_app.hpp"
+
+namespace {
+
+/** Dimensions of the series and the downsampled texture image. */
+struct Texture_series_data
+{
+	struct Cmgui_image_information *cmgui_image_information;
+	char *file_name_template, *file_number_pattern;
+	int start, increment, number_of_files;
+	int left, bottom, width, height;
+	int number_of_components, number_of_bytes_per_component;
+	int downsample, output_width, output_height, output_depth;
+};
+
+/**
+ * Dispatches the cropped pixels of cmgui_image into slice_pixels, checking it
+ * matches the format of the first image.
+ */
+int Texture_series_dispatch_slice(Texture_series_data *series_data,
+	struct Cmgui_image *cmgui_image, int file_number, unsigned char *slice_pixels)
+{
+	if ((series_data->number_of_components != Cmgui_image_get_number_of_components(cmgui_image)) ||
+		(series_data->number_of_bytes_per_component != Cmgui_image_get_number_of_bytes_per_component(cmgui_image)) ||
+		(Cmgui_image_get_width(cmgui_image) < series_data->left + series_data->width) ||
+		(Cmgui_image_get_height(cmgui_image) < series_data->bottom + series_data->height))
+	{
+		display_message(ERROR_MESSAGE, "Texture_set_image_file_number_series_downsampled.  "
+			"Image %d does not match size or format of first image", file_number);
+		return 0;
+	}
+	const int bytes_per_pixel = series_data->number_of_components*series_data->number_of_bytes_per_component;
+	return Cmgui_image_dispatch(cmgui_image, /*image_number*/0,
+		series_data->left, series_data->bottom, series_data->width, series_data->height,
+		/*padded_width_bytes*/series_data->width*bytes_per_pixel,
+		/*number_of_fill_bytes*/0, /*fill_bytes*/(unsigned char *)NULL,
+		/*components*/0, slice_pixels);
+}
+
+/** Reads file number file_index of the series into slice_pixels. */
+int Texture_series_read_slice(Texture_series_data *series_data, int file_index,
+	unsigned char *slice_pixels)
+{
+	const int file_number = series_data->start + file_index*series_data->increment;
+	Cmgui_image_information_set_file_name_series(series_data->cmgui_image_information,
+		series_data->file_name_template, series_data->file_number_pattern,
+		/*start*/file_number, /*stop*/file_number, /*increment*/1);
+	struct Cmgui_image *cmgui_image = Texture_series_read_image(
+		series_data->cmgui_image_information, series_data->file_name_template);
+	if (!cmgui_image)
+	{
+		display_message(ERROR_MESSAGE, "Texture_set_image_file_number_series_downsampled.  "
+			"Could not read image %d", file_number);
+		return 0;
+	}
+	const int return_code = Texture_series_dispatch_slice(series_data, cmgui_image,
+		file_number, slice_pixels);
+	DESTROY(Cmgui_image)(&cmgui_image);
+	return return_code;
+}
+
+/** Adds the component values of slice_pixels to the downsampled sums. */
+template <typename Component> void Texture_series_accumulate_slice(
+	const Texture_series_data *series_data, const unsigned char *slice_pixels,
+	std::vector<double>& sums, std::vector<int>& counts)
+{
+	const Component *source = reinterpret_cast<const Component *>(slice_pixels);
+	const int number_of_components = series_data->number_of_components;
+	for (int j = 0; j < series_data->height; ++j)
+	{
+		const int output_row = (j/series_data->downsample)*series_data->output_width;
+		for (int i = 0; i < series_data->width; ++i)
+		{
+			const int output_pixel = output_row + i/series_data->downsample;
+			double *sum = &(sums[output_pixel*number_of_components]);
+			for (int c = 0; c < number_of_components; ++c)
+				sum[c] += static_cast<double>(*(source++));
+			++(counts[output_pixel]);
+		}
+	}
+}
+
+/** Writes the averages of the downsampled sums to plane_pixels. */
+template <typename Component> void Texture_series_write_average(
+	const Texture_series_data *series_data, const std::vector<double>& sums,
+	const std::vector<int>& counts, unsigned char *plane_pixels)
+{
+	Component *destination = reinterpret_cast<Component *>(plane_pixels);
+	const int number_of_components = series_data->number_of_components;
+	const int number_of_pixels = series_data->output_width*series_data->output_height;
+	for (int p = 0; p < number_of_pixels; ++p)
+	{
+		const double *sum = &(sums[p*number_of_components]);
+		const double scale = (0 < counts[p]) ? 1.0/static_cast<double>(counts[p]) : 0.0;
+		for (int c = 0; c < number_of_components; ++c)
+			*(destination++) = static_cast<Component>(sum[c]*scale + 0.5);
+	}
+}
+
+}
+
+struct Cmgui_image *Texture_series_read_image(
+	struct Cmgui_image_information *cmgui_image_information, const char *file_name)
+{
+	if (!(cmgui_image_information && file_name))
+	{
+		display_message(ERROR_MESSAGE, "Texture_series_read_image.  Invalid argument(s)");
+		return 0;
+	}
+	Image_file_format image_file_format = UNKNOWN_IMAGE_FILE_FORMAT;
+	Image_file_format_from_file_name(file_name, &image_file_format);
+	struct Cmgui_image *cmgui_image = 0;
+	if (image_file_format == ANALYZE_FILE_FORMAT)
+	{
+		cmgui_image = Cmgui_image_read_analyze(cmgui_image_information,
+			CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_DEFAULT);
+	}
+	else if (image_file_format == ANALYZE_OBJECT_MAP_FORMAT)
+	{
+		cmgui_image = Cmgui_image_read_analyze_object_map(cmgui_image_information,
+			CMZN_STREAMINFORMATION_DATA_COMPRESSION_TYPE_DEFAULT);
+	}
+	else
+	{
+		cmgui_image = Cmgui_image_read(cmgui_image_information);
+	}
+	return cmgui_image;
+}
+
+int Texture_set_image_file_number_series_downsampled(struct Texture *texture,
+	struct Cmgui_image_information *cmgui_image_information,
+	struct Cmgui_image *first_image, char *file_name_template,
+	char *file_number_pattern, int start, int stop, int increment,
+	int crop_left_margin, int crop_bottom_margin, int crop_width, int crop_height,
+	int downsample)
+{
+	if (!(texture && cmgui_image_information && first_image && file_name_template &&
+		file_number_pattern && (0 != increment) && (0 == ((stop - start) % increment)) &&
+		(0 <= (stop - start)/increment) && (0 < downsample)))
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_set_image_file_number_series_downsampled.  Invalid argument(s)");
+		return 0;
+	}
+	Texture_series_data series_data;
+	series_data.cmgui_image_information = cmgui_image_information;
+	series_data.file_name_template = file_name_template;
+	series_data.file_number_pattern = file_number_pattern;
+	series_data.start = start;
+	series_data.increment = increment;
+	series_data.number_of_files = 1 + (stop - start)/increment;
+	const int image_width = Cmgui_image_get_width(first_image);
+	const int image_height = Cmgui_image_get_height(first_image);
+	series_data.left = (0 < crop_width) ? crop_left_margin : 0;
+	series_data.bottom = (0 < crop_height) ? crop_bottom_margin : 0;
+	series_data.width = (0 < crop_width) ? crop_width : image_width;
+	series_data.height = (0 < crop_height) ? crop_height : image_height;
+	series_data.number_of_components = Cmgui_image_get_number_of_components(first_image);
+	series_data.number_of_bytes_per_component = Cmgui_image_get_number_of_bytes_per_component(first_image);
+	if ((series_data.left < 0) || (series_data.bottom < 0) ||
+		(image_width < series_data.left + series_data.width) ||
+		(image_height < series_data.bottom + series_data.height))
+	{
+		display_message(ERROR_MESSAGE,
+			"Texture_set_image_file_number_series_downsampled.  Crop is outside image");
+		return 0;
+	}
+	if (2 < series_data.number_of_bytes_per_component)
+	{
+		display_message(ERROR_MESSAGE, "Texture_set_image_file_number_series_downsampled.  "
+			"Can only downsample images with 1 or 2 bytes per component");
+		return 0;
+	}
+	enum Texture_storage_type storage;
+	switch (series_data.number_of_components)
+	{
+		case 1: storage = TEXTURE_LUMINANCE; break;
+		case 2: storage = TEXTURE_LUMINANCE_ALPHA; break;
+		case 3: storage = TEXTURE_RGB; break;
+		case 4: storage = TEXTURE_RGBA; break;
+		default:
+		{
+			display_message(ERROR_MESSAGE, "Texture_set_image_file_number_series_downsampled.  "
+				"Unsupported number of components %d", series_data.number_of_components);
+			return 0;
+		} break;
+	}
+	series_data.downsample = downsample;
+	series_data.output_width = (series_data.width + downsample - 1)/downsample;
+	series_data.output_height = (series_data.height + downsample - 1)/downsample;
+	series_data.output_depth = (series_data.number_of_files + downsample - 1)/downsample;
+	if (!Texture_allocate_image(texture, series_data.output_width, series_data.output_height,
+		series_data.output_depth, storage, series_data.number_of_bytes_per_component,
+		file_name_template))
+	{
+		display_message(ERROR_MESSAGE, "Texture_set_image_file_number_series_downsampled.  "
+			"Could not allocate image in texture");
+		return 0;
+	}
+	const int bytes_per_pixel = series_data.number_of_components*series_data.number_of_bytes_per_component;
+	std::vector<unsigned char> slice_pixels(static_cast<size_t>(bytes_per_pixel)*
+		series_data.width*series_data.height);
+	std::vector<unsigned char> plane_pixels(static_cast<size_t>(bytes_per_pixel)*
+		series_data.output_width*series_data.output_height);
+	std::vector<double> sums(static_cast<size_t>(series_data.output_width)*
+		series_data.output_height*series_data.number_of_components);
+	std::vector<int> counts(static_cast<size_t>(series_data.output_width)*series_data.output_height);
+	int return_code = 1;
+	for (int k = 0; return_code && (k < series_data.output_depth); ++k)
+	{
+		std::fill(sums.begin(), sums.end(), 0.0);
+		std::fill(counts.begin(), counts.end(), 0);
+		const int stop_file = std::min((k + 1)*downsample, series_data.number_of_files);
+		for (int f = k*downsample; return_code && (f < stop_file); ++f)
+		{
+			/* the first file has already been read by the caller */
+			if (0 == f)
+				return_code = Texture_series_dispatch_slice(&series_data, first_image,
+					start, &(slice_pixels[0]));
+			else
+				return_code = Texture_series_read_slice(&series_data, f, &(slice_pixels[0]));
+			if (!return_code)
+				break;
+			if (1 == series_data.number_of_bytes_per_component)
+				Texture_series_accumulate_slice<unsigned char>(&series_data, &(slice_pixels[0]), sums, counts);
+			else
+				Texture_series_accumulate_slice<unsigned short>(&series_data, &(slice_pixels[0]), sums, counts);
+		}
+		if (!return_code)
+			break;
+		if (1 == series_data.number_of_bytes_per_component)
+			Texture_series_write_average<unsigned char>(&series_data, sums, counts, &(plane_pixels[0]));
+		else
+			Texture_series_write_average<unsigned short>(&series_data, sums, counts, &(plane_pixels[0]));
+		if (!Texture_set_image_block(texture, /*left*/0, /*bottom*/0, series_data.output_width,
+			series_data.output_height, /*depth_plane*/k, /*source_width_bytes*/
+			bytes_per_pixel*series_data.output_width, &(plane_pixels[0])))
+		{
+			display_message(ERROR_MESSAGE, "Texture_set_image_file_number_series_downsampled.  "
+				"Could not write plane %d into texture", k);
+			return_code = 0;
+		}
+	}
+	return return_code;
+}
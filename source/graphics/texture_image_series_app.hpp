@@ -0,0 +1,51 @@
+/***************************************************************************//**
+ * texture_image_series_app.hpp
+ *
+ * Reading of 3-D texture images from a file number series.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (TEXTURE_IMAGE_SERIES_APP_HPP)
+#define TEXTURE_IMAGE_SERIES_APP_HPP
+
+#include "general/image_utilities.h"
+#include "graphics/texture.h"
+
+/***************************************************************************//**
+ * Reads the image named in cmgui_image_information, using the ANALYZE readers
+ * if file_name has an ANALYZE extension. Every file of a texture image series
+ * is read with this function so all planes are read the same way.
+ * @param file_name  File name or template deciding the image file format.
+ * @return  New image or NULL on failure.
+ */
+struct Cmgui_image *Texture_series_read_image(
+	struct Cmgui_image_information *cmgui_image_information, const char *file_name);
+
+/***************************************************************************//**
+ * Sets the image of texture to the 3-D volume read from a series of 2-D image
+ * files, one per plane, named by replacing file_number_pattern in
+ * file_name_template with each number from start to stop by increment, and
+ * averaged over blocks of downsample^3 pixels.
+ * The reduced texture image is allocated once from the dimensions of the
+ * first_image and each output plane is written into it as soon as its files
+ * have been read, so only one full resolution slice is held at a time.
+ * @param cmgui_image_information  Settings for reading each file. Its file
+ * names are modified by this function.
+ * @param first_image  Image read from the first file in the series, giving
+ * the width, height, components and bytes per component of every file.
+ * @param crop_width  Width of cropped region of each image or 0 for no crop.
+ * @param crop_height  Height of cropped region of each image or 0 for no crop.
+ * @return  1 on success, 0 on failure.
+ */
+int Texture_set_image_file_number_series_downsampled(struct Texture *texture,
+	struct Cmgui_image_information *cmgui_image_information,
+	struct Cmgui_image *first_image, char *file_name_template,
+	char *file_number_pattern, int start, int stop, int increment,
+	int crop_left_margin, int crop_bottom_margin, int crop_width, int crop_height,
+	int downsample);
+
+#endif /* !defined (TEXTURE_IMAGE_SERIES_APP_HPP) */
@@ -4,13 +4,26 @@
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <string>
+#include <vector>
 #include "zinc/field.h"
+#include "zinc/fieldcache.h"
 #include "zinc/fieldmodule.h"
 #include "zinc/fieldgroup.h"
+#include "zinc/node.h"
+#include "zinc/nodeset.h"
 #include "zinc/optimisation.h"
 #include "zinc/region.h"
 #include "zinc/status.h"
+#include "zinc/timesequence.h"
+#include "computed_field/computed_field_finite_element.h"
+#include "finite_element/finite_element.h"
 #include "general/debug.h"
+#include "general/elapsed_time_app.h"
 #include "general/message.h"
 #include "command/parser.h"
 #include "general/enumerator.h"
@@ -18,6 +31,677 @@
 #include "region/cmiss_region_app.h"
 #include "minimise/minimise.h"
 
+namespace {
+
+/** Outcome of one start of a multi-start minimisation. */
+struct Minimise_start_result
+{
+	/* 1 if optimisation succeeded, 0 if it failed */
+	int status;
+	double objective;
+	double wall_seconds;
+	double cpu_seconds;
+	std::string report;
+};
+
+/** Controls for optimising in steps to report progress and stop early. */
+struct Minimise_progress
+{
+	int maximum_iterations;
+	/* iterations per step between progress checks; optimised in one call if 0 */
+	int interval;
+	/* stop when objective changes by no more than these in a step, if non-zero */
+	double absolute_tolerance;
+	double relative_tolerance;
+	/* stop after this wall clock time if non-zero */
+	double time_limit;
+	/* report each step in the command window and/or progress file */
+	int show_progress;
+	FILE *progress_file;
+};
+
+struct Minimise_starts_data
+{
+	cmzn_fieldmodule_id field_module;
+	cmzn_optimisation_id optimisation;
+	std::vector<cmzn_field_id> *independent_fields;
+	/* conditional field for each independent field, or NULL */
+	std::vector<cmzn_field_id> *conditional_fields;
+	std::vector<cmzn_field_id> *objective_fields;
+	double perturbation;
+	int show_report;
+	const Minimise_progress *progress;
+};
+
+/* node value labels and matching nodal value types of stored parameters */
+const cmzn_node_value_label minimise_node_value_labels[] =
+{
+	CMZN_NODE_VALUE_LABEL_VALUE,
+	CMZN_NODE_VALUE_LABEL_D_DS1,
+	CMZN_NODE_VALUE_LABEL_D_DS2,
+	CMZN_NODE_VALUE_LABEL_D2_DS1DS2,
+	CMZN_NODE_VALUE_LABEL_D_DS3,
+	CMZN_NODE_VALUE_LABEL_D2_DS1DS3,
+	CMZN_NODE_VALUE_LABEL_D2_DS2DS3,
+	CMZN_NODE_VALUE_LABEL_D3_DS1DS2DS3
+};
+const enum FE_nodal_value_type minimise_nodal_value_types[] =
+{
+	FE_NODAL_VALUE,
+	FE_NODAL_D_DS1,
+	FE_NODAL_D_DS2,
+	FE_NODAL_D2_DS1DS2,
+	FE_NODAL_D_DS3,
+	FE_NODAL_D2_DS1DS3,
+	FE_NODAL_D2_DS2DS3,
+	FE_NODAL_D3_DS1DS2DS3
+};
+const int minimise_number_of_node_value_labels =
+	sizeof(minimise_node_value_labels)/sizeof(cmzn_node_value_label);
+
+/**
+ * Copy of all parameters of the independent fields: every nodal value,
+ * derivative and version at every time of finite element fields, and the
+ * values of other fields such as constants. Restoring it returns the fields
+ * to the state when it was stored without copying the rest of the region.
+ */
+class Minimise_parameter_store
+{
+	struct Nodal_parameter
+	{
+		cmzn_node_id node;
+		struct FE_field *fe_field;
+		int component_number, version;
+		enum FE_nodal_value_type type;
+		FE_value time;
+	};
+	std::vector<Nodal_parameter> nodal_parameters;
+	std::vector<FE_value> nodal_values;
+	/* fields which are not finite element, with their values */
+	std::vector<cmzn_field_id> other_fields;
+	std::vector<std::vector<double> > other_values;
+
+	void clear()
+	{
+		for (size_t i = 0; i < this->nodal_parameters.size(); ++i)
+			cmzn_node_destroy(&(this->nodal_parameters[i].node));
+		this->nodal_parameters.clear();
+		this->nodal_values.clear();
+		for (size_t i = 0; i < this->other_fields.size(); ++i)
+			cmzn_field_destroy(&(this->other_fields[i]));
+		this->other_fields.clear();
+		this->other_values.clear();
+	}
+
+	bool storeNodalParameters(cmzn_nodeset_id nodeset, cmzn_field_id field,
+		struct FE_field *fe_field)
+	{
+		const int number_of_components = cmzn_field_get_number_of_components(field);
+		cmzn_nodetemplate_id nodetemplate = cmzn_nodeset_create_nodetemplate(nodeset);
+		cmzn_nodeiterator_id iterator = cmzn_nodeset_create_nodeiterator(nodeset);
+		bool result = true;
+		cmzn_node_id node = 0;
+		while (result && (0 != (node = cmzn_nodeiterator_next(iterator))))
+		{
+			if (CMZN_OK == cmzn_nodetemplate_define_field_from_node(nodetemplate, field, node))
+			{
+				std::vector<FE_value> times;
+				cmzn_timesequence_id timesequence = cmzn_nodetemplate_get_timesequence(nodetemplate, field);
+				if (timesequence)
+				{
+					const int number_of_times = cmzn_timesequence_get_number_of_times(timesequence);
+					for (int t = 1; t <= number_of_times; ++t)
+						times.push_back(cmzn_timesequence_get_time(timesequence, t));
+					cmzn_timesequence_destroy(&timesequence);
+				}
+				else
+				{
+					times.push_back(0.0);
+				}
+				for (int c = 0; result && (c < number_of_components); ++c)
+				{
+					for (int l = 0; result && (l < minimise_number_of_node_value_labels); ++l)
+					{
+						const int versions = cmzn_nodetemplate_get_value_number_of_versions(nodetemplate,
+							field, c + 1, minimise_node_value_labels[l]);
+						for (int v = 0; result && (v < versions); ++v)
+						{
+							for (size_t t = 0; t < times.size(); ++t)
+							{
+								Nodal_parameter parameter;
+								parameter.node = cmzn_node_access(node);
+								parameter.fe_field = fe_field;
+								parameter.component_number = c;
+								parameter.version = v;
+								parameter.type = minimise_nodal_value_types[l];
+								parameter.time = times[t];
+								this->nodal_parameters.push_back(parameter);
+								FE_value value = 0.0;
+								if (!get_FE_nodal_FE_value_value(node, fe_field, c, v,
+									parameter.type, parameter.time, &value))
+								{
+									result = false;
+									break;
+								}
+								this->nodal_values.push_back(value);
+							}
+						}
+					}
+				}
+			}
+			cmzn_node_destroy(&node);
+		}
+		cmzn_nodeiterator_destroy(&iterator);
+		cmzn_nodetemplate_destroy(&nodetemplate);
+		return result;
+	}
+
+public:
+
+	Minimise_parameter_store()
+	{
+	}
+
+	~Minimise_parameter_store()
+	{
+		this->clear();
+	}
+
+	/**
+	 * Stores all parameters of the independent fields, replacing any stored.
+	 * @return  True on success, false if any parameter could not be read.
+	 */
+	bool store(cmzn_fieldmodule_id field_module, std::vector<cmzn_field_id>& independent_fields)
+	{
+		this->clear();
+		cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(
+			field_module, CMZN_FIELD_DOMAIN_TYPE_NODES);
+		cmzn_fieldcache_id cache = cmzn_fieldmodule_create_fieldcache(field_module);
+		bool result = true;
+		for (size_t i = 0; result && (i < independent_fields.size()); ++i)
+		{
+			struct FE_field *fe_field = 0;
+			if (Computed_field_get_type_finite_element(independent_fields[i], &fe_field) && fe_field)
+			{
+				result = this->storeNodalParameters(nodeset, independent_fields[i], fe_field);
+			}
+			else
+			{
+				const int number_of_components = cmzn_field_get_number_of_components(independent_fields[i]);
+				std::vector<double> values((0 < number_of_components) ? number_of_components : 1);
+				if (CMZN_OK == cmzn_field_evaluate_real(independent_fields[i], cache,
+					number_of_components, &(values[0])))
+				{
+					this->other_fields.push_back(cmzn_field_access(independent_fields[i]));
+					this->other_values.push_back(values);
+				}
+				else
+				{
+					result = false;
+				}
+			}
+		}
+		cmzn_fieldcache_destroy(&cache);
+		cmzn_nodeset_destroy(&nodeset);
+		return result;
+	}
+
+	/**
+	 * Sets the stored parameters back into their fields.
+	 * @return  True on success, false if any parameter could not be set.
+	 */
+	bool restore(cmzn_fieldmodule_id field_module)
+	{
+		bool result = true;
+		cmzn_fieldmodule_begin_change(field_module);
+		for (size_t i = 0; i < this->nodal_parameters.size(); ++i)
+		{
+			const Nodal_parameter& parameter = this->nodal_parameters[i];
+			if (!set_FE_nodal_FE_value_value(parameter.node, parameter.fe_field,
+				parameter.component_number, parameter.version, parameter.type,
+				parameter.time, this->nodal_values[i]))
+			{
+				result = false;
+			}
+		}
+		cmzn_fieldcache_id cache = cmzn_fieldmodule_create_fieldcache(field_module);
+		for (size_t i = 0; i < this->other_fields.size(); ++i)
+		{
+			if (CMZN_OK != cmzn_field_assign_real(this->other_fields[i], cache,
+				static_cast<int>(this->other_values[i].size()), &(this->other_values[i][0])))
+			{
+				result = false;
+			}
+		}
+		cmzn_fieldcache_destroy(&cache);
+		cmzn_fieldmodule_end_change(field_module);
+		return result;
+	}
+
+	void swap(Minimise_parameter_store& other)
+	{
+		this->nodal_parameters.swap(other.nodal_parameters);
+		this->nodal_values.swap(other.nodal_values);
+		this->other_fields.swap(other.other_fields);
+		this->other_values.swap(other.other_values);
+	}
+};
+
+/** @return  Pseudo-random number in [-1, 1] from state, advancing it. */
+double Minimise_random_symmetric(unsigned int& state)
+{
+	state = state*1103515245u + 12345u;
+	return static_cast<double>((state >> 8) & 0xFFFFFF)/static_cast<double>(0x7FFFFF) - 1.0;
+}
+
+/**
+ * Adds uniform random perturbations of up to perturbation times the range of
+ * each component over the nodes to the node values of independent_field,
+ * where any conditional field is non-zero.
+ */
+void Minimise_perturb_independent_field(cmzn_fieldmodule_id field_module,
+	cmzn_field_id independent_field, cmzn_field_id conditional_field,
+	double perturbation, unsigned int& random_state)
+{
+	const int number_of_components = cmzn_field_get_number_of_components(independent_field);
+	const int conditional_components = (conditional_field) ?
+		cmzn_field_get_number_of_components(conditional_field) : 0;
+	if ((number_of_components <= 0) ||
+		(conditional_field && (1 != conditional_components) &&
+			(number_of_components != conditional_components)))
+	{
+		return;
+	}
+	std::vector<double> values(number_of_components), conditional_values(number_of_components, 1.0);
+	std::vector<double> minimums(number_of_components), maximums(number_of_components);
+	cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(
+		field_module, CMZN_FIELD_DOMAIN_TYPE_NODES);
+	cmzn_fieldcache_id cache = cmzn_fieldmodule_create_fieldcache(field_module);
+	/* first pass finds component ranges, second perturbs */
+	bool found = false;
+	for (int pass = 0; pass < 2; ++pass)
+	{
+		cmzn_nodeiterator_id iterator = cmzn_nodeset_create_nodeiterator(nodeset);
+		cmzn_node_id node = 0;
+		while (0 != (node = cmzn_nodeiterator_next(iterator)))
+		{
+			cmzn_fieldcache_set_node(cache, node);
+			if (CMZN_OK == cmzn_field_evaluate_real(independent_field, cache,
+				number_of_components, &(values[0])))
+			{
+				if (0 == pass)
+				{
+					for (int c = 0; c < number_of_components; ++c)
+					{
+						if ((!found) || (values[c] < minimums[c]))
+							minimums[c] = values[c];
+						if ((!found) || (values[c] > maximums[c]))
+							maximums[c] = values[c];
+					}
+					found = true;
+				}
+				else if ((!conditional_field) || (CMZN_OK == cmzn_field_evaluate_real(
+					conditional_field, cache, conditional_components, &(conditional_values[0]))))
+				{
+					for (int c = 0; c < number_of_components; ++c)
+					{
+						const double condition = conditional_values[(1 == conditional_components) ? 0 : c];
+						if (0.0 != condition)
+						{
+							values[c] += perturbation*(maximums[c] - minimums[c])*
+								Minimise_random_symmetric(random_state);
+						}
+					}
+					cmzn_field_assign_real(independent_field, cache, number_of_components, &(values[0]));
+				}
+			}
+			cmzn_node_destroy(&node);
+		}
+		cmzn_nodeiterator_destroy(&iterator);
+		if (!found)
+			break;
+	}
+	cmzn_fieldcache_destroy(&cache);
+	cmzn_nodeset_destroy(&nodeset);
+}
+
+/** @return  Sum of all components of the objective fields. */
+double Minimise_evaluate_objective(cmzn_fieldmodule_id field_module,
+	std::vector<cmzn_field_id>& objective_fields, bool& valid)
+{
+	double objective = 0.0;
+	valid = true;
+	cmzn_fieldcache_id cache = cmzn_fieldmodule_create_fieldcache(field_module);
+	for (size_t i = 0; i < objective_fields.size(); ++i)
+	{
+		const int number_of_components = cmzn_field_get_number_of_components(objective_fields[i]);
+		std::vector<double> values((0 < number_of_components) ? number_of_components : 1);
+		if (CMZN_OK == cmzn_field_evaluate_real(objective_fields[i], cache,
+			number_of_components, &(values[0])))
+		{
+			for (int c = 0; c < number_of_components; ++c)
+				objective += values[c];
+		}
+		else
+		{
+			valid = false;
+		}
+	}
+	cmzn_fieldcache_destroy(&cache);
+	return objective;
+}
+
+/**
+ * Appends the node values of the independent fields to parameters.
+ */
+void Minimise_get_parameters(cmzn_fieldmodule_id field_module,
+	std::vector<cmzn_field_id>& independent_fields, std::vector<double>& parameters)
+{
+	parameters.clear();
+	cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(
+		field_module, CMZN_FIELD_DOMAIN_TYPE_NODES);
+	cmzn_fieldcache_id cache = cmzn_fieldmodule_create_fieldcache(field_module);
+	for (size_t i = 0; i < independent_fields.size(); ++i)
+	{
+		const int number_of_components = cmzn_field_get_number_of_components(independent_fields[i]);
+		if (number_of_components <= 0)
+			continue;
+		std::vector<double> values(number_of_components);
+		cmzn_nodeiterator_id iterator = cmzn_nodeset_create_nodeiterator(nodeset);
+		cmzn_node_id node = 0;
+		while (0 != (node = cmzn_nodeiterator_next(iterator)))
+		{
+			cmzn_fieldcache_set_node(cache, node);
+			if (CMZN_OK == cmzn_field_evaluate_real(independent_fields[i], cache,
+				number_of_components, &(values[0])))
+			{
+				parameters.insert(parameters.end(), values.begin(), values.end());
+			}
+			cmzn_node_destroy(&node);
+		}
+		cmzn_nodeiterator_destroy(&iterator);
+	}
+	cmzn_fieldcache_destroy(&cache);
+	cmzn_nodeset_destroy(&nodeset);
+}
+
+/**
+ * @return  Number of iterations taken by the last optimise call as given in
+ * the "iterations taken" line of its solution report, or -1 with error
+ * reported if the report has no such line.
+ */
+int Minimise_get_iterations_taken(cmzn_optimisation_id optimisation)
+{
+	int iterations_taken = -1;
+	char *report = cmzn_optimisation_get_solution_report(optimisation);
+	if (report)
+	{
+		const char *text = strstr(report, "iterations taken");
+		if (text)
+		{
+			text = strchr(text, '=');
+			if ((!text) || (1 != sscanf(text + 1, "%d", &iterations_taken)) ||
+				(iterations_taken < 0))
+			{
+				iterations_taken = -1;
+			}
+		}
+		DEALLOCATE(report);
+	}
+	if (iterations_taken < 0)
+	{
+		display_message(ERROR_MESSAGE, "gfx minimise.  "
+			"Could not read iterations taken from the optimisation solution report");
+	}
+	return iterations_taken;
+}
+
+/**
+ * Optimises up to progress.maximum_iterations. If progress.interval is
+ * non-zero, optimises that many iterations at a time, reporting objective,
+ * parameter step size and time after each step, and stopping early when the
+ * optimiser converges within a step, the objective change is within
+ * tolerance or the time limit is reached.
+ * Note quasi-Newton methods restart their Hessian approximation each step.
+ * @param stop_reason  Set to a static description of why optimisation ended.
+ * @return  1 on success, 0 if optimisation failed.
+ */
+int Minimise_optimise(cmzn_optimisation_id optimisation, cmzn_fieldmodule_id field_module,
+	std::vector<cmzn_field_id>& independent_fields, std::vector<cmzn_field_id>& objective_fields,
+	const Minimise_progress& progress, const char *&stop_reason)
+{
+	stop_reason = "maximum iterations";
+	if (progress.interval <= 0)
+	{
+		cmzn_optimisation_set_attribute_integer(optimisation,
+			CMZN_OPTIMISATION_ATTRIBUTE_MAXIMUM_ITERATIONS, progress.maximum_iterations);
+		return cmzn_optimisation_optimise(optimisation);
+	}
+	const double start_time = get_elapsed_time_seconds();
+	bool valid = false;
+	double objective = Minimise_evaluate_objective(field_module, objective_fields, valid);
+	std::vector<double> parameters, last_parameters;
+	Minimise_get_parameters(field_module, independent_fields, last_parameters);
+	if (progress.progress_file)
+	{
+		fprintf(progress.progress_file,
+			"iteration,objective,step_norm,elapsed_seconds,seconds_per_iteration\n");
+		fprintf(progress.progress_file, "0,%.15g,0,0,0\n", objective);
+		fflush(progress.progress_file);
+	}
+	if (progress.show_progress)
+	{
+		display_message(INFORMATION_MESSAGE,
+			"gfx minimise:  iteration 0  objective %g\n", objective);
+	}
+	int return_code = 1;
+	int iteration = 0;
+	double step_end_time = start_time;
+	while (iteration < progress.maximum_iterations)
+	{
+		const int step_iterations = (progress.maximum_iterations - iteration < progress.interval) ?
+			(progress.maximum_iterations - iteration) : progress.interval;
+		cmzn_optimisation_set_attribute_integer(optimisation,
+			CMZN_OPTIMISATION_ATTRIBUTE_MAXIMUM_ITERATIONS, step_iterations);
+		if (!cmzn_optimisation_optimise(optimisation))
+		{
+			stop_reason = "optimisation failed";
+			return_code = 0;
+			break;
+		}
+		/* optimiser stopped on its own convergence tests within the step */
+		const int iterations_taken = Minimise_get_iterations_taken(optimisation);
+		if (iterations_taken < 0)
+		{
+			stop_reason = "iterations taken not reported";
+			return_code = 0;
+			break;
+		}
+		const bool step_converged = (iterations_taken < step_iterations);
+		iteration += (step_converged) ? iterations_taken : step_iterations;
+		const double last_objective = objective;
+		objective = Minimise_evaluate_objective(field_module, objective_fields, valid);
+		Minimise_get_parameters(field_module, independent_fields, parameters);
+		double step_norm = 0.0;
+		if (parameters.size() == last_parameters.size())
+		{
+			for (size_t i = 0; i < parameters.size(); ++i)
+				step_norm += (parameters[i] - last_parameters[i])*(parameters[i] - last_parameters[i]);
+			step_norm = sqrt(step_norm);
+		}
+		parameters.swap(last_parameters);
+		const double last_step_end_time = step_end_time;
+		step_end_time = get_elapsed_time_seconds();
+		const double elapsed_seconds = step_end_time - start_time;
+		const double seconds_per_iteration = (step_end_time - last_step_end_time)/
+			((step_converged && (0 < iterations_taken)) ? iterations_taken : step_iterations);
+		if (progress.progress_file)
+		{
+			fprintf(progress.progress_file, "%d,%.15g,%.15g,%g,%g\n", iteration,
+				objective, step_norm, elapsed_seconds, seconds_per_iteration);
+			fflush(progress.progress_file);
+		}
+		if (progress.show_progress)
+		{
+			display_message(INFORMATION_MESSAGE,
+				"gfx minimise:  iteration %d  objective %g  step %g  %g seconds (%g per iteration)\n",
+				iteration, objective, step_norm, elapsed_seconds, seconds_per_iteration);
+		}
+		const double change = fabs(objective - last_objective);
+		if (!valid)
+		{
+			stop_reason = "objective could not be evaluated";
+			break;
+		}
+		if (step_converged || ((0.0 == change) && (0.0 == step_norm)))
+		{
+			stop_reason = "converged";
+			break;
+		}
+		if ((0.0 < progress.absolute_tolerance) && (change <= progress.absolute_tolerance))
+		{
+			stop_reason = "absolute tolerance";
+			break;
+		}
+		if ((0.0 < progress.relative_tolerance) &&
+			(change <= progress.relative_tolerance*fabs(last_objective)))
+		{
+			stop_reason = "relative tolerance";
+			break;
+		}
+		if ((0.0 < progress.time_limit) && (elapsed_seconds >= progress.time_limit))
+		{
+			stop_reason = "time limit";
+			break;
+		}
+	}
+	return return_code;
+}
+
+/**
+ * Runs one start: perturbs the current parameters for all but start 0, then
+ * optimises and records the objective, time and report in result.
+ */
+void Minimise_start(Minimise_starts_data& starts_data, int start_number,
+	Minimise_start_result& result)
+{
+	const double start_time = get_elapsed_time_seconds();
+	const clock_t start_clock = clock();
+	result.status = 0;
+	result.objective = 0.0;
+	if (0 < start_number)
+	{
+		unsigned int random_state = 2654435761u*static_cast<unsigned int>(start_number);
+		cmzn_fieldmodule_begin_change(starts_data.field_module);
+		for (size_t i = 0; i < starts_data.independent_fields->size(); ++i)
+		{
+			Minimise_perturb_independent_field(starts_data.field_module,
+				(*starts_data.independent_fields)[i], (*starts_data.conditional_fields)[i],
+				starts_data.perturbation, random_state);
+		}
+		cmzn_fieldmodule_end_change(starts_data.field_module);
+	}
+	const char *stop_reason = 0;
+	if (Minimise_optimise(starts_data.optimisation, starts_data.field_module,
+		*starts_data.independent_fields, *starts_data.objective_fields,
+		*starts_data.progress, stop_reason))
+	{
+		bool valid = false;
+		result.objective = Minimise_evaluate_objective(starts_data.field_module,
+			*starts_data.objective_fields, valid);
+		if (valid)
+			result.status = 1;
+	}
+	if (starts_data.show_report)
+	{
+		char *report = cmzn_optimisation_get_solution_report(starts_data.optimisation);
+		if (report)
+		{
+			result.report = report;
+			DEALLOCATE(report);
+		}
+	}
+	result.wall_seconds = get_elapsed_time_seconds() - start_time;
+	result.cpu_seconds = static_cast<double>(clock() - start_clock)/CLOCKS_PER_SEC;
+}
+
+/**
+ * Runs number_of_starts optimisations one after another from the current and
+ * randomly perturbed independent field parameters, restoring the initial
+ * parameters before each start and keeping the parameters giving the lowest
+ * objective value. Only the independent field parameters are copied, so
+ * time-varying fields are supported and memory is not proportional to the
+ * number of starts.
+ * @return  1 if any start succeeded, 0 otherwise.
+ */
+int Minimise_multiple_starts(Minimise_starts_data& starts_data, int number_of_starts)
+{
+	const double start_time = get_elapsed_time_seconds();
+	Minimise_parameter_store initial_parameters, best_parameters;
+	if (!initial_parameters.store(starts_data.field_module, *starts_data.independent_fields))
+	{
+		display_message(ERROR_MESSAGE, "gfx minimise:  Could not store initial parameters");
+		return 0;
+	}
+	std::vector<Minimise_start_result> results(number_of_starts);
+	int best_start = -1;
+	for (int i = 0; i < number_of_starts; ++i)
+	{
+		if ((0 < i) && !initial_parameters.restore(starts_data.field_module))
+		{
+			display_message(ERROR_MESSAGE, "gfx minimise:  Could not restore initial parameters");
+			best_start = -1;
+			break;
+		}
+		Minimise_start(starts_data, i, results[i]);
+		if (results[i].status && ((best_start < 0) || (results[i].objective < results[best_start].objective)))
+		{
+			Minimise_parameter_store parameters;
+			if (parameters.store(starts_data.field_module, *starts_data.independent_fields))
+			{
+				best_parameters.swap(parameters);
+				best_start = i;
+			}
+		}
+	}
+	/* the last start may not be the best */
+	if (!((0 <= best_start) ? best_parameters : initial_parameters).restore(starts_data.field_module))
+	{
+		display_message(ERROR_MESSAGE, "gfx minimise:  Could not restore %s parameters",
+			(0 <= best_start) ? "best" : "initial");
+		best_start = -1;
+	}
+	const double wall_seconds = get_elapsed_time_seconds() - start_time;
+	if (starts_data.show_report)
+	{
+		if (0 <= best_start)
+			display_message_string(INFORMATION_MESSAGE, results[best_start].report.c_str());
+		display_message(INFORMATION_MESSAGE,
+			"gfx minimise:  %d starts in %g seconds\n", number_of_starts, wall_seconds);
+		for (int i = 0; i < number_of_starts; ++i)
+		{
+			const Minimise_start_result& result = results[i];
+			const double utilisation = (0.0 < result.wall_seconds) ?
+				100.0*result.cpu_seconds/result.wall_seconds : 0.0;
+			if (result.status)
+			{
+				display_message(INFORMATION_MESSAGE,
+					"  start %d: objective %g, %g seconds, %.0f%% CPU utilisation%s\n", i,
+					result.objective, result.wall_seconds, utilisation, (i == best_start) ? " (best)" : "");
+			}
+			else
+			{
+				display_message(INFORMATION_MESSAGE,
+					"  start %d: failed, %g seconds, %.0f%% CPU utilisation\n", i,
+					result.wall_seconds, utilisation);
+			}
+		}
+	}
+	return (0 <= best_start) ? 1 : 0;
+}
+
+}
+
 int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 	void *root_region_void)
 {
@@ -29,6 +713,14 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 		enum cmzn_optimisation_method optimisation_method = CMZN_OPTIMISATION_METHOD_QUASI_NEWTON;
 		int maxIters = 100; // default value
 		int showReport = 1; // output solution report by default
+		int numberOfStarts = 1;
+		double perturbation = 0.1;
+		int progressInterval = 0;
+		char showProgress = 0;
+		double absoluteTolerance = 0.0;
+		double relativeTolerance = 0.0;
+		double timeLimit = 0.0;
+		char *progressFileName = 0;
 		const char *optimisation_method_string = 0;
 		Multiple_strings conditionalFieldNames;
 		Multiple_strings independentFieldNames;
@@ -48,7 +740,29 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 			"Field types 'nodeset_sum_squares' and 'mesh_integral_squares' have "
 			"special behaviour with the LEAST_SQUARES_QUASI_NEWTON solution method, "
 			"supplying individual terms for the least squares solution, useful for "
-			"least squares fitting problems.");
+			"least squares fitting problems. "
+			"With 'starts' greater than 1, independent optimisations are run one "
+			"after another from the current node values and from values "
+			"randomly perturbed by up to 'perturbation' times the range of each "
+			"component, keeping the result with the lowest sum of objective values. "
+			"If 'progress_interval' is set, optimisation runs that many iterations "
+			"at a time, after each reporting the objective, the norm of the "
+			"parameter step and the time taken with 'show_progress' and/or to CSV "
+			"'progress_file', and stopping early if the optimiser converges, the "
+			"objective changes by no more than 'absolute_tolerance' or "
+			"'relative_tolerance' times its value, or after 'time_limit' seconds. "
+			"These options are only checked between intervals so require "
+			"'progress_interval'. Convergence within an interval is detected from "
+			"the iterations taken in the optimiser's solution report text, and it "
+			"is an error if the report does not give them. 'time_limit' is only "
+			"checked after each interval, so one interval may run past it. "
+			"Note quasi-Newton methods restart their Hessian "
+			"approximation at each interval, so results may differ from optimising "
+			"without an interval. 'show_progress' and 'progress_file' cannot be used "
+			"with multiple starts.");
+		/* absolute_tolerance */
+		Option_table_add_non_negative_double_entry(option_table, "absolute_tolerance",
+			&absoluteTolerance);
 		/* conditional_fields */
 		Option_table_add_multiple_strings_entry(option_table, "conditional_fields",
 			&conditionalFieldNames, "FIELD_NAME|none [& FIELD_NAME|none [& ...]]");
@@ -74,15 +788,49 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 		/* objective field(s) */
 		Option_table_add_multiple_strings_entry(option_table, "objective_fields",
 			&objectiveFieldNames, "FIELD_NAME [& FIELD_NAME [& ...]]");
+		/* perturbation */
+		Option_table_add_entry(option_table, "perturbation", &perturbation,
+			NULL, set_double_non_negative);
+		/* progress_file */
+		Option_table_add_string_entry(option_table, "progress_file",
+			&progressFileName, " FILE_NAME");
+		/* progress_interval */
+		Option_table_add_entry(option_table, "progress_interval", &progressInterval,
+			NULL, set_int_non_negative);
 		/* region */
 		Option_table_add_set_cmzn_region(option_table, "region", root_region, &region);
+		/* relative_tolerance */
+		Option_table_add_non_negative_double_entry(option_table, "relative_tolerance",
+			&relativeTolerance);
+		/* show_progress */
+		Option_table_add_char_flag_entry(option_table, "show_progress", &showProgress);
 		/* flag whether to show or hide the optimisation output */
 		Option_table_add_switch(option_table, "show_output", "hide_output", &showReport);
+		/* starts */
+		Option_table_add_entry(option_table, "starts", &numberOfStarts,
+			NULL, set_int_positive);
+		/* time_limit */
+		Option_table_add_non_negative_double_entry(option_table, "time_limit",
+			&timeLimit);
 		return_code = Option_table_multi_parse(option_table, state);
+		if (return_code && (0 == progressInterval) && ((0.0 < absoluteTolerance) ||
+			(0.0 < relativeTolerance) || (0.0 < timeLimit) || showProgress || progressFileName))
+		{
+			display_message(ERROR_MESSAGE, "gfx minimise:  absolute_tolerance, relative_tolerance, "
+				"time_limit, show_progress and progress_file require progress_interval");
+			return_code = 0;
+		}
+		if (return_code && (1 < numberOfStarts) && (showProgress || progressFileName))
+		{
+			display_message(ERROR_MESSAGE,
+				"gfx minimise:  show_progress and progress_file cannot be used with multiple starts");
+			return_code = 0;
+		}
 		if (return_code)
 		{
 			cmzn_fieldmodule_id fieldModule = cmzn_region_get_fieldmodule(region);
 			cmzn_optimisation_id optimisation = cmzn_fieldmodule_create_optimisation(fieldModule);
+			std::vector<cmzn_field_id> independentFields, conditionalFields, objectiveFields;
 			STRING_TO_ENUMERATOR(cmzn_optimisation_method)(
 				optimisation_method_string, &optimisation_method);
 			if (CMZN_OK != cmzn_optimisation_set_method(optimisation, optimisation_method))
@@ -94,12 +842,13 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 			{
 				cmzn_field_id independentField = cmzn_fieldmodule_find_field_by_name(
 					fieldModule, independentFieldNames.strings[i]);
+				cmzn_field_id conditionalField = 0;
 				if (CMZN_OK == cmzn_optimisation_add_independent_field(optimisation, independentField))
 				{
 					const char *conditionalFieldName = conditionalFieldNames[i];
 					if (conditionalFieldName)
 					{
-						cmzn_field_id conditionalField = cmzn_fieldmodule_find_field_by_name(fieldModule, conditionalFieldName);
+						conditionalField = cmzn_fieldmodule_find_field_by_name(fieldModule, conditionalFieldName);
 						if (conditionalField)
 						{
 							if (CMZN_OK != cmzn_optimisation_set_conditional_field(optimisation, independentField, conditionalField))
@@ -124,7 +873,9 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 						independentFieldNames.strings[i]);
 					return_code = 0;
 				}
-				cmzn_field_destroy(&independentField);
+				/* kept for perturbing starting values */
+				independentFields.push_back(independentField);
+				conditionalFields.push_back(conditionalField);
 			}
 			for (int i = 0; i < objectiveFieldNames.number_of_strings; i++)
 			{
@@ -136,7 +887,8 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 						objectiveFieldNames.strings[i]);
 					return_code = 0;
 				}
-				cmzn_field_destroy(&objectiveField);
+				/* kept for comparing starts */
+				objectiveFields.push_back(objectiveField);
 			}
 			if (CMZN_OK != cmzn_optimisation_set_attribute_integer(optimisation,
 				CMZN_OPTIMISATION_ATTRIBUTE_MAXIMUM_ITERATIONS, maxIters))
@@ -144,10 +896,55 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 				display_message(ERROR_MESSAGE, "gfx minimise:  Invalid maximum_iterations %d", maxIters);
 				return_code = 0;
 			}
-			if (return_code)
+			Minimise_progress progress;
+			progress.maximum_iterations = maxIters;
+			progress.interval = progressInterval;
+			progress.absolute_tolerance = absoluteTolerance;
+			progress.relative_tolerance = relativeTolerance;
+			progress.time_limit = timeLimit;
+			progress.show_progress = 0;
+			progress.progress_file = 0;
+			if (return_code && (1 < numberOfStarts))
 			{
-				return_code = cmzn_optimisation_optimise(optimisation);
-				if (showReport)
+				Minimise_starts_data starts_data;
+				starts_data.field_module = fieldModule;
+				starts_data.optimisation = optimisation;
+				starts_data.independent_fields = &independentFields;
+				starts_data.conditional_fields = &conditionalFields;
+				starts_data.objective_fields = &objectiveFields;
+				starts_data.perturbation = perturbation;
+				starts_data.show_report = showReport;
+				starts_data.progress = &progress;
+				return_code = Minimise_multiple_starts(starts_data, numberOfStarts);
+				if (!return_code)
+				{
+					display_message(ERROR_MESSAGE, "gfx minimise.  Optimisation failed.");
+				}
+			}
+			else if (return_code)
+			{
+				if (progressFileName)
+				{
+					progress.progress_file = fopen(progressFileName, "w");
+					if (!progress.progress_file)
+					{
+						display_message(ERROR_MESSAGE, "gfx minimise:  Could not open progress_file '%s'",
+							progressFileName);
+						return_code = 0;
+					}
+				}
+				progress.show_progress = showProgress;
+				const char *stopReason = 0;
+				if (return_code)
+				{
+					return_code = Minimise_optimise(optimisation, fieldModule,
+						independentFields, objectiveFields, progress, stopReason);
+				}
+				if (progress.progress_file)
+				{
+					fclose(progress.progress_file);
+				}
+				if (showReport && stopReason)
 				{
 					char *report = cmzn_optimisation_get_solution_report(optimisation);
 					if (report)
@@ -155,16 +952,31 @@ int gfx_minimise(struct Parse_state *state, void *dummy_to_be_modified,
 						display_message_string(INFORMATION_MESSAGE, report);
 						DEALLOCATE(report);
 					}
+					if (0 < progress.interval)
+					{
+						display_message(INFORMATION_MESSAGE, "gfx minimise:  Stop reason: %s\n", stopReason);
+					}
 				}
 				if (!return_code)
 				{
 					display_message(ERROR_MESSAGE, "gfx minimise.  Optimisation failed.");
 				}
 			}
+			for (size_t i = 0; i < independentFields.size(); ++i)
+			{
+				cmzn_field_destroy(&(independentFields[i]));
+				cmzn_field_destroy(&(conditionalFields[i]));
+			}
+			for (size_t i = 0; i < objectiveFields.size(); ++i)
+				cmzn_field_destroy(&(objectiveFields[i]));
 			cmzn_optimisation_destroy(&optimisation);
 			cmzn_fieldmodule_destroy(&fieldModule);
 		}
 		DESTROY(Option_table)(&option_table);
+		if (progressFileName)
+		{
+			DEALLOCATE(progressFileName);
+		}
 		cmzn_region_destroy(&region);
 	}
 	else
@@ -0,0 +1,248 @@
+/***************************************************************************//**
+ * node_time_series_app.cpp
+ *
+ * Lazily loaded series of node or data files, one per time step.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "zinc/region.h"
+#include "general/debug.h"
+#include "general/io_stream.h"
+#include "general/message.h"
+#include "finite_element/import_finite_element.h"
+#include "node/node_time_series_app.hpp"
+#include "region/cmiss_region.h"
+#include "region/region_binary_app.h"
+
+Node_time_series::Node_time_series(cmzn_region_id region_in, bool use_data_in,
+	Time_keeper_app *time_keeper_app_in, struct IO_stream_package *io_stream_package_in) :
+	region(cmzn_region_access(region_in)),
+	use_data(use_data_in),
+	time_keeper_app(time_keeper_app_in->access()),
+	io_stream_package(io_stream_package_in),
+	cache_memory_limit(static_cast<size_t>(NODE_TIME_SERIES_DEFAULT_CACHE_MEGABYTES*1024.0*1024.0)),
+	cache_memory_used(0),
+	step_loaded(false),
+	loaded_step_time(0.0)
+{
+	time_keeper_app->addCallback(Node_time_series::timeKeeperCallback,
+		static_cast<void *>(this), TIME_KEEPER_APP_NEW_TIME);
+}
+
+Node_time_series::~Node_time_series()
+{
+	time_keeper_app->removeCallback(Node_time_series::timeKeeperCallback,
+		static_cast<void *>(this));
+	Time_keeper_app::deaccess(&time_keeper_app);
+	cmzn_region_destroy(&region);
+}
+
+int Node_time_series::timeKeeperCallback(struct Time_keeper_app *time_keeper_app,
+	enum Time_keeper_app_event event, void *node_time_series_void)
+{
+	USE_PARAMETER(time_keeper_app);
+	USE_PARAMETER(event);
+	Node_time_series *node_time_series = static_cast<Node_time_series *>(node_time_series_void);
+	if (node_time_series)
+		return node_time_series->update();
+	return 0;
+}
+
+void Node_time_series::addStep(double time, const char *file_name)
+{
+	step_file_names[time] = file_name;
+	std::map<double, Cached_step>::iterator cached_iter = cached_steps.find(time);
+	if (cached_iter != cached_steps.end())
+	{
+		cache_memory_used -= cached_iter->second.image.size();
+		lru_times.erase(cached_iter->second.lru_position);
+		cached_steps.erase(cached_iter);
+	}
+	/* force reload if the replaced step is current */
+	if (step_loaded && (time == loaded_step_time))
+		step_loaded = false;
+}
+
+void Node_time_series::setCacheMemoryLimit(size_t bytes)
+{
+	cache_memory_limit = bytes;
+	evictSteps();
+}
+
+/**
+ * Reads the step file into a temporary region, records its contents in image
+ * and merges it into the region.
+ */
+int Node_time_series::parseStep(double step_time, std::vector<unsigned char>& image)
+{
+	int return_code = 0;
+	const char *file_name = step_file_names[step_time].c_str();
+	struct IO_stream *input_file = CREATE(IO_stream)(io_stream_package);
+	if (input_file && IO_stream_open_for_read(input_file, file_name))
+	{
+		cmzn_region_id temp_region = cmzn_region_create_region(region);
+		if (use_data)
+			return_code = read_exdata_file(temp_region, input_file, (struct FE_import_time_index *)NULL);
+		else
+			return_code = read_exregion_file(temp_region, input_file, (struct FE_import_time_index *)NULL);
+		IO_stream_close(input_file);
+		if (return_code)
+		{
+			/* keep a compact decoded copy, as a merged region cannot be merged again */
+			if (!write_region_binary_memory(temp_region, /*compress*/0, image))
+				image.clear();
+			if (cmzn_region_can_merge(region, temp_region))
+			{
+				return_code = cmzn_region_merge(region, temp_region);
+				if (!return_code)
+				{
+					display_message(ERROR_MESSAGE,
+						"Error merging nodes from file: %s", file_name);
+				}
+			}
+			else
+			{
+				display_message(ERROR_MESSAGE,
+					"Contents of file %s not compatible with global objects", file_name);
+				return_code = 0;
+			}
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE, "Error reading node file: %s", file_name);
+		}
+		cmzn_region_destroy(&temp_region);
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE, "Could not open node file: %s", file_name);
+	}
+	if (input_file)
+		DESTROY(IO_stream)(&input_file);
+	return return_code;
+}
+
+/** Removes least recently used steps until the cache is within its limit. */
+void Node_time_series::evictSteps()
+{
+	while ((cache_memory_used > cache_memory_limit) && (!lru_times.empty()))
+	{
+		std::map<double, Cached_step>::iterator cached_iter = cached_steps.find(lru_times.back());
+		cache_memory_used -= cached_iter->second.image.size();
+		cached_steps.erase(cached_iter);
+		lru_times.pop_back();
+	}
+}
+
+int Node_time_series::update()
+{
+	if (step_file_names.empty())
+		return 1;
+	const double time = time_keeper_app->getTimeKeeper()->getTime();
+	/* greatest step time not exceeding time, or the first step */
+	std::map<double, std::string>::iterator step_iter = step_file_names.upper_bound(time);
+	if (step_iter != step_file_names.begin())
+		--step_iter;
+	const double step_time = step_iter->first;
+	if (step_loaded && (step_time == loaded_step_time))
+		return 1;
+	int return_code = 0;
+	std::map<double, Cached_step>::iterator cached_iter = cached_steps.find(step_time);
+	if (cached_iter != cached_steps.end())
+	{
+		return_code = read_region_binary_memory(region, &(cached_iter->second.image[0]),
+			cached_iter->second.image.size(), step_iter->second.c_str());
+		lru_times.splice(lru_times.begin(), lru_times, cached_iter->second.lru_position);
+	}
+	else
+	{
+		std::vector<unsigned char> image;
+		return_code = parseStep(step_time, image);
+		if (return_code && (!image.empty()) && (image.size() <= cache_memory_limit))
+		{
+			Cached_step& cached_step = cached_steps[step_time];
+			cached_step.image.swap(image);
+			lru_times.push_front(step_time);
+			cached_step.lru_position = lru_times.begin();
+			cache_memory_used += cached_step.image.size();
+			evictSteps();
+		}
+	}
+	if (return_code)
+	{
+		step_loaded = true;
+		loaded_step_time = step_time;
+	}
+	return return_code;
+}
+
+Node_time_series_set::~Node_time_series_set()
+{
+	for (size_t i = 0; i < series.size(); ++i)
+		delete series[i];
+}
+
+Node_time_series *Node_time_series_set::findOrCreate(cmzn_region_id region,
+	bool use_data, Time_keeper_app *time_keeper_app,
+	struct IO_stream_package *io_stream_package)
+{
+	removeDetachedRegions();
+	for (size_t i = 0; i < series.size(); ++i)
+	{
+		if ((series[i]->getRegion() == region) && (series[i]->isUseData() == use_data))
+			return series[i];
+	}
+	Node_time_series *node_time_series =
+		new Node_time_series(region, use_data, time_keeper_app, io_stream_package);
+	series.push_back(node_time_series);
+	return node_time_series;
+}
+
+namespace {
+
+/** @return  True if region is ancestor_region or one of its subregions. */
+bool Node_time_series_region_is_within(cmzn_region_id region, cmzn_region_id ancestor_region)
+{
+	cmzn_region_id current_region = cmzn_region_access(region);
+	while (current_region && (current_region != ancestor_region))
+	{
+		cmzn_region_id parent_region = cmzn_region_get_parent(current_region);
+		cmzn_region_destroy(&current_region);
+		current_region = parent_region;
+	}
+	const bool result = (0 != current_region);
+	cmzn_region_destroy(&current_region);
+	return result;
+}
+
+}
+
+void Node_time_series_set::removeRegion(cmzn_region_id region)
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < series.size(); ++i)
+	{
+		if (Node_time_series_region_is_within(series[i]->getRegion(), region))
+			delete series[i];
+		else
+			series[kept++] = series[i];
+	}
+	series.resize(kept);
+}
+
+void Node_time_series_set::removeDetachedRegions()
+{
+	size_t kept = 0;
+	for (size_t i = 0; i < series.size(); ++i)
+	{
+		if (Node_time_series_region_is_within(series[i]->getRegion(), root_region))
+			series[kept++] = series[i];
+		else
+			delete series[i];
+	}
+	series.resize(kept);
+}
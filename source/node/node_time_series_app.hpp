@@ -0,0 +1,132 @@
+/***************************************************************************//**
+ * node_time_series_app.hpp
+ *
+ * Lazily loaded series of node or data files, one per time step. Only the
+ * file name of each step is recorded when it is added; a step is parsed when
+ * the time keeper first reaches it, and a bounded least-recently-used cache of
+ * decoded steps is kept for replay.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (NODE_TIME_SERIES_APP_HPP)
+#define NODE_TIME_SERIES_APP_HPP
+
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+#include "zinc/region.h"
+#include "time/time_keeper_app.hpp"
+
+struct IO_stream_package;
+
+/** Default memory limit for decoded steps held by each series. */
+#define NODE_TIME_SERIES_DEFAULT_CACHE_MEGABYTES 256.0
+
+/***************************************************************************//**
+ * Series of node files for one region and nodeset, loaded on demand as the
+ * time keeper time changes. The step with the greatest time not exceeding the
+ * current time, or the first step, is merged into the region.
+ */
+class Node_time_series
+{
+	struct Cached_step
+	{
+		/* step contents in binary region format */
+		std::vector<unsigned char> image;
+		std::list<double>::iterator lru_position;
+	};
+
+	cmzn_region_id region;
+	bool use_data;
+	Time_keeper_app *time_keeper_app;
+	struct IO_stream_package *io_stream_package;
+	std::map<double, std::string> step_file_names;
+	std::map<double, Cached_step> cached_steps;
+	/* cached step times, most recently used first */
+	std::list<double> lru_times;
+	size_t cache_memory_limit;
+	size_t cache_memory_used;
+	bool step_loaded;
+	double loaded_step_time;
+
+	Node_time_series(const Node_time_series&);
+	Node_time_series& operator=(const Node_time_series&);
+
+	static int timeKeeperCallback(struct Time_keeper_app *time_keeper_app,
+		enum Time_keeper_app_event event, void *node_time_series_void);
+
+	int parseStep(double step_time, std::vector<unsigned char>& image);
+
+	void evictSteps();
+
+public:
+
+	Node_time_series(cmzn_region_id region_in, bool use_data_in,
+		Time_keeper_app *time_keeper_app_in, struct IO_stream_package *io_stream_package_in);
+
+	~Node_time_series();
+
+	cmzn_region_id getRegion() const
+	{
+		return region;
+	}
+
+	bool isUseData() const
+	{
+		return use_data;
+	}
+
+	/** Records file_name as the step at time, replacing any existing step. */
+	void addStep(double time, const char *file_name);
+
+	/** Sets memory limit for cached decoded steps, evicting as needed. */
+	void setCacheMemoryLimit(size_t bytes);
+
+	/**
+	 * Ensures the step for the current time keeper time is loaded into the
+	 * region, parsing it or taking it from the cache.
+	 * @return  1 on success, 0 on failure.
+	 */
+	int update();
+};
+
+/***************************************************************************//**
+ * Owns the lazy node time series for all regions in the tree under a root
+ * region. Each series accesses its region, so series are removed when their
+ * region is removed from the tree to release it and its cached steps.
+ */
+class Node_time_series_set
+{
+	/* not accessed: the set is destroyed before the root region */
+	cmzn_region_id root_region;
+	std::vector<Node_time_series *> series;
+
+	Node_time_series_set(const Node_time_series_set&);
+	Node_time_series_set& operator=(const Node_time_series_set&);
+
+public:
+
+	Node_time_series_set(cmzn_region_id root_region_in) :
+		root_region(root_region_in)
+	{
+	}
+
+	~Node_time_series_set();
+
+	/** @return  Existing series for region and use_data, or a new one. */
+	Node_time_series *findOrCreate(cmzn_region_id region, bool use_data,
+		Time_keeper_app *time_keeper_app, struct IO_stream_package *io_stream_package);
+
+	/** Destroys all series for region and its subregions. */
+	void removeRegion(cmzn_region_id region);
+
+	/** Destroys series whose region is no longer in the tree under the root region. */
+	void removeDetachedRegions();
+};
+
+#endif /* !defined (NODE_TIME_SERIES_APP_HPP) */
@@ -5,6 +5,7 @@
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 
 #include "zinc/region.h"
+#include "zinc/status.h"
 #include "zinc/streamregion.h"
 #include "general/message.h"
 #include "general/mystring.h"
@@ -402,6 +403,60 @@ int Option_table_add_region_or_group_entry(struct Option_table *option_table,
 		(void *)region_address, (void *)group_address, set_cmzn_region_or_group);
 }
 
+namespace {
+
+/** Configures stream resource for exporting region and writes it. */
+int export_region_to_streamresource(cmzn_streaminformation_region_id si_region,
+	cmzn_streamresource_id sr, struct cmzn_region *region, const char *group_name,
+	struct cmzn_region *root_region,
+	int write_elements, int write_nodes, int write_data,
+	int number_of_field_names, char **field_names, FE_value time,
+	enum cmzn_streaminformation_region_recursion_mode recursion_mode,
+	int isFieldML)
+{
+	si_region->setRootRegion(root_region);
+	cmzn_streaminformation_region_set_resource_recursion_mode(si_region, sr,
+		recursion_mode);
+	cmzn_field_domain_types domain_types = write_elements;
+	if (write_nodes)
+		domain_types = domain_types | CMZN_FIELD_DOMAIN_TYPE_NODES;
+	if (write_data)
+		domain_types = domain_types | CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS;
+	cmzn_streaminformation_region_set_resource_domain_types(si_region, sr,
+		domain_types);
+	if (isFieldML)
+		cmzn_streaminformation_region_set_file_format(si_region, CMZN_STREAMINFORMATION_REGION_FILE_FORMAT_FIELDML);
+	else
+		cmzn_streaminformation_region_set_file_format(si_region, CMZN_STREAMINFORMATION_REGION_FILE_FORMAT_EX);
+	if (number_of_field_names && field_names)
+	{
+		if (number_of_field_names == 1 && (0 == (strcmp(field_names[0], "none"))))
+		{
+			si_region->setWriteNoField(1);
+		}
+		else
+		{
+			const char **temp_names = new const char *[number_of_field_names];
+
+			for (int i = 0; i < number_of_field_names; i++)
+			{
+				temp_names[i] = field_names[i];
+			}
+			cmzn_streaminformation_region_set_resource_field_names(si_region,
+				sr, number_of_field_names, temp_names);
+			delete[] temp_names;
+		}
+	}
+	cmzn_streaminformation_region_set_resource_group_name(si_region,
+		sr, group_name);
+	cmzn_streaminformation_region_set_resource_attribute_real(
+		si_region, sr, CMZN_STREAMINFORMATION_REGION_ATTRIBUTE_TIME,
+		(double)time);
+	return cmzn_region_write(region, si_region);
+}
+
+}
+
 int export_region_file_of_name(const char *file_name,
 	struct cmzn_region *region, const char *group_name,
 	struct cmzn_region *root_region,
@@ -418,45 +473,9 @@ int export_region_file_of_name(const char *file_name,
 		cmzn_streaminformation_region_id si_region = cmzn_streaminformation_cast_region(
 			si);
 		cmzn_streamresource_id sr = cmzn_streaminformation_create_streamresource_file(si, file_name);
-		si_region->setRootRegion(root_region);
-		cmzn_streaminformation_region_set_resource_recursion_mode(si_region, sr,
-			recursion_mode);
-		cmzn_field_domain_types domain_types = write_elements;
-		if (write_nodes)
-			domain_types = domain_types | CMZN_FIELD_DOMAIN_TYPE_NODES;
-		if (write_data)
-			domain_types = domain_types | CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS;
-		cmzn_streaminformation_region_set_resource_domain_types(si_region, sr,
-			domain_types);
-		if (isFieldML)
-			cmzn_streaminformation_region_set_file_format(si_region, CMZN_STREAMINFORMATION_REGION_FILE_FORMAT_FIELDML);
-		else
-			cmzn_streaminformation_region_set_file_format(si_region, CMZN_STREAMINFORMATION_REGION_FILE_FORMAT_EX);
-		if (number_of_field_names && field_names)
-		{
-			if (number_of_field_names == 1 && (0 == (strcmp(field_names[0], "none"))))
-			{
-				si_region->setWriteNoField(1);
-			}
-			else
-			{
-				const char **temp_names = new const char *[number_of_field_names];
-
-				for (int i = 0; i < number_of_field_names; i++)
-				{
-					temp_names[i] = field_names[i];
-				}
-				cmzn_streaminformation_region_set_resource_field_names(si_region,
-					sr, number_of_field_names, temp_names);
-				delete[] temp_names;
-			}
-		}
-		cmzn_streaminformation_region_set_resource_group_name(si_region,
-			sr, group_name);
-		cmzn_streaminformation_region_set_resource_attribute_real(
-			si_region, sr, CMZN_STREAMINFORMATION_REGION_ATTRIBUTE_TIME,
-			(double)time);
-		return_code = cmzn_region_write(region, si_region);
+		return_code = export_region_to_streamresource(si_region, sr, region, group_name,
+			root_region, write_elements, write_nodes, write_data, number_of_field_names,
+			field_names, time, recursion_mode, isFieldML);
 		cmzn_streamresource_destroy(&sr);
 		cmzn_streaminformation_region_destroy(&si_region);
 		cmzn_streaminformation_destroy(&si);
@@ -464,3 +483,32 @@ int export_region_file_of_name(const char *file_name,
 
 	return return_code;
 }
+
+cmzn_streamresource_memory_id export_region_to_memory(
+	struct cmzn_region *region, const char *group_name,
+	struct cmzn_region *root_region,
+	int write_elements, int write_nodes, int write_data,
+	int number_of_field_names, char **field_names, FE_value time,
+	enum cmzn_streaminformation_region_recursion_mode recursion_mode,
+	int isFieldML)
+{
+	cmzn_streamresource_memory_id memory_resource = 0;
+	if (region && root_region)
+	{
+		cmzn_streaminformation_id si = cmzn_region_create_streaminformation_region(
+			region);
+		cmzn_streaminformation_region_id si_region = cmzn_streaminformation_cast_region(
+			si);
+		cmzn_streamresource_id sr = cmzn_streaminformation_create_streamresource_memory(si);
+		if (CMZN_OK == export_region_to_streamresource(si_region, sr, region, group_name,
+			root_region, write_elements, write_nodes, write_data, number_of_field_names,
+			field_names, time, recursion_mode, isFieldML))
+		{
+			memory_resource = cmzn_streamresource_cast_memory(sr);
+		}
+		cmzn_streamresource_destroy(&sr);
+		cmzn_streaminformation_region_destroy(&si_region);
+		cmzn_streaminformation_destroy(&si);
+	}
+	return memory_resource;
+}
@@ -4,6 +4,7 @@
 * License, v. 2.0. If a copy of the MPL was not distributed with this
 * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
 #include "zinc/region.h"
+#include "zinc/stream.h"
 #include "command/parser.h"
 #include "finite_element/export_finite_element.h"
 
@@ -120,3 +121,17 @@ int export_region_file_of_name(const char *file_name,
 	int number_of_field_names, char **field_names, FE_value time,
 	enum cmzn_streaminformation_region_recursion_mode recursion_mode,
 	int isFieldML);
+
+/**
+ * Exports region to an in-memory EX or FieldML stream, as for
+ * export_region_file_of_name.
+ * @return  Memory resource holding the exported text, which the caller must
+ * destroy after use, or NULL on failure.
+ */
+cmzn_streamresource_memory_id export_region_to_memory(
+	struct cmzn_region *region, const char *group_name,
+	struct cmzn_region *root_region,
+	int write_elements, int write_nodes, int write_data,
+	int number_of_field_names, char **field_names, FE_value time,
+	enum cmzn_streaminformation_region_recursion_mode recursion_mode,
+	int isFieldML);
@@ -0,0 +1,1217 @@
+/***************************************************************************//**
+ * region_binary_app.cpp
+ *
+ * Versioned binary companion format for region contents.
+ *
+ * File layout, all values in the writer's native byte order:
+ *   char[8] signature "CMREGION"
+ *   uint32 version, uint32 byte order check 0x01020304, uint32 block count
+ *   blocks, each:
+ *     uint32 block type, uint32 compression, uint64 size, uint64 stored size
+ *     stored size bytes of block data
+ * Block types are FIELDS (field definitions), NODES (one per nodeset: node
+ * identifiers, per-field parameter templates and packed parameters, and group
+ * membership) and ELEMENTS (EX text of all meshes). Nodes are created before
+ * the element text is read so elements find their nodes by identifier.
+ * Node parameters are packed per component, value label and version, so each
+ * component may have its own set of derivatives and versions.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include "configure/cmgui_configure.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <limits>
+#include <map>
+#include <string>
+#include <vector>
+#if defined (USE_ZLIB)
+#include <zlib.h>
+#endif /* defined (USE_ZLIB) */
+#include "zinc/core.h"
+#include "zinc/field.h"
+#include "zinc/fieldfiniteelement.h"
+#include "zinc/fieldgroup.h"
+#include "zinc/fieldmodule.h"
+#include "zinc/fieldsubobjectgroup.h"
+#include "zinc/node.h"
+#include "zinc/nodeset.h"
+#include "zinc/region.h"
+#include "zinc/status.h"
+#include "zinc/stream.h"
+#include "zinc/streamregion.h"
+#include "zinc/timesequence.h"
+#include "computed_field/computed_field_finite_element.h"
+#include "finite_element/finite_element.h"
+#include "general/debug.h"
+#include "general/message.h"
+#include "region/cmiss_region.h"
+#include "region/region_binary_app.h"
+
+namespace {
+
+const char region_binary_signature[8] = { 'C', 'M', 'R', 'E', 'G', 'I', 'O', 'N' };
+const unsigned int region_binary_version = 2;
+const unsigned int region_binary_byte_order_check = 0x01020304;
+
+enum Region_binary_block_type
+{
+	REGION_BINARY_BLOCK_FIELDS = 1,
+	REGION_BINARY_BLOCK_NODES = 2,
+	REGION_BINARY_BLOCK_ELEMENTS = 3
+};
+
+enum Region_binary_compression
+{
+	REGION_BINARY_COMPRESSION_NONE = 0,
+	REGION_BINARY_COMPRESSION_ZLIB = 1
+};
+
+const int region_binary_field_flag_coordinate = 1;
+
+/* upper bound on uncompressed/stored size of a block: zlib deflate cannot
+ * compress by more than about 1032:1 */
+const unsigned long long region_binary_maximum_compression_ratio = 1032;
+
+/* node value labels in the order parameters are packed */
+const cmzn_node_value_label region_binary_node_value_labels[] =
+{
+	CMZN_NODE_VALUE_LABEL_VALUE,
+	CMZN_NODE_VALUE_LABEL_D_DS1,
+	CMZN_NODE_VALUE_LABEL_D_DS2,
+	CMZN_NODE_VALUE_LABEL_D2_DS1DS2,
+	CMZN_NODE_VALUE_LABEL_D_DS3,
+	CMZN_NODE_VALUE_LABEL_D2_DS1DS3,
+	CMZN_NODE_VALUE_LABEL_D2_DS2DS3,
+	CMZN_NODE_VALUE_LABEL_D3_DS1DS2DS3
+};
+const int region_binary_number_of_node_value_labels =
+	sizeof(region_binary_node_value_labels)/sizeof(cmzn_node_value_label);
+
+/* nodal value types matching region_binary_node_value_labels */
+const enum FE_nodal_value_type region_binary_nodal_value_types[] =
+{
+	FE_NODAL_VALUE,
+	FE_NODAL_D_DS1,
+	FE_NODAL_D_DS2,
+	FE_NODAL_D2_DS1DS2,
+	FE_NODAL_D_DS3,
+	FE_NODAL_D2_DS1DS3,
+	FE_NODAL_D2_DS2DS3,
+	FE_NODAL_D3_DS1DS2DS3
+};
+
+/** Appends native binary values to a growing block. */
+class Region_binary_block_writer
+{
+	std::vector<unsigned char> data;
+
+public:
+
+	void appendBytes(const void *bytes, size_t size)
+	{
+		const unsigned char *source = static_cast<const unsigned char *>(bytes);
+		data.insert(data.end(), source, source + size);
+	}
+
+	void appendInt(int value)
+	{
+		appendBytes(&value, sizeof(value));
+	}
+
+	void appendUnsignedLongLong(unsigned long long value)
+	{
+		appendBytes(&value, sizeof(value));
+	}
+
+	void appendDouble(double value)
+	{
+		appendBytes(&value, sizeof(value));
+	}
+
+	void appendString(const char *text)
+	{
+		const int length = static_cast<int>(strlen(text));
+		appendInt(length);
+		appendBytes(text, length);
+	}
+
+	const std::vector<unsigned char>& getData() const
+	{
+		return data;
+	}
+
+	void clear()
+	{
+		data.clear();
+	}
+};
+
+/** Reads native binary values from a block with bounds checking. */
+class Region_binary_block_reader
+{
+	const unsigned char *data;
+	size_t size;
+	size_t position;
+	bool valid;
+
+public:
+
+	Region_binary_block_reader(const unsigned char *data_in, size_t size_in) :
+		data(data_in),
+		size(size_in),
+		position(0),
+		valid(true)
+	{
+	}
+
+	bool isValid() const
+	{
+		return valid;
+	}
+
+	/**
+	 * Checks count items each taking at least item_size bytes could remain in
+	 * the block, so containers can be sized from counts read from the block.
+	 * Invalidates the reader if not.
+	 */
+	bool checkCount(int count, size_t item_size)
+	{
+		if ((!valid) || (count < 0) || (static_cast<size_t>(count) > (size - position)/item_size))
+			valid = false;
+		return valid;
+	}
+
+	bool readBytes(void *bytes, size_t count)
+	{
+		if ((!valid) || (count > size - position))
+		{
+			valid = false;
+			return false;
+		}
+		memcpy(bytes, data + position, count);
+		position += count;
+		return true;
+	}
+
+	int readInt()
+	{
+		int value = 0;
+		readBytes(&value, sizeof(value));
+		return value;
+	}
+
+	unsigned long long readUnsignedLongLong()
+	{
+		unsigned long long value = 0;
+		readBytes(&value, sizeof(value));
+		return value;
+	}
+
+	double readDouble()
+	{
+		double value = 0.0;
+		readBytes(&value, sizeof(value));
+		return value;
+	}
+
+	std::string readString()
+	{
+		const int length = readInt();
+		if ((length < 0) || (static_cast<size_t>(length) > size - position))
+		{
+			valid = false;
+			return std::string();
+		}
+		std::string text(reinterpret_cast<const char *>(data + position), length);
+		position += length;
+		return text;
+	}
+
+	/** Reads count values of type T into values, which is resized. */
+	template <typename T> bool readArray(std::vector<T>& values, unsigned long long count)
+	{
+		if ((!valid) || (count > (size - position)/sizeof(T)))
+		{
+			valid = false;
+			return false;
+		}
+		values.resize(static_cast<size_t>(count));
+		if (0 < count)
+			readBytes(&(values[0]), static_cast<size_t>(count)*sizeof(T));
+		return valid;
+	}
+};
+
+/** Sequential binary input or output for a binary region file or buffer. */
+class Region_binary_stream
+{
+public:
+
+	virtual ~Region_binary_stream()
+	{
+	}
+
+	virtual bool write(const void *bytes, size_t size) = 0;
+
+	virtual bool read(void *bytes, size_t size) = 0;
+
+	/** @return  Number of bytes left to read, or the largest value if unknown. */
+	virtual unsigned long long remaining() = 0;
+
+	template <typename T> bool writeValue(const T& value)
+	{
+		return write(&value, sizeof(T));
+	}
+
+	template <typename T> bool readValue(T& value)
+	{
+		return read(&value, sizeof(T));
+	}
+};
+
+class Region_binary_file_stream : public Region_binary_stream
+{
+	FILE *file;
+
+public:
+
+	explicit Region_binary_file_stream(FILE *file_in) :
+		file(file_in)
+	{
+	}
+
+	virtual bool write(const void *bytes, size_t size)
+	{
+		return (0 == size) || (1 == fwrite(bytes, size, 1, file));
+	}
+
+	virtual bool read(void *bytes, size_t size)
+	{
+		return (0 == size) || (1 == fread(bytes, size, 1, file));
+	}
+
+	virtual unsigned long long remaining()
+	{
+#if defined (WIN32_SYSTEM)
+		struct _stat64 file_stat;
+		const long long position = _ftelli64(file);
+		const bool regular_file = (0 == _fstat64(_fileno(file), &file_stat)) &&
+			(0 != (file_stat.st_mode & _S_IFREG));
+#else /* defined (WIN32_SYSTEM) */
+		struct stat file_stat;
+		const long long position = static_cast<long long>(ftello(file));
+		const bool regular_file = (0 == fstat(fileno(file), &file_stat)) && S_ISREG(file_stat.st_mode);
+#endif /* defined (WIN32_SYSTEM) */
+		if ((0 <= position) && regular_file)
+		{
+			const unsigned long long file_size = static_cast<unsigned long long>(file_stat.st_size);
+			const unsigned long long file_position = static_cast<unsigned long long>(position);
+			return (file_position < file_size) ? (file_size - file_position) : 0;
+		}
+		return std::numeric_limits<unsigned long long>::max();
+	}
+};
+
+class Region_binary_memory_stream : public Region_binary_stream
+{
+	std::vector<unsigned char> *output;
+	const unsigned char *input;
+	size_t input_size, input_position;
+
+public:
+
+	explicit Region_binary_memory_stream(std::vector<unsigned char> *output_in) :
+		output(output_in),
+		input(0),
+		input_size(0),
+		input_position(0)
+	{
+	}
+
+	Region_binary_memory_stream(const void *input_in, size_t input_size_in) :
+		output(0),
+		input(static_cast<const unsigned char *>(input_in)),
+		input_size(input_size_in),
+		input_position(0)
+	{
+	}
+
+	virtual bool write(const void *bytes, size_t size)
+	{
+		if (!output)
+			return false;
+		const unsigned char *source = static_cast<const unsigned char *>(bytes);
+		output->insert(output->end(), source, source + size);
+		return true;
+	}
+
+	virtual bool read(void *bytes, size_t size)
+	{
+		if ((!input) || (size > input_size - input_position))
+			return false;
+		if (0 < size)
+			memcpy(bytes, input + input_position, size);
+		input_position += size;
+		return true;
+	}
+
+	virtual unsigned long long remaining()
+	{
+		return input ? (input_size - input_position) : 0;
+	}
+};
+
+/**
+ * Writes a block header and data to stream, compressing if requested and if it
+ * reduces the size.
+ */
+bool Region_binary_write_block(Region_binary_stream& stream, int block_type,
+	const std::vector<unsigned char>& data, bool compress)
+{
+	unsigned int compression = REGION_BINARY_COMPRESSION_NONE;
+	const unsigned char *stored_data = data.empty() ? 0 : &(data[0]);
+	unsigned long long stored_size = data.size();
+#if defined (USE_ZLIB)
+	std::vector<unsigned char> compressed_data;
+	if (compress && (0 < data.size()))
+	{
+		uLongf compressed_size = compressBound(static_cast<uLong>(data.size()));
+		compressed_data.resize(compressed_size);
+		if ((Z_OK == compress2(&(compressed_data[0]), &compressed_size, &(data[0]),
+			static_cast<uLong>(data.size()), Z_DEFAULT_COMPRESSION)) &&
+			(compressed_size < data.size()))
+		{
+			compression = REGION_BINARY_COMPRESSION_ZLIB;
+			stored_data = &(compressed_data[0]);
+			stored_size = compressed_size;
+		}
+	}
+#else /* defined (USE_ZLIB) */
+	USE_PARAMETER(compress);
+#endif /* defined (USE_ZLIB) */
+	unsigned int type = static_cast<unsigned int>(block_type);
+	unsigned long long size = data.size();
+	return stream.writeValue(type) && stream.writeValue(compression) &&
+		stream.writeValue(size) && stream.writeValue(stored_size) &&
+		stream.write(stored_data, static_cast<size_t>(stored_size));
+}
+
+/**
+ * Reads the next block from stream, uncompressing its data.
+ * @return  true on success, false on error or end of stream.
+ */
+bool Region_binary_read_block(Region_binary_stream& stream, int& block_type,
+	std::vector<unsigned char>& data)
+{
+	unsigned int type, compression;
+	unsigned long long size, stored_size;
+	if (!(stream.readValue(type) && stream.readValue(compression) &&
+		stream.readValue(size) && stream.readValue(stored_size)))
+	{
+		display_message(ERROR_MESSAGE, "Binary region file:  Truncated block header");
+		return false;
+	}
+	block_type = static_cast<int>(type);
+	/* check sizes from the header before allocating, so corrupt or truncated
+	 * input fails cleanly instead of exhausting memory */
+	if ((stored_size > stream.remaining()) ||
+		(stored_size > static_cast<unsigned long long>(std::numeric_limits<size_t>::max())))
+	{
+		display_message(ERROR_MESSAGE, "Binary region file:  Truncated block data");
+		return false;
+	}
+	if ((size > static_cast<unsigned long long>(std::numeric_limits<size_t>::max())) ||
+		((REGION_BINARY_COMPRESSION_NONE == compression) && (size != stored_size)) ||
+		((stored_size < std::numeric_limits<unsigned long long>::max()/region_binary_maximum_compression_ratio) &&
+			(size > region_binary_maximum_compression_ratio*(stored_size + 1))))
+	{
+		display_message(ERROR_MESSAGE, "Binary region file:  Invalid block size");
+		return false;
+	}
+	std::vector<unsigned char> stored_data(static_cast<size_t>(stored_size));
+	if ((0 < stored_size) && (!stream.read(&(stored_data[0]), static_cast<size_t>(stored_size))))
+	{
+		display_message(ERROR_MESSAGE, "Binary region file:  Truncated block data");
+		return false;
+	}
+	if (REGION_BINARY_COMPRESSION_NONE == compression)
+	{
+		data.swap(stored_data);
+		return true;
+	}
+#if defined (USE_ZLIB)
+	if (REGION_BINARY_COMPRESSION_ZLIB == compression)
+	{
+		if (size > static_cast<unsigned long long>(std::numeric_limits<uLongf>::max()))
+		{
+			display_message(ERROR_MESSAGE, "Binary region file:  Invalid block size");
+			return false;
+		}
+		data.resize(static_cast<size_t>(size));
+		uLongf uncompressed_size = static_cast<uLongf>(size);
+		if ((0 < size) && ((Z_OK != uncompress(&(data[0]), &uncompressed_size,
+			&(stored_data[0]), static_cast<uLong>(stored_size))) || (uncompressed_size != size)))
+		{
+			display_message(ERROR_MESSAGE, "Binary region file:  Could not uncompress block");
+			return false;
+		}
+		return true;
+	}
+#endif /* defined (USE_ZLIB) */
+	display_message(ERROR_MESSAGE,
+		"Binary region file:  Unsupported block compression %u", compression);
+	return false;
+}
+
+/** @return  True if field is a real-valued finite element field. */
+bool Region_binary_is_stored_field(cmzn_field_id field)
+{
+	bool result = false;
+	cmzn_field_finite_element_id finite_element_field = cmzn_field_cast_finite_element(field);
+	if (finite_element_field)
+	{
+		result = (CMZN_FIELD_VALUE_TYPE_REAL == cmzn_field_get_value_type(field));
+		cmzn_field_finite_element_destroy(&finite_element_field);
+	}
+	return result;
+}
+
+/** Parameter layout of a field at a node: number of versions of each value
+ * label for each component. */
+typedef std::vector<unsigned char> Region_binary_node_field_template;
+
+/** Writes definitions of stored fields, adding them to fields in order. */
+bool Region_binary_write_fields_block(cmzn_fieldmodule_id fieldmodule,
+	std::vector<cmzn_field_id>& fields, Region_binary_block_writer& block)
+{
+	cmzn_fielditerator_id iterator = cmzn_fieldmodule_create_fielditerator(fieldmodule);
+	cmzn_field_id field;
+	while (0 != (field = cmzn_fielditerator_next(iterator)))
+	{
+		if (Region_binary_is_stored_field(field))
+			fields.push_back(field);
+		else
+			cmzn_field_destroy(&field);
+	}
+	cmzn_fielditerator_destroy(&iterator);
+	block.appendInt(static_cast<int>(fields.size()));
+	for (size_t f = 0; f < fields.size(); ++f)
+	{
+		field = fields[f];
+		char *name = cmzn_field_get_name(field);
+		block.appendString(name);
+		cmzn_deallocate(name);
+		const int number_of_components = cmzn_field_get_number_of_components(field);
+		block.appendInt(number_of_components);
+		block.appendInt(static_cast<int>(cmzn_field_get_coordinate_system_type(field)));
+		block.appendDouble(cmzn_field_get_coordinate_system_focus(field));
+		block.appendInt(cmzn_field_is_type_coordinate(field) ? region_binary_field_flag_coordinate : 0);
+		for (int c = 1; c <= number_of_components; ++c)
+		{
+			char *component_name = cmzn_field_get_component_name(field, c);
+			block.appendString(component_name ? component_name : "");
+			cmzn_deallocate(component_name);
+		}
+	}
+	return true;
+}
+
+/**
+ * Writes identifiers, packed field parameters and group membership for nodes
+ * in the nodeset for domain_type.
+ */
+bool Region_binary_write_nodes_block(cmzn_fieldmodule_id fieldmodule,
+	cmzn_field_domain_type domain_type, const std::vector<cmzn_field_id>& fields,
+	Region_binary_block_writer& block)
+{
+	bool result = true;
+	cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(fieldmodule, domain_type);
+	std::vector<cmzn_node_id> nodes;
+	cmzn_nodeiterator_id iterator = cmzn_nodeset_create_nodeiterator(nodeset);
+	cmzn_node_id node;
+	while (0 != (node = cmzn_nodeiterator_next(iterator)))
+		nodes.push_back(node);
+	cmzn_nodeiterator_destroy(&iterator);
+	const int number_of_nodes = static_cast<int>(nodes.size());
+	block.appendInt(static_cast<int>(domain_type));
+	block.appendInt(number_of_nodes);
+	for (int n = 0; n < number_of_nodes; ++n)
+		block.appendInt(cmzn_node_get_identifier(nodes[n]));
+	cmzn_nodetemplate_id nodetemplate = cmzn_nodeset_create_nodetemplate(nodeset);
+	const int number_of_fields = static_cast<int>(fields.size());
+	block.appendInt(number_of_fields);
+	for (int f = 0; (f < number_of_fields) && result; ++f)
+	{
+		cmzn_field_id field = fields[f];
+		const int number_of_components = cmzn_field_get_number_of_components(field);
+		struct FE_field *fe_field = 0;
+		Computed_field_get_type_finite_element(field, &fe_field);
+		std::vector<Region_binary_node_field_template> templates;
+		std::map<Region_binary_node_field_template, int> template_indexes;
+		std::vector<int> node_template_indexes(number_of_nodes, -1);
+		std::vector<double> parameters;
+		for (int n = 0; (n < number_of_nodes) && result; ++n)
+		{
+			if (CMZN_OK != cmzn_nodetemplate_define_field_from_node(nodetemplate, field, nodes[n]))
+				continue;
+			cmzn_timesequence_id timesequence = cmzn_nodetemplate_get_timesequence(nodetemplate, field);
+			if (timesequence)
+			{
+				cmzn_timesequence_destroy(&timesequence);
+				char *name = cmzn_field_get_name(field);
+				display_message(ERROR_MESSAGE, "Binary region file:  "
+					"Time varying nodal parameters of field %s are not supported", name);
+				cmzn_deallocate(name);
+				result = false;
+				break;
+			}
+			Region_binary_node_field_template node_field_template(
+				number_of_components*region_binary_number_of_node_value_labels);
+			for (int c = 0; c < number_of_components; ++c)
+			{
+				for (int l = 0; l < region_binary_number_of_node_value_labels; ++l)
+				{
+					int versions = cmzn_nodetemplate_get_value_number_of_versions(nodetemplate,
+						field, c + 1, region_binary_node_value_labels[l]);
+					node_field_template[c*region_binary_number_of_node_value_labels + l] =
+						static_cast<unsigned char>((0 < versions) ? versions : 0);
+				}
+			}
+			std::map<Region_binary_node_field_template, int>::iterator template_iter =
+				template_indexes.find(node_field_template);
+			if (template_iter == template_indexes.end())
+			{
+				template_iter = template_indexes.insert(std::make_pair(
+					node_field_template, static_cast<int>(templates.size()))).first;
+				templates.push_back(node_field_template);
+			}
+			node_template_indexes[n] = template_iter->second;
+			for (int c = 0; (c < number_of_components) && result; ++c)
+			{
+				for (int l = 0; (l < region_binary_number_of_node_value_labels) && result; ++l)
+				{
+					const int versions = node_field_template[c*region_binary_number_of_node_value_labels + l];
+					for (int v = 0; v < versions; ++v)
+					{
+						FE_value value = 0.0;
+						if (!get_FE_nodal_FE_value_value(nodes[n], fe_field, c, v,
+							region_binary_nodal_value_types[l], /*time*/0.0, &value))
+						{
+							char *name = cmzn_field_get_name(field);
+							display_message(ERROR_MESSAGE, "Binary region file:  "
+								"Could not get parameters of field %s at node %d", name,
+								cmzn_node_get_identifier(nodes[n]));
+							cmzn_deallocate(name);
+							result = false;
+							break;
+						}
+						parameters.push_back(value);
+					}
+				}
+			}
+		}
+		block.appendInt(f);
+		block.appendInt(static_cast<int>(templates.size()));
+		for (size_t t = 0; t < templates.size(); ++t)
+			block.appendBytes(&(templates[t][0]), templates[t].size());
+		if (0 < number_of_nodes)
+			block.appendBytes(&(node_template_indexes[0]), number_of_nodes*sizeof(int));
+		block.appendUnsignedLongLong(parameters.size());
+		if (!parameters.empty())
+			block.appendBytes(&(parameters[0]), parameters.size()*sizeof(double));
+	}
+	cmzn_nodetemplate_destroy(&nodetemplate);
+	/* group membership */
+	std::vector<cmzn_field_group_id> groups;
+	cmzn_fielditerator_id field_iterator = cmzn_fieldmodule_create_fielditerator(fieldmodule);
+	cmzn_field_id field;
+	while (0 != (field = cmzn_fielditerator_next(field_iterator)))
+	{
+		cmzn_field_group_id group = cmzn_field_cast_group(field);
+		if (group)
+			groups.push_back(group);
+		cmzn_field_destroy(&field);
+	}
+	cmzn_fielditerator_destroy(&field_iterator);
+	block.appendInt(static_cast<int>(groups.size()));
+	for (size_t g = 0; g < groups.size(); ++g)
+	{
+		char *name = cmzn_field_get_name(cmzn_field_group_base_cast(groups[g]));
+		block.appendString(name);
+		cmzn_deallocate(name);
+		std::vector<int> identifiers;
+		cmzn_field_node_group_id node_group = cmzn_field_group_get_field_node_group(groups[g], nodeset);
+		if (node_group)
+		{
+			cmzn_nodeset_group_id nodeset_group = cmzn_field_node_group_get_nodeset_group(node_group);
+			for (int n = 0; n < number_of_nodes; ++n)
+				if (cmzn_nodeset_contains_node(cmzn_nodeset_group_base_cast(nodeset_group), nodes[n]))
+					identifiers.push_back(cmzn_node_get_identifier(nodes[n]));
+			cmzn_nodeset_group_destroy(&nodeset_group);
+			cmzn_field_node_group_destroy(&node_group);
+		}
+		block.appendInt(static_cast<int>(identifiers.size()));
+		if (!identifiers.empty())
+			block.appendBytes(&(identifiers[0]), identifiers.size()*sizeof(int));
+		cmzn_field_group_destroy(&(groups[g]));
+	}
+	for (int n = 0; n < number_of_nodes; ++n)
+		cmzn_node_destroy(&(nodes[n]));
+	cmzn_nodeset_destroy(&nodeset);
+	return result;
+}
+
+/** Writes EX text for all elements and element fields in region. */
+bool Region_binary_write_elements_block(cmzn_region_id region,
+	Region_binary_block_writer& block)
+{
+	bool result = false;
+	cmzn_streaminformation_id streaminformation = cmzn_region_create_streaminformation_region(region);
+	cmzn_streaminformation_region_id streaminformation_region =
+		cmzn_streaminformation_cast_region(streaminformation);
+	cmzn_streamresource_id resource = cmzn_streaminformation_create_streamresource_memory(streaminformation);
+	cmzn_streaminformation_region_set_recursion_mode(streaminformation_region,
+		CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_OFF);
+	cmzn_streaminformation_region_set_resource_domain_types(streaminformation_region, resource,
+		CMZN_FIELD_DOMAIN_TYPE_MESH1D|CMZN_FIELD_DOMAIN_TYPE_MESH2D|CMZN_FIELD_DOMAIN_TYPE_MESH3D);
+	if (CMZN_OK == cmzn_region_write(region, streaminformation_region))
+	{
+		cmzn_streamresource_memory_id memory_resource = cmzn_streamresource_cast_memory(resource);
+		const void *buffer = 0;
+		unsigned int buffer_length = 0;
+		if (CMZN_OK == cmzn_streamresource_memory_get_buffer(memory_resource, &buffer, &buffer_length))
+		{
+			block.appendBytes(buffer, buffer_length);
+			result = true;
+		}
+		cmzn_streamresource_memory_destroy(&memory_resource);
+	}
+	cmzn_streamresource_destroy(&resource);
+	cmzn_streaminformation_region_destroy(&streaminformation_region);
+	cmzn_streaminformation_destroy(&streaminformation);
+	return result;
+}
+
+/** Creates or finds the fields in a fields block, adding them to fields. */
+bool Region_binary_read_fields_block(cmzn_fieldmodule_id fieldmodule,
+	Region_binary_block_reader& block, std::vector<cmzn_field_id>& fields)
+{
+	const int number_of_fields = block.readInt();
+	for (int f = 0; (f < number_of_fields) && block.isValid(); ++f)
+	{
+		std::string name = block.readString();
+		const int number_of_components = block.readInt();
+		const int coordinate_system_type = block.readInt();
+		const double coordinate_system_focus = block.readDouble();
+		const int flags = block.readInt();
+		if ((!block.checkCount(number_of_components, sizeof(int))) || (number_of_components < 1))
+			return false;
+		std::vector<std::string> component_names(number_of_components);
+		for (int c = 0; c < number_of_components; ++c)
+			component_names[c] = block.readString();
+		if (!block.isValid())
+			return false;
+		cmzn_field_id field = cmzn_fieldmodule_create_field_finite_element(fieldmodule, number_of_components);
+		cmzn_field_set_name(field, name.c_str());
+		cmzn_field_set_managed(field, true);
+		cmzn_field_set_coordinate_system_type(field,
+			static_cast<cmzn_field_coordinate_system_type>(coordinate_system_type));
+		cmzn_field_set_coordinate_system_focus(field, coordinate_system_focus);
+		cmzn_field_set_type_coordinate(field, (0 != (flags & region_binary_field_flag_coordinate)));
+		for (int c = 0; c < number_of_components; ++c)
+			if (!component_names[c].empty())
+				cmzn_field_set_component_name(field, c + 1, component_names[c].c_str());
+		fields.push_back(field);
+	}
+	return block.isValid();
+}
+
+/** Creates nodes, assigns their parameters and adds them to groups. */
+bool Region_binary_read_nodes_block(cmzn_fieldmodule_id fieldmodule,
+	Region_binary_block_reader& block, const std::vector<cmzn_field_id>& fields)
+{
+	const cmzn_field_domain_type domain_type = static_cast<cmzn_field_domain_type>(block.readInt());
+	const int number_of_nodes = block.readInt();
+	std::vector<int> identifiers;
+	if ((!block.isValid()) || (number_of_nodes < 0) || (!block.readArray(identifiers, number_of_nodes)))
+		return false;
+	cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(fieldmodule, domain_type);
+	if (!nodeset)
+	{
+		display_message(ERROR_MESSAGE, "Binary region file:  Invalid nodeset domain");
+		return false;
+	}
+	bool result = true;
+	/* read all field layouts first as nodes need every field defined on creation */
+	const int number_of_fields = block.readInt();
+	/* each field has at least an index, template count and parameter count */
+	if (!block.checkCount(number_of_fields, 2*sizeof(int) + sizeof(unsigned long long)))
+	{
+		cmzn_nodeset_destroy(&nodeset);
+		return false;
+	}
+	std::vector<int> field_indexes(number_of_fields);
+	std::vector< std::vector<Region_binary_node_field_template> > field_templates(field_indexes.size());
+	std::vector< std::vector<int> > field_node_template_indexes(field_indexes.size());
+	std::vector< std::vector<double> > field_parameters(field_indexes.size());
+	for (int f = 0; (f < number_of_fields) && result; ++f)
+	{
+		field_indexes[f] = block.readInt();
+		if ((field_indexes[f] < 0) || (field_indexes[f] >= static_cast<int>(fields.size())))
+		{
+			result = false;
+			break;
+		}
+		const int number_of_components = cmzn_field_get_number_of_components(fields[field_indexes[f]]);
+		const int number_of_templates = block.readInt();
+		if (!block.checkCount(number_of_templates,
+			static_cast<size_t>(number_of_components*region_binary_number_of_node_value_labels)))
+		{
+			result = false;
+			break;
+		}
+		field_templates[f].resize(number_of_templates);
+		for (int t = 0; t < number_of_templates; ++t)
+			block.readArray(field_templates[f][t], number_of_components*region_binary_number_of_node_value_labels);
+		block.readArray(field_node_template_indexes[f], number_of_nodes);
+		const unsigned long long number_of_parameters = block.readUnsignedLongLong();
+		block.readArray(field_parameters[f], number_of_parameters);
+		result = block.isValid();
+		for (int n = 0; (n < number_of_nodes) && result; ++n)
+			if (field_node_template_indexes[f][n] >= number_of_templates)
+				result = false;
+	}
+	if (result)
+	{
+		/* node templates are shared by nodes with the same combination of field layouts */
+		std::map<std::vector<int>, cmzn_nodetemplate_id> nodetemplates;
+		std::vector<struct FE_field *> fe_fields(number_of_fields, static_cast<struct FE_field *>(0));
+		std::vector<size_t> parameter_offsets(number_of_fields, 0);
+		for (int f = 0; f < number_of_fields; ++f)
+			Computed_field_get_type_finite_element(fields[field_indexes[f]], &(fe_fields[f]));
+		std::vector<int> key(number_of_fields);
+		for (int n = 0; (n < number_of_nodes) && result; ++n)
+		{
+			for (int f = 0; f < number_of_fields; ++f)
+				key[f] = field_node_template_indexes[f][n];
+			std::map<std::vector<int>, cmzn_nodetemplate_id>::iterator template_iter = nodetemplates.find(key);
+			if (template_iter == nodetemplates.end())
+			{
+				cmzn_nodetemplate_id nodetemplate = cmzn_nodeset_create_nodetemplate(nodeset);
+				for (int f = 0; f < number_of_fields; ++f)
+				{
+					if (key[f] < 0)
+						continue;
+					cmzn_field_id field = fields[field_indexes[f]];
+					const int number_of_components = cmzn_field_get_number_of_components(field);
+					const Region_binary_node_field_template& node_field_template = field_templates[f][key[f]];
+					cmzn_nodetemplate_define_field(nodetemplate, field);
+					for (int c = 0; c < number_of_components; ++c)
+						for (int l = 0; l < region_binary_number_of_node_value_labels; ++l)
+							cmzn_nodetemplate_set_value_number_of_versions(nodetemplate, field, c + 1,
+								region_binary_node_value_labels[l],
+								node_field_template[c*region_binary_number_of_node_value_labels + l]);
+				}
+				template_iter = nodetemplates.insert(std::make_pair(key, nodetemplate)).first;
+			}
+			cmzn_node_id node = cmzn_nodeset_create_node(nodeset, identifiers[n], template_iter->second);
+			if (!node)
+			{
+				display_message(ERROR_MESSAGE,
+					"Binary region file:  Could not create node %d", identifiers[n]);
+				result = false;
+				break;
+			}
+			for (int f = 0; (f < number_of_fields) && result; ++f)
+			{
+				if (key[f] < 0)
+					continue;
+				const int number_of_components = cmzn_field_get_number_of_components(fields[field_indexes[f]]);
+				const Region_binary_node_field_template& node_field_template = field_templates[f][key[f]];
+				for (int c = 0; (c < number_of_components) && result; ++c)
+				{
+					for (int l = 0; (l < region_binary_number_of_node_value_labels) && result; ++l)
+					{
+						const int versions = node_field_template[c*region_binary_number_of_node_value_labels + l];
+						for (int v = 0; v < versions; ++v)
+						{
+							if (parameter_offsets[f] >= field_parameters[f].size())
+							{
+								display_message(ERROR_MESSAGE, "Binary region file:  Too few node parameters");
+								result = false;
+								break;
+							}
+							if (!set_FE_nodal_FE_value_value(node, fe_fields[f], c, v,
+								region_binary_nodal_value_types[l], /*time*/0.0,
+								field_parameters[f][parameter_offsets[f]]))
+							{
+								char *name = cmzn_field_get_name(fields[field_indexes[f]]);
+								display_message(ERROR_MESSAGE, "Binary region file:  "
+									"Could not set parameters of field %s at node %d", name, identifiers[n]);
+								cmzn_deallocate(name);
+								result = false;
+								break;
+							}
+							++parameter_offsets[f];
+						}
+					}
+				}
+			}
+			cmzn_node_destroy(&node);
+		}
+		for (std::map<std::vector<int>, cmzn_nodetemplate_id>::iterator template_iter = nodetemplates.begin();
+			template_iter != nodetemplates.end(); ++template_iter)
+		{
+			cmzn_nodetemplate_destroy(&(template_iter->second));
+		}
+		for (int f = 0; (f < number_of_fields) && result; ++f)
+		{
+			if (parameter_offsets[f] != field_parameters[f].size())
+			{
+				display_message(ERROR_MESSAGE, "Binary region file:  Too many node parameters");
+				result = false;
+			}
+		}
+	}
+	/* group membership */
+	const int number_of_groups = result ? block.readInt() : 0;
+	for (int g = 0; (g < number_of_groups) && result; ++g)
+	{
+		std::string name = block.readString();
+		const int number_of_members = block.readInt();
+		std::vector<int> member_identifiers;
+		if ((number_of_members < 0) || (!block.readArray(member_identifiers, number_of_members)))
+		{
+			result = false;
+			break;
+		}
+		cmzn_field_id field = cmzn_fieldmodule_find_field_by_name(fieldmodule, name.c_str());
+		if (!field)
+		{
+			field = cmzn_fieldmodule_create_field_group(fieldmodule);
+			cmzn_field_set_name(field, name.c_str());
+			cmzn_field_set_managed(field, true);
+		}
+		cmzn_field_group_id group = cmzn_field_cast_group(field);
+		cmzn_field_destroy(&field);
+		if (!group)
+		{
+			display_message(ERROR_MESSAGE,
+				"Binary region file:  Field %s is not a group", name.c_str());
+			result = false;
+			break;
+		}
+		if (0 < number_of_members)
+		{
+			cmzn_field_node_group_id node_group = cmzn_field_group_get_field_node_group(group, nodeset);
+			if (!node_group)
+				node_group = cmzn_field_group_create_field_node_group(group, nodeset);
+			cmzn_nodeset_group_id nodeset_group = cmzn_field_node_group_get_nodeset_group(node_group);
+			for (int m = 0; m < number_of_members; ++m)
+			{
+				cmzn_node_id node = cmzn_nodeset_find_node_by_identifier(nodeset, member_identifiers[m]);
+				cmzn_nodeset_group_add_node(nodeset_group, node);
+				cmzn_node_destroy(&node);
+			}
+			cmzn_nodeset_group_destroy(&nodeset_group);
+			cmzn_field_node_group_destroy(&node_group);
+		}
+		cmzn_field_group_destroy(&group);
+	}
+	cmzn_nodeset_destroy(&nodeset);
+	return result && block.isValid();
+}
+
+/** Reads EX element text into region. */
+bool Region_binary_read_elements_block(cmzn_region_id region,
+	const std::vector<unsigned char>& data)
+{
+	if (data.empty())
+		return true;
+	cmzn_streaminformation_id streaminformation = cmzn_region_create_streaminformation_region(region);
+	cmzn_streamresource_id resource = cmzn_streaminformation_create_streamresource_memory_buffer(
+		streaminformation, &(data[0]), static_cast<unsigned int>(data.size()));
+	cmzn_streaminformation_region_id streaminformation_region =
+		cmzn_streaminformation_cast_region(streaminformation);
+	const bool result = (CMZN_OK == cmzn_region_read(region, streaminformation_region));
+	cmzn_streamresource_destroy(&resource);
+	cmzn_streaminformation_region_destroy(&streaminformation_region);
+	cmzn_streaminformation_destroy(&streaminformation);
+	return result;
+}
+
+/**
+ * Writes header and all blocks for region to stream.
+ */
+bool Region_binary_write(cmzn_region_id region, Region_binary_stream& stream,
+	bool compress)
+{
+	cmzn_fieldmodule_id fieldmodule = cmzn_region_get_fieldmodule(region);
+	const unsigned int number_of_blocks = 4;
+	bool result = stream.write(region_binary_signature, sizeof(region_binary_signature)) &&
+		stream.writeValue(region_binary_version) &&
+		stream.writeValue(region_binary_byte_order_check) &&
+		stream.writeValue(number_of_blocks);
+	std::vector<cmzn_field_id> fields;
+	Region_binary_block_writer block;
+	result = result && Region_binary_write_fields_block(fieldmodule, fields, block) &&
+		Region_binary_write_block(stream, REGION_BINARY_BLOCK_FIELDS, block.getData(), compress);
+	const cmzn_field_domain_type nodeset_domain_types[2] =
+		{ CMZN_FIELD_DOMAIN_TYPE_NODES, CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS };
+	for (int i = 0; (i < 2) && result; ++i)
+	{
+		block.clear();
+		result = Region_binary_write_nodes_block(fieldmodule, nodeset_domain_types[i], fields, block) &&
+			Region_binary_write_block(stream, REGION_BINARY_BLOCK_NODES, block.getData(), compress);
+	}
+	if (result)
+	{
+		block.clear();
+		result = Region_binary_write_elements_block(region, block) &&
+			Region_binary_write_block(stream, REGION_BINARY_BLOCK_ELEMENTS, block.getData(), compress);
+	}
+	for (size_t f = 0; f < fields.size(); ++f)
+		cmzn_field_destroy(&(fields[f]));
+	cmzn_fieldmodule_destroy(&fieldmodule);
+	return result;
+}
+
+/**
+ * Reads binary region contents from stream into a temporary child of region
+ * and merges it into region.
+ * @param source_name  File name or description of source for error messages.
+ */
+bool Region_binary_read(cmzn_region_id region, Region_binary_stream& stream,
+	const char *source_name)
+{
+	char signature[8];
+	unsigned int version = 0, byte_order_check = 0, number_of_blocks = 0;
+	bool result = stream.read(signature, sizeof(signature)) &&
+		(0 == memcmp(signature, region_binary_signature, sizeof(signature))) &&
+		stream.readValue(version) && stream.readValue(byte_order_check) &&
+		stream.readValue(number_of_blocks);
+	if (!result)
+	{
+		display_message(ERROR_MESSAGE, "%s is not a binary region file", source_name);
+		return false;
+	}
+	if (version != region_binary_version)
+	{
+		display_message(ERROR_MESSAGE, "Binary region file %s has unsupported version %u",
+			source_name, version);
+		return false;
+	}
+	if (byte_order_check != region_binary_byte_order_check)
+	{
+		display_message(ERROR_MESSAGE,
+			"Binary region file %s was written with a different byte order", source_name);
+		return false;
+	}
+	cmzn_region_id temp_region = cmzn_region_create_region(region);
+	cmzn_fieldmodule_id fieldmodule = cmzn_region_get_fieldmodule(temp_region);
+	cmzn_fieldmodule_begin_change(fieldmodule);
+	std::vector<cmzn_field_id> fields;
+	std::vector<unsigned char> data;
+	for (unsigned int b = 0; (b < number_of_blocks) && result; ++b)
+	{
+		int block_type = 0;
+		result = Region_binary_read_block(stream, block_type, data);
+		if (!result)
+			break;
+		Region_binary_block_reader block(data.empty() ? 0 : &(data[0]), data.size());
+		switch (block_type)
+		{
+		case REGION_BINARY_BLOCK_FIELDS:
+			result = Region_binary_read_fields_block(fieldmodule, block, fields);
+			break;
+		case REGION_BINARY_BLOCK_NODES:
+			result = Region_binary_read_nodes_block(fieldmodule, block, fields);
+			break;
+		case REGION_BINARY_BLOCK_ELEMENTS:
+			result = Region_binary_read_elements_block(temp_region, data);
+			break;
+		default:
+			/* skip blocks from newer minor revisions */
+			break;
+		}
+	}
+	for (size_t f = 0; f < fields.size(); ++f)
+		cmzn_field_destroy(&(fields[f]));
+	cmzn_fieldmodule_end_change(fieldmodule);
+	cmzn_fieldmodule_destroy(&fieldmodule);
+	if (!result)
+	{
+		display_message(ERROR_MESSAGE, "Error reading binary region file: %s", source_name);
+	}
+	else if (cmzn_region_can_merge(region, temp_region))
+	{
+		if (!cmzn_region_merge(region, temp_region))
+		{
+			display_message(ERROR_MESSAGE,
+				"Error merging binary region file: %s", source_name);
+			result = false;
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Contents of file %s not compatible with global objects", source_name);
+		result = false;
+	}
+	cmzn_region_destroy(&temp_region);
+	return result;
+}
+
+} // anonymous namespace
+
+int write_region_binary_file(cmzn_region_id region, const char *file_name,
+	int compress)
+{
+	if (!(region && file_name))
+	{
+		display_message(ERROR_MESSAGE, "write_region_binary_file.  Invalid argument(s)");
+		return 0;
+	}
+#if !defined (USE_ZLIB)
+	if (compress)
+	{
+		display_message(WARNING_MESSAGE,
+			"Binary region file:  Compression is not available in this build");
+	}
+#endif /* !defined (USE_ZLIB) */
+	FILE *file = fopen(file_name, "wb");
+	if (!file)
+	{
+		display_message(ERROR_MESSAGE, "Could not open binary region file: %s", file_name);
+		return 0;
+	}
+	Region_binary_file_stream stream(file);
+	bool result = Region_binary_write(region, stream, (0 != compress));
+	if (0 != fclose(file))
+		result = false;
+	if (!result)
+	{
+		display_message(ERROR_MESSAGE, "Error writing binary region file: %s", file_name);
+		remove(file_name);
+	}
+	return result ? 1 : 0;
+}
+
+int read_region_binary_file(cmzn_region_id region, const char *file_name)
+{
+	if (!(region && file_name))
+	{
+		display_message(ERROR_MESSAGE, "read_region_binary_file.  Invalid argument(s)");
+		return 0;
+	}
+	FILE *file = fopen(file_name, "rb");
+	if (!file)
+	{
+		display_message(ERROR_MESSAGE, "Could not open binary region file: %s", file_name);
+		return 0;
+	}
+	Region_binary_file_stream stream(file);
+	const bool result = Region_binary_read(region, stream, file_name);
+	fclose(file);
+	return result ? 1 : 0;
+}
+
+int write_region_binary_memory(cmzn_region_id region, int compress,
+	std::vector<unsigned char>& buffer)
+{
+	if (!region)
+	{
+		display_message(ERROR_MESSAGE, "write_region_binary_memory.  Invalid argument(s)");
+		return 0;
+	}
+	buffer.clear();
+	Region_binary_memory_stream stream(&buffer);
+	return Region_binary_write(region, stream, (0 != compress)) ? 1 : 0;
+}
+
+int read_region_binary_memory(cmzn_region_id region, const void *buffer,
+	size_t buffer_size, const char *source_name)
+{
+	if (!(region && buffer))
+	{
+		display_message(ERROR_MESSAGE, "read_region_binary_memory.  Invalid argument(s)");
+		return 0;
+	}
+	Region_binary_memory_stream stream(buffer, buffer_size);
+	return Region_binary_read(region, stream, source_name ? source_name : "memory") ? 1 : 0;
+}
+
+int region_has_time_varying_nodal_parameters(cmzn_region_id region)
+{
+	if (!region)
+		return 0;
+	bool time_varying = false;
+	cmzn_fieldmodule_id fieldmodule = cmzn_region_get_fieldmodule(region);
+	std::vector<cmzn_field_id> fields;
+	cmzn_fielditerator_id field_iterator = cmzn_fieldmodule_create_fielditerator(fieldmodule);
+	cmzn_field_id field;
+	while (0 != (field = cmzn_fielditerator_next(field_iterator)))
+	{
+		if (Region_binary_is_stored_field(field))
+			fields.push_back(field);
+		else
+			cmzn_field_destroy(&field);
+	}
+	cmzn_fielditerator_destroy(&field_iterator);
+	const cmzn_field_domain_type nodeset_domain_types[2] =
+		{ CMZN_FIELD_DOMAIN_TYPE_NODES, CMZN_FIELD_DOMAIN_TYPE_DATAPOINTS };
+	for (int i = 0; (i < 2) && (!time_varying) && (!fields.empty()); ++i)
+	{
+		cmzn_nodeset_id nodeset = cmzn_fieldmodule_find_nodeset_by_field_domain_type(
+			fieldmodule, nodeset_domain_types[i]);
+		cmzn_nodetemplate_id nodetemplate = cmzn_nodeset_create_nodetemplate(nodeset);
+		cmzn_nodeiterator_id node_iterator = cmzn_nodeset_create_nodeiterator(nodeset);
+		cmzn_node_id node;
+		while ((!time_varying) && (0 != (node = cmzn_nodeiterator_next(node_iterator))))
+		{
+			for (size_t f = 0; (f < fields.size()) && (!time_varying); ++f)
+			{
+				if (CMZN_OK != cmzn_nodetemplate_define_field_from_node(nodetemplate, fields[f], node))
+					continue;
+				cmzn_timesequence_id timesequence = cmzn_nodetemplate_get_timesequence(nodetemplate, fields[f]);
+				if (timesequence)
+				{
+					cmzn_timesequence_destroy(&timesequence);
+					time_varying = true;
+				}
+			}
+			cmzn_node_destroy(&node);
+		}
+		cmzn_nodeiterator_destroy(&node_iterator);
+		cmzn_nodetemplate_destroy(&nodetemplate);
+		cmzn_nodeset_destroy(&nodeset);
+	}
+	for (size_t f = 0; f < fields.size(); ++f)
+		cmzn_field_destroy(&(fields[f]));
+	cmzn_fieldmodule_destroy(&fieldmodule);
+	return time_varying ? 1 : 0;
+}
+
+int is_region_binary_file(const char *file_name)
+{
+	int return_code = 0;
+	FILE *file = file_name ? fopen(file_name, "rb") : 0;
+	if (file)
+	{
+		char signature[8];
+		if ((1 == fread(signature, sizeof(signature), 1, file)) &&
+			(0 == memcmp(signature, region_binary_signature, sizeof(signature))))
+		{
+			return_code = 1;
+		}
+		fclose(file);
+	}
+	return return_code;
+}
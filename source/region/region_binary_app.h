@@ -0,0 +1,71 @@
+/***************************************************************************//**
+ * region_binary_app.h
+ *
+ * Versioned binary companion format for region contents. Node and datapoint
+ * identifiers, finite element field parameters and group membership are
+ * stored in packed columnar blocks; element definitions are stored as EX text.
+ * Blocks may be individually compressed.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (REGION_BINARY_APP_H)
+#define REGION_BINARY_APP_H
+
+#include <stddef.h>
+#include <vector>
+#include "zinc/region.h"
+
+/** Recommended file name extension for binary region files. */
+#define REGION_BINARY_FILE_EXTENSION ".cmregion"
+
+/***************************************************************************//**
+ * Writes the contents of region, not including child regions, to a binary
+ * region file. Time varying nodal parameters are not supported.
+ * @param compress  If non-zero, compress each block if zlib is available.
+ * @return  1 on success, 0 on failure.
+ */
+int write_region_binary_file(cmzn_region_id region, const char *file_name,
+	int compress);
+
+/***************************************************************************//**
+ * Reads a binary region file into a temporary child of region and merges it
+ * into region.
+ * @return  1 on success, 0 on failure.
+ */
+int read_region_binary_file(cmzn_region_id region, const char *file_name);
+
+/***************************************************************************//**
+ * Writes the contents of region in binary region format to buffer, replacing
+ * its contents. Used to hold decoded region data compactly in memory.
+ * @see write_region_binary_file
+ */
+int write_region_binary_memory(cmzn_region_id region, int compress,
+	std::vector<unsigned char>& buffer);
+
+/***************************************************************************//**
+ * Reads binary region format from buffer into a temporary child of region and
+ * merges it into region.
+ * @param source_name  Name used in error messages. Optional.
+ * @return  1 on success, 0 on failure.
+ */
+int read_region_binary_memory(cmzn_region_id region, const void *buffer,
+	size_t buffer_size, const char *source_name);
+
+/***************************************************************************//**
+ * @return  1 if any node or datapoint in region, not including child regions,
+ * has time varying parameters for a field, which binary region format cannot
+ * hold, otherwise 0.
+ */
+int region_has_time_varying_nodal_parameters(cmzn_region_id region);
+
+/***************************************************************************//**
+ * @return  1 if the named file starts with the binary region file signature,
+ * otherwise 0.
+ */
+int is_region_binary_file(const char *file_name);
+
+#endif /* !defined (REGION_BINARY_APP_H) */
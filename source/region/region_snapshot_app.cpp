@@ -0,0 +1,449 @@
+/***************************************************************************//**
+ * region_snapshot_app.cpp
+ *
+ * Snapshot file holding a whole region tree and session commands.
+ *
+ * File layout, header and table values little endian, packed:
+ *   char[8] signature "CMSNPSHT"
+ *   uint32 version, uint32 byte order check 0x01020304 in the byte order of
+ *   the binary region data, uint32 section count, uint32 reserved
+ *   section table, each entry:
+ *     uint32 section type, uint32 name size, uint64 name offset,
+ *     uint64 data offset, uint64 data size
+ *   section names and data at the offsets given, from the start of the file
+ * Section types are REGION (name is the path relative to the root region,
+ * empty for the root; data is a binary region image), REGION_EX (as REGION
+ * but data is EX text, for regions with time varying nodal parameters which
+ * binary region format cannot hold) and COMMANDS (command text). Regions are
+ * stored parents first so each is read after its parent.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <limits.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "zinc/region.h"
+#include "zinc/stream.h"
+#include "zinc/streamregion.h"
+#include "general/debug.h"
+#include "general/elapsed_time_app.h"
+#include "general/mapped_file_app.hpp"
+#include "general/message.h"
+#include "region/cmiss_region_app.h"
+#include "region/region_binary_app.h"
+#include "region/region_snapshot_app.h"
+
+namespace {
+
+const char region_snapshot_signature[8] = { 'C', 'M', 'S', 'N', 'P', 'S', 'H', 'T' };
+/* version 2 has an explicitly packed little endian header and table */
+const unsigned int region_snapshot_version = 2;
+const unsigned int region_snapshot_byte_order_check = 0x01020304;
+
+enum Region_snapshot_section_type
+{
+	REGION_SNAPSHOT_SECTION_REGION = 1,
+	REGION_SNAPSHOT_SECTION_COMMANDS = 2,
+	REGION_SNAPSHOT_SECTION_REGION_EX = 3
+};
+
+struct Region_snapshot_header
+{
+	char signature[8];
+	unsigned int version, byte_order_check, number_of_sections, reserved;
+};
+
+/* bytes in the file, independent of structure padding */
+const size_t region_snapshot_header_size = 24;
+
+struct Region_snapshot_section
+{
+	unsigned int type, name_size;
+	unsigned long long name_offset, data_offset, data_size;
+};
+
+const size_t region_snapshot_section_size = 32;
+
+void Region_snapshot_append_uint32(std::vector<unsigned char>& bytes, unsigned int value)
+{
+	for (int i = 0; i < 4; ++i)
+		bytes.push_back(static_cast<unsigned char>((value >> (8*i)) & 0xff));
+}
+
+void Region_snapshot_append_uint64(std::vector<unsigned char>& bytes, unsigned long long value)
+{
+	for (int i = 0; i < 8; ++i)
+		bytes.push_back(static_cast<unsigned char>((value >> (8*i)) & 0xff));
+}
+
+unsigned int Region_snapshot_get_uint32(const char *data)
+{
+	const unsigned char *bytes = reinterpret_cast<const unsigned char *>(data);
+	return static_cast<unsigned int>(bytes[0]) | (static_cast<unsigned int>(bytes[1]) << 8) |
+		(static_cast<unsigned int>(bytes[2]) << 16) | (static_cast<unsigned int>(bytes[3]) << 24);
+}
+
+unsigned long long Region_snapshot_get_uint64(const char *data)
+{
+	return static_cast<unsigned long long>(Region_snapshot_get_uint32(data)) |
+		(static_cast<unsigned long long>(Region_snapshot_get_uint32(data + 4)) << 32);
+}
+
+void Region_snapshot_encode_header(const Region_snapshot_header& header,
+	std::vector<unsigned char>& bytes)
+{
+	bytes.insert(bytes.end(), header.signature, header.signature + sizeof(header.signature));
+	Region_snapshot_append_uint32(bytes, header.version);
+	/* native order so the reader can tell if binary region data is readable */
+	const unsigned char *check = reinterpret_cast<const unsigned char *>(&header.byte_order_check);
+	bytes.insert(bytes.end(), check, check + sizeof(header.byte_order_check));
+	Region_snapshot_append_uint32(bytes, header.number_of_sections);
+	Region_snapshot_append_uint32(bytes, header.reserved);
+}
+
+void Region_snapshot_decode_header(const char *data, Region_snapshot_header& header)
+{
+	memcpy(header.signature, data, sizeof(header.signature));
+	header.version = Region_snapshot_get_uint32(data + 8);
+	memcpy(&header.byte_order_check, data + 12, sizeof(header.byte_order_check));
+	header.number_of_sections = Region_snapshot_get_uint32(data + 16);
+	header.reserved = Region_snapshot_get_uint32(data + 20);
+}
+
+void Region_snapshot_encode_sections(const std::vector<Region_snapshot_section>& sections,
+	std::vector<unsigned char>& bytes)
+{
+	for (size_t s = 0; s < sections.size(); ++s)
+	{
+		Region_snapshot_append_uint32(bytes, sections[s].type);
+		Region_snapshot_append_uint32(bytes, sections[s].name_size);
+		Region_snapshot_append_uint64(bytes, sections[s].name_offset);
+		Region_snapshot_append_uint64(bytes, sections[s].data_offset);
+		Region_snapshot_append_uint64(bytes, sections[s].data_size);
+	}
+}
+
+void Region_snapshot_decode_section(const char *data, Region_snapshot_section& section)
+{
+	section.type = Region_snapshot_get_uint32(data);
+	section.name_size = Region_snapshot_get_uint32(data + 4);
+	section.name_offset = Region_snapshot_get_uint64(data + 8);
+	section.data_offset = Region_snapshot_get_uint64(data + 16);
+	section.data_size = Region_snapshot_get_uint64(data + 24);
+}
+
+/**
+ * @return  True if path is empty for the root region or a relative region path
+ * of non-empty names separated by single slashes, with no . or .. names.
+ */
+bool Region_snapshot_is_valid_region_path(const std::string& path)
+{
+	if (std::string::npos != path.find('\0'))
+		return false;
+	size_t start = 0;
+	while (start < path.size())
+	{
+		size_t end = path.find('/', start);
+		if (std::string::npos == end)
+			end = path.size();
+		else if (end + 1 == path.size())
+			return false;
+		const std::string name(path, start, end - start);
+		if (name.empty() || (name == ".") || (name == ".."))
+			return false;
+		start = end + 1;
+	}
+	return true;
+}
+
+/** Reads EX text into region. */
+bool Region_snapshot_read_ex(cmzn_region_id region, const char *data, unsigned long long size)
+{
+	/* Zinc memory stream resources have an unsigned int length */
+	if (size > UINT_MAX)
+		return false;
+	cmzn_streaminformation_id streaminformation = cmzn_region_create_streaminformation_region(region);
+	cmzn_streamresource_id resource = cmzn_streaminformation_create_streamresource_memory_buffer(
+		streaminformation, data, static_cast<unsigned int>(size));
+	cmzn_streaminformation_region_id streaminformation_region =
+		cmzn_streaminformation_cast_region(streaminformation);
+	const bool result = (CMZN_OK == cmzn_region_read(region, streaminformation_region));
+	cmzn_streamresource_destroy(&resource);
+	cmzn_streaminformation_region_destroy(&streaminformation_region);
+	cmzn_streaminformation_destroy(&streaminformation);
+	return result;
+}
+
+/**
+ * Writes region alone as EX text to buffer, with paths relative to itself.
+ */
+bool Region_snapshot_write_ex(cmzn_region_id region, std::vector<unsigned char>& buffer)
+{
+	buffer.clear();
+	cmzn_streamresource_memory_id memory = export_region_to_memory(region, /*group_name*/0,
+		/*root_region*/region, CMZN_FIELD_DOMAIN_TYPE_MESH1D|CMZN_FIELD_DOMAIN_TYPE_MESH2D|
+		CMZN_FIELD_DOMAIN_TYPE_MESH3D|CMZN_FIELD_DOMAIN_TYPE_MESH_HIGHEST_DIMENSION,
+		/*write_nodes*/1, /*write_data*/1, /*number_of_field_names*/0, /*field_names*/0,
+		/*time*/0.0, CMZN_STREAMINFORMATION_REGION_RECURSION_MODE_OFF, /*isFieldML*/0);
+	if (!memory)
+		return false;
+	const void *text = 0;
+	unsigned int length = 0;
+	const bool result = (CMZN_OK == cmzn_streamresource_memory_get_buffer(memory, &text, &length));
+	if (result && (0 < length))
+	{
+		const unsigned char *bytes = static_cast<const unsigned char *>(text);
+		buffer.assign(bytes, bytes + length);
+	}
+	cmzn_streamresource_memory_destroy(&memory);
+	return result;
+}
+
+/** Appends root_region and its descendants, parents first, with their paths. */
+void Region_snapshot_get_regions(cmzn_region_id region, const std::string& path,
+	std::vector<cmzn_region_id>& regions, std::vector<std::string>& paths)
+{
+	regions.push_back(cmzn_region_access(region));
+	paths.push_back(path);
+	cmzn_region_id child = cmzn_region_get_first_child(region);
+	while (child)
+	{
+		char *name = cmzn_region_get_name(child);
+		Region_snapshot_get_regions(child,
+			path.empty() ? std::string(name) : (path + "/" + name), regions, paths);
+		cmzn_deallocate(name);
+		cmzn_region_reaccess_next_sibling(&child);
+	}
+}
+
+bool Region_snapshot_write_bytes(FILE *file, const void *bytes, size_t size,
+	unsigned long long& offset)
+{
+	if ((0 < size) && (1 != fwrite(bytes, size, 1, file)))
+		return false;
+	offset += size;
+	return true;
+}
+
+} // anonymous namespace
+
+int write_region_snapshot_file(cmzn_region_id root_region,
+	const char *commands, size_t commands_size, int compress,
+	const char *file_name)
+{
+	if (!(root_region && (commands || (0 == commands_size)) && file_name))
+	{
+		display_message(ERROR_MESSAGE, "write_region_snapshot_file.  Invalid argument(s)");
+		return 0;
+	}
+	FILE *file = fopen(file_name, "wb");
+	if (!file)
+	{
+		display_message(ERROR_MESSAGE, "Could not open snapshot file: %s", file_name);
+		return 0;
+	}
+	std::vector<cmzn_region_id> regions;
+	std::vector<std::string> paths;
+	Region_snapshot_get_regions(root_region, std::string(), regions, paths);
+	const size_t number_of_regions = regions.size();
+	Region_snapshot_header header;
+	memcpy(header.signature, region_snapshot_signature, sizeof(header.signature));
+	header.version = region_snapshot_version;
+	header.byte_order_check = region_snapshot_byte_order_check;
+	header.number_of_sections = static_cast<unsigned int>(number_of_regions + 1);
+	header.reserved = 0;
+	std::vector<Region_snapshot_section> sections(header.number_of_sections);
+	/* the table is written again once section offsets are known */
+	std::vector<unsigned char> buffer;
+	Region_snapshot_encode_header(header, buffer);
+	Region_snapshot_encode_sections(sections, buffer);
+	unsigned long long offset = 0;
+	bool result = Region_snapshot_write_bytes(file, &(buffer[0]), buffer.size(), offset);
+	for (size_t r = 0; (r < number_of_regions) && result; ++r)
+	{
+		Region_snapshot_section& section = sections[r];
+		section.name_size = static_cast<unsigned int>(paths[r].size());
+		section.name_offset = offset;
+		result = Region_snapshot_write_bytes(file, paths[r].c_str(), paths[r].size(), offset);
+		if (region_has_time_varying_nodal_parameters(regions[r]))
+		{
+			section.type = REGION_SNAPSHOT_SECTION_REGION_EX;
+			result = result && Region_snapshot_write_ex(regions[r], buffer);
+		}
+		else
+		{
+			section.type = REGION_SNAPSHOT_SECTION_REGION;
+			result = result && write_region_binary_memory(regions[r], compress, buffer);
+		}
+		if (!result)
+		{
+			display_message(ERROR_MESSAGE, "Snapshot file:  Could not write region '%s'",
+				paths[r].c_str());
+			break;
+		}
+		section.data_offset = offset;
+		section.data_size = buffer.size();
+		result = Region_snapshot_write_bytes(file,
+			buffer.empty() ? 0 : &(buffer[0]), buffer.size(), offset);
+	}
+	if (result)
+	{
+		Region_snapshot_section& section = sections[number_of_regions];
+		section.type = REGION_SNAPSHOT_SECTION_COMMANDS;
+		section.name_size = 0;
+		section.name_offset = offset;
+		section.data_offset = offset;
+		section.data_size = commands_size;
+		buffer.clear();
+		Region_snapshot_encode_sections(sections, buffer);
+		result = Region_snapshot_write_bytes(file, commands, commands_size, offset) &&
+			(0 == fseek(file, static_cast<long>(region_snapshot_header_size), SEEK_SET)) &&
+			(1 == fwrite(&(buffer[0]), buffer.size(), 1, file));
+	}
+	for (size_t r = 0; r < number_of_regions; ++r)
+		cmzn_region_destroy(&(regions[r]));
+	if (0 != fclose(file))
+		result = false;
+	if (!result)
+	{
+		display_message(ERROR_MESSAGE, "Error writing snapshot file: %s", file_name);
+		remove(file_name);
+	}
+	return result ? 1 : 0;
+}
+
+int read_region_snapshot_file(cmzn_region_id root_region,
+	const char *file_name, std::string& commands, double *region_seconds_address)
+{
+	if (!(root_region && file_name))
+	{
+		display_message(ERROR_MESSAGE, "read_region_snapshot_file.  Invalid argument(s)");
+		return 0;
+	}
+	Mapped_file mapped_file;
+	if (!mapped_file.open(file_name))
+	{
+		display_message(ERROR_MESSAGE, "Could not open snapshot file: %s", file_name);
+		return 0;
+	}
+	const char *data = mapped_file.getData();
+	const unsigned long long file_size = mapped_file.getSize();
+	Region_snapshot_header header;
+	if ((!data) || (file_size < region_snapshot_header_size))
+	{
+		display_message(ERROR_MESSAGE, "%s is not a snapshot file", file_name);
+		return 0;
+	}
+	Region_snapshot_decode_header(data, header);
+	if (0 != memcmp(header.signature, region_snapshot_signature, sizeof(header.signature)))
+	{
+		display_message(ERROR_MESSAGE, "%s is not a snapshot file", file_name);
+		return 0;
+	}
+	if (header.version != region_snapshot_version)
+	{
+		display_message(ERROR_MESSAGE, "Snapshot file %s has unsupported version %u",
+			file_name, header.version);
+		return 0;
+	}
+	if (header.byte_order_check != region_snapshot_byte_order_check)
+	{
+		display_message(ERROR_MESSAGE,
+			"Snapshot file %s was written with a different byte order", file_name);
+		return 0;
+	}
+	const unsigned long long table_size =
+		static_cast<unsigned long long>(header.number_of_sections)*region_snapshot_section_size;
+	if (file_size - region_snapshot_header_size < table_size)
+	{
+		display_message(ERROR_MESSAGE, "Snapshot file %s is truncated", file_name);
+		return 0;
+	}
+	std::vector<Region_snapshot_section> sections(header.number_of_sections);
+	for (size_t s = 0; s < sections.size(); ++s)
+	{
+		Region_snapshot_decode_section(
+			data + region_snapshot_header_size + s*region_snapshot_section_size, sections[s]);
+	}
+	const double start_time = get_elapsed_time_seconds();
+	bool result = true;
+	commands.clear();
+	cmzn_region_begin_hierarchical_change(root_region);
+	for (size_t s = 0; (s < sections.size()) && result; ++s)
+	{
+		const Region_snapshot_section& section = sections[s];
+		if ((section.name_offset > file_size) || (section.name_size > file_size - section.name_offset) ||
+			(section.data_offset > file_size) || (section.data_size > file_size - section.data_offset))
+		{
+			display_message(ERROR_MESSAGE, "Snapshot file %s is truncated", file_name);
+			result = false;
+			break;
+		}
+		const std::string name(data + section.name_offset, section.name_size);
+		switch (section.type)
+		{
+		case REGION_SNAPSHOT_SECTION_REGION:
+		case REGION_SNAPSHOT_SECTION_REGION_EX:
+		{
+			if (!Region_snapshot_is_valid_region_path(name))
+			{
+				display_message(ERROR_MESSAGE, "Snapshot file %s:  Invalid region path '%s'",
+					file_name, name.c_str());
+				result = false;
+				break;
+			}
+			cmzn_region_id region = 0;
+			if (name.empty())
+			{
+				region = cmzn_region_access(root_region);
+			}
+			else
+			{
+				region = cmzn_region_find_subregion_at_path(root_region, name.c_str());
+				if (!region)
+					region = cmzn_region_create_subregion(root_region, name.c_str());
+			}
+			if (!region)
+			{
+				display_message(ERROR_MESSAGE, "Snapshot file:  Could not create region '%s'",
+					name.c_str());
+				result = false;
+				break;
+			}
+			if (REGION_SNAPSHOT_SECTION_REGION_EX == section.type)
+			{
+				result = Region_snapshot_read_ex(region, data + section.data_offset, section.data_size);
+				if (!result)
+				{
+					display_message(ERROR_MESSAGE, "Snapshot file %s:  Could not read region '%s'",
+						file_name, name.c_str());
+				}
+			}
+			else
+			{
+				const std::string source_name = std::string(file_name) + ":" + name;
+				result = (0 != read_region_binary_memory(region, data + section.data_offset,
+					static_cast<size_t>(section.data_size), source_name.c_str()));
+			}
+			cmzn_region_destroy(&region);
+		} break;
+		case REGION_SNAPSHOT_SECTION_COMMANDS:
+		{
+			commands.append(data + section.data_offset, static_cast<size_t>(section.data_size));
+		} break;
+		default:
+		{
+			/* skip sections from newer minor revisions */
+		} break;
+		}
+	}
+	cmzn_region_end_hierarchical_change(root_region);
+	if (region_seconds_address)
+		*region_seconds_address = get_elapsed_time_seconds() - start_time;
+	return result ? 1 : 0;
+}
@@ -0,0 +1,44 @@
+/***************************************************************************//**
+ * region_snapshot_app.h
+ *
+ * Snapshot file holding a whole region tree in binary region format together
+ * with the commands defining the rest of a session, for fast restore.
+ */
+/* OpenCMISS-Cmgui Application
+*
+* This Source Code Form is subject to the terms of the Mozilla Public
+* License, v. 2.0. If a copy of the MPL was not distributed with this
+* file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#if !defined (REGION_SNAPSHOT_APP_H)
+#define REGION_SNAPSHOT_APP_H
+
+#include <stddef.h>
+#include <string>
+#include "zinc/region.h"
+
+/** Recommended file name extension for snapshot files. */
+#define REGION_SNAPSHOT_FILE_EXTENSION ".cmsnapshot"
+
+/***************************************************************************//**
+ * Writes root_region and all its descendants, each in binary region format,
+ * followed by the commands text to a snapshot file. A table of section offsets
+ * follows the header so sections can be located without reading earlier ones.
+ * @param commands  Text of commands to execute after the regions are read.
+ * @param compress  If non-zero, compress region blocks if zlib is available.
+ * @return  1 on success, 0 on failure.
+ */
+int write_region_snapshot_file(cmzn_region_id root_region,
+	const char *commands, size_t commands_size, int compress,
+	const char *file_name);
+
+/***************************************************************************//**
+ * Reads the regions in a snapshot file into root_region, creating child
+ * regions as needed, and returns its commands text for the caller to execute.
+ * @param region_seconds_address  Optional; set to seconds spent reading regions.
+ * @return  1 on success, 0 on failure.
+ */
+int read_region_snapshot_file(cmzn_region_id root_region,
+	const char *file_name, std::string& commands, double *region_seconds_address);
+
+#endif /* !defined (REGION_SNAPSHOT_APP_H) */
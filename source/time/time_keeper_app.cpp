@@ -18,6 +18,7 @@ This is intended to be multithreaded......
 
 #include "zinc/timekeeper.h"
 #include "general/debug.h"
+#include "general/elapsed_time_app.h"
 #include "general/list_private.h"
 #include "general/mystring.h"
 #include "general/object.h"
@@ -29,6 +30,13 @@ This is intended to be multithreaded......
 #include "time/time_private.h"
 #include "user_interface/event_dispatcher.h"
 #include "general/enumerator_conversion.hpp"
+#include <map>
+
+/* Timer events firing later than this many seconds after they were due are
+	counted as late */
+#define TIME_KEEPER_APP_LATE_TOLERANCE (0.005)
+/* Limit on callback times counted as dropped in one catch-up step */
+#define TIME_KEEPER_APP_MAXIMUM_DROPPED_COUNT (10000)
 
 struct Time_keeper_app_callback_data
 {
@@ -57,14 +65,18 @@ Time_keeper_app::Time_keeper_app(cmzn_timekeeper *time_keeper_in,
 	step(0.1),
 	play_direction(CMZN_TIMEKEEPER_PLAY_DIRECTION_FORWARD),
 	play_every_frame(0),
-	play_start_seconds(0),
-	play_start_microseconds(0),
+	play_start_elapsed_seconds(0.0),
+	timeout_due_elapsed_seconds(0.0),
 	real_time(0),
 	playing(0),
 	timeout_callback_id(0),
 	event_dispatcher(event_dispatcher),
 	callback_list(0),
 	time_keeper(cmzn_timekeeper_access(time_keeper_in)),
+	schedule_direction(CMZN_TIMEKEEPER_PLAY_DIRECTION_FORWARD),
+	number_of_timer_events(0),
+	number_of_late_timer_events(0),
+	maximum_timer_lateness(0.0),
 	access_count(1)
 {
 }
@@ -173,7 +185,6 @@ void Time_keeper_app::setSpeed(double speed_in)
 int Time_keeper_app::playPrivate()
 {
 	int return_code = 0, looping = 0;
-	struct timeval timeofday;
 	double current_time = time_keeper->getTime();
 	double minimum = time_keeper->getMinimum(),
 		maximum = time_keeper->getMaximum();
@@ -207,9 +218,7 @@ int Time_keeper_app::playPrivate()
 			}
 		} break;
 		}
-		gettimeofday(&timeofday, (struct timezone *)NULL);
-		play_start_seconds = timeofday.tv_sec;
-		play_start_microseconds = timeofday.tv_usec;
+		play_start_elapsed_seconds = get_elapsed_time_seconds();
 		real_time = current_time;
 		time_keeper->setTimeQuiet(current_time);
 		struct Time_object_info *object_info = time_keeper->getObjectInfo();
@@ -229,6 +238,7 @@ int Time_keeper_app::playPrivate()
 				play_direction);
 			object_info = object_info->next;
 		}
+		rebuildSchedule();
 		notifyClients(TIME_KEEPER_APP_NEW_TIME);
 
 		return_code = setPlayTimeout();
@@ -379,25 +389,149 @@ void Time_keeper_app::setTimeStep(double time_step)
 	step = time_step;
 }
 
+/***************************************************************************//**
+ * Checks the schedule was built for the play direction and from the time
+ * keeper's current time objects. Zinc gives no notice when time objects are
+ * added or removed, and removing one frees its Time_object_info, so this is the
+ * one pass over the time keeper's list made per timer event: it compares
+ * pointers only, while the due time objects are taken from the schedule.
+ */
+bool Time_keeper_app::isScheduleCurrent()
+{
+	if (schedule_direction != play_direction)
+		return false;
+	size_t index = 0;
+	struct Time_object_info *object_info = time_keeper->getObjectInfo();
+	while (object_info)
+	{
+		if ((index >= scheduled_objects.size()) ||
+			(scheduled_objects[index].object_info != object_info))
+			return false;
+		++index;
+		object_info = object_info->next;
+	}
+	return (index == scheduled_objects.size());
+}
+
+/***************************************************************************//**
+ * Rebuilds the schedule from the time keeper's current time objects and their
+ * next_callback_due, keeping statistics for objects already scheduled.
+ */
+void Time_keeper_app::rebuildSchedule()
+{
+	std::map<struct Time_object_info *, Time_keeper_app_object_statistics> previous;
+	for (size_t i = 0; i < scheduled_objects.size(); ++i)
+		previous[scheduled_objects[i].object_info] = scheduled_objects[i];
+	scheduled_objects.clear();
+	schedule_queue.clear();
+	schedule_direction = play_direction;
+	struct Time_object_info *object_info = time_keeper->getObjectInfo();
+	while (object_info)
+	{
+		std::map<struct Time_object_info *, Time_keeper_app_object_statistics>::iterator
+			iter = previous.find(object_info);
+		if (iter != previous.end())
+		{
+			scheduled_objects.push_back(iter->second);
+		}
+		else
+		{
+			Time_keeper_app_object_statistics statistics;
+			statistics.object_info = object_info;
+			statistics.number_of_callbacks = 0;
+			statistics.total_callback_seconds = 0.0;
+			statistics.maximum_callback_seconds = 0.0;
+			statistics.number_of_dropped_callbacks = 0;
+			scheduled_objects.push_back(statistics);
+		}
+		pushSchedule(static_cast<int>(scheduled_objects.size()) - 1);
+		object_info = object_info->next;
+	}
+}
+
+/** @return  true if scheduled object index1 is due before index2 in the
+ * direction of play. */
+bool Time_keeper_app::isScheduledBefore(int index1, int index2) const
+{
+	const double due1 = scheduled_objects[index1].object_info->next_callback_due;
+	const double due2 = scheduled_objects[index2].object_info->next_callback_due;
+	if (schedule_direction == CMZN_TIMEKEEPER_PLAY_DIRECTION_REVERSE)
+		return (due1 > due2);
+	return (due1 < due2);
+}
+
+void Time_keeper_app::pushSchedule(int index)
+{
+	size_t position = schedule_queue.size();
+	schedule_queue.push_back(index);
+	while (0 < position)
+	{
+		const size_t parent = (position - 1)/2;
+		if (!isScheduledBefore(schedule_queue[position], schedule_queue[parent]))
+			break;
+		int tmp = schedule_queue[parent];
+		schedule_queue[parent] = schedule_queue[position];
+		schedule_queue[position] = tmp;
+		position = parent;
+	}
+}
+
+/** Removes and returns the index of the next scheduled object. */
+int Time_keeper_app::popSchedule()
+{
+	const int index = schedule_queue.front();
+	schedule_queue.front() = schedule_queue.back();
+	schedule_queue.pop_back();
+	const size_t size = schedule_queue.size();
+	size_t position = 0;
+	while (true)
+	{
+		size_t first = position;
+		const size_t left = 2*position + 1;
+		const size_t right = left + 1;
+		if ((left < size) && isScheduledBefore(schedule_queue[left], schedule_queue[first]))
+			first = left;
+		if ((right < size) && isScheduledBefore(schedule_queue[right], schedule_queue[first]))
+			first = right;
+		if (first == position)
+			break;
+		int tmp = schedule_queue[first];
+		schedule_queue[first] = schedule_queue[position];
+		schedule_queue[position] = tmp;
+		position = first;
+	}
+	return index;
+}
+
+/** @return  Index of the next scheduled object without removing it. */
+int Time_keeper_app::getNextScheduled() const
+{
+	return schedule_queue.front();
+}
+
 int Time_keeper_app::timerEvent()
 {
 	double event_time = 0.0, real_time_elapsed, closest_object_time, event_interval;
 	int first_event_time, return_code;
-	struct Time_object_info *object_info;
-	struct timeval timeofday;
-	double current_time = 0.0;
 
 	if(timeout_callback_id)
 	{
 		timeout_callback_id = (struct Event_dispatcher_timeout_callback *)NULL;
 		first_event_time = 1;
 
-		gettimeofday(&timeofday, (struct timezone *)NULL);
-		real_time_elapsed = (double)(timeofday.tv_sec -
-			play_start_seconds) + ((double)(timeofday.tv_usec - play_start_microseconds) / 1000000.0);
-		real_time_elapsed *= speed;
-		play_start_seconds = timeofday.tv_sec;
-		play_start_microseconds = timeofday.tv_usec;
+		const double now = get_elapsed_time_seconds();
+		const double lateness = now - timeout_due_elapsed_seconds;
+		++number_of_timer_events;
+		if (lateness > TIME_KEEPER_APP_LATE_TOLERANCE)
+		{
+			++number_of_late_timer_events;
+		}
+		if (lateness > maximum_timer_lateness)
+		{
+			maximum_timer_lateness = lateness;
+		}
+		real_time_elapsed = (now - play_start_elapsed_seconds)*speed;
+		play_start_elapsed_seconds = now;
 		/* Set an interval from within which we will do every event pending event.
 				When we are playing every frame we want this to be much smaller */
 		if (play_every_frame)
@@ -408,133 +542,112 @@ int Time_keeper_app::timerEvent()
 		{
 			event_interval = 0.01 * speed;
 		}
-		switch(play_direction)
+		const bool forward = (play_direction != CMZN_TIMEKEEPER_PLAY_DIRECTION_REVERSE);
+		const enum cmzn_timekeeper_play_direction opposite_direction = (forward) ?
+			CMZN_TIMEKEEPER_PLAY_DIRECTION_REVERSE : CMZN_TIMEKEEPER_PLAY_DIRECTION_FORWARD;
+		if (play_every_frame)
 		{
-		case CMZN_TIMEKEEPER_PLAY_DIRECTION_FORWARD:
+			real_time += (forward) ? step : -step;
+		}
+		else
 		{
-			if(play_every_frame)
-			{
-				real_time += step;
-			}
-			else
+			real_time += (forward) ? real_time_elapsed : -real_time_elapsed;
+		}
+		/* Record the time_keeper->time so that if a callback changes it
+			then we do a full restart */
+		time_keeper->setTimeQuiet(real_time);
+		const double limit_time = (forward) ? time_keeper->getMaximum() : time_keeper->getMinimum();
+		/* Do all the events in the next event interval, taking them from the
+			front of the schedule rather than scanning all time objects */
+		const double interval_end = (forward) ? (real_time + event_interval) : (real_time - event_interval);
+		if (!isScheduleCurrent())
+		{
+			rebuildSchedule();
+		}
+		std::vector<int> due_objects;
+		while (!schedule_queue.empty())
+		{
+			Time_keeper_app_object_statistics& scheduled = scheduled_objects[getNextScheduled()];
+			struct Time_object_info *object_info = scheduled.object_info;
+			if ((forward) ? (object_info->next_callback_due >= interval_end) :
+				(object_info->next_callback_due <= interval_end))
 			{
-				real_time += real_time_elapsed;
+				break;
 			}
-			/* Record the time_keeper->time so that if a callback changes it
-						then we do a full restart */
-			time_keeper->setTimeQuiet(real_time);
-			object_info = time_keeper->getObjectInfo();
-			while(object_info)
+			due_objects.push_back(popSchedule());
+			if(!play_every_frame)
 			{
-				/* Do all the events in the next event interval */
-				if(object_info->next_callback_due < real_time + event_interval)
+				/* Then look for the event that should have occurred most
+					recently, counting the callback times skipped to reach it */
+				closest_object_time =
+					cmzn_timenotifier_get_next_callback_time_private(
+						object_info->time_object, interval_end, opposite_direction);
+				if ((forward) ? (closest_object_time >= object_info->next_callback_due) :
+					(closest_object_time <= object_info->next_callback_due))
 				{
-					if(!play_every_frame)
+					double skipped_time = object_info->next_callback_due;
+					int number_dropped = 0;
+					while ((number_dropped < TIME_KEEPER_APP_MAXIMUM_DROPPED_COUNT) &&
+						((forward) ? (skipped_time < closest_object_time) : (skipped_time > closest_object_time)))
 					{
-						/* Then look for the event that should have occurred most
-									recently */
-						closest_object_time =
-							cmzn_timenotifier_get_next_callback_time_private(
-								object_info->time_object, real_time + event_interval,
-								CMZN_TIMEKEEPER_PLAY_DIRECTION_REVERSE);
-						if(closest_object_time >= object_info->next_callback_due)
+						const double next_skipped_time = cmzn_timenotifier_get_next_callback_time_private(
+							object_info->time_object, skipped_time, play_direction);
+						if (next_skipped_time == skipped_time)
 						{
-							object_info->next_callback_due = closest_object_time;
+							break;
 						}
+						skipped_time = next_skipped_time;
+						++number_dropped;
 					}
-					if(first_event_time || object_info->next_callback_due > event_time)
-					{
-						first_event_time = 0;
-						event_time = object_info->next_callback_due;
-					}
-					if (object_info->next_callback_due < time_keeper->getMaximum())
-					{
-						Time_object_set_current_time_privileged(object_info->time_object,
-							object_info->next_callback_due);
-						Time_object_notify_clients_privileged(object_info->time_object);
-					}
-					object_info->next_callback_due = cmzn_timenotifier_get_next_callback_time_private(
-						object_info->time_object, real_time + event_interval,
-						CMZN_TIMEKEEPER_PLAY_DIRECTION_FORWARD);
-				}
-				else if (play_remaining && (real_time + event_interval)>time_keeper->getMaximum())
-				{
-					/* when playing the remaining time, the difference between
-								 next_callback_due and current time is normally large then the event interval,
-								 so the actual event time needs to be set to maximum here */
-					event_time = time_keeper->getMaximum();
-					play_remaining = 0;
+					scheduled.number_of_dropped_callbacks += number_dropped;
+					object_info->next_callback_due = closest_object_time;
 				}
-				object_info = object_info->next;
 			}
-			if (real_time >= time_keeper->getMaximum())
+			if (first_event_time || ((forward) ? (object_info->next_callback_due > event_time) :
+				(object_info->next_callback_due < event_time)))
 			{
-				play_remaining = 0;
+				first_event_time = 0;
+				event_time = object_info->next_callback_due;
 			}
-		} break;
-		case CMZN_TIMEKEEPER_PLAY_DIRECTION_REVERSE:
-		{
-			if(play_every_frame)
+			if ((forward) ? (object_info->next_callback_due < limit_time) :
+				(object_info->next_callback_due >= limit_time))
 			{
-				real_time -= step;
-			}
-			else
-			{
-				real_time -= real_time_elapsed;
-			}
-			/* Record the time_keeper->time so that if a callback changes it
-						then we do a full restart */
-			time_keeper->setTimeQuiet(real_time);
-
-			object_info = time_keeper->getObjectInfo();
-			while(object_info)
-			{
-				/* Do all the events in the next 10 milliseconds */
-				if(object_info->next_callback_due > real_time - event_interval)
-				{
-					if(!play_every_frame)
-					{
-						/* Then look for the event that should have occurred most
-									recently */
-						closest_object_time =
-							cmzn_timenotifier_get_next_callback_time_private(
-								object_info->time_object, real_time - event_interval,
-								CMZN_TIMEKEEPER_PLAY_DIRECTION_FORWARD);
-						if(closest_object_time <= object_info->next_callback_due)
-						{
-							object_info->next_callback_due = closest_object_time;
-						}
-					}
-					if(first_event_time || object_info->next_callback_due < event_time)
-					{
-						first_event_time = 0;
-						event_time = object_info->next_callback_due;
-					}
-					if (object_info->next_callback_due >= time_keeper->getMinimum())
-					{
-						Time_object_set_current_time_privileged(object_info->time_object,
-							object_info->next_callback_due);
-						Time_object_notify_clients_privileged(object_info->time_object);
-					}
-					object_info->next_callback_due = cmzn_timenotifier_get_next_callback_time_private(
-						object_info->time_object, real_time - event_interval,
-						CMZN_TIMEKEEPER_PLAY_DIRECTION_REVERSE);
-				}
-				else if (play_remaining && (real_time - event_interval)<time_keeper->getMinimum())
+				Time_object_set_current_time_privileged(object_info->time_object,
+					object_info->next_callback_due);
+				const double callback_start = get_elapsed_time_seconds();
+				Time_object_notify_clients_privileged(object_info->time_object);
+				const double callback_seconds = get_elapsed_time_seconds() - callback_start;
+				++scheduled.number_of_callbacks;
+				scheduled.total_callback_seconds += callback_seconds;
+				if (callback_seconds > scheduled.maximum_callback_seconds)
 				{
-					/* when playing the remaining time, the difference between
-								 next_callback_due and current time is normally large then the event interval,
-								 so the actual event time needs to be set to minimum here */
-					event_time = time_keeper->getMinimum();
-					play_remaining = 0;
+					scheduled.maximum_callback_seconds = callback_seconds;
 				}
-				object_info = object_info->next;
 			}
-			if (real_time <= time_keeper->getMinimum())
-			{
-				play_remaining = 0;
-			}
-		} break;
+			object_info->next_callback_due = cmzn_timenotifier_get_next_callback_time_private(
+				object_info->time_object, interval_end, play_direction);
+		}
+		/* The time objects left in the queue are exactly those not due in the
+			interval, which the previous scan tested one at a time. The limit is
+			therefore applied once after the due callbacks rather than in the
+			middle of them, so it now takes precedence over any due time object
+			whose callback time lies beyond the limit. */
+		if (play_remaining && (!schedule_queue.empty()) &&
+			((forward) ? (interval_end > limit_time) : (interval_end < limit_time)))
+		{
+			/* when playing the remaining time, the difference between
+				next_callback_due and current time is normally large then the event interval,
+				so the actual event time needs to be set to the limit here */
+			event_time = limit_time;
+			play_remaining = 0;
+		}
+		for (size_t i = 0; i < due_objects.size(); ++i)
+		{
+			pushSchedule(due_objects[i]);
+		}
+		if ((forward) ? (real_time >= limit_time) : (real_time <= limit_time))
+		{
+			play_remaining = 0;
 		}
 
 		if(time_keeper->getTime() == real_time)
@@ -599,7 +712,6 @@ int Time_keeper_app::setPlayTimeout()
 	double next_time, real_time_elapsed, sleep;
 	int return_code;
 	struct Time_object_info *object_info;
-	struct timeval timeofday;
 	unsigned long sleep_s, sleep_ns;
 	double maximum = time_keeper->getMaximum(),
 		minimum = time_keeper->getMinimum(),
@@ -610,21 +722,17 @@ int Time_keeper_app::setPlayTimeout()
 		object_info = time_keeper->getObjectInfo();
 		if(object_info)
 		{
+			/* next time is at the front of the schedule, which playPrivate builds
+				and timerEvent checks before calling this */
+			if (schedule_direction != play_direction)
+			{
+				rebuildSchedule();
+			}
+			next_time = scheduled_objects[getNextScheduled()].object_info->next_callback_due;
 			switch(play_direction)
 			{
 			case CMZN_TIMEKEEPER_PLAY_DIRECTION_FORWARD:
 			{
-				next_time = object_info->next_callback_due;
-				object_info = object_info->next;
-				while(object_info)
-				{
-					if(object_info->next_callback_due < next_time )
-					{
-						next_time = object_info->next_callback_due;
-					}
-					object_info = object_info->next;
-				}
-
 				if ((next_time > maximum) &&
 					(current_time < maximum))
 				{
@@ -672,10 +780,8 @@ int Time_keeper_app::setPlayTimeout()
 					{
 						double time_difference = next_time - real_time;
 
-						gettimeofday(&timeofday, (struct timezone *)NULL);
-						real_time_elapsed = (double)(timeofday.tv_sec -
-							play_start_seconds) + ((double)(timeofday.tv_usec
-								- play_start_microseconds) / 1000000.0);
+						const double now = get_elapsed_time_seconds();
+						real_time_elapsed = now - play_start_elapsed_seconds;
 						sleep = time_difference / speed - real_time_elapsed;
 						if (sleep > 0)
 						{
@@ -693,6 +799,7 @@ int Time_keeper_app::setPlayTimeout()
 										processed before the events from this next callback occur */
 							sleep_ns = 3000000;
 						}
+						timeout_due_elapsed_seconds = now + (double)sleep_s + (double)sleep_ns*1.0e-9;
 						timeout_callback_id = Event_dispatcher_add_timeout_callback(event_dispatcher, (unsigned long)sleep_s, sleep_ns,
 							Time_keeper_app_timer_event_handler, (void *)this);
 						return_code=1;
@@ -707,16 +814,6 @@ int Time_keeper_app::setPlayTimeout()
 			} break;
 			case CMZN_TIMEKEEPER_PLAY_DIRECTION_REVERSE:
 			{
-				next_time = object_info->next_callback_due;
-				object_info = object_info->next;
-				while(object_info)
-				{
-					if(object_info->next_callback_due > next_time )
-					{
-						next_time = object_info->next_callback_due;
-					}
-					object_info = object_info->next;
-				}
 				if ((next_time < minimum) && (current_time > minimum))
 				{
 					next_time = minimum;
@@ -764,10 +861,8 @@ int Time_keeper_app::setPlayTimeout()
 					{
 						double time_difference = real_time - next_time;
 
-						gettimeofday(&timeofday, (struct timezone *)NULL);
-						real_time_elapsed = (double)(timeofday.tv_sec -
-							play_start_seconds) + ((double)(timeofday.tv_usec
-								- play_start_microseconds) / 1000000.0);
+						const double now = get_elapsed_time_seconds();
+						real_time_elapsed = now - play_start_elapsed_seconds;
 						sleep = time_difference / speed - real_time_elapsed;
 						if (sleep > 0)
 						{
@@ -785,6 +880,7 @@ int Time_keeper_app::setPlayTimeout()
 										processed before the events from this next callback occur */
 							sleep_ns = 3000000;
 						}
+						timeout_due_elapsed_seconds = now + (double)sleep_s + (double)sleep_ns*1.0e-9;
 						timeout_callback_id = Event_dispatcher_add_timeout_callback(
 							event_dispatcher, sleep_s, sleep_ns,
 							Time_keeper_app_timer_event_handler, (void *)this);
@@ -824,6 +920,29 @@ int Time_keeper_app::setPlayTimeout()
 	return (return_code);
 }
 
+void Time_keeper_app::listStatistics()
+{
+	if (!isScheduleCurrent())
+	{
+		rebuildSchedule();
+	}
+	display_message(INFORMATION_MESSAGE,
+		"Playback: %d timer events, %d late by more than %g ms, maximum lateness %.3f ms\n",
+		number_of_timer_events, number_of_late_timer_events,
+		TIME_KEEPER_APP_LATE_TOLERANCE*1000.0, maximum_timer_lateness*1000.0);
+	for (size_t i = 0; i < scheduled_objects.size(); ++i)
+	{
+		const Time_keeper_app_object_statistics& statistics = scheduled_objects[i];
+		display_message(INFORMATION_MESSAGE,
+			"  time object %d: %d callbacks, %d dropped, mean %.3f ms, maximum %.3f ms\n",
+			static_cast<int>(i + 1), statistics.number_of_callbacks,
+			statistics.number_of_dropped_callbacks,
+			(statistics.number_of_callbacks) ?
+				(statistics.total_callback_seconds*1000.0/statistics.number_of_callbacks) : 0.0,
+			statistics.maximum_callback_seconds*1000.0);
+	}
+}
+
 int DESTROY(Time_keeper_app)(struct Time_keeper_app **time_keeper_app_address)
 {
 	int return_code = 0;
@@ -14,11 +14,26 @@
 
 #include "time/time_keeper.hpp"
 #include <ctime>
+#include <vector>
 
 PROTOTYPE_OBJECT_FUNCTIONS(Time_keeper_app);
 
 struct Time_keeper_app_callback_data;
 
+/***************************************************************************//**
+ * Playback instrumentation for a time object scheduled by a Time_keeper_app.
+ */
+struct Time_keeper_app_object_statistics
+{
+	struct Time_object_info *object_info;
+	/* number of callbacks made and their total and maximum cost in seconds */
+	int number_of_callbacks;
+	double total_callback_seconds;
+	double maximum_callback_seconds;
+	/* callback times skipped to catch up when not playing every frame */
+	int number_of_dropped_callbacks;
+};
+
 enum Time_keeper_app_event
 {
 	/* These constants are bit masked and so should be powers of two */
@@ -51,17 +66,40 @@ private:
 	double step;
 	enum cmzn_timekeeper_play_direction play_direction;
 	int play_every_frame;
-	time_t play_start_seconds;
-	long play_start_microseconds;
+	/* monotonic clock reading at the last timer event or start of play */
+	double play_start_elapsed_seconds;
+	/* monotonic clock reading the pending timer event is due */
+	double timeout_due_elapsed_seconds;
 	double real_time;
 	int playing;
 	struct Event_dispatcher_timeout_callback *timeout_callback_id;
 	struct Event_dispatcher *event_dispatcher;
 	struct Time_keeper_app_callback_data *callback_list;
 	cmzn_timekeeper *time_keeper;
+	/* time objects in the order of the time keeper's list, with statistics */
+	std::vector<Time_keeper_app_object_statistics> scheduled_objects;
+	/* lookahead queue of indices into scheduled_objects, a heap ordered so the
+		next callback due in the play direction is at the front */
+	std::vector<int> schedule_queue;
+	enum cmzn_timekeeper_play_direction schedule_direction;
+	int number_of_timer_events;
+	int number_of_late_timer_events;
+	double maximum_timer_lateness;
 
 	int notifyClients(enum Time_keeper_app_event event_mask);
 
+	bool isScheduleCurrent();
+
+	void rebuildSchedule();
+
+	bool isScheduledBefore(int index1, int index2) const;
+
+	void pushSchedule(int index);
+
+	int popSchedule();
+
+	int getNextScheduled() const;
+
 public:
 
 	int access_count;
@@ -126,6 +164,9 @@ public:
 	void setPlaySkipFrames();
 
 	int setPlayTimeout();
+
+	/** Writes timer lateness and per time object callback statistics. */
+	void listStatistics();
 };
 
 #endif
@@ -24,6 +24,15 @@ This provides an object which interfaces between a event_dispatcher and Cmgui
 #include "general/object.h"
 #include "general/message.h"
 #include "user_interface/event_dispatcher.h"
+#if defined (USE_GENERIC_EVENT_DISPATCHER) && defined (__linux__)
+/* On Linux Fdio descriptors are registered persistently with epoll instead of
+	being queried into descriptor sets for select on every event */
+#define USE_EPOLL_EVENT_DISPATCHER
+#include <errno.h>
+#include <limits.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif /* defined (USE_GENERIC_EVENT_DISPATCHER) && defined (__linux__) */
 
 /* After the event_dispatcher.h has set up these variables */
 #if defined (USE_XTAPP_CONTEXT) /* switch (USER_INTERFACE) */
@@ -32,6 +41,19 @@ This provides an object which interfaces between a event_dispatcher and Cmgui
 #include <wx/wx.h>
 #include <wx/apptrait.h>
 #include "user_interface/user_interface.h"
+#if defined (UNIX)
+#if wxCHECK_VERSION(3,0,0) && wxUSE_EVENTLOOP_SOURCE
+/* Fdio descriptors are watched by the wx event loop as event sources */
+#define USE_WX_FDIO_SOURCE
+#include <wx/evtloopsrc.h>
+#else /* wxCHECK_VERSION(3,0,0) && wxUSE_EVENTLOOP_SOURCE */
+/* older wx does not watch arbitrary descriptors, so Fdios are polled */
+#define USE_WX_FDIO_POLLING
+#include <poll.h>
+/* milliseconds between polls of each Fdio with a callback set */
+#define EVENT_DISPATCHER_WX_FDIO_POLL_MILLISECONDS 20
+#endif /* wxCHECK_VERSION(3,0,0) && wxUSE_EVENTLOOP_SOURCE */
+#endif /* defined (UNIX) */
 #elif defined (WIN32_USER_INTERFACE) /* switch (USER_INTERFACE) */
 //#define WINDOWS_LEAN_AND_MEAN
 #define NOMINMAX
@@ -49,6 +71,15 @@ Module types
 */
 
 class wxEventTimer;
+class wxFdioWatcher;
+
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+/* Maximum number of ready descriptors collected from each epoll_wait */
+#define EVENT_DISPATCHER_EPOLL_MAX_EVENTS (64)
+/* Longest select wait when the epoll descriptor is too large for select and
+	must be polled between waits instead */
+#define EVENT_DISPATCHER_EPOLL_POLL_MICROSECONDS (10000)
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
 
 #if defined (USE_GENERIC_EVENT_DISPATCHER)
 struct Event_dispatcher_descriptor_callback
@@ -92,6 +123,10 @@ Contains all information necessary for a file descriptor callback.
 	unsigned long timeout_ns;
 	Event_dispatcher_timeout_function *timeout_function;
 	void *user_data;
+#if defined (USE_GENERIC_EVENT_DISPATCHER)
+	/* position in event_dispatcher timeout_heap, or -1 if not in it */
+	int heap_index;
+#endif /* defined (USE_GENERIC_EVENT_DISPATCHER) */
 #if defined (USE_XTAPP_CONTEXT)
 	XtIntervalId xt_timeout_id;
 #endif /* defined (USE_XTAPP_CONTEXT) */
@@ -156,7 +191,21 @@ DESCRIPTION :
 #else
 	struct LIST(Event_dispatcher_descriptor_callback) *descriptor_list;
 #endif
+#if defined (USE_XTAPP_CONTEXT)
 	struct LIST(Event_dispatcher_timeout_callback) *timeout_list;
+#endif /* defined (USE_XTAPP_CONTEXT) */
+#if defined (USE_GENERIC_EVENT_DISPATCHER)
+	/* binary min-heap of accessed timeout callbacks ordered by due time */
+	struct Event_dispatcher_timeout_callback **timeout_heap;
+	int timeout_heap_size, timeout_heap_allocated_size;
+#endif /* defined (USE_GENERIC_EVENT_DISPATCHER) */
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+	int epoll_descriptor;
+	/* Fdios reported ready by the last epoll_wait, dispatched one per event;
+		entries are cleared if the Fdio is destroyed before dispatch */
+	struct Fdio *ready_fdios[EVENT_DISPATCHER_EPOLL_MAX_EVENTS];
+	int number_of_ready_fdios, next_ready_fdio;
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
 	struct LIST(Event_dispatcher_idle_callback) *idle_list;
 #if defined (USE_XTAPP_CONTEXT)
 /* This implements nearly the same interface as the normal implementation
@@ -203,8 +252,15 @@ read from or written to.
 	int is_reentrant, signal_to_destroy;
 	struct Event_dispatcher_descriptor_callback *callback;
 	int ready_to_read, ready_to_write;
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+	/* events the descriptor is currently registered for with epoll, 0 if none */
+	unsigned int epoll_events;
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
 #elif defined(WIN32_USER_INTERFACE)
 	int wantevents;
+#elif defined(USE_WX_FDIO_SOURCE) || defined(USE_WX_FDIO_POLLING)
+	int is_reentrant, signal_to_destroy;
+	wxFdioWatcher *wx_watcher;
 #elif defined(USE_GTK_MAIN_STEP)
 	GIOChannel* iochannel;
 	guint read_source_tag, write_source_tag;
@@ -559,6 +615,9 @@ Create a single object that belongs to a specific file descriptor.
 		timeout_callback->timeout_ns = timeout_ns;
 		timeout_callback->timeout_function = timeout_function;
 		timeout_callback->user_data = user_data;
+#if defined (USE_GENERIC_EVENT_DISPATCHER)
+		timeout_callback->heap_index = -1;
+#endif /* defined (USE_GENERIC_EVENT_DISPATCHER) */
 #if defined (USE_XTAPP_CONTEXT)
 		timeout_callback->xt_timeout_id = (XtIntervalId)NULL;
 #endif /* defined (USE_XTAPP_CONTEXT) */
@@ -681,6 +740,138 @@ DECLARE_INDEXED_LIST_FUNCTIONS(Event_dispatcher_timeout_callback)
 DECLARE_FIND_BY_IDENTIFIER_IN_INDEXED_LIST_FUNCTION(Event_dispatcher_timeout_callback, \
 	self,struct Event_dispatcher_timeout_callback *,Event_dispatcher_timeout_callback_compare)
 
+#if defined (USE_GENERIC_EVENT_DISPATCHER)
+static void Event_dispatcher_timeout_heap_set(
+	struct Event_dispatcher *event_dispatcher, int heap_index,
+	struct Event_dispatcher_timeout_callback *timeout_callback)
+{
+	event_dispatcher->timeout_heap[heap_index] = timeout_callback;
+	timeout_callback->heap_index = heap_index;
+}
+
+static void Event_dispatcher_timeout_heap_sift_up(
+	struct Event_dispatcher *event_dispatcher, int heap_index)
+/*******************************************************************************
+Moves the timeout callback at <heap_index> towards the root until its parent
+is due no later than it.
+==============================================================================*/
+{
+	struct Event_dispatcher_timeout_callback *timeout_callback =
+		event_dispatcher->timeout_heap[heap_index];
+	while (0 < heap_index)
+	{
+		int parent_index = (heap_index - 1)/2;
+		struct Event_dispatcher_timeout_callback *parent =
+			event_dispatcher->timeout_heap[parent_index];
+		if (Event_dispatcher_timeout_callback_compare(parent, timeout_callback) <= 0)
+		{
+			break;
+		}
+		Event_dispatcher_timeout_heap_set(event_dispatcher, heap_index, parent);
+		heap_index = parent_index;
+	}
+	Event_dispatcher_timeout_heap_set(event_dispatcher, heap_index, timeout_callback);
+}
+
+static void Event_dispatcher_timeout_heap_sift_down(
+	struct Event_dispatcher *event_dispatcher, int heap_index)
+/*******************************************************************************
+Moves the timeout callback at <heap_index> away from the root until both its
+children are due no earlier than it.
+==============================================================================*/
+{
+	struct Event_dispatcher_timeout_callback *timeout_callback =
+		event_dispatcher->timeout_heap[heap_index];
+	const int heap_size = event_dispatcher->timeout_heap_size;
+	while (true)
+	{
+		int child_index = 2*heap_index + 1;
+		if (child_index >= heap_size)
+		{
+			break;
+		}
+		if ((child_index + 1 < heap_size) && (0 > Event_dispatcher_timeout_callback_compare(
+			event_dispatcher->timeout_heap[child_index + 1],
+			event_dispatcher->timeout_heap[child_index])))
+		{
+			++child_index;
+		}
+		struct Event_dispatcher_timeout_callback *child =
+			event_dispatcher->timeout_heap[child_index];
+		if (Event_dispatcher_timeout_callback_compare(timeout_callback, child) <= 0)
+		{
+			break;
+		}
+		Event_dispatcher_timeout_heap_set(event_dispatcher, heap_index, child);
+		heap_index = child_index;
+	}
+	Event_dispatcher_timeout_heap_set(event_dispatcher, heap_index, timeout_callback);
+}
+
+static int Event_dispatcher_timeout_heap_add(
+	struct Event_dispatcher *event_dispatcher,
+	struct Event_dispatcher_timeout_callback *timeout_callback)
+/*******************************************************************************
+Adds and accesses <timeout_callback> in the timeout heap of <event_dispatcher>.
+==============================================================================*/
+{
+	struct Event_dispatcher_timeout_callback **temp_timeout_heap;
+
+	if (event_dispatcher->timeout_heap_size == event_dispatcher->timeout_heap_allocated_size)
+	{
+		const int allocated_size = (0 < event_dispatcher->timeout_heap_allocated_size) ?
+			2*event_dispatcher->timeout_heap_allocated_size : 16;
+		if (!REALLOCATE(temp_timeout_heap, event_dispatcher->timeout_heap,
+			struct Event_dispatcher_timeout_callback *, allocated_size))
+		{
+			display_message(ERROR_MESSAGE,
+				"Event_dispatcher_timeout_heap_add.  Could not enlarge timeout heap.");
+			return 0;
+		}
+		event_dispatcher->timeout_heap = temp_timeout_heap;
+		event_dispatcher->timeout_heap_allocated_size = allocated_size;
+	}
+	ACCESS(Event_dispatcher_timeout_callback)(timeout_callback);
+	const int heap_index = event_dispatcher->timeout_heap_size;
+	++(event_dispatcher->timeout_heap_size);
+	Event_dispatcher_timeout_heap_set(event_dispatcher, heap_index, timeout_callback);
+	Event_dispatcher_timeout_heap_sift_up(event_dispatcher, heap_index);
+	return 1;
+}
+
+static int Event_dispatcher_timeout_heap_remove(
+	struct Event_dispatcher *event_dispatcher,
+	struct Event_dispatcher_timeout_callback *timeout_callback)
+/*******************************************************************************
+Removes <timeout_callback> from the timeout heap of <event_dispatcher> and
+deaccesses it.
+@return  1 if removed, 0 if not in the heap.
+==============================================================================*/
+{
+	const int heap_index = timeout_callback->heap_index;
+	if ((heap_index < 0) || (heap_index >= event_dispatcher->timeout_heap_size) ||
+		(event_dispatcher->timeout_heap[heap_index] != timeout_callback))
+	{
+		return 0;
+	}
+	--(event_dispatcher->timeout_heap_size);
+	if (heap_index < event_dispatcher->timeout_heap_size)
+	{
+		/* fill the gap with the last callback and restore heap order */
+		struct Event_dispatcher_timeout_callback *last_timeout_callback =
+			event_dispatcher->timeout_heap[event_dispatcher->timeout_heap_size];
+		Event_dispatcher_timeout_heap_set(event_dispatcher, heap_index,
+			last_timeout_callback);
+		Event_dispatcher_timeout_heap_sift_down(event_dispatcher, heap_index);
+		Event_dispatcher_timeout_heap_sift_up(event_dispatcher,
+			last_timeout_callback->heap_index);
+	}
+	timeout_callback->heap_index = -1;
+	DEACCESS(Event_dispatcher_timeout_callback)(&timeout_callback);
+	return 1;
+}
+#endif /* defined (USE_GENERIC_EVENT_DISPATCHER) */
+
 static struct Event_dispatcher_idle_callback *CREATE(Event_dispatcher_idle_callback)(
 	Event_dispatcher_idle_function idle_function, void *user_data,
 	enum Event_dispatcher_idle_priority priority)
@@ -1136,9 +1327,24 @@ Creates a connection to a event_dispatcher of the specified type.
 #if defined (USE_GENERIC_EVENT_DISPATCHER)
 		event_dispatcher->descriptor_list =
 			CREATE(LIST(Event_dispatcher_descriptor_callback))();
+		event_dispatcher->timeout_heap = (struct Event_dispatcher_timeout_callback **)NULL;
+		event_dispatcher->timeout_heap_size = 0;
+		event_dispatcher->timeout_heap_allocated_size = 0;
 #endif /* defined (USE_GENERIC_EVENT_DISPATCHER) */
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+		event_dispatcher->epoll_descriptor = epoll_create1(EPOLL_CLOEXEC);
+		if (-1 == event_dispatcher->epoll_descriptor)
+		{
+			display_message(ERROR_MESSAGE, "CREATE(Event_dispatcher).  "
+				"Unable to create epoll descriptor; Fdio callbacks are unavailable.");
+		}
+		event_dispatcher->number_of_ready_fdios = 0;
+		event_dispatcher->next_ready_fdio = 0;
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
+#if defined (USE_XTAPP_CONTEXT)
 		event_dispatcher->timeout_list =
 			CREATE(LIST(Event_dispatcher_timeout_callback))();
+#endif /* defined (USE_XTAPP_CONTEXT) */
 		event_dispatcher->idle_list =
 			CREATE(LIST(Event_dispatcher_idle_callback))();
 #if defined (USE_XTAPP_CONTEXT)
@@ -1193,12 +1399,29 @@ Destroys a Event_dispatcher object
 			DESTROY(LIST(Event_dispatcher_descriptor_callback))
 				(&event_dispatcher->descriptor_list);
 		}
+		while (0 < event_dispatcher->timeout_heap_size)
+		{
+			Event_dispatcher_timeout_heap_remove(event_dispatcher,
+				event_dispatcher->timeout_heap[event_dispatcher->timeout_heap_size - 1]);
+		}
+		if (event_dispatcher->timeout_heap)
+		{
+			DEALLOCATE(event_dispatcher->timeout_heap);
+		}
 #endif /* defined (USE_GENERIC_EVENT_DISPATCHER) */
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+		if (-1 != event_dispatcher->epoll_descriptor)
+		{
+			close(event_dispatcher->epoll_descriptor);
+		}
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
+#if defined (USE_XTAPP_CONTEXT)
 		if (event_dispatcher->timeout_list)
 		{
 			DESTROY(LIST(Event_dispatcher_timeout_callback))
 				(&event_dispatcher->timeout_list);
 		}
+#endif /* defined (USE_XTAPP_CONTEXT) */
 		if (event_dispatcher->idle_list)
 		{
 			DESTROY(LIST(Event_dispatcher_idle_callback))
@@ -1731,12 +1954,14 @@ DESCRIPTION :
 
 	if (event_dispatcher && timeout_function)
 	{
+		/* normalise so due times compare correctly in the timeout heap */
+		timeout_s += timeout_ns/1000000000;
+		timeout_ns %= 1000000000;
 		timeout_callback = CREATE(Event_dispatcher_timeout_callback)(
 					timeout_s, timeout_ns, timeout_function, user_data);
 		if (timeout_callback)
 		{
-			if (!(ADD_OBJECT_TO_LIST(Event_dispatcher_timeout_callback)(
-				timeout_callback, event_dispatcher->timeout_list)))
+			if (!Event_dispatcher_timeout_heap_add(event_dispatcher, timeout_callback))
 			{
 				DESTROY(Event_dispatcher_timeout_callback)(&timeout_callback);
 				timeout_callback = (struct Event_dispatcher_timeout_callback *)NULL;
@@ -1843,7 +2068,7 @@ DESCRIPTION :
 
 	ENTER(Event_dispatcher_remove_timeout_callback);
 
-	if (event_dispatcher && event_dispatcher->timeout_list && callback_id)
+	if (event_dispatcher && callback_id)
 	{
 #if defined (USE_GTK_MAIN_STEP)
 		gtk_timeout_remove(callback_id->gtk_timeout_id);
@@ -1856,8 +2081,7 @@ DESCRIPTION :
 		return_code = 1;
 		KillTimer(event_dispatcher->networkWindowHandle, (ULONG)callback_id);
 #elif defined (USE_GENERIC_EVENT_DISPATCHER)
-		return_code = REMOVE_OBJECT_FROM_LIST(Event_dispatcher_timeout_callback)
-			(callback_id, event_dispatcher->timeout_list);
+		return_code = Event_dispatcher_timeout_heap_remove(event_dispatcher, callback_id);
 #else /* switch (USER_INTERFACE) */
 #error remove timeout callbacks not defined on this platform
 #endif /* switch (USER_INTERFACE) */
@@ -2040,7 +2264,7 @@ DESCRIPTION :
 
 	ENTER(Event_dispatcher_remove_idle_callback);
 
-	if (event_dispatcher && event_dispatcher->timeout_list && callback_id)
+	if (event_dispatcher && event_dispatcher->idle_list && callback_id)
 	{
 #if defined (USE_XTAPP_CONTEXT)
 		XtRemoveWorkProc(callback_id->xt_idle_id);
@@ -2065,6 +2289,64 @@ DESCRIPTION :
 	return (return_code);
 } /* Event_dispatcher_remove_idle_callback */
 
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+static int Fdio_event_dispatcher_dispatch_function(void *user_data);
+
+static int Event_dispatcher_epoll_wait(struct Event_dispatcher *event_dispatcher,
+	int timeout_ms)
+/*******************************************************************************
+Waits up to <timeout_ms>, or indefinitely if negative, for registered Fdios to
+become ready and queues them for dispatch, replacing any earlier queue.
+Returns the number of ready Fdios, 0 if none or interrupted, or -1 on error.
+==============================================================================*/
+{
+	struct epoll_event events[EVENT_DISPATCHER_EPOLL_MAX_EVENTS];
+	int i, number_of_events;
+
+	event_dispatcher->number_of_ready_fdios = 0;
+	event_dispatcher->next_ready_fdio = 0;
+	if (-1 == event_dispatcher->epoll_descriptor)
+	{
+		return 0;
+	}
+	number_of_events = epoll_wait(event_dispatcher->epoll_descriptor, events,
+		EVENT_DISPATCHER_EPOLL_MAX_EVENTS, timeout_ms);
+	if (-1 == number_of_events)
+	{
+		return (EINTR == errno) ? 0 : -1;
+	}
+	for (i = 0; i < number_of_events; i++)
+	{
+		struct Fdio *io = (struct Fdio *)events[i].data.ptr;
+		/* hang up and error are reported as readable, as with select */
+		io->ready_to_read = (0 != (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)));
+		io->ready_to_write = (0 != (events[i].events & (EPOLLOUT | EPOLLERR)));
+		event_dispatcher->ready_fdios[i] = io;
+	}
+	event_dispatcher->number_of_ready_fdios = number_of_events;
+	return number_of_events;
+}
+
+static struct Fdio *Event_dispatcher_get_next_ready_Fdio(
+	struct Event_dispatcher *event_dispatcher)
+/*******************************************************************************
+Returns the next queued ready Fdio not destroyed since it was queued, skipping
+destroyed ones, or NULL if none.
+==============================================================================*/
+{
+	while ((event_dispatcher->next_ready_fdio < event_dispatcher->number_of_ready_fdios) &&
+		(!event_dispatcher->ready_fdios[event_dispatcher->next_ready_fdio]))
+	{
+		++(event_dispatcher->next_ready_fdio);
+	}
+	if (event_dispatcher->next_ready_fdio < event_dispatcher->number_of_ready_fdios)
+	{
+		return event_dispatcher->ready_fdios[event_dispatcher->next_ready_fdio];
+	}
+	return (struct Fdio *)NULL;
+}
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
+
 int Event_dispatcher_do_one_event(struct Event_dispatcher *event_dispatcher)
 /*******************************************************************************
 LAST MODIFIED : 24 October 2002
@@ -2082,6 +2364,9 @@ DESCRIPTION :
 	struct Event_dispatcher_idle_callback *idle_callback;
 	struct Event_dispatcher_timeout_callback *timeout_callback;
 #endif /*  defined (USE_GENERIC_EVENT_DISPATCHER) */
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+	struct Fdio *ready_fdio;
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
 
 	ENTER(Event_dispatcher_do_one_event);
 
@@ -2114,10 +2399,17 @@ DESCRIPTION :
 		FOR_EACH_OBJECT_IN_LIST(Event_dispatcher_descriptor_callback)
 			(Event_dispatcher_descriptor_do_query_callback,
 			&descriptor_set, event_dispatcher->descriptor_list);
-		timeout_callback = FIRST_OBJECT_IN_LIST_THAT(Event_dispatcher_timeout_callback)
-			((LIST_CONDITIONAL_FUNCTION(Event_dispatcher_timeout_callback) *)NULL,
-			(void *)NULL, event_dispatcher->timeout_list);
-		if (event_dispatcher->special_idle_callback_pending && event_dispatcher->special_idle_callback)
+		/* earliest timeout is at the root of the heap */
+		timeout_callback = (0 < event_dispatcher->timeout_heap_size) ?
+			event_dispatcher->timeout_heap[0] : (struct Event_dispatcher_timeout_callback *)NULL;
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+		ready_fdio = Event_dispatcher_get_next_ready_Fdio(event_dispatcher);
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
+		if ((event_dispatcher->special_idle_callback_pending && event_dispatcher->special_idle_callback)
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+			|| ready_fdio
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
+			)
 		{
 			timeout.tv_sec = 0;
 			timeout.tv_usec = 0;
@@ -2181,11 +2473,62 @@ DESCRIPTION :
 			}
 		}
 		select_code = 0;
-		if (!(descriptor_callback = FIRST_OBJECT_IN_LIST_THAT(Event_dispatcher_descriptor_callback)
+		descriptor_callback = FIRST_OBJECT_IN_LIST_THAT(Event_dispatcher_descriptor_callback)
 			(Event_dispatcher_descriptor_callback_is_pending,
-			(void *)NULL, event_dispatcher->descriptor_list)))
+			(void *)NULL, event_dispatcher->descriptor_list);
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+		if ((!descriptor_callback) && (!ready_fdio) &&
+			(0 == NUMBER_IN_LIST(Event_dispatcher_descriptor_callback)(
+				event_dispatcher->descriptor_list)))
+		{
+			/* Only Fdios: wait on epoll alone, rounding the timeout up to whole
+				milliseconds so timeouts are not woken for early */
+			long timeout_ms = -1;
+			if (timeout_ptr)
+			{
+				timeout_ms = (long)timeout_ptr->tv_sec*1000 + (timeout_ptr->tv_usec + 999)/1000;
+				if (timeout_ms > INT_MAX)
+				{
+					timeout_ms = INT_MAX;
+				}
+			}
+			select_code = Event_dispatcher_epoll_wait(event_dispatcher, (int)timeout_ms);
+			ready_fdio = Event_dispatcher_get_next_ready_Fdio(event_dispatcher);
+			if (0 < select_code)
+			{
+				/* ready Fdios are dispatched below */
+				select_code = 0;
+			}
+		}
+		else if ((!descriptor_callback) && (!ready_fdio))
+		{
+			/* Wait on descriptor callbacks and epoll together */
+			if ((-1 != event_dispatcher->epoll_descriptor) &&
+				(event_dispatcher->epoll_descriptor < FD_SETSIZE))
+			{
+				FD_SET(event_dispatcher->epoll_descriptor, &(descriptor_set.read_set));
+			}
+			else if (-1 != event_dispatcher->epoll_descriptor)
+			{
+				/* too large for select: poll epoll now and limit the select wait */
+				if (0 < Event_dispatcher_epoll_wait(event_dispatcher, /*timeout_ms*/0))
+				{
+					ready_fdio = Event_dispatcher_get_next_ready_Fdio(event_dispatcher);
+				}
+				const long maximum_usec = ready_fdio ? 0 : EVENT_DISPATCHER_EPOLL_POLL_MICROSECONDS;
+				if ((!timeout_ptr) || (0 < timeout_ptr->tv_sec) ||
+					(timeout_ptr->tv_usec > maximum_usec))
+				{
+					timeout.tv_sec = 0;
+					timeout.tv_usec = maximum_usec;
+					timeout_ptr = &timeout;
+				}
+			}
+#else /* defined (USE_EPOLL_EVENT_DISPATCHER) */
+		if (!descriptor_callback)
 		{
-			if (-1 < (select_code = select(100, &(descriptor_set.read_set),
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
+			if (-1 < (select_code = select(FD_SETSIZE, &(descriptor_set.read_set),
 				&(descriptor_set.write_set), &(descriptor_set.error_set),
 				timeout_ptr)))
 			{
@@ -2203,6 +2546,15 @@ DESCRIPTION :
 					FIRST_OBJECT_IN_LIST_THAT(Event_dispatcher_descriptor_callback)
 					(Event_dispatcher_descriptor_callback_is_pending,
 					(void *)NULL, event_dispatcher->descriptor_list);
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+				if ((-1 != event_dispatcher->epoll_descriptor) &&
+					(event_dispatcher->epoll_descriptor < FD_SETSIZE) &&
+					FD_ISSET(event_dispatcher->epoll_descriptor, &(descriptor_set.read_set)))
+				{
+					Event_dispatcher_epoll_wait(event_dispatcher, /*timeout_ms*/0);
+					ready_fdio = Event_dispatcher_get_next_ready_Fdio(event_dispatcher);
+				}
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
 			}
 		}
 		if (descriptor_callback)
@@ -2215,6 +2567,18 @@ DESCRIPTION :
 			descriptor_callback->pending = 0;
 			(*descriptor_callback->dispatch_callback)(descriptor_callback->user_data);
 		}
+#if defined (USE_EPOLL_EVENT_DISPATCHER)
+		else if (ready_fdio)
+		{
+			if (event_dispatcher->special_idle_callback)
+			{
+				event_dispatcher->special_idle_callback_pending = 1;
+			}
+			event_dispatcher->ready_fdios[event_dispatcher->next_ready_fdio] = (struct Fdio *)NULL;
+			++(event_dispatcher->next_ready_fdio);
+			Fdio_event_dispatcher_dispatch_function(ready_fdio);
+		}
+#endif /* defined (USE_EPOLL_EVENT_DISPATCHER) */
 		else
 		{
 			if (select_code == 0)
@@ -2230,11 +2594,13 @@ DESCRIPTION :
 					{
 						event_dispatcher->special_idle_callback_pending = 1;
 					}
-					/* Do it now */
+					/* Remove it from the heap first so the callback may add or remove
+						timeouts, then do it now */
+					ACCESS(Event_dispatcher_timeout_callback)(timeout_callback);
+					Event_dispatcher_timeout_heap_remove(event_dispatcher, timeout_callback);
 					callback_code = (*timeout_callback->timeout_function)(
 						timeout_callback->user_data);
-					REMOVE_OBJECT_FROM_LIST(Event_dispatcher_timeout_callback)
-						(timeout_callback, event_dispatcher->timeout_list);
+					DEACCESS(Event_dispatcher_timeout_callback)(&timeout_callback);
 				}
 				else
 				{
@@ -2486,7 +2852,253 @@ This function creates an Fdio object, given a Fdio_package and a descriptor.
  * easier to write the whole thing again for each option than to put
  * preprocessor conditionals in every single function.
 */
-#if defined(USE_GENERIC_EVENT_DISPATCHER)
+#if defined(USE_EPOLL_EVENT_DISPATCHER)
+static int Fdio_set_callback(struct Fdio_callback_data *callback_data,
+	Fdio_callback callback,
+	void *app_user_data)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+This function sets the callback and user data for a given callback_data structure.
+==============================================================================*/
+{
+	ENTER(Fdio_set_callback);
+	callback_data->function = callback;
+	callback_data->app_user_data = app_user_data;
+	LEAVE;
+
+	return (1);
+} /* Fdio_set_callback (epoll version) */
+
+static int Fdio_update_epoll_registration(Fdio_id io)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Registers, modifies or removes the epoll registration of the descriptor of <io>
+to match the callbacks currently set on it. Registrations persist between
+events so nothing is done unless the callbacks change.
+==============================================================================*/
+{
+	struct epoll_event event;
+	int operation, return_code;
+	unsigned int events;
+
+	ENTER(Fdio_update_epoll_registration);
+	return_code = 1;
+	events = (io->read_data.function ? (unsigned int)EPOLLIN : 0u) |
+		(io->write_data.function ? (unsigned int)EPOLLOUT : 0u);
+	if (events != io->epoll_events)
+	{
+		if (0 == io->epoll_events)
+		{
+			operation = EPOLL_CTL_ADD;
+		}
+		else if (0 == events)
+		{
+			operation = EPOLL_CTL_DEL;
+		}
+		else
+		{
+			operation = EPOLL_CTL_MOD;
+		}
+		memset(&event, 0, sizeof(event));
+		event.events = events;
+		event.data.ptr = io;
+		if (0 == epoll_ctl(io->event_dispatcher->epoll_descriptor, operation,
+			io->descriptor, &event))
+		{
+			io->epoll_events = events;
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE, "Fdio_update_epoll_registration.  "
+				"Unable to register descriptor %d with epoll", (int)io->descriptor);
+			return_code = 0;
+		}
+	}
+	LEAVE;
+
+	return (return_code);
+} /* Fdio_update_epoll_registration */
+
+Fdio_id Event_dispatcher_create_Fdio(struct Event_dispatcher *dispatcher,
+	cmzn_native_socket_t descriptor)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Creates a new Fdio, given an event dispatcher. The descriptor is registered
+with epoll once a read or write callback is set.
+==============================================================================*/
+{
+	struct Fdio *io;
+
+	ENTER(Event_dispatcher_create_Fdio);
+	io = (Fdio_id)NULL;
+	if (dispatcher && (-1 != dispatcher->epoll_descriptor))
+	{
+		if (ALLOCATE(io, struct Fdio, 1))
+		{
+			memset(io, 0, sizeof(*io));
+			io->event_dispatcher = dispatcher;
+			io->descriptor = descriptor;
+			io->callback = (struct Event_dispatcher_descriptor_callback *)NULL;
+			io->epoll_events = 0;
+			io->access_count = 0;
+		}
+		else
+		{
+			display_message(ERROR_MESSAGE, "Event_dispatcher_create_Fdio.  "
+				"Unable to allocate structure");
+		}
+	}
+	else
+	{
+		display_message(ERROR_MESSAGE,
+			"Event_dispatcher_create_Fdio.  Invalid argument(s)");
+	}
+	LEAVE;
+
+	return (io);
+} /* Event_dispatcher_create_Fdio (epoll version) */
+
+int DESTROY(Fdio)(Fdio_id *io)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Destroys the IO object. This causes cmgui to forget about the descriptor, but the
+descriptor itself must still be closed. This should be called as soon as the
+application is notified by the operating system of a closure event.
+==============================================================================*/
+{
+	struct Event_dispatcher *event_dispatcher;
+	int i;
+
+	ENTER(DESTROY(Fdio));
+	if ((*io)->is_reentrant)
+		(*io)->signal_to_destroy = 1;
+	else
+	{
+		event_dispatcher = (*io)->event_dispatcher;
+		if ((*io)->epoll_events)
+		{
+			/* event is ignored but must be non-NULL for older kernels */
+			struct epoll_event event;
+			memset(&event, 0, sizeof(event));
+			epoll_ctl(event_dispatcher->epoll_descriptor, EPOLL_CTL_DEL,
+				(*io)->descriptor, &event);
+		}
+		/* must not be dispatched if already reported ready */
+		for (i = event_dispatcher->next_ready_fdio;
+			i < event_dispatcher->number_of_ready_fdios; i++)
+		{
+			if (event_dispatcher->ready_fdios[i] == *io)
+			{
+				event_dispatcher->ready_fdios[i] = (struct Fdio *)NULL;
+			}
+		}
+		DEALLOCATE(*io);
+	}
+
+	*io = NULL;
+
+	LEAVE;
+
+	return (1);
+} /* DESTROY(Fdio) (epoll version) */
+
+int Fdio_set_read_callback(Fdio_id handle,
+	Fdio_callback callback,
+	void *user_data)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Sets a read callback on the specified IO handle. This callback is called at
+least once after a read function indicates it would block. An application
+should not rely upon it being called more than once without attempting a
+read between the calls. This read should occur after Fdio_set_read_callback
+is called. The callback will also be called if the underlying descriptor is
+closed by the peer. The callback is not one-shot, and the callback remains in
+effect until it is explicitly cancelled.
+
+There may be at most one read callback set per I/O handle at any one time. If
+this function is passed NULL as the callback parameter, the read callback
+previously set will be cancelled.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Fdio_set_read_callback);
+	Fdio_set_callback(&handle->read_data, callback, user_data);
+	return_code = Fdio_update_epoll_registration(handle);
+	LEAVE;
+
+	return (return_code);
+} /* Fdio_set_read_callback (epoll version) */
+
+int Fdio_set_write_callback(Fdio_id handle,
+	Fdio_callback callback,
+	void *user_data)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Sets a write callback on the specified Fdio handle. This callback is called at
+least once after a write function indicates it would block. An application
+should not rely upon it being called more than once without attempting a
+write between the calls. This write should occur after Fdio_set_write_callback
+is called. The callback is not one-shot, and the callback remains in
+effect until it is explicitly cancelled.
+
+There may be at most one write callback set per I/O handle at any one time. If
+this function is passed NULL as the callback parameter, the write callback
+previously set will be cancelled.
+==============================================================================*/
+{
+	int return_code;
+
+	ENTER(Fdio_set_write_callback);
+	Fdio_set_callback(&handle->write_data, callback, user_data);
+	return_code = Fdio_update_epoll_registration(handle);
+	LEAVE;
+
+	return (return_code);
+} /* Fdio_set_write_callback (epoll version) */
+
+static int Fdio_event_dispatcher_dispatch_function(void *user_data)
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Calls the read and/or write callbacks of the Fdio <user_data> reported ready by
+epoll.
+==============================================================================*/
+{
+	Fdio_id io;
+
+	ENTER(Fdio_event_dispatcher_dispatch_function);
+	io = (Fdio_id)user_data;
+
+	io->is_reentrant = 1;
+	if (io->read_data.function && io->ready_to_read)
+		io->read_data.function(io, io->read_data.app_user_data);
+	if (io->write_data.function &&
+		io->ready_to_write &&
+		!io->signal_to_destroy)
+		io->write_data.function(io, io->write_data.app_user_data);
+	io->is_reentrant = 0;
+	if (io->signal_to_destroy)
+		DESTROY(Fdio)(&io);
+	LEAVE;
+
+	return (1);
+} /* Fdio_event_dispatcher_dispatch_function (epoll version) */
+
+#elif defined(USE_GENERIC_EVENT_DISPATCHER)
 static int Fdio_event_dispatcher_query_function(
 	struct Event_dispatcher_descriptor_set *descriptor_set,
 	void *user_data
@@ -2650,7 +3262,7 @@ previously set will be cancelled.
 ==============================================================================*/
 {
 	ENTER(Fdio_set_write_callback);
-	Fdio_set_callback(&handle->read_data, callback, user_data);
+	Fdio_set_callback(&handle->write_data, callback, user_data);
 	LEAVE;
 
 	return (1);
@@ -2913,10 +3525,172 @@ previously set will be cancelled.
 
 #elif defined(WX_USER_INTERFACE)
 
+#if defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING)
+class wxFdioWatcher :
+#if defined (USE_WX_FDIO_SOURCE)
+	public wxObject, public wxEventLoopSourceHandler
+#else /* defined (USE_WX_FDIO_SOURCE) */
+	public wxTimer
+#endif /* defined (USE_WX_FDIO_SOURCE) */
+/*******************************************************************************
+LAST MODIFIED : 17 October 2026
+
+DESCRIPTION :
+Watches the descriptor of an Fdio while it has a read or write callback, calling
+the callbacks when it is ready. With wx 3 the descriptor is an event loop source
+so callbacks are made as soon as it is ready; older wx polls it every
+EVENT_DISPATCHER_WX_FDIO_POLL_MILLISECONDS. An Fdio destroyed by its own
+callback is only destroyed once the callbacks return, and this watcher is then
+deleted when the application is next idle.
+==============================================================================*/
+{
+	struct Fdio *io;
+#if defined (USE_WX_FDIO_SOURCE)
+	wxEventLoopSource *source;
+	int source_flags;
+
+	void OnReadWaiting()
+	{
+		dispatch(/*read_ready*/true, /*write_ready*/false);
+	}
+
+	void OnWriteWaiting()
+	{
+		dispatch(/*read_ready*/false, /*write_ready*/true);
+	}
+
+	/* errors and hang ups are reported through the read callback */
+	void OnExceptionWaiting()
+	{
+		dispatch(/*read_ready*/true, /*write_ready*/false);
+	}
+#else /* defined (USE_WX_FDIO_SOURCE) */
+	void Notify()
+	{
+		struct pollfd poll_descriptor;
+		poll_descriptor.fd = io->descriptor;
+		poll_descriptor.events = 0;
+		poll_descriptor.revents = 0;
+		if (io->read_data.function)
+		{
+			poll_descriptor.events |= POLLIN;
+		}
+		if (io->write_data.function)
+		{
+			poll_descriptor.events |= POLLOUT;
+		}
+		if (0 < poll(&poll_descriptor, 1, /*timeout*/0))
+		{
+			dispatch(0 != (poll_descriptor.revents & (POLLIN | POLLHUP | POLLERR)),
+				0 != (poll_descriptor.revents & POLLOUT));
+		}
+	}
+#endif /* defined (USE_WX_FDIO_SOURCE) */
+
+	void dispatch(bool read_ready, bool write_ready)
+	{
+		io->is_reentrant = 1;
+		if (read_ready && io->read_data.function)
+		{
+			(io->read_data.function)(io, io->read_data.app_user_data);
+		}
+		if ((!io->signal_to_destroy) && write_ready && io->write_data.function)
+		{
+			(io->write_data.function)(io, io->write_data.app_user_data);
+		}
+		io->is_reentrant = 0;
+		if (io->signal_to_destroy)
+		{
+			/* this watcher is still executing so cannot be deleted yet */
+			DEALLOCATE(io);
+#if defined (USE_WX_FDIO_SOURCE)
+			wxTheApp->ScheduleForDestruction(this);
+#else /* defined (USE_WX_FDIO_SOURCE) */
+			if (!wxPendingDelete.Member(this))
+			{
+				wxPendingDelete.Append(this);
+			}
+#endif /* defined (USE_WX_FDIO_SOURCE) */
+		}
+	}
+
+public:
+	wxFdioWatcher(struct Fdio *io) :
+		io(io)
+#if defined (USE_WX_FDIO_SOURCE)
+		, source(0),
+		source_flags(0)
+#endif /* defined (USE_WX_FDIO_SOURCE) */
+	{
+	}
+
+#if defined (USE_WX_FDIO_SOURCE)
+	~wxFdioWatcher()
+	{
+		delete source;
+	}
+#endif /* defined (USE_WX_FDIO_SOURCE) */
+
+	/** Watches the descriptor for the callbacks the Fdio has set, if any. */
+	void update()
+	{
+#if defined (USE_WX_FDIO_SOURCE)
+		int flags = 0;
+		if (io->read_data.function)
+		{
+			flags |= wxEVENT_SOURCE_INPUT | wxEVENT_SOURCE_EXCEPTION;
+		}
+		if (io->write_data.function)
+		{
+			flags |= wxEVENT_SOURCE_OUTPUT;
+		}
+		if (flags != source_flags)
+		{
+			/* deleting the source stops the event loop watching the descriptor */
+			delete source;
+			source = 0;
+			source_flags = 0;
+			if (flags)
+			{
+				wxAppTraits *traits = wxTheApp ? wxTheApp->GetTraits() : 0;
+				wxEventLoopSourcesManagerBase *sources_manager =
+					traits ? traits->GetEventLoopSourcesManager() : 0;
+				if (sources_manager)
+				{
+					source = sources_manager->AddSourceForFD(io->descriptor, this, flags);
+				}
+				if (source)
+				{
+					source_flags = flags;
+				}
+				else
+				{
+					display_message(ERROR_MESSAGE, "wxFdioWatcher::update.  "
+						"Could not watch descriptor %d", (int)io->descriptor);
+				}
+			}
+		}
+#else /* defined (USE_WX_FDIO_SOURCE) */
+		if (io->read_data.function || io->write_data.function)
+		{
+			if (!IsRunning())
+			{
+				Start(EVENT_DISPATCHER_WX_FDIO_POLL_MILLISECONDS, wxTIMER_CONTINUOUS);
+			}
+		}
+		else if (IsRunning())
+		{
+			Stop();
+		}
+#endif /* defined (USE_WX_FDIO_SOURCE) */
+	}
+}; /* class wxFdioWatcher */
+#endif /* defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING) */
+
 Fdio_id Event_dispatcher_create_Fdio(struct Event_dispatcher *dispatcher,
 	cmzn_native_socket_t descriptor)
 /*******************************************************************************
-LAST MODIFIED : 16 May 2005
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
 Creates a new Fdio, given an event dispatcher and a descriptor.
@@ -2932,6 +3706,11 @@ Creates a new Fdio, given an event dispatcher and a descriptor.
 		io->event_dispatcher = dispatcher;
 		io->descriptor = descriptor;
 		io->access_count = 0;
+#if defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING)
+		io->is_reentrant = 0;
+		io->signal_to_destroy = 0;
+		io->wx_watcher = new wxFdioWatcher(io);
+#endif /* defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING) */
 	}
 	else
 	{
@@ -2939,18 +3718,14 @@ Creates a new Fdio, given an event dispatcher and a descriptor.
 			"Unable to allocate structure");
 	}
 
-	//	io->iochannel = g_io_channel_unix_new(descriptor);
-	//	io->read_source_tag = 0;
-	// io->write_source_tag = 0;
-
 	LEAVE;
 
 	return (io);
-} /* Event_dispatcher_create_fdio (glib) */
+} /* Event_dispatcher_create_fdio (wx) */
 
 int DESTROY(Fdio)(Fdio_id *io)
 /*******************************************************************************
-LAST MODIFIED : 16 May 2005
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
 Destroys the IO object. This causes cmgui to forget about the descriptor, but the
@@ -2958,31 +3733,27 @@ descriptor itself must still be closed. This should be called as soon as the
 application is notified by the operating system of a closure event.
 ==============================================================================*/
 {
-	if ((*io)->read_data.function)
-	{
-		Fdio_set_read_callback(*io, NULL, NULL);
-	}
-	else if ((*io)->write_data.function)
+	Fdio_set_read_callback(*io, NULL, NULL);
+	Fdio_set_write_callback(*io, NULL, NULL);
+#if defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING)
+	if ((*io)->is_reentrant)
 	{
-		Fdio_set_write_callback(*io, NULL, NULL);
+		/* destroyed when its callbacks return */
+		(*io)->signal_to_destroy = 1;
+		*io = NULL;
+		return (1);
 	}
-
-	// g_io_channel_unref((*io)->iochannel);
-
-	// if ((*io)->read_source_tag != 0)
-	//	g_source_remove((*io)->read_source_tag);
-	//if ((*io)->write_source_tag != 0)
-	//	g_source_remove((*io)->write_source_tag);
-
+	delete (*io)->wx_watcher;
+#endif /* defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING) */
 	DEALLOCATE((*io));
 	*io = NULL;
 	return (1);
-} /* DESTROY(Fdio) (glib) */
+} /* DESTROY(Fdio) (wx) */
 
 int Fdio_set_read_callback(Fdio_id handle, Fdio_callback callback,
 	void *user_data)
 /*******************************************************************************
-LAST MODIFIED : 16 May 2005
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
 Sets a read callback on the specified IO handle. This callback is called at
@@ -2996,6 +3767,9 @@ effect until it is explicitly cancelled.
 There may be at most one read callback set per I/O handle at any one time. If
 this function is passed NULL as the callback parameter, the read callback
 previously set will be cancelled.
+On Unix the descriptor is watched by the wx event loop while a callback is
+set, or with wx older than 3.0 polled every
+EVENT_DISPATCHER_WX_FDIO_POLL_MILLISECONDS.
 ==============================================================================*/
 {
 	ENTER(Fdio_set_read_callback);
@@ -3003,31 +3777,25 @@ previously set will be cancelled.
 	if (callback == NULL)
 	{
 		handle->read_data.function = NULL;
-		//		if (handle->read_source_tag != 0)
-		//{
-		//	g_source_remove(handle->read_source_tag);
-		//	handle->read_source_tag = 0;
-		//}
 	}
 	else
 	{
 		handle->read_data.function = callback;
 		handle->read_data.app_user_data = user_data;
-		//if (handle->read_source_tag == 0)
-		//	handle->read_source_tag =
-		//		g_io_add_watch(handle->iochannel, G_IO_IN | G_IO_HUP,
-		//			Fdio_glib_io_callback, handle);
 	}
+#if defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING)
+	handle->wx_watcher->update();
+#endif /* defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING) */
 
 	LEAVE;
 
 	return (1);
-} /* Fdio_set_read_callback (glib version) */
+} /* Fdio_set_read_callback (wx version) */
 
 int Fdio_set_write_callback(Fdio_id handle, Fdio_callback callback,
 	void *user_data)
 /*******************************************************************************
-LAST MODIFIED : 16 May 2005
+LAST MODIFIED : 17 October 2026
 
 DESCRIPTION :
 Sets a write callback on the specified IO handle. This callback is called at
@@ -3047,26 +3815,20 @@ previously set will be cancelled.
 	if (callback == NULL)
 	{
 		handle->write_data.function = NULL;
-		//if (handle->write_source_tag != 0)
-		//{
-		//	g_source_remove(handle->write_source_tag);
-		//	handle->write_source_tag = 0;
-		//}
 	}
 	else
 	{
 		handle->write_data.function = callback;
 		handle->write_data.app_user_data = user_data;
-		//if (handle->write_source_tag == 0)
-		//	handle->write_source_tag =
-		//		g_io_add_watch(handle->iochannel, G_IO_OUT,
-		//			Fdio_glib_io_callback, handle);
 	}
+#if defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING)
+	handle->wx_watcher->update();
+#endif /* defined (USE_WX_FDIO_SOURCE) || defined (USE_WX_FDIO_POLLING) */
 
 	LEAVE;
 
 	return (1);
-} /* Fdio_set_write_callback (glib version) */
+} /* Fdio_set_write_callback (wx version) */
 #elif defined(USE_GTK_MAIN_STEP)
 
 Fdio_id Event_dispatcher_create_Fdio(struct Event_dispatcher *dispatcher,